@@ -0,0 +1,314 @@
+"""Benchmarks of the LEED engine.
+
+A benchmark is a list of cases: the examples and synthetic structures that
+sweep one parameter at a time (angular momentum, superstructure, atoms per
+composite layer, energy range) around a Ni(111) reference. Every case is run
+in a fresh process, so that its peak memory is its own, and is reported with
+its wall time and the time spent in the stages of the calculation
+(PROFILE_STAGES). The report is a JSON file that can be compared with the
+report of an earlier build (compare_reports).
+"""
+
+import datetime
+import json
+import multiprocessing
+import platform
+import resource
+import time
+from dataclasses import dataclass, field
+from pathlib import Path
+
+from .config import InputParameters
+from .interface.cleed import PROFILE_STAGES, LeedSession, result_profile
+from .version import __version__
+
+# Ni(111) surface cell [A].
+A1 = (1.2450, 2.1564)
+A2 = (1.2450, -2.1564)
+# In-plane positions of the fcc stacking sites A, B, C.
+SITES = ((0.0, 0.0), (1.2450, -0.7188), (1.2450, 0.7188))
+LAYER_DISTANCE = 2.0330
+
+# Values of the synthetic sweeps.
+SWEEPS = {
+    "l_max": (6, 8, 10, 12, 14),
+    "superstructure": (1, 2, 3, 4),
+    "composite_atoms": (1, 2, 5, 10, 20),
+    "energy_final": (150.0, 300.0, 450.0, 600.0),
+}
+EXAMPLES = ("ni111_cu_leed", "ni111_2x2O_leed")
+
+# Reference of the synthetic sweeps; every sweep changes one of these.
+REFERENCE = {
+    "l_max": 8,
+    "superstructure": 1,
+    "energy_initial": 70.0,
+    "energy_final": 250.0,
+    "energy_step": 4.0,
+}
+# Cell (n x n) and plane spacing [A] of the composite layer sweep; planes
+# closer than 1 A are combined into one composite layer.
+COMPOSITE_CELL = 3
+COMPOSITE_SPACING = 0.6
+
+
+@dataclass
+class BenchmarkCase:
+    """A single benchmark: either an input file (`parameters_file`, used
+    for the parameters and the bulk) or a synthetic `config`."""
+
+    name: str
+    sweep: str
+    value: float | str
+    parameters_file: str | None = None
+    config: dict | None = field(default=None, repr=False)
+
+
+def _atom(phase_file, x, y, z, dr=0.025):
+    return {
+        "phase_file": phase_file,
+        "position": [x, y, z],
+        "vibrational_displacement": ["dr3", dr, dr, dr],
+    }
+
+
+def _cell_offsets(n):
+    """In-plane translations of the 1x1 cell within an n x n cell."""
+    return [
+        (i * A1[0] + j * A2[0], i * A1[1] + j * A2[1])
+        for i in range(n)
+        for j in range(n)
+    ]
+
+
+def synthetic_config(
+    l_max=REFERENCE["l_max"],
+    superstructure=REFERENCE["superstructure"],
+    composite_atoms=None,
+    energy_final=REFERENCE["energy_final"],
+    phase_file="Ni",
+    adatom_phase_file="Cu",
+) -> dict:
+    """Input parameters of a synthetic Ni(111) structure.
+
+    The overlayer consists of two Ni layers and an adatom per
+    `superstructure` x `superstructure` cell. If `composite_atoms` is given,
+    the overlayer is instead a single composite layer of that many Ni atoms
+    in a COMPOSITE_CELL x COMPOSITE_CELL cell, spread over up to three
+    planes COMPOSITE_SPACING apart.
+    """
+    if composite_atoms is None:
+        n = superstructure
+        overlayers = [_atom(adatom_phase_file, 0.0, 0.0, 3 * LAYER_DISTANCE, 0.032)]
+        for x, y in _cell_offsets(n):
+            overlayers.append(
+                _atom(phase_file, SITES[1][0] + x, SITES[1][1] + y, 2 * LAYER_DISTANCE)
+            )
+            overlayers.append(
+                _atom(phase_file, SITES[2][0] + x, SITES[2][1] + y, LAYER_DISTANCE)
+            )
+    else:
+        n = COMPOSITE_CELL
+        offsets = _cell_offsets(n)
+        if composite_atoms > len(offsets) * len(SITES):
+            raise ValueError(
+                f"At most {len(offsets) * len(SITES)} atoms per composite layer"
+            )
+        overlayers = [
+            _atom(
+                phase_file,
+                SITES[k][0] + x,
+                SITES[k][1] + y,
+                LAYER_DISTANCE + k * COMPOSITE_SPACING,
+            )
+            for x, y in offsets
+            for k in range(len(SITES))
+        ][:composite_atoms]
+
+    return {
+        "system_name": "Ni(111) benchmark",
+        "unit_cell": {
+            "a1": [A1[0], A1[1], 0.0],
+            "a2": [A2[0], A2[1], 0.0],
+            "a3": [0.0, 0.0, -3 * LAYER_DISTANCE],
+        },
+        "superstructure_matrix": {"m1": [n, 0.0], "m2": [0.0, n]},
+        "overlayers": overlayers,
+        "bulk_layers": [
+            _atom(phase_file, *SITES[k], -k * LAYER_DISTANCE) for k in range(3)
+        ],
+        "minimum_radius": {phase_file: 0.9, adatom_phase_file: 0.9},
+        "optical_potential": [-8.0, 4.0],
+        "energy_range": {
+            "initial": REFERENCE["energy_initial"],
+            "final": energy_final,
+            "step": REFERENCE["energy_step"],
+        },
+        "maximum_angular_momentum": l_max,
+    }
+
+
+def benchmark_cases(sweeps=None, examples_path=None) -> list[BenchmarkCase]:
+    """The cases of the sweeps named in `sweeps` (SWEEPS and "examples";
+    None: all of them). The examples are taken from `examples_path`."""
+    cases = []
+    for sweep in sweeps or ("examples", *SWEEPS):
+        if sweep == "examples":
+            if examples_path is None:
+                raise ValueError("The examples need examples_path")
+            for example in EXAMPLES:
+                cases.append(
+                    BenchmarkCase(
+                        name=example,
+                        sweep="examples",
+                        value=example,
+                        parameters_file=str(Path(examples_path) / example / "leed.inp"),
+                    )
+                )
+            continue
+        if sweep not in SWEEPS:
+            raise ValueError(f"Unknown sweep {sweep}")
+        for value in SWEEPS[sweep]:
+            cases.append(
+                BenchmarkCase(
+                    name=f"{sweep}={value}",
+                    sweep=sweep,
+                    value=value,
+                    config=synthetic_config(**{sweep: value}),
+                )
+            )
+    return cases
+
+
+def _session(case, phase_path, n_threads):
+    if case.parameters_file is not None:
+        return LeedSession(
+            case.parameters_file, case.parameters_file, phase_path, n_threads
+        )
+    config = InputParameters.model_validate(case.config)
+    return LeedSession.from_config(config, phase_path, n_threads)
+
+
+def run_case(case: BenchmarkCase, phase_path, n_threads=1, repeat=1) -> dict:
+    """Run a case `repeat` times (each with a new session, so that nothing
+    is reused from the caches of an earlier evaluation) and return the
+    measurements of the fastest run.
+
+    The peak memory is the maximum resident size of the calling process.
+    """
+    runs = []
+    for _ in range(repeat):
+        start = time.perf_counter()
+        session = _session(case, phase_path, n_threads)
+        setup_time = time.perf_counter() - start
+
+        start = time.perf_counter()
+        result = session.evaluate()
+        wall_time = time.perf_counter() - start
+
+        profile = result_profile(result)
+        runs.append(
+            {
+                "setup_time": setup_time,
+                "wall_time": wall_time,
+                "n_atoms": session.n_atoms,
+                "n_beams": result.n_beams,
+                "n_energies": result.n_energies,
+                "stage_time": dict(
+                    zip(PROFILE_STAGES, profile["time"].sum(axis=0).tolist())
+                ),
+                "stage_calls": dict(
+                    zip(PROFILE_STAGES, profile["calls"].sum(axis=0).tolist())
+                ),
+                "matrix_bytes": float(profile["bytes"].sum()),
+                "matrix_bytes_new": float(profile["bytes_new"].sum()),
+                "gmres_iterations": int(profile["mbg_iterations"].sum()),
+            }
+        )
+        session.close()
+
+    best = min(runs, key=lambda run: run["wall_time"])
+    best["wall_times"] = [run["wall_time"] for run in runs]
+    # ru_maxrss is in kilobytes on Linux, in bytes on macOS.
+    peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    best["peak_memory"] = peak if platform.system() == "Darwin" else 1024 * peak
+    return best
+
+
+def _run_case_process(args):
+    case, phase_path, n_threads, repeat = args
+    return run_case(case, phase_path, n_threads, repeat)
+
+
+def run_benchmark(
+    cases, phase_path, n_threads=1, repeat=1, output_file=None, log=print
+) -> dict:
+    """Run all cases, each in a new process, and return the report.
+
+    If `output_file` is given, the report is written to it (JSON) after
+    every case, so that an interrupted benchmark keeps what it has done.
+    """
+    report = {
+        "version": __version__,
+        "date": datetime.datetime.now().isoformat(timespec="seconds"),
+        "platform": platform.platform(),
+        "processor": platform.processor(),
+        "n_threads": n_threads,
+        "repeat": repeat,
+        "stages": list(PROFILE_STAGES),
+        "cases": [],
+    }
+
+    context = multiprocessing.get_context("spawn")
+    for case in cases:
+        with context.Pool(1, maxtasksperchild=1) as pool:
+            measurements = pool.apply(
+                _run_case_process, ((case, str(phase_path), n_threads, repeat),)
+            )
+        entry = {"name": case.name, "sweep": case.sweep, "value": case.value}
+        entry.update(measurements)
+        report["cases"].append(entry)
+        if log is not None:
+            log(
+                f"{case.name:28s} {entry['wall_time']:9.3f} s "
+                f"{entry['peak_memory'] / 2**20:9.1f} MB"
+            )
+        if output_file is not None:
+            write_report(report, output_file)
+
+    return report
+
+
+def write_report(report, output_file):
+    with open(output_file, "w") as f:
+        json.dump(report, f, indent=2)
+
+
+def load_report(report_file) -> dict:
+    with open(report_file) as f:
+        return json.load(f)
+
+
+def compare_reports(report, baseline) -> list[dict]:
+    """Ratios (report / baseline) of wall time and peak memory for the
+    cases present in both reports."""
+    base = {case["name"]: case for case in baseline["cases"]}
+    comparison = []
+    for case in report["cases"]:
+        if case["name"] not in base:
+            continue
+        old = base[case["name"]]
+        comparison.append(
+            {
+                "name": case["name"],
+                "wall_time": case["wall_time"] / old["wall_time"],
+                "peak_memory": case["peak_memory"] / old["peak_memory"],
+                "stage_time": {
+                    stage: (case["stage_time"][stage] / old["stage_time"][stage])
+                    if old["stage_time"][stage] > 0
+                    else None
+                    for stage in case["stage_time"]
+                },
+            }
+        )
+    return comparison
@@ -43,6 +43,35 @@ GH/10.07.10: include <stdlib.h> and <string.h> to avoid compiler warnings
 #define STDCTR stdout
 #define STDCPU stdout
 
+/*********************************************************************
+ control output selected at run time (matlog_set in matlog.c)
+
+ Control output is written only if its level does not exceed
+ matlog_level and its category is contained in matlog_cat:
+
+   if(LOG_ON(LOG_MS, LOG_CONTROL)) fprintf(STDCTR, ...);
+
+ The default is silence (matlog_level = LOG_NONE).
+*********************************************************************/
+
+#define LOG_NONE       0         /* no control output */
+#define LOG_CONTROL    1         /* control output (CONTROL) */
+#define LOG_CONTROL_X  2         /* extended control output (CONTROL_X) */
+
+#define LOG_INP     0x01         /* input (inp_*) */
+#define LOG_BM      0x02         /* beam lists (bm_*) */
+#define LOG_PC      0x04         /* phase shifts and t matrices (pc_*) */
+#define LOG_MS      0x08         /* multiple scattering (ms_*) */
+#define LOG_LD      0x10         /* layer doubling (ld_*) */
+#define LOG_QM      0x20         /* basic functions (qm*, cri*) */
+#define LOG_MAT     0x40         /* matrix library (mat*) */
+#define LOG_ALL     0x7f
+
+extern int matlog_level;
+extern int matlog_cat;
+
+#define LOG_ON(cat,level) ((matlog_level >= (level)) && (matlog_cat & (cat)))
+
 /*********************************************************************
  general mathematical definitions / constants
 *********************************************************************/
@@ -84,8 +113,8 @@ GH/10.07.10: include <stdlib.h> and <string.h> to avoid compiler warnings
  macros:
 *********************************************************************/
 
-#define MAX(x,y)  ((x)>(y))?(x):(y)
-#define MIN(x,y)  ((x)<(y))?(x):(y)
+#define MAX(x,y)  (((x)>(y))?(x):(y))
+#define MIN(x,y)  (((x)<(y))?(x):(y))
 #define SQUARE(x) (x)*(x)
 
 #define ODD(n)    ((n)%2)
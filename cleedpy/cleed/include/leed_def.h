@@ -203,6 +203,9 @@ struct var_str
  real epsilon;  /*   */
  int  l_max;    /* max. l quantum number used in the calculation */
  mat  *p_tl;    /* array of diagonal atomic scattering matrices (1st dim = lmax, 2nd dim = 1) */
+ int  lsum;     /* method for the lattice sums (LSUM_REAL/EWALD/AUTO) */
+ int  mbg_solver; /* solution of the giant matrix equations (MBG_*) */
+ real mbg_tol;  /* tolerance for MBG_GMRES */
 };
 
 /*********************************************************************
@@ -216,6 +219,181 @@ struct eng_str  /* contains all parameters that change during the energy loop
  real stp;      /* energy step */
 };
 
+/*********************************************************************
+  struct ctx_str holds everything that used to live in static
+  variables inside the calculation functions: the (shared, read-only)
+  Clebsch-Gordan and Ylm coefficient tables and the scratch matrices
+  and cache keys of the individual kernels.
+
+  One context is needed per concurrently running energy loop; the
+  coefficient tables are reference counted and shared between them.
+*********************************************************************/
+struct ld2lay_str     /* scratch storage of ld_2lay */
+{
+ mat Pp, Pm, Maux_a, Maux_b, Maux_c;
+ mat Tpp_ab, Tmm_ab, Rpm_ab, Rmp_ab;
+};
+
+struct bravl_str      /* lattice sum cache of ms_bravl_nd */
+{
+ real eng;            /* energy of the stored lattice sum */
+ int  set;            /* beam set of the stored lattice sum */
+ int  n_beams;
+ int  type;           /* atom type of the stored Tii */
+ int  l_max;
+
+ mat Llm, Tii;
+ mat Yin_p, Yin_m, Yout_p, Yout_m;
+};
+
+#define LSM_N_PAR 9          /* k_r, k_i, k_in[1,2], a[1..4], epsilon */
+
+struct lsij_str       /* interlayer lattice sums of ms_compl_nd */
+{
+ real par[LSM_N_PAR]; /* parameters the stored lattice sums are valid for */
+ int  l_max;
+
+ int  n_entries;
+ int  n_alloc;
+ real *d_ij;          /* interlayer vector of entry i: d_ij[4*i + 1..3] */
+ mat  *Llm_p, *Llm_m; /* lattice sums for +d_ij and -d_ij */
+};
+
+struct cumtl_str      /* angular momentum matrices used by pc_cumtl */
+{
+ int n_call;
+ int last_l;
+ mat Mx, My, Mz;
+ mat MxMx, MyMy, MzMz;
+};
+
+/*********************************************************************
+  struct prof_str holds the profiling counters of one energy: wall time
+  and number of calls of the main stages of the calculation (PROF_*),
+  the size of the matrix element arrays requested by the energy loop and
+  the number of GMRES iterations (MBG_GMRES).
+*********************************************************************/
+#define PROF_UPDATE   0      /* energy and phase shifts (pc_update) */
+#define PROF_BEAMS    1      /* beam selection (bm_select) */
+#define PROF_LSUM     2      /* lattice sums (one call per lattice sum) */
+#define PROF_TMAT     3      /* atomic and interlayer scattering matrices */
+#define PROF_MBG      4      /* giant matrix of composite layers */
+#define PROF_LD       5      /* layer doubling (ld_2lay, ld_2lay_rpm) */
+#define PROF_BULK     6      /* bulk layer doubling (ld_2n, one call per
+                                doubling iteration) */
+#define PROF_OUT      7      /* potential step and intensities */
+#define PROF_N_STAGES 8
+
+struct prof_str
+{
+ double time[PROF_N_STAGES];  /* wall time [s] */
+ long calls[PROF_N_STAGES];   /* number of calls */
+ double bytes;                /* matrix elements requested [bytes] */
+ double bytes_new;            /* thereof newly allocated (not pooled) */
+ long mbg_iter;               /* GMRES iterations of the giant matrices */
+};
+
+struct ctx_str
+{
+ struct cgc_str  *cgc;     /* Clebsch-Gordan coefficients (up to 2*l_max) */
+ struct ylmc_str *ylmc;    /* Ylm coefficients (up to 2*l_max) */
+ struct lsm_str  *lsm;     /* shared lattice sum cache (or NULL) */
+ int lsum;                 /* method for the lattice sums (LSUM_*) */
+ int n_threads;            /* threads for the loops within one energy */
+ struct prof_str *prof;    /* counters of the current energy (or NULL) */
+
+ mat Ylm;                  /* scratch for ms_ymat, ms_ymat_set, ms_ymmat */
+
+ struct ld2lay_str ld2lay;
+ struct bravl_str  bravl;
+ struct lsij_str   lsij;
+ struct cumtl_str  cumtl;
+};
+
+/*********************************************************************
+  struct rbc_str caches the bulk reflection matrices R_bulk of an
+  energy list (one entry per energy). An entry is only valid for the
+  bulk input it was computed for (key, see rbc_key) and for the same
+  beam list (beam_key).
+*********************************************************************/
+struct rbc_str
+{
+ unsigned long long key;       /* hash of the bulk input */
+ int n_eng;                    /* number of entries */
+ real *eng;                    /* energy of each entry */
+ unsigned long long *beam_key; /* hash of the beam list of each entry */
+ int *state;                   /* empty, written to file, or new */
+ mat *R_bulk;                  /* bulk reflection matrices */
+};
+
+/*********************************************************************
+  struct lmc_str caches the scattering matrices Tpp, Tmm, Rpm, Rmp of
+  single layers for an energy list (n_max entries per energy). An entry
+  is identified by the energy, the content of the layer (key, see
+  rbc_layer_key) and the beam list (beam_key); the least recently used
+  entry of an energy is replaced when all are taken.
+*********************************************************************/
+struct lmc_entry_str
+{
+ real eng;                     /* energy */
+ unsigned long long key;       /* hash of the layer content */
+ unsigned long long beam_key;  /* hash of the beam list */
+ unsigned long long used;      /* time of last use (0: empty) */
+ mat Tpp, Tmm, Rpm, Rmp;       /* layer scattering matrices */
+};
+
+struct lmc_str
+{
+ int n_eng;                    /* number of energies */
+ int n_max;                    /* max. number of entries per energy */
+ unsigned long long *clock;    /* access counter of each energy */
+ struct lmc_entry_str *entry;  /* n_eng * n_max entries */
+};
+
+/*********************************************************************
+  struct lsc_str keeps the reflection matrices of the partial overlayer
+  stacks (R_tot after each overlayer layer) of an energy list, so that
+  the stacking can restart above the lowest layer that has changed
+  since the last evaluation. Each stack is identified by its key (see
+  rbc_stack_key); all stacks of an energy belong to the same beam list.
+*********************************************************************/
+struct lsc_eng_str
+{
+ real eng;                     /* energy */
+ unsigned long long beam_key;  /* hash of the beam list */
+ int n_layers;                 /* number of valid stacks */
+ int n_alloc;                  /* allocated length of key and R_tot */
+ unsigned long long *key;      /* key of the stack up to layer i */
+ mat *R_tot;                   /* reflection matrix of that stack */
+};
+
+struct lsc_str
+{
+ int n_eng;                    /* number of energies */
+ struct lsc_eng_str *stack;    /* stacks of each energy */
+};
+
+/*********************************************************************
+  struct lsm_str caches the lattice sums Llm of ms_lsum_ii. An entry is
+  identified by all parameters of the lattice sum; the cache is shared
+  by the calculation contexts of all threads (see llsmcache.c).
+*********************************************************************/
+struct lsm_entry_str
+{
+ real par[LSM_N_PAR];          /* k_r, k_i, k_in[1,2], a[1..4], epsilon */
+ int l_max;
+ unsigned long long hash;      /* hash of par and l_max */
+ mat Llm;                      /* lattice sum */
+ struct lsm_entry_str *next;   /* next entry in the same hash slot */
+};
+
+struct lsm_str
+{
+ int n_entries;                /* number of entries stored */
+ int n_max;                    /* max. number of entries */
+ struct lsm_entry_str **slot;  /* hash slots (lists of entries) */
+};
+
 /*********************************************************************
  Fundamental constants/conversion factors
  (Source: CRC Handbook, 73rd Edition)
@@ -258,6 +436,8 @@ struct eng_str  /* contains all parameters that change during the energy loop
 #define K_TOLERANCE    1.e-4   /* tolerance for k_par in (BOHR)^-1 */
 #define LD_TOLERANCE   1.e-4   /* convergence criterion for layer doubling */
 #define WAVE_TOLERANCE 1.e-4   /* tolerance for wave amplitudes */
+#define MBG_TOLERANCE  1.e-8   /* rel. residual for iterative solutions */
+#define MBG_MAX_ITER   1000    /* max. number of GMRES iterations */
 
 /* Flags for mirror planes etc. */
 
@@ -267,6 +447,18 @@ struct eng_str  /* contains all parameters that change during the energy loop
 #define T_DIAG  0
 #define T_NOND  1
 
+/* Methods for the lattice sums of a periodic plane (ms_lsum_ewald) */
+
+#define LSUM_REAL   0      /* real space summation (ms_lsum_ii) */
+#define LSUM_EWALD  1      /* Ewald summation (ms_lsum_ii_ew) */
+#define LSUM_AUTO   2      /* Ewald summation for weak damping */
+
+/* Solution of the giant matrix equations of composite layers (ms_compl_nd) */
+
+#define MBG_LU      0      /* LU decomposition (ms_partsolve) */
+#define MBG_GMRES   1      /* iterative, matrix-free (ms_gmres) */
+#define MBG_INV     2      /* explicit inversion (ms_partinv) */
+
 #define S0  0
 #define SX  1
 #define SY  2
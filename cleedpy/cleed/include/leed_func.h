@@ -26,14 +26,28 @@ mat inp_mat_lm(mat , int , const char *);
 
    /* read bulk parameters; file linprdbul.c */
 int inp_rdbul_nd(struct cryst_str ** , struct phs_str ** , char *, char *, int *);
+void inp_bul_preset(struct cryst_str *);
+int inp_bul_setup(struct cryst_str *, struct atom_str *, int, real *, real *, real *);
 int inp_rdbulsym(struct cryst_str ** , struct phs_str ** , char *);
 
    /* read overlayer parameters; file linprdovl.c */
 int inp_rdovl   (struct cryst_str ** , struct phs_str ** , struct cryst_str * , char *);
-int inp_rdovl_nd(struct cryst_str **, struct phs_str **, struct cryst_str *, char *, char *, int *);
+int inp_rdovl_nd(struct cryst_str **, struct phs_str **, struct cryst_str *, char *, char *, int *,
+                 struct atom_str **);
+int inp_ovl_atoms(struct cryst_str *, struct cryst_str *, struct atom_str *, int);
 int inp_rdovlsym(struct cryst_str ** , struct phs_str ** , struct cryst_str * , char *);
+   /* set up parameters from memory; file linpstrnd.c */
+int inp_strbul_nd(struct cryst_str **, struct phs_str **, struct cryst_str *, real *,
+                  struct phs_str *, int *);
+int inp_strpar(struct var_str **, struct eng_str **, struct cryst_str *,
+               struct var_str *, struct eng_str *);
+int inp_strovl_nd(struct cryst_str **, struct phs_str **, struct cryst_str *,
+                  struct cryst_str *, struct phs_str *, int *, struct atom_str **);
    /* read other parameters; file linprdpar.c */
 int inp_rdpar(struct var_str **, struct eng_str **, struct cryst_str * , char *);
+int inp_par_setup(struct var_str *, struct eng_str *, struct cryst_str *);
+   /* read phase shifts; file linpphasend.c */
+int inp_phase_nd(char *, real *, int, struct phs_str **, int *);
    /* show all parameters; file linpshowbop.c */
 int inp_showbop(struct cryst_str *, struct cryst_str *, struct phs_str *);
    /* read and write parameters */
@@ -65,6 +79,58 @@ int bm_select(struct beam_str **, struct beam_str *,
     /* Find the beams of a particular beam set (lbmset.c) */
 int bm_set(struct beam_str **, struct beam_str *, int);
 
+/*********************************************************************
+ Calculation context (lctxalloc.c)
+*********************************************************************/
+struct ctx_str *ctx_alloc(int );
+int ctx_free(struct ctx_str *);
+int ctx_cg_coef(struct ctx_str *, int);
+
+/*********************************************************************
+ Profiling counters (lprof.c)
+*********************************************************************/
+double prof_time(struct prof_str *);
+void prof_add(struct prof_str *, int, double, long);
+
+/*********************************************************************
+ Cache of bulk reflection matrices (lrbcache.c)
+*********************************************************************/
+struct rbc_str *rbc_alloc(int );
+int rbc_free(struct rbc_str *);
+unsigned long long rbc_key(struct cryst_str *, struct phs_str *, struct var_str *);
+unsigned long long rbc_beam_key(struct beam_str *, int);
+unsigned long long rbc_layer_key(struct layer_str *, struct phs_str *, struct var_str *);
+unsigned long long rbc_stack_key(unsigned long long, unsigned long long, real *);
+int rbc_set_key(struct rbc_str *, unsigned long long);
+int rbc_get(struct rbc_str *, int, real, unsigned long long, mat *);
+int rbc_put(struct rbc_str *, int, real, unsigned long long, mat);
+int rbc_read(struct rbc_str *, real *, const char *);
+int rbc_write(struct rbc_str *, const char *);
+
+/*********************************************************************
+ Cache of layer scattering matrices (llmcache.c)
+*********************************************************************/
+struct lmc_str *lmc_alloc(int, int);
+int lmc_free(struct lmc_str *);
+int lmc_get(struct lmc_str *, int, real, unsigned long long, unsigned long long,
+            mat *, mat *, mat *, mat *);
+int lmc_put(struct lmc_str *, int, real, unsigned long long, unsigned long long,
+            mat, mat, mat, mat);
+struct lsc_str *lsc_alloc(int);
+int lsc_free(struct lsc_str *);
+int lsc_get(struct lsc_str *, int, real, unsigned long long,
+            unsigned long long *, int, mat *);
+int lsc_put(struct lsc_str *, int, real, unsigned long long,
+            int, unsigned long long, mat);
+
+/*********************************************************************
+ Cache of lattice sums (llsmcache.c)
+*********************************************************************/
+struct lsm_str *lsm_alloc(int);
+int lsm_free(struct lsm_str *);
+int lsm_get(struct lsm_str *, mat *, real, real, real *, real *, int, real);
+int lsm_put(struct lsm_str *, mat, real, real, real *, real *, int, real);
+
 /*********************************************************************
  Parameter control
 *********************************************************************/
@@ -72,14 +138,14 @@ int bm_set(struct beam_str **, struct beam_str *, int);
 int pc_reset(struct var_str *, struct cryst_str *);
 
     /* update energy (lpcupdate.c) and tl (lpcmktl.c) */
-int pc_update(struct var_str *, struct phs_str *, real);
-mat *pc_mktl(mat *, struct phs_str *, int, real);
-mat *pc_mktl_nd(mat *, struct phs_str *, int, real);
+int pc_update(struct ctx_str *, struct var_str *, struct phs_str *, real);
+mat *pc_mktl(struct ctx_str *, mat *, struct phs_str *, int, real);
+mat *pc_mktl_nd(struct ctx_str *, mat *, struct phs_str *, int, real);
 
     /* temperature dependent scattering factors */
-mat pc_temtl(mat , mat , real , real , int , int );
-mat pc_cumtl(mat , mat , real , real , real , real , int , int );
-int pc_mk_ms(mat * , mat *, mat *, mat *, mat *, mat *, int );
+mat pc_temtl(struct ctx_str *, mat , mat , real , real , int , int );
+mat pc_cumtl(struct ctx_str *, mat , mat , real , real , real , real , int , int );
+int pc_mk_ms(struct ctx_str *, mat * , mat *, mat *, mat *, mat *, mat *, int );
 
 /*********************************************************************
  Output
@@ -94,13 +160,13 @@ double cpu_time(FILE *, const char *);
  Layer doubling
 *********************************************************************/
    /* LD for 2 layers */
-int ld_2lay (mat *, mat *, mat *, mat *,
+int ld_2lay (struct ctx_str *, mat *, mat *, mat *, mat *,
              mat, mat, mat, mat, mat, mat, mat, mat,
              struct beam_str *, real *);
 mat ld_2lay_rpm (mat, mat, mat, mat, mat, mat,
              struct beam_str *, real *);
    /* LD for periodic layers */
-mat ld_2n (mat, mat, mat, mat, mat, struct beam_str *, real *);
+mat ld_2n (struct ctx_str *, mat, mat, mat, mat, mat, struct beam_str *, real *);
    /* LD for potential step */
 mat ld_potstep ( mat , mat , struct beam_str *, real , real *);
 mat ld_potstep0 ( mat , mat , struct beam_str *, real , real *);
@@ -110,39 +176,44 @@ mat ld_potstep0 ( mat , mat , struct beam_str *, real , real *);
 *********************************************************************/
 
    /* Don't know yet */
-int ms_bravl ( mat *, mat *,
-               struct var_str *, struct layer_str *, struct beam_str *);
-int ms_bravl_nd ( mat *, mat *, mat *, mat *,
+int ms_bravl_nd ( struct ctx_str *, mat *, mat *, mat *, mat *,
                struct var_str *, struct layer_str *, struct beam_str *);
 int ms_bravl_sym ( mat *, mat *,
                struct var_str *, struct layer_str *, struct beam_str *);
-int ms_compl ( mat *, mat *, mat *, mat *,
-               struct var_str *, struct layer_str *, struct beam_str *);
-int ms_compl_nd ( mat *, mat *, mat *, mat *,
+int ms_compl_nd ( struct ctx_str *, mat *, mat *, mat *, mat *,
                struct var_str *, struct layer_str *, struct beam_str *);
 int ms_complsym ( mat *, mat *, mat *, mat *,
                struct var_str *, struct layer_str * ,struct beam_str *);
 
    /* lattice sum for one layer (lmslsumii.c) */
-mat ms_lsum_ii (mat , real , real , real * , real * , int , real );
+mat ms_lsum_ii (struct ctx_str *, mat , real , real , real * , real * , int , real );
+
+   /* lattice sum for one layer by Ewald summation (lmslsumew.c) */
+mat ms_lsum_ii_ew (struct ctx_str *, mat , real , real , real * , real * , int , real );
+int ms_lsum_ewald (int , real , real , real * , int , real );
 
    /* lattice sum for two layers (lmslsumij(sym).c) */
-int ms_lsum_ij (mat *, mat *, real , real , real * , real * , real *, int , real );
+int ms_lsum_ij (struct ctx_str *, mat *, mat *, real , real , real * , real * , real *, int , real );
 mat ms_lsum_ij_sym (mat, real , real , real * , real * , real *, int , real, int );
 
     /* partial inversion */
 mat ms_partinv ( mat , mat , int , int );
+mat ms_partsolve ( mat , mat , mat , int , int );
+
+    /* iterative solution (lmsgmres.c) */
+int ms_gmres ( mat *, mat , mat (*)(mat, mat, void *),
+               mat (*)(mat, mat, void *), void *, real , int );
 
    /* Green's function (lmstmatii/ij/ijsym.c, lmsgmatijsym.c) */
-mat ms_tmat_ii (mat , mat, mat, int );
-mat ms_tmat_nd_ii (mat , mat, mat, int );
-mat ms_tmat_ij (mat , mat, mat, int );
+mat ms_tmat_ii (struct ctx_str *, mat , mat, mat, int );
+mat ms_tmat_nd_ii (struct ctx_str *, mat , mat, mat, int );
+mat ms_tmat_ij (struct ctx_str *, mat , mat, mat, int );
 mat ms_tmat_ij_sym (mat, mat, mat, int, int );
 
    /* Transformation L -> k (lmsymat.c/lmsymmat.c) */
-mat ms_ymat  (mat , int , struct beam_str *, int );
-mat ms_ymat_set  (mat , int , struct beam_str *, int );
-mat ms_ymmat (mat , int , struct beam_str *, int );
+mat ms_ymat  (struct ctx_str *, mat , int , struct beam_str *, int );
+mat ms_ymat_set  (struct ctx_str *, mat , int , struct beam_str *, int );
+mat ms_ymmat (struct ctx_str *, mat , int , struct beam_str *, int );
 mat ms_ymat_r (mat , int , struct beam_str *, int );
 
    /* Transformations of Ylm (lmsypy.c) */
@@ -32,10 +32,17 @@ struct mat_str      /* real or complex matrix */
  int rows;          /* 1st dimension of matrix (number of rows) */
  int cols;          /* 2nd dimension of matrix (number of columns) */
  real *rel;         /* pointer to real matrix elements */
- real *iel;         /* pointer to complex matrix elements */
+ real *iel;         /* pointer to imaginary parts (complex matrices only) */
 /*
- The matrix element (m,n) is in the ((m-1)*dim1 + n)th position of the arrays
- del or dcel, respectively.
+ The matrix element (m,n) is the k = ((m-1)*cols + n)th element.
+
+ Real matrices: element k is rel[k] (iel = NULL).
+
+ Complex matrices are stored interleaved, i.e. in the layout of BLAS and
+ LAPACK (real and imaginary part of each element next to each other).
+ rel points to the array, iel = rel + 1, and element k is rel[2*k] +
+ i * iel[2*k]. The first element (k = 1) is at rel + 2, which is what is
+ passed to BLAS/LAPACK. Only rel is allocated.
 */
 };
 
@@ -44,6 +51,18 @@ struct mat_str      /* real or complex matrix */
 */
 typedef struct mat_str*  mat;
 
+/*
+ pool for arrays of matrix elements (see matpool.c)
+*/
+
+#define MATPOOL_N_CLASS 160     /* number of size classes */
+
+struct matpool_str
+{
+ real *head[MATPOOL_N_CLASS];   /* lists of free arrays (one per size class) */
+ int n_used[MATPOOL_N_CLASS];   /* arrays asked for since the last reset */
+};
+
 /*********************************************************************
  values for:
  mat_type
@@ -94,14 +113,18 @@ i.e. 0xFFFF >= BLK_* > 0x0FFF (NUM_MASK)
 Macros for matrix operations
 *********************************************************************/
 /*
+MAT_STRIDE(Mat) - distance between two elements in rel (and iel)
 R(I)MATEL(m,n,Mat) - access matrix element (m,n) of matrix Mat (mat)
 
 m and n must be integers,
 Mat must be of type mat.
 */
 
-#define RMATEL(m,n,Mat) *((Mat)->rel + ((m)-1) * (Mat)->cols + (n))
-#define IMATEL(m,n,Mat) *((Mat)->iel + ((m)-1) * (Mat)->cols + (n))
+#define MAT_STRIDE(Mat) (((Mat)->num_type == NUM_COMPLEX) + 1)
+
+#define RMATEL(m,n,Mat) \
+        *((Mat)->rel + (((m)-1) * (Mat)->cols + (n)) * MAT_STRIDE(Mat))
+#define IMATEL(m,n,Mat) *((Mat)->iel + 2 * (((m)-1) * (Mat)->cols + (n)))
 
 
 #endif /* MAT_DEF_H */
@@ -42,6 +42,8 @@ int matline( mat , int , int , int , int );
 mat matrow(mat, mat, int);
   /* matrix multiplication with complex number in file matscal.c */
 mat matscal(mat, mat, real, real);
+  /* solve linear equations A*X = B in file matsolve_lp.c */
+mat matsolve(mat, mat, mat);
   /* print a matrix in file matshow.c */
 int matshow(mat);
   /* print the modulus of a matrix in file matshow.c */
@@ -65,6 +67,24 @@ int matwrite(mat , FILE *);
 mat matread (mat , FILE *);
 mat matrdlm (mat , int, const char *);
 
+/*********************************************************************
+ memory for matrix elements in file matpool.c
+*********************************************************************/
+
+real *matel_alloc(size_t);
+void matel_free(real *);
+void matel_bytes(double *, double *);
+struct matpool_str *matpool_alloc(void);
+int matpool_free(struct matpool_str *);
+struct matpool_str *matpool_use(struct matpool_str *);
+int matpool_reset(struct matpool_str *);
+
+/*********************************************************************
+ control output in file matlog.c
+*********************************************************************/
+
+void matlog_set(int, int);
+
 
 /*********************************************************************
 lower level functions
@@ -8,6 +8,21 @@
 #include <cblas.h>
 #endif
 
+#ifndef USE_MKL
+/*
+  LU factorisation (Fortran LAPACK interface, used by matsolve and
+  matinv). Complex matrices are interleaved (re, im) arrays.
+*/
+void sgetrf_(const int *m, const int *n, float *a, const int *lda,
+             int *ipiv, int *info);
+void dgetrf_(const int *m, const int *n, double *a, const int *lda,
+             int *ipiv, int *info);
+void cgetrf_(const int *m, const int *n, void *a, const int *lda,
+             int *ipiv, int *info);
+void zgetrf_(const int *m, const int *n, void *a, const int *lda,
+             int *ipiv, int *info);
+#endif
+
 #ifndef ATL_INT
    #define ATL_INT int
 #endif
@@ -15,6 +15,7 @@ Other includes
 #include "real.h"
 #include "cpl.h"
 #include "mat.h"
+#include "qm_def.h"
 #include "qm_func.h"
 
 #endif /* QM_H */
@@ -0,0 +1,33 @@
+/*********************************************************************
+  type definitions of the shared tables of the basic quantum mechanical
+  functions (see qmcgc.c, qmylm.c)
+*********************************************************************/
+#ifndef QM_DEF_H
+#define QM_DEF_H
+
+/*********************************************************************
+  struct cgc_str contains a table of Clebsh Gordan coefficients
+  (qmcgc.c). Tables are created by mk_cg_coef, shared by all callers
+  and never modified once they have been handed out.
+*********************************************************************/
+struct cgc_str
+{
+ int l_max;     /* max l2, l3 (l1 <= 2*l_max) */
+ int st_fac1;   /* storage increment for (l1,m1) */
+ int st_fac2;   /* storage increment for (l2,m2) */
+ double *coef;  /* coefficients (storage scheme: see mk_cg_coef) */
+ int n_ref;     /* number of references held (mk_cg_coef/free_cg_coef) */
+};
+
+/*********************************************************************
+  struct ylmc_str contains the coefficients of the power series used to
+  calculate spherical harmonics (qmylm.c). Shared like struct cgc_str.
+*********************************************************************/
+struct ylmc_str
+{
+ int l_max;     /* max l for which coefficients are stored */
+ real *coef;    /* coefficients (storage scheme: see mk_ylm_coef) */
+ int n_ref;     /* number of references held (mk_ylm_coef/free_ylm_coef) */
+};
+
+#endif /* QM_DEF_H */
@@ -7,23 +7,25 @@ basic quantum mechanical functions for the leed programs
 /*
   C.G.-coefficients:
 */
-  /* Calculate C.G. coefficients (qmcgc.c) */
-int mk_cg_coef(int);
+  /* Get/release a table of C.G. coefficients (qmcgc.c) */
+struct cgc_str * mk_cg_coef(int);
+void free_cg_coef(struct cgc_str *);
   /* Return C.G. coefficient (qmcgc.c) */
-double cg(int ,int ,int ,int ,int ,int );
+double cg(const struct cgc_str *, int ,int ,int ,int ,int ,int );
   /* Return relevant storage information (qmcgc.c) */
-double * cg_info (int , int , int , int , int* , int* , int* );
+double * cg_info (const struct cgc_str *, int , int , int , int , int* , int* , int* );
   /* list C.G. coefficients (qmcgc.c) */
-void show_cg_coef();
+void show_cg_coef(const struct cgc_str *);
 
 /*
   Spherical harmonics
 */
 
   /* Calculate spherical harmonics (qmylm.c) */
-mat r_ylm(mat, real, real, int);
-mat c_ylm(mat, real, real, real, int);
-int mk_ylm_coef(int);
+mat r_ylm(mat, const struct ylmc_str *, real, real, int);
+mat c_ylm(mat, const struct ylmc_str *, real, real, real, int);
+struct ylmc_str * mk_ylm_coef(int);
+void free_ylm_coef(struct ylmc_str *);
 
 /*
   Hankel/Bessel functions
@@ -32,9 +34,17 @@ int mk_ylm_coef(int);
   /* Calculate Hankel and Bessel functions (qmhank.c, qmbess.c) */
 mat r_hank1 (mat, real, int);
 mat c_hank1 (mat, real, real, int);
+int c_hank1_vec (real *, real *, const real *, const real *, int, int);
 mat c_bess  (mat, real, real, int);
 mat c_bessm (mat, real, real, int);
 
+/*
+  Error function
+*/
+
+  /* Complementary error function for complex arguments (qmerfc.c) */
+void c_erfc (real *, real *, real, real);
+
 /*********************************************************************
 lower level functions
 *********************************************************************/
@@ -29,8 +29,6 @@ WB/27.02.98 - change eng_max to eng_max - vr when calculating k_max
 /*
 #define CONTROL_X
 */
-#define CONTROL
-#define CONTROL_X
 #define WARNING
 #define ERROR
 
@@ -132,14 +130,15 @@ struct beam_str *bm_off;
    beams = *p_beams;
  }
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(bm_gen): eng_max  = %.2f, vr = %.2e\n",
-                 eng_max * HART, v_par->vr * HART);
- fprintf(STDCTR,"(bm_gen): dmin  = %.2f, epsilon = %.2e\n",
-                 c_par->dmin * BOHR, v_par->epsilon);
- fprintf(STDCTR,"(bm_gen): k_max = %.2f, max. No of beams = %2d\n",
-                 k_max, iaux);
-#endif
+ if(LOG_ON(LOG_BM, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(bm_gen): eng_max  = %.2f, vr = %.2e\n",
+                   eng_max * HART, v_par->vr * HART);
+   fprintf(STDCTR,"(bm_gen): dmin  = %.2f, epsilon = %.2e\n",
+                   c_par->dmin * BOHR, v_par->epsilon);
+   fprintf(STDCTR,"(bm_gen): k_max = %.2f, max. No of beams = %2d\n",
+                   k_max, iaux);
+ }
 
 
 /**********************************************************************
@@ -160,10 +159,11 @@ struct beam_str *bm_off;
  k_in[1] = faux_r * R_cos(v_par->phi);
  k_in[2] = faux_r * R_sin(v_par->phi);
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(bm_gen): a1 = (%.2f, %.2f)",   g1_x, g1_y);
- fprintf(STDCTR,        "\ta2 = (%.2f, %.2f)\n", g2_x, g2_y);
-#endif
+ if(LOG_ON(LOG_BM, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(bm_gen): a1 = (%.2f, %.2f)",   g1_x, g1_y);
+   fprintf(STDCTR,        "\ta2 = (%.2f, %.2f)\n", g2_x, g2_y);
+ }
 
 /**********************************************************************
   Determine number of beam sets (n_set)
@@ -182,11 +182,12 @@ struct beam_str *bm_off;
  (bm_off+0)->k_r[1] = 0.;
  (bm_off+0)->k_r[2] = 0.;
 
-#ifdef CONTROL_X
-     fprintf(STDCTR,"(bm_gen): set %d: %5.2f %5.2f (%5.2f %5.2f)\n",
-             0, (bm_off)->ind_1, (bm_off)->ind_2,
-             (bm_off)->k_r[1], (bm_off)->k_r[2]);
-#endif
+ if(LOG_ON(LOG_BM, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(bm_gen): set %d: %5.2f %5.2f (%5.2f %5.2f)\n",
+           0, (bm_off)->ind_1, (bm_off)->ind_2,
+           (bm_off)->k_r[1], (bm_off)->k_r[2]);
+ }
 
  for(n1 = -n_set, i_set = 1; n1 <= n_set;                     n1++)
  for(n2 = -n_set;           (n2 <= n_set) && (i_set < n_set); n2++)
@@ -238,9 +239,10 @@ struct beam_str *bm_off;
  n2_max = 2 + (int)(k_max/faux_i + k_in[0]/a2);
  n1_max = 2 + (int)( k_max/a1 + n2_max * faux_r/ a1 + k_in[0]/a1);
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(bm_gen): n1_max = %2d, n2_max = %2d\n", n1_max, n2_max);
-#endif
+ if(LOG_ON(LOG_BM, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(bm_gen): n1_max = %2d, n2_max = %2d\n", n1_max, n2_max);
+ }
 
 /*
   k_r, k_i is now defined by the complex energy
@@ -297,10 +299,11 @@ struct beam_str *bm_off;
     1st pass: Sort the beams according to the parallel component
     (i.e. smallest k_par first)
   *********************************************************/
-#ifdef CONTROL
- fprintf(STDCTR,"(bm_gen): SORTING %2d beams in set %d:\n",
-                i_beams - offset, i_set);
-#endif
+   if(LOG_ON(LOG_BM, LOG_CONTROL))
+   {
+     fprintf(STDCTR,"(bm_gen): SORTING %2d beams in set %d:\n",
+                    i_beams - offset, i_set);
+   }
    for(n1 = offset; n1 < i_beams; n1 ++)
    {
      for(n2 = n1+1; n2 < i_beams; n2 ++)
@@ -338,13 +341,14 @@ struct beam_str *bm_off;
          memcpy( beams + n1, & beam_aux, sizeof(struct beam_str) );
        }
      } /* n2 */
-#ifdef CONTROL
- fprintf(STDCTR,"%2d: (%6.2f, %6.2f):\t",
-                n1, (beams + n1)->ind_1, (beams + n1)->ind_2);
- fprintf(STDCTR,"\td_par: %.2f\tk_r: (%5.2f, %5.2f, %5.2f)\n",
-                R_sqrt((beams + n1)->k_par),  (beams + n1)->k_r[1],
-                (beams + n1)->k_r[2], (beams + n1)->k_r[3]);
-#endif
+     if(LOG_ON(LOG_BM, LOG_CONTROL))
+     {
+       fprintf(STDCTR,"%2d: (%6.2f, %6.2f):\t",
+                      n1, (beams + n1)->ind_1, (beams + n1)->ind_2);
+       fprintf(STDCTR,"\td_par: %.2f\tk_r: (%5.2f, %5.2f, %5.2f)\n",
+                      R_sqrt((beams + n1)->k_par),  (beams + n1)->k_r[1],
+                      (beams + n1)->k_r[2], (beams + n1)->k_r[3]);
+     }
    }  /* n1 */
  } /* for i_set */
 
@@ -353,5 +357,6 @@ struct beam_str *bm_off;
 */
  (beams + i_beams)->k_par = F_END_OF_LIST;
 
+ free(bm_off);
  return(n_set);
 }  /* end of function bm_gen */
@@ -0,0 +1,183 @@
+/*********************************************************************
+  file contains functions:
+
+  ctx_alloc
+     Create a calculation context.
+  ctx_free
+     Free a calculation context and all matrices stored in it.
+  ctx_cg_coef
+     Make sure the C.G. coefficients of a context are large enough.
+
+*********************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "leed.h"
+
+#define ERROR
+#define EXIT_ON_ERROR
+
+/*======================================================================*/
+/*======================================================================*/
+
+struct ctx_str *ctx_alloc(int l_max)
+
+/************************************************************************
+
+ Create a calculation context for LEED calculations up to angular
+ momentum l_max.
+
+ INPUT:
+
+   int l_max - max. l quantum number used in the calculation.
+
+ DESIGN:
+
+   The context takes a reference to the shared Clebsh-Gordan and Ylm
+   coefficient tables for 2*l_max (as needed by the lattice sums and
+   the temperature dependent scattering factors). All scratch matrices
+   are created on first use by the functions working with them.
+
+   The lattice sum cache (ctx->lsm) is not set; it can be shared by
+   several contexts and belongs to whoever sets it.
+
+   Each thread that runs an energy loop needs its own context. The
+   loops within one energy may use ctx->n_threads threads (default: 1,
+   set by the caller).
+
+ RETURN VALUES:
+
+   pointer to the new context.
+   NULL if failed (and EXIT_ON_ERROR is not defined).
+
+*************************************************************************/
+{
+struct ctx_str *ctx;
+
+ ctx = (struct ctx_str *) calloc(1, sizeof(struct ctx_str));
+ if(ctx == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR, "*** error (ctx_alloc): allocation error.\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(NULL);
+#endif
+ }
+
+ ctx->cgc  = mk_cg_coef(2*l_max);
+ ctx->ylmc = mk_ylm_coef(2*l_max);
+ if( (ctx->cgc == NULL) || (ctx->ylmc == NULL) )
+ {
+#ifdef ERROR
+   fprintf(STDERR,
+           "*** error (ctx_alloc): could not create coefficient tables.\n");
+#endif
+   ctx_free(ctx);
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(NULL);
+#endif
+ }
+
+ ctx->bravl.eng     = F_END_OF_LIST;
+ ctx->bravl.set     = I_END_OF_LIST;
+ ctx->bravl.n_beams = I_END_OF_LIST;
+ ctx->bravl.type    = I_END_OF_LIST;
+ ctx->bravl.l_max   = I_END_OF_LIST;
+
+ ctx->lsij.l_max = I_END_OF_LIST;
+
+ ctx->n_threads = 1;
+ ctx->prof = NULL;
+
+ ctx->cumtl.n_call = 0;
+ ctx->cumtl.last_l = -1;
+
+ return(ctx);
+}  /* end of function ctx_alloc */
+
+/*======================================================================*/
+/*======================================================================*/
+
+static void ctx_matfree(mat M)
+{
+ if(M != NULL) matfree(M);
+}
+
+int ctx_free(struct ctx_str *ctx)
+
+/************************************************************************
+
+ Free a calculation context created by ctx_alloc.
+
+ RETURN VALUES:
+
+   1 if successful, 0 if ctx is NULL.
+
+*************************************************************************/
+{
+int i;
+
+ if(ctx == NULL) return(0);
+
+ free_cg_coef(ctx->cgc);
+ free_ylm_coef(ctx->ylmc);
+
+ ctx_matfree(ctx->Ylm);
+
+ ctx_matfree(ctx->ld2lay.Pp);     ctx_matfree(ctx->ld2lay.Pm);
+ ctx_matfree(ctx->ld2lay.Maux_a); ctx_matfree(ctx->ld2lay.Maux_b);
+ ctx_matfree(ctx->ld2lay.Maux_c);
+ ctx_matfree(ctx->ld2lay.Tpp_ab); ctx_matfree(ctx->ld2lay.Tmm_ab);
+ ctx_matfree(ctx->ld2lay.Rpm_ab); ctx_matfree(ctx->ld2lay.Rmp_ab);
+
+ ctx_matfree(ctx->bravl.Llm);     ctx_matfree(ctx->bravl.Tii);
+ ctx_matfree(ctx->bravl.Yin_p);   ctx_matfree(ctx->bravl.Yin_m);
+ ctx_matfree(ctx->bravl.Yout_p);  ctx_matfree(ctx->bravl.Yout_m);
+
+ for(i = 0; i < ctx->lsij.n_entries; i ++)
+ {
+   ctx_matfree(ctx->lsij.Llm_p[i]);
+   ctx_matfree(ctx->lsij.Llm_m[i]);
+ }
+ free(ctx->lsij.d_ij);
+ free(ctx->lsij.Llm_p);
+ free(ctx->lsij.Llm_m);
+
+ ctx_matfree(ctx->cumtl.Mx);      ctx_matfree(ctx->cumtl.MxMx);
+ ctx_matfree(ctx->cumtl.My);      ctx_matfree(ctx->cumtl.MyMy);
+ ctx_matfree(ctx->cumtl.Mz);      ctx_matfree(ctx->cumtl.MzMz);
+
+ free(ctx);
+ return(1);
+}  /* end of function ctx_free */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int ctx_cg_coef(struct ctx_str *ctx, int l_max)
+
+/************************************************************************
+
+ Make sure that the C.G. coefficients of the context cover l_max
+ (replaces the former calls to mk_cg_coef in the calculation functions).
+
+ RETURN VALUES:
+
+   0 if the coefficients were available already,
+   1 if they had to be recalculated.
+
+*************************************************************************/
+{
+ if(ctx->cgc->l_max >= l_max) return(0);
+
+ free_cg_coef(ctx->cgc);
+ ctx->cgc = mk_cg_coef(l_max);
+ return(1);
+}  /* end of function ctx_cg_coef */
@@ -1,5 +1,14 @@
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "leed.h"
 
+#define LSM_N_PER_ENERGY 16     /* max. number of lattice sums per energy */
+#define LMC_N_PER_LAYER 2       /* layer matrices kept per layer and energy */
+
 typedef struct {
     int n_beams;
     real * beam_index1;
@@ -8,6 +17,7 @@ typedef struct {
     int n_energies;
     real * energies;
     real * iv_curves;
+    struct prof_str * profile;  /* stage counters, one per energy */
 } CleedResult;
 
 void print_phase_shift(struct phs_str phs_shift)
@@ -34,258 +44,884 @@ void print_phase_shift(struct phs_str phs_shift)
 }
 
 
-CleedResult leed(char * par_file, char * bul_file, char *phase_path)
+/*
+  Per-thread work space of the energy loop. Every thread owns its own copy
+  of the energy dependent parameters (v_par, including the atomic
+  scattering matrices p_tl), its own beam lists and its own scattering
+  matrices, so that energies can be computed independently of each other.
+  The calculation context ctx holds the scratch storage and caches of the
+  lower level functions (ms_*, ld_*, pc_*) and pool the element arrays
+  of the temporary matrices (see matpool.c).
+*/
+struct leed_wsp_str
 {
-    struct cryst_str *bulk=NULL;
-    struct cryst_str *over=NULL;
-    struct phs_str *phs_shifts=NULL;
-    struct var_str *v_par=NULL;
+    struct ctx_str *ctx;
+    struct matpool_str *pool;
+    struct var_str v_par;
 
+    struct beam_str *beams_now;
+    struct beam_str *beams_set;
 
-    struct beams_str * beams_now=NULL;
-    struct beams_str * beams_set=NULL;
-    struct beam_str * beams_out=NULL;
-    struct beam_str *beams_all=NULL;
+    mat R_bulk, R_tot, Amp;
+    mat Tpp, Tmm, Rpm, Rmp;
+    mat Tpp_s, Tmm_s, Rpm_s, Rmp_s;
+};
 
-    int n_beams_now, n_beams_set;
+static void leed_wsp_init(struct leed_wsp_str *wsp, struct var_str *v_par,
+                          struct lsm_str *lsm)
+{
+    wsp->ctx = ctx_alloc(v_par->l_max);
+    wsp->ctx->lsm = lsm;
+    wsp->ctx->lsum = v_par->lsum;
+    wsp->pool = matpool_alloc();
+    wsp->v_par = *v_par;
+    wsp->v_par.p_tl = NULL;
+
+    wsp->beams_now = wsp->beams_set = NULL;
+
+    wsp->R_bulk = wsp->R_tot = wsp->Amp = NULL;
+    wsp->Tpp = wsp->Tmm = wsp->Rpm = wsp->Rmp = NULL;
+    wsp->Tpp_s = wsp->Tmm_s = wsp->Rpm_s = wsp->Rmp_s = NULL;
+}
 
-    CleedResult results;
+static void leed_matfree(mat M)
+{
+    if (M != NULL)
+        matfree(M);
+}
+
+static void leed_wsp_free(struct leed_wsp_str *wsp, int n_types)
+{
+    int i;
 
-    int i_c, i_set, offset, i;
+    if (wsp->v_par.p_tl != NULL)
+    {
+        for (i = 0; i < n_types; i++)
+            leed_matfree(wsp->v_par.p_tl[i]);
+        free(wsp->v_par.p_tl);
+    }
+    free(wsp->beams_now);
+    free(wsp->beams_set);
+
+    leed_matfree(wsp->R_bulk); leed_matfree(wsp->R_tot); leed_matfree(wsp->Amp);
+    leed_matfree(wsp->Tpp);   leed_matfree(wsp->Tmm);   leed_matfree(wsp->Rpm);   leed_matfree(wsp->Rmp);
+    leed_matfree(wsp->Tpp_s); leed_matfree(wsp->Tmm_s); leed_matfree(wsp->Rpm_s); leed_matfree(wsp->Rmp_s);
+
+    ctx_free(wsp->ctx);
+    matpool_free(wsp->pool);
+}
+
+/*
+  Compute the bulk reflection matrix R_bulk (wsp->R_bulk) for the current
+  energy and beam list (wsp->beams_now, n_beams_now beams).
+*/
+static void leed_bulk(struct leed_wsp_str *wsp, struct cryst_str *bulk,
+                      int n_beams_now, int n_set)
+{
+    struct var_str *v_par = &wsp->v_par;
+
+    int i_set, offset;
     int i_layer;
-    int energy_index;
-    int n_set;
-    int n_phase_shifts=0;
-    real energy;
+    int n_beams_set;
+    double t_start;
+
+    /*********************************************************************
+    BULK:
+    Loop over beam sets
+
+    Create matrix R_bulk that will eventually contain the bulk
+    reflection matrix
+    *********************************************************************/
+
+    wsp->R_bulk = matalloc(wsp->R_bulk, n_beams_now, n_beams_now, NUM_COMPLEX);
+
+    /*********************************************************************
+        Loop over periodic bulk layers
+    *********************************************************************/
+    for(offset = 1, i_set = 0; i_set < n_set; i_set ++)
+    {
+        n_beams_set = bm_set(&wsp->beams_set, wsp->beams_now, i_set);
+
+        /**********************************************************
+         Compute scattering matrices for bottom-most bulk layer:
+        - single Bravais layer or composite layer
+        **********************************************************/
+        if( (bulk->layers + 0)->natoms == 1)
+        {
+            ms_bravl_nd( wsp->ctx, &wsp->Tpp, &wsp->Tmm, &wsp->Rpm, &wsp->Rmp,
+                        v_par, (bulk->layers + 0), wsp->beams_set);
+        }
+        else
+        {
+            ms_compl_nd( wsp->ctx, &wsp->Tpp, &wsp->Tmm, &wsp->Rpm, &wsp->Rmp,
+                        v_par, (bulk->layers + 0), wsp->beams_set);
+        }
+
+        /**********************************************************
+        Loop over the other bulk layers
+        **********************************************************/
+
+        for(i_layer = 1;
+        ((bulk->layers+i_layer)->periodic == 1) && (i_layer < bulk->nlayers);
+        i_layer ++)
+        {
+            /**************************************************************
+             Compute scattering matrices R/T_s for a single bulk layer
+            - single Bravais layer or composite layer
+            ***************************************************************/
+
+            if( (bulk->layers + i_layer)->natoms == 1)
+            {
+            ms_bravl_nd ( wsp->ctx, &wsp->Tpp_s, &wsp->Tmm_s, &wsp->Rpm_s, &wsp->Rmp_s,
+                            v_par, (bulk->layers + i_layer), wsp->beams_set);
+            }
+            else
+            {
+            ms_compl_nd( wsp->ctx, &wsp->Tpp_s, &wsp->Tmm_s, &wsp->Rpm_s, &wsp->Rmp_s,
+                        v_par, (bulk->layers + i_layer), wsp->beams_set);
+            }
+
+            /***************************************************************************
+             Add the single layer matrices to the rest by layer doubling
+            - inter layer vector is the vector between layers
+                (i_layer - 1) and (i_layer):
+                (bulk->layers + i_layer)->vec_from_last
+            ****************************************************************************/
+
+            t_start = prof_time(wsp->ctx->prof);
+            ld_2lay( wsp->ctx, &wsp->Tpp,  &wsp->Tmm,  &wsp->Rpm,  &wsp->Rmp,
+                    wsp->Tpp,   wsp->Tmm,   wsp->Rpm,   wsp->Rmp,
+                    wsp->Tpp_s, wsp->Tmm_s, wsp->Rpm_s, wsp->Rmp_s,
+                    wsp->beams_set, (bulk->layers + i_layer)->vec_from_last);
+            prof_add(wsp->ctx->prof, PROF_LD, t_start, 1);
+        } /* for i_layer (bulk) */
+
+        /*********************************************************************
+             Layer doubling for all periodic bulk layers until convergence is
+            reached:
+            - inter layer vector is (bulk->layers + 0)->vec_from_last
+        **********************************************************************/
+        wsp->Rpm = ld_2n( wsp->ctx, wsp->Rpm, wsp->Tpp, wsp->Tmm, wsp->Rpm, wsp->Rmp,
+                    wsp->beams_set, (bulk->layers + 0)->vec_from_last);
+
+        /*******************************************************************
+        Compute scattering matrices for top-most bulk layer if it is
+        not periodic.
+        - single Bravais layer or composite layer
+        **********************************************************************/
+        if( i_layer == bulk->nlayers - 1 ){
+            if( (bulk->layers + i_layer)->natoms == 1){
+                ms_bravl_nd( wsp->ctx, &wsp->Tpp_s, &wsp->Tmm_s, &wsp->Rpm_s, &wsp->Rmp_s,
+                        v_par, (bulk->layers + i_layer), wsp->beams_set);
+            }
+            else{
+                ms_compl_nd( wsp->ctx, &wsp->Tpp_s, &wsp->Tmm_s, &wsp->Rpm_s, &wsp->Rmp_s,
+                        v_par, (bulk->layers + i_layer), wsp->beams_set);
+            }
+
+            /**************************************************************************
+             Add the single layer matrices of the top-most layer to the rest
+            by layer doubling:
+            - inter layer vector is the vector between layers
+                (i_layer - 1) and (i_layer):
+                (bulk->layers + i_layer)->vec_from_last
+            ***************************************************************************/
+
+            t_start = prof_time(wsp->ctx->prof);
+            wsp->Rpm = ld_2lay_rpm(wsp->Rpm, wsp->Rpm,
+                            wsp->Tpp_s, wsp->Tmm_s, wsp->Rpm_s, wsp->Rmp_s,
+                            wsp->beams_set, (bulk->layers + i_layer)->vec_from_last);
+            prof_add(wsp->ctx->prof, PROF_LD, t_start, 1);
+        }  /* if( i_layer == bulk->nlayers - 1 ) */
+
+        /*******************************************************
+        Insert reflection matrix for this beam set into R_bulk.
+        ********************************************************/
+
+        wsp->R_bulk = matins(wsp->R_bulk, wsp->Rpm, offset, offset);
+        offset += n_beams_set;
+
+    }  /* for i_set */
+}
+
+/*
+  Scattering matrices of a single overlayer layer for the current energy
+  and beam list (wsp->beams_now). If lmc is not NULL, they are taken from
+  the cache when a layer with the same content (layer_key) has been
+  calculated before, otherwise they are computed and stored there. The
+  returned matrices must not be modified.
+*/
+static void leed_layer(struct leed_wsp_str *wsp, struct layer_str *layer,
+                       struct lmc_str *lmc, int i_eng, real energy,
+                       unsigned long long layer_key, unsigned long long beam_key,
+                       mat *p_Tpp, mat *p_Tmm, mat *p_Rpm, mat *p_Rmp)
+{
+    if ( (lmc != NULL) &&
+         lmc_get(lmc, i_eng, energy, layer_key, beam_key, p_Tpp, p_Tmm, p_Rpm, p_Rmp) )
+        return;
+
+    /***********************************************************
+    Calculate scattering matrices for a single overlayer layer
+    - single Bravais layer or composite layer
+    ************************************************************/
+    if( layer->natoms == 1)
+    {
+        ms_bravl_nd( wsp->ctx, &wsp->Tpp_s, &wsp->Tmm_s, &wsp->Rpm_s, &wsp->Rmp_s,
+                    &wsp->v_par, layer, wsp->beams_now);
+    }
+    else
+    {
+        ms_compl_nd( wsp->ctx, &wsp->Tpp_s, &wsp->Tmm_s, &wsp->Rpm_s, &wsp->Rmp_s,
+                    &wsp->v_par, layer, wsp->beams_now);
+    }
+
+    if (lmc != NULL)
+        lmc_put(lmc, i_eng, energy, layer_key, beam_key,
+                wsp->Tpp_s, wsp->Tmm_s, wsp->Rpm_s, wsp->Rmp_s);
+
+    *p_Tpp = wsp->Tpp_s;
+    *p_Tmm = wsp->Tmm_s;
+    *p_Rpm = wsp->Rpm_s;
+    *p_Rmp = wsp->Rmp_s;
+}
+
+/*
+  Vector from the top-most layer below overlayer layer i_layer (the top-most
+  bulk layer for i_layer = 0) to layer i_layer.
+*/
+static void leed_over_vec(struct cryst_str *bulk, struct cryst_str *over,
+                          int i_layer, real *vec)
+{
+    int i_c;
+
+    /****************************************************************
+        - if the current layer is the bottom-most (i_layer == 0),
+        the inter layer vector is calculated from the vectors between
+        top-most bulk layer and origin
+        ( (bulk->layers + nlayers)->vec_to_next )
+        and origin and bottom-most overlayer
+        (over->layers + 0)->vec_from_last.
+
+        - inter layer vector is the vector between layers
+        (i_layer - 1) and (i_layer): (over->layers + i_layer)->vec_from_last
+    **********************************************************************/
+    for(i_c = 1; i_c <= 3; i_c ++)
+    {
+        vec[i_c] = (over->layers + i_layer)->vec_from_last[i_c];
+        if (i_layer == 0)
+            vec[i_c] += (bulk->layers + bulk->nlayers - 1)->vec_to_next[i_c];
+    }
+}
+
+/*
+  Compute the beam intensities for a single energy and write them to
+  iv_curve (n_beams entries, same order as beams_out).
+
+  If rbc is not NULL, R_bulk is taken from entry i_eng of the cache if it
+  is valid for the current beam list, otherwise it is computed and stored
+  there. Likewise, if lmc is not NULL, the scattering matrices of the
+  overlayer layers are looked up there by the keys in layer_keys
+  (one per overlayer layer).
+
+  If lsc is not NULL, the overlayer is stacked onto the largest partial
+  stack of the last evaluation that is still valid according to
+  stack_keys (one per overlayer layer), and the new partial stacks are
+  stored there.
+
+  The element arrays of the matrices freed during the calculation are
+  kept in the pool of the work space for the next energy; the ones that
+  were not needed again are released at the end.
+
+  If prof is not NULL, the time spent in the stages of the calculation
+  and the size of the element arrays allocated are added to it.
+*/
+static void leed_energy(struct leed_wsp_str *wsp,
+                        struct cryst_str *bulk, struct cryst_str *over,
+                        struct phs_str *phs_shifts,
+                        struct beam_str *beams_all, struct beam_str *beams_out,
+                        int n_set, struct rbc_str *rbc,
+                        struct lmc_str *lmc, unsigned long long *layer_keys,
+                        struct lsc_str *lsc, unsigned long long *stack_keys,
+                        int i_eng, real energy, real *iv_curve,
+                        struct prof_str *prof)
+{
+    struct var_str *v_par = &wsp->v_par;
+
+    int i_layer, i_start;
+    int n_beams_now;
+    unsigned long long beam_key;
     real vec[4];
-    mat R_bulk=NULL, R_tot=NULL;
-    mat Amp=NULL;
+    mat Tpp, Tmm, Rpm, Rmp;
+    mat R_below;
+    struct matpool_str *pool_old;
+    double t_start;
+    double bytes_req, bytes_new;
+
+    pool_old = matpool_use(wsp->pool);
+    wsp->ctx->prof = prof;
+    if (prof != NULL)
+        matel_bytes(&bytes_req, &bytes_new);
+
+    t_start = prof_time(prof);
+    pc_update(wsp->ctx, v_par, phs_shifts, energy);
+    prof_add(prof, PROF_UPDATE, t_start, 1);
+
+    t_start = prof_time(prof);
+    n_beams_now = bm_select(&wsp->beams_now, beams_all, v_par, bulk->dmin);
+    prof_add(prof, PROF_BEAMS, t_start, 1);
+    beam_key = rbc_beam_key(wsp->beams_now, n_beams_now);
+
+    /*********************************************************************
+    Find the partial overlayer stack to start from (if any).
+    *********************************************************************/
+
+    i_start = 0;
+    R_below = NULL;
+    if (lsc != NULL)
+        i_start = lsc_get(lsc, i_eng, energy, beam_key, stack_keys, over->nlayers, &R_below);
+
+    /*********************************************************************
+    BULK:
+    Take R_bulk from the cache or compute it.
+    *********************************************************************/
+
+    if (i_start == 0)
+    {
+        if ( (rbc == NULL) || !rbc_get(rbc, i_eng, energy, beam_key, &wsp->R_bulk) )
+        {
+            leed_bulk(wsp, bulk, n_beams_now, n_set);
+            if (rbc != NULL)
+                rbc_put(rbc, i_eng, energy, beam_key, wsp->R_bulk);
+        }
+        R_below = wsp->R_bulk;
+    }
 
-    mat Tpp=NULL, Tmm=NULL, Rpm=NULL, Rmp=NULL;
-    mat Tpp_s=NULL, Tmm_s=NULL, Rpm_s=NULL, Rmp_s=NULL;
+    /*********************************************************************
+    OVERLAYER
+    Loop over all overlayer layers above the partial stack
+    *********************************************************************/
 
-    struct eng_str *eng=NULL;
+    if (i_start == over->nlayers)
+        wsp->R_tot = matcop(wsp->R_tot, R_below);
 
-    // Read input parameters
-    inp_rdbul_nd(&bulk, &phs_shifts, bul_file, phase_path, &n_phase_shifts);
-    inp_rdpar(&v_par, &eng, bulk, bul_file);
-    inp_rdovl_nd(&over, &phs_shifts, bulk, par_file, phase_path, &n_phase_shifts);
-    inp_showbop(bulk, over, phs_shifts);
-    for (i=0; (phs_shifts + i)->lmax != I_END_OF_LIST; i++)
-        print_phase_shift(phs_shifts[i]);
+    for(i_layer = i_start; i_layer < over->nlayers; i_layer ++)
+    {
+        leed_layer(wsp, over->layers + i_layer, lmc, i_eng, energy,
+                   (lmc != NULL) ? layer_keys[i_layer] : 0, beam_key,
+                   &Tpp, &Tmm, &Rpm, &Rmp);
+
+        /****************************************************************
+             Add the single layer matrices to the rest by layer doubling
+        **********************************************************************/
+        leed_over_vec(bulk, over, i_layer, vec);
+        t_start = prof_time(prof);
+        wsp->R_tot = ld_2lay_rpm(wsp->R_tot, R_below,
+                                 Tpp, Tmm, Rpm, Rmp, wsp->beams_now, vec);
+        prof_add(prof, PROF_LD, t_start, 1);
+        R_below = wsp->R_tot;
+
+        if (lsc != NULL)
+            lsc_put(lsc, i_eng, energy, beam_key, i_layer, stack_keys[i_layer], wsp->R_tot);
+
+    }  /* for i_layer (overlayer) */
+
+    /*********************************************
+     Add propagation towards the potential step.
+    **********************************************/
+
+    vec[1] = vec[2] = 0.;
+    vec[3] = 1.25 / BOHR;
+
+    /********************************************
+        No scattering at pot. step
+    ********************************************/
+
+    t_start = prof_time(prof);
+    wsp->Amp = ld_potstep0(wsp->Amp, wsp->R_tot, wsp->beams_now, v_par->eng_v, vec);
+    out_int(wsp->Amp, wsp->beams_now, beams_out, v_par, iv_curve);
+    prof_add(prof, PROF_OUT, t_start, 1);
+
+    if (prof != NULL)
+    {
+        prof->bytes -= bytes_req;
+        prof->bytes_new -= bytes_new;
+        matel_bytes(&bytes_req, &bytes_new);
+        prof->bytes += bytes_req;
+        prof->bytes_new += bytes_new;
+    }
+    wsp->ctx->prof = NULL;
 
+    matpool_reset(wsp->pool);
+    matpool_use(pool_old);
+}
 
 
-    // Construct energy list
-    results.n_energies = (eng->fin - eng->ini)/eng->stp + 1;
-    results.energies = (real *) malloc(results.n_energies * sizeof(real));
+/*
+  A LEED session keeps everything that does not depend on the overlayer
+  geometry between evaluations: the input read from the files, the
+  coefficient tables, the beam lists, the energy list and the per-thread
+  work spaces (including their calculation contexts). Only the positions
+  of the overlayer atoms can be changed (leed_session_set_positions).
+
+  The bulk reflection matrices of all energies are kept as well (rbc) and
+  reused as long as the bulk input and the beam list of an energy do not
+  change. They can be stored in a file to be reused by later sessions
+  (leed_session_set_bulk_cache).
+
+  The scattering matrices of the single overlayer layers (lmc) are kept
+  per energy and identified by the content of the layer, i.e. the atom
+  positions relative to the layer origin. Moving a whole layer (e.g. a
+  relaxation of the interlayer distance) only changes vec_from_last, so
+  only the layer doubling has to be repeated for it.
+
+  The reflection matrices of the partial overlayer stacks (lsc) are kept
+  per energy as well, so that only the layers above the lowest changed
+  one have to be added again.
+
+  The lattice sums of the Bravais layers (lsm) do not depend on the atom
+  positions at all; they are shared by the work spaces of all threads.
+*/
+struct leed_session_str
+{
+    struct cryst_str *bulk;
+    struct cryst_str *over;
+    struct phs_str *phs_shifts;
+    struct var_str *v_par;
+    struct eng_str *eng;
+
+    struct atom_str *atoms;     /* overlayer atoms in input order */
+    int n_atoms;
+    real dmin_bulk;             /* min. interlayer distance of the bulk alone */
+    real dmin_beams;            /* dmin used to generate beams_all */
+
+    struct beam_str *beams_all;
+    struct beam_str *beams_out;
+    int n_set;
+    int n_types;
+
+    int n_threads;
+    struct leed_wsp_str *wsp;   /* one work space per thread */
+
+    struct rbc_str *rbc;        /* bulk reflection matrices */
+    char *rbc_file;             /* file to store rbc in (or NULL) */
+    struct lmc_str *lmc;        /* overlayer layer scattering matrices */
+    unsigned long long *layer_keys; /* content keys of the overlayer layers */
+    struct lsc_str *lsc;        /* partial overlayer stacks */
+    unsigned long long *stack_keys; /* keys of the partial overlayer stacks */
+    struct lsm_str *lsm;        /* lattice sums (shared by all work spaces) */
+
+    CleedResult results;
+};
+
+static void leed_free_layers(struct cryst_str *cryst)
+{
+    int i;
+
+    if (cryst->layers != NULL)
+    {
+        for (i = 0; i < cryst->nlayers; i++)
+            free(cryst->layers[i].atoms);
+        free(cryst->layers);
+    }
+    cryst->layers = NULL;
+    cryst->nlayers = 0;
+}
+
+static void leed_free_comments(char **comments)
+{
+    int i;
 
-    for (energy_index=0; energy_index < results.n_energies; energy_index++)
-        results.energies[energy_index] = eng->ini + energy_index * eng->stp;
+    if (comments == NULL)
+        return;
+    for (i = 0; comments[i] != NULL; i++)
+        free(comments[i]);
+    free(comments);
+}
+
+/*
+  Set up everything needed to evaluate the IV curves once bulk, over,
+  phs_shifts, v_par, eng, atoms and dmin_bulk of the session have been
+  filled in.
+*/
+static struct leed_session_str *leed_session_setup(struct leed_session_str *session,
+                                                   int n_threads)
+{
+    struct var_str *v_par;
+    struct eng_str *eng;
 
-    eng->fin = results.energies[results.n_energies - 1];
+    int i;
+    int energy_index;
 
-    // Printing stuff
-    inp_showbop(bulk, over, phs_shifts);
+    session->n_atoms = session->over->natoms;
+    if (LOG_ON(LOG_INP, LOG_CONTROL))
+        inp_showbop(session->bulk, session->over, session->phs_shifts);
+    for (i=0; (session->phs_shifts + i)->lmax != I_END_OF_LIST; i++)
+        if (LOG_ON(LOG_INP, LOG_CONTROL_X))
+            print_phase_shift(session->phs_shifts[i]);
+    session->n_types = i;
 
-    mk_cg_coef (2*v_par->l_max); // Setting up Clebsh Gordan coefficients as global variables.
-    mk_ylm_coef(2*v_par->l_max); // Setting up spherical harmonics coefficients as global variables.
+    v_par = session->v_par;
+    eng = session->eng;
 
+    // Construct energy list
+    session->results.n_energies = (eng->fin - eng->ini)/eng->stp + 1;
+    session->results.energies = (real *) malloc(session->results.n_energies * sizeof(real));
 
+    for (energy_index=0; energy_index < session->results.n_energies; energy_index++)
+        session->results.energies[energy_index] = eng->ini + energy_index * eng->stp;
 
+    eng->fin = session->results.energies[session->results.n_energies - 1];
 
     /* Generate beams out */
-    n_set = bm_gen(&beams_all, bulk, v_par, eng->fin);
-    results.n_beams = out_bmlist(&beams_out, beams_all, eng, &results.beam_index1, &results.beam_index2, &results.beam_set);
-    results.iv_curves = (real *) calloc(results.n_energies * results.n_beams, sizeof(real));
+    session->dmin_beams = session->bulk->dmin;
+    session->n_set = bm_gen(&session->beams_all, session->bulk, v_par, eng->fin);
+    session->results.n_beams = out_bmlist(&session->beams_out, session->beams_all, eng,
+                                          &session->results.beam_index1,
+                                          &session->results.beam_index2,
+                                          &session->results.beam_set);
+    session->results.iv_curves = (real *) calloc(
+        session->results.n_energies * session->results.n_beams, sizeof(real));
+    session->results.profile = (struct prof_str *) calloc(
+        session->results.n_energies, sizeof(struct prof_str));
+
+    /* Work spaces for the energy loop */
+#ifdef _OPENMP
+    if (n_threads <= 0)
+        n_threads = omp_get_max_threads();
+#else
+    n_threads = 1;
+#endif
+    session->n_threads = n_threads;
+    session->lsm = lsm_alloc(LSM_N_PER_ENERGY * session->results.n_energies);
+    session->wsp = (struct leed_wsp_str *) malloc(n_threads * sizeof(struct leed_wsp_str));
+    for (i = 0; i < n_threads; i++)
+        leed_wsp_init(session->wsp + i, v_par, session->lsm);
+
+    session->rbc = rbc_alloc(session->results.n_energies);
+    /*
+      Room for a previous version of every layer, so that a layer moved and
+      moved back is found again instead of evicted by its moved version.
+    */
+    session->lmc = lmc_alloc(session->results.n_energies,
+                             LMC_N_PER_LAYER * MAX(session->over->nlayers, 1));
+    session->lsc = lsc_alloc(session->results.n_energies);
+
+    return session;
+}
 
-    /* Main Energy Loop */
+/*
+  Read the input files and set up everything needed to evaluate the IV
+  curves. n_threads <= 0 lets the OpenMP runtime decide (OMP_NUM_THREADS or
+  the number of available cores). Without OpenMP support the energy loop is
+  always serial.
+*/
+struct leed_session_str *leed_session_create(char *par_file, char *bul_file,
+                                             char *phase_path, int n_threads)
+{
+    struct leed_session_str *session;
+    int n_phase_shifts=0;
 
-    for(energy_index=0; energy_index < results.n_energies; energy_index++){
-        pc_update(v_par, phs_shifts, results.energies[energy_index]);
-        n_beams_now = bm_select(&beams_now, beams_all, v_par, bulk->dmin);
+    session = (struct leed_session_str *) calloc(1, sizeof(struct leed_session_str));
 
-        /*********************************************************************
-        BULK:
-        Loop over beam sets
+    // Read input parameters
+    inp_rdbul_nd(&session->bulk, &session->phs_shifts, bul_file, phase_path, &n_phase_shifts);
+    inp_rdpar(&session->v_par, &session->eng, session->bulk, bul_file);
+    session->dmin_bulk = session->bulk->dmin;
+    inp_rdovl_nd(&session->over, &session->phs_shifts, session->bulk, par_file, phase_path,
+                 &n_phase_shifts, &session->atoms);
 
-        Create matrix R_bulk that will eventually contain the bulk
-        reflection matrix
-        *********************************************************************/
+    return leed_session_setup(session, n_threads);
+}
 
-        R_bulk = matalloc(R_bulk, n_beams_now, n_beams_now, NUM_COMPLEX);
+/*
+  Same as leed_session_create, but the input is taken from structures in
+  memory instead of the input files (see linpstrnd.c for the elements
+  that are used). Nothing is written to or read from disk except the
+  phase shift files named in phs_in.
+*/
+struct leed_session_str *leed_session_create_str(struct cryst_str *bulk_in, real *a3,
+                                                 struct cryst_str *over_in,
+                                                 struct phs_str *phs_in,
+                                                 struct var_str *v_par_in,
+                                                 struct eng_str *eng_in,
+                                                 int n_threads)
+{
+    struct leed_session_str *session;
+    int n_phase_shifts=0;
 
-        /*********************************************************************
-            Loop over periodic bulk layers
-        *********************************************************************/
-        for(offset = 1, i_set = 0; i_set < n_set; i_set ++)
-        {
-            n_beams_set = bm_set(&beams_set, beams_now, i_set);
+    session = (struct leed_session_str *) calloc(1, sizeof(struct leed_session_str));
 
-            /**********************************************************
-             Compute scattering matrices for bottom-most bulk layer:
-            - single Bravais layer or composite layer
-            **********************************************************/
-            if( (bulk->layers + 0)->natoms == 1)
-            {
-                ms_bravl_nd( &Tpp, &Tmm, &Rpm, &Rmp,
-                            v_par, (bulk->layers + 0), beams_set);
-            }
-            else
-            {
-                ms_compl_nd( &Tpp, &Tmm, &Rpm, &Rmp,
-                            v_par, (bulk->layers + 0), beams_set);
-            }
+    inp_strbul_nd(&session->bulk, &session->phs_shifts, bulk_in, a3, phs_in, &n_phase_shifts);
+    inp_strpar(&session->v_par, &session->eng, session->bulk, v_par_in, eng_in);
+    session->dmin_bulk = session->bulk->dmin;
+    inp_strovl_nd(&session->over, &session->phs_shifts, session->bulk, over_in, phs_in,
+                  &n_phase_shifts, &session->atoms);
 
-            /**********************************************************
-            Loop over the other bulk layers
-            **********************************************************/
+    return leed_session_setup(session, n_threads);
+}
 
-            for(i_layer = 1;
-            ((bulk->layers+i_layer)->periodic == 1) && (i_layer < bulk->nlayers);
-            i_layer ++)
-            {
-                /**************************************************************
-                 Compute scattering matrices R/T_s for a single bulk layer
-                - single Bravais layer or composite layer
-                ***************************************************************/
-
-                if( (bulk->layers + i_layer)->natoms == 1)
-                {
-                ms_bravl_nd ( &Tpp_s, &Tmm_s, &Rpm_s, &Rmp_s,
-                                v_par, (bulk->layers + i_layer), beams_set);
-                }
-                else
-                {
-                ms_compl_nd( &Tpp_s, &Tmm_s, &Rpm_s, &Rmp_s,
-                            v_par, (bulk->layers + i_layer), beams_set);
-                }
-
-                /***************************************************************************
-                 Add the single layer matrices to the rest by layer doubling
-                - inter layer vector is the vector between layers
-                    (i_layer - 1) and (i_layer):
-                    (bulk->layers + i_layer)->vec_from_last
-                ****************************************************************************/
-
-                ld_2lay( &Tpp,  &Tmm,  &Rpm,  &Rmp,
-                        Tpp,   Tmm,   Rpm,   Rmp,
-                        Tpp_s, Tmm_s, Rpm_s, Rmp_s,
-                        beams_set, (bulk->layers + i_layer)->vec_from_last);
-            } /* for i_layer (bulk) */
-
-            /*********************************************************************
-                 Layer doubling for all periodic bulk layers until convergence is
-                reached:
-                - inter layer vector is (bulk->layers + 0)->vec_from_last
-            **********************************************************************/
-            Rpm = ld_2n( Rpm, Tpp, Tmm, Rpm, Rmp,
-                        beams_set, (bulk->layers + 0)->vec_from_last);
-
-            /*******************************************************************
-            Compute scattering matrices for top-most bulk layer if it is
-            not periodic.
-            - single Bravais layer or composite layer
-            **********************************************************************/
-            if( i_layer == bulk->nlayers - 1 ){
-                if( (bulk->layers + i_layer)->natoms == 1){
-                    ms_bravl_nd( &Tpp_s, &Tmm_s, &Rpm_s, &Rmp_s,
-                            v_par, (bulk->layers + i_layer), beams_set);
-                }
-                else{
-                    ms_compl_nd( &Tpp_s, &Tmm_s, &Rpm_s, &Rmp_s,
-                            v_par, (bulk->layers + i_layer), beams_set);
-                }
-
-                /**************************************************************************
-                 Add the single layer matrices of the top-most layer to the rest
-                by layer doubling:
-                - inter layer vector is the vector between layers
-                    (i_layer - 1) and (i_layer):
-                    (bulk->layers + i_layer)->vec_from_last
-                ***************************************************************************/
-
-                Rpm = ld_2lay_rpm(Rpm, Rpm, Tpp_s, Tmm_s, Rpm_s, Rmp_s,
-                                beams_set, (bulk->layers + i_layer)->vec_from_last);
-            }  /* if( i_layer == bulk->nlayers - 1 ) */
-
-            /*******************************************************
-            Insert reflection matrix for this beam set into R_bulk.
-            ********************************************************/
-
-            R_bulk = matins(R_bulk, Rpm, offset, offset);
-            offset += n_beams_set;
-
-        }  /* for i_set */
+/*
+  Number of overlayer atoms, i.e. the number of positions expected by
+  leed_session_set_positions.
+*/
+int leed_session_n_atoms(struct leed_session_str *session)
+{
+    return session->n_atoms;
+}
 
-        /*********************************************************************
-        OVERLAYER
-        Loop over all overlayer layers
-        *********************************************************************/
+/*
+  Replace the positions of the overlayer atoms. positions contains x, y, z
+  (in Angstroms) for each of the n_atoms atoms, in the order of the "po:"
+  lines of the parameter file. The atoms are redistributed to layers; the
+  beam list is only regenerated if the min. interlayer distance has become
+  smaller than the one it was generated for.
 
-        for(i_layer = 0; i_layer < over->nlayers; i_layer ++)
-        {
-            /***********************************************************
-            Calculate scattering matrices for a single overlayer layer
-            - only single Bravais layer
-            ************************************************************/
-            if( (over->layers + i_layer)->natoms == 1)
-            {
-                ms_bravl_nd( &Tpp_s, &Tmm_s, &Rpm_s, &Rmp_s,
-                            v_par, (over->layers + i_layer), beams_now);
-            }
-            else
-            {
-                ms_compl_nd( &Tpp_s, &Tmm_s, &Rpm_s, &Rmp_s,
-                            v_par, (over->layers + i_layer), beams_now);
-            }
-            /****************************************************************
-                 Add the single layer matrices to the rest by layer doubling:
-                - if the current layer is the bottom-most (i_layer == 0),
-                the inter layer vector is calculated from the vectors between
-                top-most bulk layer and origin
-                ( (bulk->layers + nlayers)->vec_to_next )
-                and origin and bottom-most overlayer
-                (over->layers + 0)->vec_from_last.
-
-                - inter layer vector is the vector between layers
-                (i_layer - 1) and (i_layer): (over->layers + i_layer)->vec_from_last
-            **********************************************************************/
-            if (i_layer == 0)
-            {
-                for(i_c = 1; i_c <= 3; i_c ++)
-                {
-                    vec[i_c] = (bulk->layers + bulk->nlayers - 1)->vec_to_next[i_c]
-                                + (over->layers + 0)->vec_from_last[i_c];
-                }
-
-                R_tot = ld_2lay_rpm(R_tot, R_bulk, Tpp_s, Tmm_s, Rpm_s, Rmp_s,
-                                    beams_now, vec);
-            }
-            else
-            {
+  Returns 1 if ok, -1 if n_atoms does not match the session.
+*/
+int leed_session_set_positions(struct leed_session_str *session, real *positions, int n_atoms)
+{
+    int i;
 
-                R_tot = ld_2lay_rpm(R_tot, R_tot, Tpp_s, Tmm_s, Rpm_s, Rmp_s,
-                                beams_now, (over->layers + i_layer)->vec_from_last);
-            }
+    if (n_atoms != session->n_atoms)
+    {
+        fprintf(STDERR,
+            "*** error (leed_session_set_positions): %d positions given, the overlayer has %d atoms\n",
+            n_atoms, session->n_atoms);
+        return -1;
+    }
 
-        }  /* for i_layer (overlayer) */
+    for (i = 0; i < n_atoms; i++)
+    {
+        session->atoms[i].pos[1] = positions[3*i + 0] / BOHR;
+        session->atoms[i].pos[2] = positions[3*i + 1] / BOHR;
+        session->atoms[i].pos[3] = positions[3*i + 2] / BOHR;
+    }
 
-        /*********************************************
-         Add propagation towards the potential step.
-        **********************************************/
+    leed_free_layers(session->over);
+    session->bulk->dmin = session->dmin_bulk;
+    inp_ovl_atoms(session->over, session->bulk, session->atoms, n_atoms);
 
-        vec[1] = vec[2] = 0.;
-        vec[3] = 1.25 / BOHR;
+    if (session->bulk->dmin < session->dmin_beams)
+    {
+        session->dmin_beams = session->bulk->dmin;
+        bm_gen(&session->beams_all, session->bulk, session->v_par, session->eng->fin);
+    }
+
+    return 1;
+}
+
+/*
+  Store the bulk reflection matrices in filename. Matrices found in the
+  file are used if they were computed for the same bulk input, energies
+  and beams; the file is updated after every evaluation that computed new
+  ones. A NULL filename stops writing the file.
+
+  Returns the number of matrices read from the file (0 if it does not
+  exist yet).
+*/
+int leed_session_set_bulk_cache(struct leed_session_str *session, char *filename)
+{
+    int n_read;
+
+    free(session->rbc_file);
+    session->rbc_file = NULL;
+    if (filename == NULL)
+        return 0;
+
+    session->rbc_file = strdup(filename);
+    rbc_set_key(session->rbc, rbc_key(session->bulk, session->phs_shifts, session->v_par));
+    n_read = rbc_read(session->rbc, session->results.energies, filename);
+
+    return MAX(n_read, 0);
+}
+
+/*
+  Compute the IV curves for the current geometry. The arrays of the returned
+  structure belong to the session: they are overwritten by the next call and
+  freed by leed_session_free.
+*/
+CleedResult leed_session_evaluate(struct leed_session_str *session)
+{
+    int i;
+    int energy_index;
+    int n_layers;
+    int n_eng_threads;
+#ifdef _OPENMP
+    int max_levels;
+#endif
+    unsigned long long bulk_key;
+    real vec[4];
+    int n_energies = session->results.n_energies;
+    int n_beams = session->results.n_beams;
+
+    memset(session->results.profile, 0, n_energies * sizeof(struct prof_str));
+
+    bulk_key = rbc_key(session->bulk, session->phs_shifts, session->v_par);
+    rbc_set_key(session->rbc, bulk_key);
+
+    n_layers = session->over->nlayers;
+    session->layer_keys = (unsigned long long *) realloc(session->layer_keys,
+        MAX(n_layers, 1) * sizeof(unsigned long long));
+    session->stack_keys = (unsigned long long *) realloc(session->stack_keys,
+        MAX(n_layers, 1) * sizeof(unsigned long long));
+    for (i = 0; i < n_layers; i++)
+    {
+        session->layer_keys[i] = rbc_layer_key(session->over->layers + i,
+                                               session->phs_shifts, session->v_par);
+        leed_over_vec(session->bulk, session->over, i, vec);
+        session->stack_keys[i] = rbc_stack_key((i == 0) ? bulk_key : session->stack_keys[i-1],
+                                               session->layer_keys[i], vec);
+    }
+
+    /*
+      Energies are independent of each other. The number of beams (and
+      thereby the matrix dimensions) grows with energy, so the loop runs
+      from the highest energy downwards: the expensive points are handed out
+      first and the cheap ones fill the gaps at the end.
+      Threads left over if there are fewer energies than threads are used
+      within the energies (ctx->n_threads, see ms_compl_nd).
+    */
+    n_eng_threads = MIN(session->n_threads, MAX(n_energies, 1));
+    for (i = 0; i < session->n_threads; i++)
+        session->wsp[i].ctx->n_threads = session->n_threads / n_eng_threads;
+#ifdef _OPENMP
+    /* nesting is enabled for this call only; the caller's setting is restored */
+    max_levels = omp_get_max_active_levels();
+    if ((session->n_threads > n_eng_threads) && (max_levels < 2))
+        omp_set_max_active_levels(2);
+#endif
+
+#pragma omp parallel num_threads(n_eng_threads) private(energy_index)
+    {
+#ifdef _OPENMP
+        struct leed_wsp_str *wsp = session->wsp + omp_get_thread_num();
+#else
+        struct leed_wsp_str *wsp = session->wsp;
+#endif
+
+#pragma omp for schedule(dynamic, 1)
+        for(i = 0; i < n_energies; i++){
+            energy_index = n_energies - 1 - i;
+            leed_energy(wsp, session->bulk, session->over, session->phs_shifts,
+                        session->beams_all, session->beams_out, session->n_set,
+                        session->rbc, session->lmc, session->layer_keys,
+                        session->lsc, session->stack_keys,
+                        energy_index,
+                        session->results.energies[energy_index],
+                        &session->results.iv_curves[energy_index * n_beams],
+                        session->results.profile + energy_index);
+        }  /* end of energy loop */
+    }
+#ifdef _OPENMP
+    omp_set_max_active_levels(max_levels);
+#endif
+
+    if (session->rbc_file != NULL)
+        rbc_write(session->rbc, session->rbc_file);
+
+    return session->results;
+}
+
+void leed_session_free(struct leed_session_str *session)
+{
+    int i;
+
+    if (session == NULL)
+        return;
+
+    for (i = 0; i < session->n_threads; i++)
+        leed_wsp_free(session->wsp + i, session->n_types);
+    free(session->wsp);
+
+    rbc_free(session->rbc);
+    free(session->rbc_file);
+    lmc_free(session->lmc);
+    free(session->layer_keys);
+    lsc_free(session->lsc);
+    free(session->stack_keys);
+    lsm_free(session->lsm);
+
+    free(session->results.beam_index1);
+    free(session->results.beam_index2);
+    free(session->results.beam_set);
+    free(session->results.energies);
+    free(session->results.iv_curves);
+    free(session->results.profile);
+
+    free(session->beams_all);
+    free(session->beams_out);
+    free(session->atoms);
+
+    for (i = 0; i < session->n_types; i++)
+    {
+        free(session->phs_shifts[i].energy);
+        free(session->phs_shifts[i].pshift);
+        free(session->phs_shifts[i].input_file);
+    }
+    free(session->phs_shifts);
+
+    leed_free_layers(session->over);
+    leed_free_layers(session->bulk);
+    leed_free_comments(session->over->comments);
+    leed_free_comments(session->bulk->comments);
+    free(session->bulk->m_plane);   /* shared with over */
+    free(session->over);
+    free(session->bulk);
+    free(session->v_par);
+    free(session->eng);
+
+    free(session);
+}
 
-        /********************************************
-            No scattering at pot. step
-        ********************************************/
+/*
+  Compute the IV curves using n_threads threads for the energy loop
+  (see leed_session_create). The arrays of the result are owned by the
+  caller, who frees them with leed_result_free.
+*/
+CleedResult leed_threads(char * par_file, char * bul_file, char *phase_path, int n_threads)
+{
+    struct leed_session_str *session;
+    CleedResult results;
 
-        Amp = ld_potstep0(Amp, R_tot, beams_now, v_par->eng_v, vec);
-        out_int(Amp, beams_now, beams_out, v_par, &results.iv_curves[energy_index * results.n_beams]);
+    session = leed_session_create(par_file, bul_file, phase_path, n_threads);
+    results = leed_session_evaluate(session);
 
-    }  /* end of energy loop */
+    /* hand the result arrays over to the caller */
+    session->results.beam_index1 = session->results.beam_index2 = NULL;
+    session->results.beam_set = NULL;
+    session->results.energies = session->results.iv_curves = NULL;
+    session->results.profile = NULL;
+    leed_session_free(session);
 
     return results;
 }
+
+/*
+  Free the arrays of a result returned by leed_threads or leed and set them
+  to NULL. The arrays of a result of leed_session_evaluate belong to the
+  session and must not be freed with this function.
+*/
+void leed_result_free(CleedResult *result)
+{
+    if (result == NULL)
+        return;
+
+    free(result->beam_index1);
+    free(result->beam_index2);
+    free(result->beam_set);
+    free(result->energies);
+    free(result->iv_curves);
+    free(result->profile);
+
+    result->beam_index1 = result->beam_index2 = NULL;
+    result->beam_set = NULL;
+    result->energies = result->iv_curves = NULL;
+    result->profile = NULL;
+    result->n_beams = result->n_energies = 0;
+}
+
+
+CleedResult leed(char * par_file, char * bul_file, char *phase_path)
+{
+    return leed_threads(par_file, bul_file, phase_path, 1);
+}
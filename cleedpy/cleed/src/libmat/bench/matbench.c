@@ -0,0 +1,245 @@
+/*********************************************************************
+  matbench - micro-benchmark of the libmat kernels
+
+  usage: matbench [-t min_time] [-m max_size] [kernel ...]
+
+  Times matalloc (with and without pool), matcop, mattrans, matext,
+  matins, matsqmod, matmul, matinv, matsolve and the conversions
+  mat2cblas/cblas2mat for real and complex square matrices of the
+  sizes used in LEED calculations:
+
+    beams      number of beams (20 - 400)
+    lm         (l_max+1)^2 for l_max = 6 ... 14 (49 - 225)
+    giant      giant matrices of composite layers (900 - 3600)
+
+  Each kernel is called until min_time seconds (default 0.2) have
+  elapsed (at least once). Sizes above max_size (default 3600) are
+  skipped. If kernels are given, only those are timed.
+
+  Output (one line per measurement, columns separated by blanks):
+
+    group kernel type rows cols calls time_per_call[us] GFLOP/s
+
+  GFLOP/s is given for matmul, matinv and matsolve (nominal operation
+  counts: 2 n^3, 2 n^3 and 8/3 n^3 for real matrices, four times as
+  much for complex ones), 0 otherwise. matmul_mixed multiplies a real
+  with a complex matrix (conversion of the real one by mat2cblas).
+  matsolve overwrites its matrix with the LU factors; it is restored
+  from a copy before each call and the time of this copy (see matcop)
+  is not included in the time per call.
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mat.h"
+#include "mat_blas.h"
+
+#define MIN_TIME 0.2
+#define MAX_SIZE 3600
+
+/* sizes of the groups (terminated by 0) */
+static int beams_sizes[] = { 20, 50, 100, 200, 400, 0 };
+static int lm_sizes[]    = { 49, 100, 169, 225, 0 };
+static int giant_sizes[] = { 900, 1800, 3600, 0 };
+
+/* kernels */
+enum { K_ALLOC, K_ALLOC_POOL, K_COP, K_TRANS, K_EXT, K_INS, K_SQMOD,
+       K_MUL, K_MUL_MIXED, K_INV, K_SOLVE, K_MAT2CBLAS, K_CBLAS2MAT,
+       N_KERNELS };
+
+static const char *kernel_names[N_KERNELS] =
+{ "matalloc", "matalloc_pool", "matcop", "mattrans", "matext", "matins",
+  "matsqmod", "matmul", "matmul_mixed", "matinv", "matsolve",
+  "mat2cblas", "cblas2mat" };
+
+/* kernels selected on the command line (all if none) */
+static int selected[N_KERNELS];
+
+/*======================================================================*/
+
+static double wall_time(void)
+{
+struct timespec now;
+
+ clock_gettime(CLOCK_MONOTONIC, &now);
+ return( (double)now.tv_sec + 1.e-9 * (double)now.tv_nsec );
+}
+
+/*
+  Matrix with pseudo-random elements in [-0.5, 0.5) plus n on the
+  diagonal (well conditioned for matinv/matsolve).
+*/
+static mat bench_matrix(int rows, int cols, int num_type)
+{
+int i, k, n_el;
+mat M;
+
+ M = matalloc(NULL, rows, cols, num_type);
+ n_el = (num_type == NUM_COMPLEX)? 2*rows*cols: rows*cols;
+ k = (num_type == NUM_COMPLEX)? 2: 1;
+ for(i = 0; i < n_el; i ++)
+   M->rel[k + i] = (real)rand() / RAND_MAX - 0.5;
+ if(rows == cols)
+   for(i = 0; i < rows; i ++)
+     M->rel[k*(i*cols + i + 1)] += rows;
+ return(M);
+}
+
+/*
+  Call kernel i_kernel for n x n matrices of type num_type until
+  min_time has elapsed and print the time per call.
+*/
+static void bench_kernel(const char *group, int i_kernel, int n, int num_type,
+                         double min_time)
+{
+int k, n_calls;
+double t_start, t_call, t_copy, t_0, flops;
+real *buffer;
+mat A, A0, B, C, Ar;
+
+ if(!selected[i_kernel]) return;
+ /* the mixed product has a real and a complex operand */
+ if( (i_kernel == K_MUL_MIXED) && (num_type == NUM_REAL) ) return;
+
+ A = bench_matrix(n, n, num_type);
+ B = bench_matrix(n, n, num_type);
+ Ar = (i_kernel == K_MUL_MIXED)? bench_matrix(n, n, NUM_REAL): NULL;
+ /* pristine copy of A (overwritten by matsolve) */
+ A0 = (i_kernel == K_SOLVE)? matcop(NULL, A): NULL;
+ C = NULL;
+ buffer = (real *) malloc(2 * n * n * sizeof(real));
+
+ if(i_kernel == K_ALLOC_POOL)
+   matpool_use(matpool_alloc());
+
+ t_copy = 0.;
+ t_start = wall_time();
+ for(n_calls = 0; (n_calls == 0) || (wall_time() - t_start < min_time);
+     n_calls ++)
+ {
+   switch(i_kernel)
+   {
+     case K_ALLOC:
+     case K_ALLOC_POOL:
+       C = matalloc(NULL, n, n, num_type);
+       matfree(C);
+       C = NULL;
+       break;
+     case K_COP:         C = matcop(C, A); break;
+     case K_TRANS:       C = mattrans(C, A); break;
+     case K_EXT:         C = matext(C, A, 1, n, 1, n/2); break;
+     case K_INS:
+       if(C == NULL) C = matext(NULL, B, 1, n/2, 1, n/2);
+       A = matins(A, C, n/4 + 1, n/4 + 1);
+       break;
+     case K_SQMOD:       C = matsqmod(C, A); break;
+     case K_MUL:         C = matmul(C, A, B); break;
+     case K_MUL_MIXED:   C = matmul(C, Ar, B); break;
+     case K_INV:         C = matinv(C, A); break;
+     case K_SOLVE:
+       t_0 = wall_time();
+       A = matcop(A, A0);
+       t_copy += wall_time() - t_0;
+       C = matsolve(C, A, B);
+       break;
+     case K_MAT2CBLAS:   mat2cblas(buffer, num_type, A); break;
+     case K_CBLAS2MAT:   cblas2mat(A, buffer); break;
+   }
+ }
+ t_call = (wall_time() - t_start - t_copy) / n_calls;
+
+ if(i_kernel == K_ALLOC_POOL)
+   matpool_free(matpool_use(NULL));
+
+ /* nominal operation counts */
+ flops = (double)n * n * n;
+ k = (num_type == NUM_COMPLEX)? 4: 1;
+ switch(i_kernel)
+ {
+   case K_MUL:
+   case K_MUL_MIXED: flops *= 2. * k; break;
+   case K_INV:       flops *= 2. * k; break;
+   case K_SOLVE:     flops *= 8./3. * k; break;
+   default:          flops = 0.;
+ }
+
+ printf("%-6s %-14s %-7s %5d %5d %8d %14.3f %8.3f\n", group,
+        kernel_names[i_kernel], (num_type == NUM_COMPLEX)? "complex": "real",
+        n, n, n_calls, 1.e6 * t_call, 1.e-9 * flops / t_call);
+ fflush(stdout);
+
+ free(buffer);
+ matfree(A);
+ matfree(B);
+ if(C != NULL) matfree(C);
+ if(A0 != NULL) matfree(A0);
+ if(Ar != NULL) matfree(Ar);
+}
+
+/*======================================================================*/
+
+int main(int argc, char *argv[])
+{
+int i, i_kernel, i_size, i_group;
+int n_named;
+int max_size = MAX_SIZE;
+int num_types[2] = { NUM_REAL, NUM_COMPLEX };
+double min_time = MIN_TIME;
+
+const char *group_names[3] = { "beams", "lm", "giant" };
+int *group_sizes[3];
+
+ group_sizes[0] = beams_sizes;
+ group_sizes[1] = lm_sizes;
+ group_sizes[2] = giant_sizes;
+
+ for(i_kernel = 0; i_kernel < N_KERNELS; i_kernel ++)
+   selected[i_kernel] = 1;
+
+ for(i = 1, n_named = 0; i < argc; i ++)
+ {
+   if( (strcmp(argv[i], "-t") == 0) && (i + 1 < argc) )
+     min_time = atof(argv[++ i]);
+   else if( (strcmp(argv[i], "-m") == 0) && (i + 1 < argc) )
+     max_size = atoi(argv[++ i]);
+   else
+   {
+     for(i_kernel = 0; i_kernel < N_KERNELS; i_kernel ++)
+       if(strcmp(argv[i], kernel_names[i_kernel]) == 0) break;
+
+     if(i_kernel == N_KERNELS)
+     {
+       fprintf(stderr, "usage: %s [-t min_time] [-m max_size] [kernel ...]\n"
+                       "kernels:", argv[0]);
+       for(i_kernel = 0; i_kernel < N_KERNELS; i_kernel ++)
+         fprintf(stderr, " %s", kernel_names[i_kernel]);
+       fprintf(stderr, "\n");
+       exit(1);
+     }
+
+     /* only the kernels given */
+     if(n_named == 0)
+       memset(selected, 0, sizeof(selected));
+     selected[i_kernel] = 1;
+     n_named ++;
+   }
+ }
+
+ printf("# group kernel type rows cols calls time_per_call[us] GFLOP/s\n");
+ srand(1);
+
+ for(i_group = 0; i_group < 3; i_group ++)
+   for(i_size = 0; group_sizes[i_group][i_size] > 0; i_size ++)
+   {
+     if(group_sizes[i_group][i_size] > max_size) continue;
+     for(i = 0; i < 2; i ++)
+       for(i_kernel = 0; i_kernel < N_KERNELS; i_kernel ++)
+         bench_kernel(group_names[i_group], i_kernel,
+                      group_sizes[i_group][i_size], num_types[i], min_time);
+   }
+
+ return(0);
+}
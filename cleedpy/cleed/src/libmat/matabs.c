@@ -80,8 +80,8 @@ long int nn;
 
      case(NUM_COMPLEX):
      {
-       for (ptr_r = M->rel + 1, ptr_i = M->iel + 1, ptr_end = M->rel + nn;
-            ptr_r <= ptr_end; ptr_r ++, ptr_i ++)
+       for (ptr_r = M->rel + 2, ptr_i = M->iel + 2, ptr_end = M->rel + 2*nn;
+            ptr_r <= ptr_end; ptr_r += 2, ptr_i += 2)
        {
          mabs += R_cabs(*ptr_r, *ptr_i);
        }
@@ -107,8 +107,8 @@ long int nn;
 
      case(NUM_COMPLEX):
      {
-       for (ptr_r = M->rel + 1, ptr_i = M->iel + 1, ptr_end = M->rel + nn;
-            ptr_r <= ptr_end; ptr_r ++, ptr_i ++)
+       for (ptr_r = M->rel + 2, ptr_i = M->iel + 2, ptr_end = M->rel + 2*nn;
+            ptr_r <= ptr_end; ptr_r += 2, ptr_i += 2)
        {
          mabs += R_cabs(*ptr_r, *ptr_i);
        }
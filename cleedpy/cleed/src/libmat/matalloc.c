@@ -15,6 +15,7 @@
 *********************************************************************/
 
 #include <stdio.h>
+#include <string.h>
 #if defined (__MACH__)
   #include <stdlib.h>
 #else
@@ -104,21 +105,16 @@ mat matalloc(mat M, int rows, int cols, int num_type)
         if(M->num_type == NUM_COMPLEX)
         {
             // M->mat_type < MAT_DIAG means square, normal or scalar
+            // real and imaginary parts are interleaved in rel
             if(M->mat_type < MAT_DIAG)
             {
-                ptr_end = M->rel + M->rows*M->cols;
+                ptr_end = M->iel + 2*M->rows*M->cols;
                 for(ptr = M->rel; ptr <= ptr_end; ptr ++) *ptr = 0.;
-
-                ptr_end = M->iel + M->rows*M->cols;
-                for(ptr = M->iel; ptr <= ptr_end; ptr ++) *ptr = 0.;
             }
             if(M->mat_type == MAT_DIAG)
             {
-                ptr_end = M->rel + M->cols;
+                ptr_end = M->iel + 2*M->cols;
                 for(ptr = M->rel; ptr <= ptr_end; ptr ++) *ptr = 0.;
-
-                ptr_end = M->iel + M->cols;
-                for(ptr = M->iel; ptr <= ptr_end; ptr ++) *ptr = 0.;
             }
         } /* NUM_COMPLEX */
 
@@ -154,8 +150,8 @@ mat matalloc(mat M, int rows, int cols, int num_type)
     }
     else  // M != NULL
     {
-        if (M->iel != NULL) free(M->iel);
-        if (M->rel != NULL) free(M->rel);
+        // iel is part of rel for complex matrices (see mat_def.h)
+        matel_free(M->rel);
     }
 
     M->cols = cols;
@@ -173,29 +169,17 @@ mat matalloc(mat M, int rows, int cols, int num_type)
         case(NUM_REAL):
         {
             M->iel = NULL;
-            M->rel = (real*)calloc( no_of_elts, sizeof(real));
-            if (M->rel == NULL)
-            {
-                free(M);
-                fprintf(STDERR,"*** error (matalloc) allocation error\n");
-                exit(1);
-            }
+            M->rel = matel_alloc(no_of_elts);
+            memset(M->rel, 0, no_of_elts * sizeof(real));
             break;
         }  /* NUM_REAL */
 
         case(NUM_COMPLEX):
         {
-            M->rel = (real*)calloc( no_of_elts, sizeof(real));
-            M->iel = (real*)calloc( no_of_elts, sizeof(real));
-
-            if( (M->rel == NULL) || (M->iel == NULL) )
-            {
-                if (M->rel != NULL) free(M->rel);
-                if (M->iel != NULL) free(M->iel);
-                free(M);
-                fprintf(STDERR,"*** error (matalloc) allocation error\n");
-                exit(1);
-            }
+            // real and imaginary parts interleaved
+            M->rel = matel_alloc(2*no_of_elts);
+            memset(M->rel, 0, 2*no_of_elts * sizeof(real));
+            M->iel = M->rel + 1;
             break;
         }  /* NUM_COMPLEX */
 
@@ -17,7 +17,6 @@
 /*
 #define WARNING
 */
-#define CONTROL
 #define ERROR
 
 #define EXIT_ON_ERROR
@@ -95,10 +94,11 @@ int mat_ch, i_mat;
   not match, allocate new array.
 *********************************************************************/
 
-#ifdef CONTROL
+ if(LOG_ON(LOG_MAT, LOG_CONTROL))
+ {
    fprintf(STDCTR,"(matarralloc): create new matrix array of length %d\n",
            length);
-#endif
+ }
 
  M = ( mat )malloc( (length+1) * sizeof(struct mat_str));
 
@@ -16,7 +16,6 @@
 /*
 #define WARNING
 */
-#define CONTROL
 #define ERROR
 
 /*======================================================================*/
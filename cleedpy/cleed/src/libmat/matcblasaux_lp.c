@@ -35,9 +35,9 @@ void mat2cblas ( real *cblas_mx, int cblas_num, mat Mx ) {
      }
 
    } else if (Mx->num_type ==  NUM_COMPLEX) {
-     for ( i = 1 , cblas_px = cblas_mx , ptrx = Mx->rel+1 , ptix = Mx->iel+1 ;
+     for ( i = 1 , cblas_px = cblas_mx , ptrx = Mx->rel+2 , ptix = Mx->iel+2 ;
            i <= Mx->rows * Mx->cols ;
-           i++ , cblas_px += incre , ptrx++ , ptix++ ) {
+           i++ , cblas_px += incre , ptrx += 2 , ptix += 2 ) {
        *cblas_px = *ptrx;
        *(cblas_px+1) = *ptix;
      }
@@ -62,9 +62,9 @@ void cblas2mat ( mat Mx, real *cblas_mx ) { /* silently assume cblas same type a
      }
 
    } else if (Mx->num_type ==  NUM_COMPLEX) {
-     for ( i = 1 , cblas_px = cblas_mx , ptrx = Mx->rel+1 , ptix = Mx->iel+1 ;
+     for ( i = 1 , cblas_px = cblas_mx , ptrx = Mx->rel+2 , ptix = Mx->iel+2 ;
            i <= Mx->rows * Mx->cols ;
-           i++ , cblas_px += 2 , ptrx++ , ptix++ )
+           i++ , cblas_px += 2 , ptrx += 2 , ptix += 2 )
      {
        *ptrx = *cblas_px;
        *ptix = *(cblas_px+1);
@@ -50,9 +50,6 @@ int i_r, i_c, i_i;
 
 real dumi, dumr, aux;
 
-real *ptrr1, *ptr_end;
-real *invr, *invi;
-
 mat Minv;
 
 /*
@@ -82,29 +79,10 @@ mat Minv;
   Create nxn identity matrix (will be output).
 */
 
- Minv = (mat)malloc( sizeof( struct mat_str ) );
- invr = Minv->rel = (real *)calloc( n*n + 1, sizeof(real) );
- invi = Minv->iel = (real *)calloc( n*n + 1, sizeof(real) );
-
- if( (Minv == NULL) || (invr == NULL) || (invi == NULL) )
- {
-#ifdef ERROR
-   fprintf(STDERR," *** error (c_luinv): allocation error \n");
-#endif
-   free(invr);
-   free(invi);
-   free(Minv);
-   return(NULL);
- }
-
- Minv->num_type = NUM_COMPLEX;
- Minv->mat_type = MAT_SQUARE;
-
- Minv->cols = Minv->rows = n;
+ Minv = matalloc(NULL, n, n, NUM_COMPLEX);
 
- for (ptrr1 = invr + 1, ptr_end = invr + n*n;
-      ptrr1 <= ptr_end; ptrr1 += n+1)
-   *ptrr1 = 1.0;
+ for (i_r = 1; i_r <= n; i_r ++)
+   RMATEL(i_r,i_r,Minv) = 1.0;
 
 
 /*
@@ -90,17 +90,11 @@ real *ptr_r, *ptr_M, *ptr_end;
 
      case(NUM_COMPLEX):
      {
-     /* first real part */
-       for (ptr_M = M->rel + col_num,
-            ptr_r = col->rel + 1, ptr_end = M->rel + M->rows*M->cols;
-            ptr_M <= ptr_end; ptr_r ++, ptr_M += M->cols)
-       { *ptr_r = *ptr_M; }
-
-    /* now imaginary part */
-       for (ptr_M = M->iel + col_num,
-            ptr_r = col->iel + 1, ptr_end = M->iel + M->rows*M->cols;
-            ptr_M <= ptr_end; ptr_r ++, ptr_M += M->cols)
-       { *ptr_r = *ptr_M; }
+     /* real and imaginary parts are interleaved */
+       for (ptr_M = M->rel + 2*col_num,
+            ptr_r = col->rel + 2, ptr_end = M->rel + 2*M->rows*M->cols;
+            ptr_M <= ptr_end; ptr_r += 2, ptr_M += 2*M->cols)
+       { *ptr_r = *ptr_M; *(ptr_r+1) = *(ptr_M+1); }
 
        break;
      } /* case COMPLEX */
@@ -123,19 +117,9 @@ real *ptr_r, *ptr_M, *ptr_end;
 
      case(NUM_COMPLEX):
      {
-     /* first real part */
-       for ( ptr_r = col->rel + 1, ptr_end = ptr_r + M->rows;
-             ptr_r <= ptr_end; ptr_r ++)
-       { *ptr_r = 0.; }
-
-       *(col->rel + col_num) = *(M->rel + col_num);
-
-    /* now imaginary part */
-       for ( ptr_r = col->iel + 1, ptr_end = ptr_r + M->rows;
-             ptr_r <= ptr_end; ptr_r ++)
-       { *ptr_r = 0.; }
-
-       *(col->iel + col_num) = *(M->iel + col_num);
+     /* real and imaginary parts are interleaved (col is zero already) */
+       *(col->rel + 2*col_num) = *(M->rel + 2*col_num);
+       *(col->iel + 2*col_num) = *(M->iel + 2*col_num);
 
        break;
      } /* case COMPLEX */
@@ -82,8 +82,8 @@ mat Maux;
      Only conj. complex for complex diagonal matrices.
    */
        Mt = matcop(Mt,M);
-       ptr_o_end = Mt->iel+Mt->rows;
-       for(ptr_o = Mt->iel+1; ptr_o <= ptr_o_end; ptr_o ++)
+       ptr_o_end = Mt->iel+2*Mt->rows;
+       for(ptr_o = Mt->iel+2; ptr_o <= ptr_o_end; ptr_o += 2)
        {
          *ptr_o = - (*ptr_o);
        }
@@ -117,38 +117,25 @@ mat Maux;
    /*
      Transposition and conjugation of a complex matrix
    */
-       Maux = matcop(NULL,M);
+       /* a copy of M is only needed if the result overwrites it */
+       Maux = (Mt == M) ? matcop(NULL,M) : M;
        Mt = matalloc(Mt, Maux->cols, Maux->rows, Maux->num_type);
    /*
-     rel: only transposition
+     transposition and conjugation (real and imaginary parts interleaved)
    */
        ptr_o_end = Maux->rel;
        for(i_r = 1; i_r <= Maux->rows; i_r ++)
        {
-         ptr_o = ptr_o_end + 1;
-         ptr_o_end += Maux->cols;
-         ptr_t = Mt->rel + i_r;
-         for(; ptr_o <= ptr_o_end; ptr_o ++, ptr_t += Maux->rows)
+         ptr_o = ptr_o_end + 2;
+         ptr_o_end += 2*Maux->cols;
+         ptr_t = Mt->rel + 2*i_r;
+         for(; ptr_o <= ptr_o_end; ptr_o += 2, ptr_t += 2*Maux->rows)
          {
            *ptr_t = *ptr_o;
+           *(ptr_t+1) = -(*(ptr_o+1));
          }
        } /* for i_r */
-
-   /*
-     iel: transposition and conjugation
-   */
-       ptr_o_end = Maux->iel;
-       for(i_r = 1; i_r <= Maux->rows; i_r ++)
-       {
-         ptr_o = ptr_o_end + 1;
-         ptr_o_end += Maux->cols;
-         ptr_t = Mt->iel + i_r;
-         for(; ptr_o <= ptr_o_end; ptr_o ++, ptr_t += Maux->rows)
-         {
-           *ptr_t = -(*ptr_o);
-         }
-       } /* for i_r */
-       matfree(Maux);
+       if(Maux != M) matfree(Maux);
        return(Mt);
        break;
      } /* NUM_COMPLEX */
@@ -28,8 +28,9 @@ mat matcop( mat M1, mat M2 )
 
   parameters:
   M1 - pointer to the destination matrix. If this is NULL, the memory will
-       be allocated. In any case, the memory where the old matrix elements
-       of M1 are stroed will be freed and reallocated.
+       be allocated. The memory where the old matrix elements of M1 are
+       stored is reused if M1 has the same type and dimensions as M2,
+       otherwise it will be freed and reallocated.
 
   M2 - pointers to the source matrix.
 
@@ -66,34 +67,41 @@ long int size, i;
 
 /*********************************************************************
   Check if M1 exists.
-  If not, allocate memory for the matrix structure
-  Free the matrix elements.
+  If not, allocate memory for the matrix structure.
+  Free the matrix elements unless they have the right size already.
 *********************************************************************/
+
  if (matcheck(M1) == 0)
  {
 #ifdef CONTROL
   fprintf(STDCTR," (matcop) M1 = NULL \n");
 #endif
   M1 = ( mat )malloc( sizeof( struct mat_str ));
+  M1->blk_type = BLK_SINGLE;
   M1->rel = NULL;
   M1->iel = NULL;
  }
-
- if (M1->rel != NULL) {free(M1->rel); M1->rel = NULL;}
- if (M1->iel != NULL) {free(M1->iel); M1->iel = NULL;}
+ else if ( (M1->num_type != M2->num_type) || (M1->mat_type != M2->mat_type) ||
+           (M1->cols != M2->cols) || (M1->rows != M2->rows) )
+ {
+  matel_free(M1->rel); M1->rel = NULL;
+  M1->iel = NULL;
+ }
 
 /*********************************************************************
   Copy matrix parameters
 *********************************************************************/
+
  M1->num_type =  M2->num_type;
  M1->mat_type =  M2->mat_type;
-
  M1->cols = M2->cols;
  M1->rows = M2->rows;
 
 /*********************************************************************
   Find size of matrix
+  (complex matrices: real and imaginary parts are interleaved in rel)
 *********************************************************************/
+
  switch(M2->mat_type)
  {
    case (MAT_DIAG): { size = (M2->cols + 1)*sizeof(real); break;}
@@ -103,13 +111,13 @@ long int size, i;
 /*********************************************************************
   Allocate memory and copy matrix elements
 *********************************************************************/
+
  if(M2->num_type == NUM_REAL)
  {
    /*
     real matrix
    */
-   M1->rel = (real *)malloc( size );
-
+   if(M1->rel == NULL) M1->rel = matel_alloc(size / sizeof(real));
    memcpy(M1->rel, M2->rel, size );
  }
  else if (M2->num_type == NUM_COMPLEX)
@@ -117,11 +125,9 @@ long int size, i;
    /*
     complex matrix
    */
-   M1->rel = (real *)malloc( size );
-   M1->iel = (real *)malloc( size );
-
-   memcpy(M1->rel, M2->rel, size );
-   memcpy(M1->iel, M2->iel, size );
+   if(M1->rel == NULL) M1->rel = matel_alloc(2*size / sizeof(real));
+   M1->iel = M1->rel + 1;
+   memcpy(M1->rel, M2->rel, 2*size );
  }
  else
  {
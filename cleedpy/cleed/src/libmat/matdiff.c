@@ -93,15 +93,8 @@ long int nn;
 
      case(NUM_COMPLEX):
      {
-     /* first calculate diffrerence of real part */
-       for (ptr_1 = M1->rel + 1, ptr_2 = M2->rel + 1, ptr_end = M1->rel + nn;
-            ptr_1 <= ptr_end; ptr_1 ++, ptr_2 ++)
-       {
-         diff += R_fabs(*ptr_1 - *ptr_2);
-       }
-
-    /* add diffrerence of imaginary part */
-       for (ptr_1 = M1->iel + 1, ptr_2 = M2->iel + 1, ptr_end = M1->iel + nn;
+     /* real and imaginary parts are interleaved */
+       for (ptr_1 = M1->rel + 2, ptr_2 = M2->rel + 2, ptr_end = M1->iel + 2*nn;
             ptr_1 <= ptr_end; ptr_1 ++, ptr_2 ++)
        {
          diff += R_fabs(*ptr_1 - *ptr_2);
@@ -44,7 +44,7 @@ mat matext(mat Msm, mat Mbg,
 
 *********************************************************************/
 {
-int i_r;
+int i_r, st;
 int size;
 register real *ptr_bg, *ptr_sm;
 real *ptr_end;
@@ -119,41 +119,31 @@ mat Maux = NULL;
 ********************************************************************/
  else
  {
-   Maux = matalloc(Maux,
+   /* write into Msm directly unless it is the input matrix */
+   Maux = matalloc( (Msm == Mbg) ? NULL : Msm,
                    end_row - off_row + 1,
                    end_col - off_col + 1,
                    Mbg->num_type);
 
-   size = Maux->cols*sizeof(real);
 /*
-  Copy real parts first (for real and complex matrices)
+  Copy rows (complex matrices: real and imaginary parts are interleaved)
 */
-   ptr_end = Maux->rel + Maux->cols*Maux->rows;
-   for(ptr_bg = Mbg->rel + (off_row-1)*Mbg->cols + off_col,
-       ptr_sm = Maux->rel+1;
+   st = MAT_STRIDE(Mbg);
+   size = st*Maux->cols*sizeof(real);
+   ptr_end = Maux->rel + st*Maux->cols*Maux->rows;
+   for(ptr_bg = Mbg->rel + st*((off_row-1)*Mbg->cols + off_col),
+       ptr_sm = Maux->rel + st;
        ptr_sm <= ptr_end;
-       ptr_bg += Mbg->cols, ptr_sm += Maux->cols)
+       ptr_bg += st*Mbg->cols, ptr_sm += st*Maux->cols)
    {
      memcpy(ptr_sm, ptr_bg, size );
    }
-
-   if(Mbg->num_type == NUM_COMPLEX)
-   {
-/*
-  For complex matrix copy also imag. parts.
-*/
-     ptr_end = Maux->iel + Maux->cols*Maux->rows;
-     for(ptr_bg = Mbg->iel + (off_row-1)*Mbg->cols + off_col,
-         ptr_sm = Maux->iel+1;
-         ptr_sm <= ptr_end;
-         ptr_bg += Mbg->cols, ptr_sm += Maux->cols)
-     {
-       memcpy(ptr_sm, ptr_bg, size );
-     }
-   } /* NUM_COMPLEX */
  }     /* else */
 
- Msm = matcop(Msm, Maux);
- matfree(Maux);
+ if (Maux != Msm)
+ {
+   Msm = matcop(Msm, Maux);
+   matfree(Maux);
+ }
  return(Msm);
 } /* end of function matext */
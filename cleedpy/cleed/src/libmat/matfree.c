@@ -43,8 +43,7 @@ int matfree( mat M )
    return(0);
  }
 
- if (M->rel != NULL) free(M->rel);
- if (M->iel != NULL) free(M->iel);
+ matel_free(M->rel);   /* iel is part of rel (mat_def.h) */
 
  free(M);
  return(1);
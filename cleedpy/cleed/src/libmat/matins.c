@@ -41,7 +41,7 @@ mat matins(mat Mbg, mat Msm, int off_row, int off_col)
 
 *********************************************************************/
 {
-int i_r;
+int i_r, st;
 int size;
 register real *ptr_bg, *ptr_sm;
 real *ptr_end;
@@ -117,33 +117,19 @@ mat Maux;
 ********************************************************************/
  else
  {
-   size = Msm->cols*sizeof(real);
 /*
-  Copy real parts first (for real and complex matrices)
+  Copy rows (complex matrices: real and imaginary parts are interleaved)
 */
-   ptr_end = Msm->rel + Msm->cols*Msm->rows;
-   for(ptr_bg = Mbg->rel + (off_row-1)*Mbg->cols + off_col,
-       ptr_sm = Msm->rel+1;
+   st = MAT_STRIDE(Msm);
+   size = st*Msm->cols*sizeof(real);
+   ptr_end = Msm->rel + st*Msm->cols*Msm->rows;
+   for(ptr_bg = Mbg->rel + st*((off_row-1)*Mbg->cols + off_col),
+       ptr_sm = Msm->rel + st;
        ptr_sm <= ptr_end;
-       ptr_bg += Mbg->cols, ptr_sm += Msm->cols)
+       ptr_bg += st*Mbg->cols, ptr_sm += st*Msm->cols)
    {
      memcpy(ptr_bg, ptr_sm, size );
    }
-
-   if(Msm->num_type == NUM_COMPLEX)
-   {
-/*
-  For complex matrix copy also imag. parts.
-*/
-     ptr_end = Msm->iel + Msm->cols*Msm->rows;
-     for(ptr_bg = Mbg->iel + (off_row-1)*Mbg->cols + off_col,
-         ptr_sm = Msm->iel+1;
-         ptr_sm <= ptr_end;
-         ptr_bg += Mbg->cols, ptr_sm += Msm->cols)
-     {
-       memcpy(ptr_bg, ptr_sm, size );
-     }
-   } /* NUM_COMPLEX */
  }     /* else */
 
    return(Mbg);
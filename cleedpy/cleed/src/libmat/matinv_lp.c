@@ -116,28 +116,29 @@ real *cblas_a, *work;
    case (NUM_REAL):
    {
 
-      cblas_a = calloc(n*n, sizeof(real)) ;
-      mat2cblas( cblas_a, NUM_REAL, A);
+      /* invert a copy of A in place */
+      A_1 = matcop(A_1, A);
+      cblas_a = A_1->rel + 1;
 
       if ( sizeof(real) == sizeof(float) ) {
         nb = ilaenv_( &p1, "SGETRI", " ", &n, &m1, &m1, &m1);
         lwork = n*nb;
-        work = calloc(lwork, sizeof(float));
-        sgetrf_(&n, &n, cblas_a, &n, ipiv, &info);
+        work = matel_alloc(lwork);
+        sgetrf_(&n, &n, (float*)cblas_a, &n, ipiv, &info);
 	info_check("sgetrf", info);
         sgetri_(&n, (float*)cblas_a, &n, ipiv, work, &lwork, &info);
 	info_check("sgetri", info);
-	free(work);
+	matel_free(work);
       }
       else if ( sizeof(real) == sizeof(double) ) {
         nb = ilaenv_( &p1, "DGETRI", " ", &n, &m1, &m1, &m1);
         lwork = n*nb;
-        work = calloc(lwork, sizeof(double));
-        dgetrf_(&n, &n, cblas_a, &n, ipiv, &info);
+        work = matel_alloc(lwork);
+        dgetrf_(&n, &n, (double*)cblas_a, &n, ipiv, &info);
 	info_check("dgetrf", info);
         dgetri_(&n, (double*)cblas_a, &n, ipiv, work, &lwork, &info);
 	info_check("dgetri", info);
-	free(work);
+	matel_free(work);
      } else {
        fprintf(stderr, "matinv: unexpected sizeof(real)=%lu\n", sizeof(real));
        exit(1);
@@ -150,10 +151,6 @@ real *cblas_a, *work;
      fprintf(STDCTR,"\n");
 #endif
 
-     /* Allocate A_1 (if it does not exist.) */
-     A_1 = matalloc( A_1, n, n, A->num_type);
-     cblas2mat(A_1, cblas_a);
-     free(cblas_a);
      break;
    }  /* REAL */
 
@@ -164,28 +161,29 @@ real *cblas_a, *work;
    case (NUM_COMPLEX):
    {
 
-      cblas_a = calloc(n*n, 2*sizeof(real)) ;
-      mat2cblas( cblas_a, NUM_COMPLEX, A);
+      /* invert a copy of A in place (stored in the lapack layout) */
+      A_1 = matcop(A_1, A);
+      cblas_a = A_1->rel + 2;
 
       if ( sizeof(real) == sizeof(float) ) {
         nb = ilaenv_( &p1, "CGETRI", " ", &n, &m1, &m1, &m1);
         lwork = n*nb;
-        work = calloc(lwork, 2*sizeof(float));
+        work = matel_alloc(2*lwork);
         cgetrf_(&n, &n, cblas_a, &n, ipiv, &info);
 	info_check("cgetrf", info);
         cgetri_(&n, (float*)cblas_a, &n, ipiv, work, &lwork, &info);
 	info_check("cgetri", info);
-	free(work);
+	matel_free(work);
       }
       else if ( sizeof(real) == sizeof(double) ) {
         nb = ilaenv_( &p1, "ZGETRI", " ", &n, &m1, &m1, &m1);
         lwork = n*nb;
-        work = calloc(lwork, 2*sizeof(double));
+        work = matel_alloc(2*lwork);
         zgetrf_(&n, &n, cblas_a, &n, ipiv, &info);
 	info_check("zgetrf", info);
         zgetri_(&n, (double*)cblas_a, &n, ipiv, work, &lwork, &info);
 	info_check("zgetri", info);
-	free(work);
+	matel_free(work);
      } else {
        fprintf(stderr, "matinv: unexpected sizeof(real)=%lu\n", sizeof(real));
        exit(1);
@@ -197,10 +195,6 @@ real *cblas_a, *work;
      fprintf(STDCTR,"\n");
 #endif
 
-     /* Allocate A_1 (if it does not exist.) */
-     A_1 = matalloc( A_1, n, n, A->num_type);
-     cblas2mat(A_1, cblas_a);
-     free(cblas_a);
      break;
    }     /* COMPLEX */
 
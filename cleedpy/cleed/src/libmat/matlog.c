@@ -0,0 +1,43 @@
+/*********************************************************************
+  file contains functions:
+
+  matlog_set
+     Select the control output written at run time.
+
+*********************************************************************/
+
+#include <stdio.h>
+
+#include "mat.h"
+
+/* current level and categories of the control output (see LOG_ON) */
+int matlog_level = LOG_NONE;
+int matlog_cat   = LOG_ALL;
+
+/*======================================================================*/
+/*======================================================================*/
+
+void matlog_set(int level, int categories)
+
+/*********************************************************************
+  Select the control output of the library.
+
+  INPUT:
+
+   int level - LOG_NONE (no output, default), LOG_CONTROL or
+               LOG_CONTROL_X (extended output).
+   int categories - bitwise or of the categories LOG_INP, LOG_BM, ...
+               for which the output is written (LOG_ALL: all).
+
+  DESIGN:
+
+  The selection is meant to be made before the calculation is started;
+  it is not protected against concurrent changes. Disabled output costs
+  one comparison (LOG_ON), the arguments are not formatted.
+*********************************************************************/
+{
+ matlog_level = level;
+ matlog_cat   = categories;
+}  /* end of function matlog_set */
+
+/*======================================================================*/
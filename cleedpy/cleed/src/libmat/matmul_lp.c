@@ -50,7 +50,10 @@ mat matmul( mat Mr, mat M1, mat M2 )
   Mr - pointer to the matrix containing the result of the multiplication.
        If NULL, the pointer will be created and returned.
 
-  M1, M2 - pointers to the matrices to multiply.
+  M1, M2 - pointers to the matrices to multiply. Mr can be equal to
+       M1 or M2.
+
+  Complex matrices are passed to cblas_Xgemm as they are stored.
 
   return value: Mr
 
@@ -58,13 +61,14 @@ mat matmul( mat Mr, mat M1, mat M2 )
 
 {
 
-long int i;
-long int i_c2, i_r1;
-long int i_cr1, i_cr2;
-
-int result_num_type;
+int result_num_type, stride;
 
 real *cblas_m1, *cblas_m2, *cblas_mr; /* passed to cblas_Xgemm */
+real *elements;
+
+mat M1_in = M1, M2_in = M2;           /* operands as passed */
+mat Maux1, Maux2;                     /* complex copies of real operands */
+mat Mres;                             /* result (if Mr is an operand) */
 
 /*********************************************************************
   check input matrices
@@ -96,40 +100,52 @@ real *cblas_m1, *cblas_m2, *cblas_mr; /* passed to cblas_Xgemm */
   return(NULL);
 #endif
  }
-
 /*********************************************************************
-  Create cblas matrices
+  Operands
+  Complex matrices are stored in the cblas layout already (interleaved,
+  row major, see mat_def.h), so only a real operand of a complex
+  product has to be converted.
 *********************************************************************/
 
 // printf("matmul: (%d,%d) x (%d,%d)\n", M1->rows, M1->cols, M2->rows, M2->cols);
 
+ Maux1 = Maux2 = NULL;
  if((M1->num_type ==  NUM_REAL) && (M2->num_type ==  NUM_REAL) )
  {
-   /* in this case we
-   ** - need no intermediary storage for operands
-   ** - need no conversion to complex
-   */
-   cblas_mr = calloc(M1->rows * M2->cols, sizeof(real));
-
-   cblas_m1 = M1->rel + 1;   /* matrices are stored row major */
-   cblas_m2 = M2->rel + 1;
-
    result_num_type = NUM_REAL;
-
  }
  else
  {
-   /* at least one operand is complex */
-   cblas_mr = calloc(M1->rows * M2->cols, 2*sizeof(real));
-
-   cblas_m1 = calloc(M1->rows * M1->cols, 2*sizeof(real));
-   cblas_m2 = calloc(M2->rows * M2->cols, 2*sizeof(real));
-
-   mat2cblas ( cblas_m1, NUM_COMPLEX, M1 ) ;
-   mat2cblas ( cblas_m2, NUM_COMPLEX, M2 ) ;
-
    result_num_type = NUM_COMPLEX;
+   if(M1->num_type == NUM_REAL)
+   {
+     Maux1 = matalloc(NULL, M1->rows, M1->cols, NUM_COMPLEX);
+     mat2cblas(Maux1->rel + 2, NUM_COMPLEX, M1);
+     M1 = Maux1;
+   }
+   if(M2->num_type == NUM_REAL)
+   {
+     Maux2 = matalloc(NULL, M2->rows, M2->cols, NUM_COMPLEX);
+     mat2cblas(Maux2->rel + 2, NUM_COMPLEX, M2);
+     M2 = Maux2;
+   }
  }
+ stride = (result_num_type == NUM_COMPLEX) ? 2 : 1;
+ cblas_m1 = M1->rel + stride;
+ cblas_m2 = M2->rel + stride;
+
+/*********************************************************************
+  Result
+  The product is written into Mr directly unless Mr is one of the
+  operands. In that case it is written into a new matrix whose elements
+  replace those of Mr afterwards.
+*********************************************************************/
+
+ if( (Mr != NULL) && ( (Mr == M1_in) || (Mr == M2_in) ) )
+   Mres = matalloc(NULL, M1->rows, M2->cols, result_num_type);
+ else
+   Mres = Mr = matalloc(Mr, M1->rows, M2->cols, result_num_type);
+ cblas_mr = Mres->rel + stride;
 
 /*********************************************************************
   Perform the multiplication
@@ -194,21 +210,24 @@ real *cblas_m1, *cblas_m2, *cblas_mr; /* passed to cblas_Xgemm */
   }   /* endswitch */
 
 /*
-  Copy cblas_mr into Mr
+  Hand the elements of Mres over to Mr if Mr was an operand
 */
-
-  Mr = matalloc(Mr, M1->rows, M2->cols, result_num_type);
-  cblas2mat ( Mr, cblas_mr );
-
-/* WAS
-  Mr = matcop(Mr, Maux);
-  matfree(Maux);
-*/
-  if ( result_num_type == NUM_COMPLEX ) {
-    free(cblas_m1);
-    free(cblas_m2);
+  if (Mres != Mr)
+  {
+    elements = Mr->rel;
+    Mr->rel = Mres->rel;
+    Mr->iel = Mres->iel;
+    Mr->rows = Mres->rows;
+    Mr->cols = Mres->cols;
+    Mr->num_type = Mres->num_type;
+    Mr->mat_type = Mres->mat_type;
+    Mres->rel = elements;
+    Mres->iel = NULL;
+    matfree(Mres);
   }
-  free(cblas_mr);
+
+  if (Maux1 != NULL) matfree(Maux1);
+  if (Maux2 != NULL) matfree(Maux2);
   return(Mr);
 
 }  /* end of function matmul */
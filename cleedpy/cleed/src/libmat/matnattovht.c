@@ -20,7 +20,6 @@
 /*
 #define CONTROL_X
 */
-#define CONTROL
 #define WARNING
 #define ERROR
 
@@ -0,0 +1,283 @@
+/*********************************************************************
+  file contains functions:
+
+  matel_alloc
+     Allocate an array for matrix elements (from the current pool).
+  matel_free
+     Free an array allocated by matel_alloc (return it to the pool).
+  matel_bytes
+     Size of the arrays requested by the calling thread.
+  matpool_alloc
+     Create a pool for arrays of matrix elements.
+  matpool_free
+     Free a pool and all arrays stored in it.
+  matpool_use
+     Select the pool of the calling thread.
+  matpool_reset
+     Release the arrays that have not been used since the last reset.
+
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mat.h"
+
+/*
+#define CONTROL
+*/
+#define ERROR
+#define EXIT_ON_ERROR
+
+/*
+ Arrays are preceded by a header of MATPOOL_HEAD reals (which keeps the
+ alignment of malloc for complex numbers) holding the size class.
+*/
+#define MATPOOL_HEAD  2
+#define MATPOOL_MIN   16         /* size of the smallest class (reals) */
+
+#if defined(__GNUC__)
+#define MATPOOL_THREAD __thread
+#else
+#define MATPOOL_THREAD _Thread_local
+#endif
+
+/* pool of the calling thread (NULL: no pool, use malloc/free) */
+static MATPOOL_THREAD struct matpool_str *matpool_now = NULL;
+
+/* bytes requested from matel_alloc by the calling thread (see matel_bytes) */
+static MATPOOL_THREAD double matpool_bytes_req = 0.;
+static MATPOOL_THREAD double matpool_bytes_new = 0.;
+
+/*======================================================================*/
+/*======================================================================*/
+
+static size_t matpool_size(int i_class)
+
+/*********************************************************************
+  Number of reals in an array of size class i_class: four classes per
+  factor of two (16, 20, 24, 28, 32, 40, ...), so that at most a fifth
+  of an array is wasted.
+*********************************************************************/
+{
+ return( (size_t)(4 + (i_class & 3)) * (MATPOOL_MIN/4) << (i_class >> 2) );
+}
+
+/*======================================================================*/
+/*======================================================================*/
+
+real *matel_alloc(size_t n)
+
+/*********************************************************************
+  Allocate an array of (at least) n reals for matrix elements.
+
+  If the calling thread uses a pool (matpool_use), a free array of the
+  same size class is taken from there. Otherwise, or if the pool does
+  not contain one, a new array is allocated.
+
+  Unlike matalloc, the elements are not initialised.
+
+  RETURN VALUE:
+    pointer to the array (exit on allocation error).
+
+*********************************************************************/
+{
+int i_class;
+size_t size;
+real *block, *ptr;
+struct matpool_str *pool = matpool_now;
+
+ matpool_bytes_req += (double)(n * sizeof(real));
+
+ for(i_class = 0, size = MATPOOL_MIN;
+     (size < n) && (i_class < MATPOOL_N_CLASS);
+     i_class ++, size = matpool_size(i_class))
+   ;
+
+ if(i_class == MATPOOL_N_CLASS)
+ {
+   i_class = -1;
+   size = n;
+ }
+ else if( (pool != NULL) && (pool->head[i_class] != NULL) )
+ {
+   ptr = pool->head[i_class];
+   pool->head[i_class] = *(real **)ptr;
+   pool->n_used[i_class] ++;
+   return(ptr);
+ }
+ else if(pool != NULL)
+   pool->n_used[i_class] ++;
+
+ matpool_bytes_new += (double)((size + MATPOOL_HEAD) * sizeof(real));
+
+ block = (real *) malloc( (size + MATPOOL_HEAD) * sizeof(real) );
+ if(block == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR,"*** error (matel_alloc): allocation error\n");
+#endif
+   exit(1);
+ }
+
+ *(int *)block = i_class;
+ return(block + MATPOOL_HEAD);
+}  /* end of function matel_alloc */
+
+/*======================================================================*/
+/*======================================================================*/
+
+void matel_bytes(double *p_req, double *p_new)
+
+/*********************************************************************
+  Total size [bytes] of the arrays requested from matel_alloc by the
+  calling thread (*p_req) and of those that had to be allocated
+  because the pool did not contain one (*p_new). The counters are
+  never reset; differences give the amounts for a part of a
+  calculation.
+*********************************************************************/
+{
+ *p_req = matpool_bytes_req;
+ *p_new = matpool_bytes_new;
+}  /* end of function matel_bytes */
+
+/*======================================================================*/
+/*======================================================================*/
+
+void matel_free(real *ptr)
+
+/*********************************************************************
+  Free an array allocated by matel_alloc. The array is put into the pool
+  of the calling thread, if there is one, otherwise it is freed. It does
+  not matter which pool (if any) the array was taken from.
+*********************************************************************/
+{
+int i_class;
+real *block;
+struct matpool_str *pool = matpool_now;
+
+ if(ptr == NULL) return;
+
+ block = ptr - MATPOOL_HEAD;
+ i_class = *(int *)block;
+
+ if( (pool == NULL) || (i_class < 0) )
+   free(block);
+ else
+ {
+   *(real **)ptr = pool->head[i_class];
+   pool->head[i_class] = ptr;
+ }
+}  /* end of function matel_free */
+
+/*======================================================================*/
+/*======================================================================*/
+
+struct matpool_str *matpool_alloc(void)
+
+/*********************************************************************
+  Create an empty pool for arrays of matrix elements.
+
+  DESIGN:
+  A pool keeps the element arrays of freed matrices (one list per size
+  class) and hands them out again to matalloc, matcop, etc., which saves
+  the calls of malloc/free and, for large matrices, the page faults of
+  fresh memory. A pool must only be used by one thread at a time; it is
+  selected by matpool_use and emptied partly by matpool_reset.
+
+  RETURN VALUE:
+    pointer to the new pool.
+
+*********************************************************************/
+{
+ return( (struct matpool_str *) calloc(1, sizeof(struct matpool_str)) );
+}  /* end of function matpool_alloc */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int matpool_free(struct matpool_str *pool)
+
+/*********************************************************************
+  Free all arrays stored in the pool and the pool itself. The pool must
+  not be used by any thread.
+*********************************************************************/
+{
+int i_class;
+real *ptr;
+
+ if(pool == NULL) return(0);
+
+ for(i_class = 0; i_class < MATPOOL_N_CLASS; i_class ++)
+   while( (ptr = pool->head[i_class]) != NULL)
+   {
+     pool->head[i_class] = *(real **)ptr;
+     free(ptr - MATPOOL_HEAD);
+   }
+
+ free(pool);
+ return(1);
+}  /* end of function matpool_free */
+
+/*======================================================================*/
+/*======================================================================*/
+
+struct matpool_str *matpool_use(struct matpool_str *pool)
+
+/*********************************************************************
+  Let the calling thread take element arrays from pool and return them
+  there (NULL: use malloc and free directly).
+
+  RETURN VALUE:
+    the pool used before.
+
+*********************************************************************/
+{
+struct matpool_str *pool_old = matpool_now;
+
+ matpool_now = pool;
+ return(pool_old);
+}  /* end of function matpool_use */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int matpool_reset(struct matpool_str *pool)
+
+/*********************************************************************
+  Free the arrays of all size classes that have not been asked for since
+  the last reset and start counting again.
+
+  DESIGN:
+  Called after each step of a calculation (e.g. an energy), this keeps
+  the arrays that the next step is likely to need again, while the pool
+  does not grow beyond the working set of a single step.
+
+  RETURN VALUE:
+    number of arrays freed.
+
+*********************************************************************/
+{
+int i_class, n_freed;
+real *ptr;
+
+ if(pool == NULL) return(0);
+
+ for(n_freed = 0, i_class = 0; i_class < MATPOOL_N_CLASS; i_class ++)
+ {
+   if(pool->n_used[i_class] == 0)
+     while( (ptr = pool->head[i_class]) != NULL)
+     {
+       pool->head[i_class] = *(real **)ptr;
+       free(ptr - MATPOOL_HEAD);
+       n_freed ++;
+     }
+   pool->n_used[i_class] = 0;
+ }
+
+#ifdef CONTROL
+ fprintf(STDCTR,"(matpool_reset): %d arrays freed\n", n_freed);
+#endif
+
+ return(n_freed);
+}  /* end of function matpool_reset */
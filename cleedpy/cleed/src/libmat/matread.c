@@ -22,7 +22,6 @@ GH/09.08.95 - Allocate mat_str for NULL input
 #define ERROR
 */
 
-#define CONTROL
 #define ERROR
 #define EXIT_ON_ERROR
 
@@ -45,7 +44,7 @@ mat matread(mat M, FILE *file)
 
 *********************************************************************/
 {
-int n_el, size;
+int n_el;
 int check;
 int tot_size;
 
@@ -70,8 +69,8 @@ int tot_size;
      M = (mat) malloc( sizeof(struct mat_str) );
    else
    {
-     free(M->rel); M->rel = NULL;
-     free(M->iel); M->iel = NULL;
+     matel_free(M->rel); M->rel = NULL;     /* iel is part of rel */
+     M->iel = NULL;
    }
  }
 
@@ -127,29 +126,19 @@ int tot_size;
  else
  {
 /*
-  Read real parts first (for real and complex matrices)
+  Read matrix elements (complex matrices: real and imaginary parts
+  interleaved, see matwrite)
 */
-   n_el = M->cols * M->rows;
-   size = (n_el+1) * sizeof(real);
+   n_el = M->cols * M->rows * MAT_STRIDE(M);
+   M->rel = matel_alloc(n_el + MAT_STRIDE(M));
 
-   if( (M->rel = (real *) malloc(size)) == NULL)
-   {
-#ifdef ERROR
-     fprintf(STDERR,"*** error (matread): allocation error (reals)\n");
-#endif
-#ifdef EXIT_ON_ERROR
-     exit(1);
-#else
-     return(NULL);
-#endif
-   }
-
-   M->iel = NULL;          /* (for now, will be changed for complex M) */
+   if(M->num_type == NUM_COMPLEX) M->iel = M->rel + 1;
+   else                           M->iel = NULL;
 
-   if( fread(M->rel+1, sizeof(real), n_el, file) != n_el )
+   if( fread(M->rel + MAT_STRIDE(M), sizeof(real), n_el, file) != n_el )
    {
 #ifdef ERROR
- fprintf(STDERR,"*** error (matread): input error while reading reals\n");
+ fprintf(STDERR,"*** error (matread): input error while reading elements\n");
 #endif
 #ifdef EXIT_ON_ERROR
      exit(1);
@@ -158,43 +147,12 @@ int tot_size;
 #endif
    }
    tot_size += n_el * sizeof(real);
-
-/*
-  For complex matrix copy also imag. parts.
-*/
-   if(M->num_type == NUM_COMPLEX)
-   {
-
-     if( (M->iel = (real *) malloc(size)) == NULL)
-     {
-#ifdef ERROR
-       fprintf(STDERR,"*** error (matread): allocation error (imag.)\n");
-#endif
-#ifdef EXIT_ON_ERROR
-       exit(1);
-#else
-       return(NULL);
-#endif
-     }
-
-     if( fread(M->iel+1, sizeof(real), n_el, file) != n_el )
-     {
-#ifdef ERROR
- fprintf(STDERR,"*** error (matread): input error while reading imag. part\n");
-#endif
-#ifdef EXIT_ON_ERROR
-       exit(1);
-#else
-       return(NULL);
-#endif
-     }
-     tot_size += n_el * sizeof(real);
-   } /* NUM_COMPLEX */
  }     /* else */
 
-#ifdef CONTROL
- fprintf(STDCTR,"(matread): %d byte read\n", tot_size);
-#endif
+ if(LOG_ON(LOG_MAT, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(matread): %d byte read\n", tot_size);
+ }
 
  return(M);
 } /* end of function matread */
@@ -90,16 +90,10 @@ real *ptr_r, *ptr_M, *ptr_end;
 
      case(NUM_COMPLEX):
      {
-     /* first real part */
-       for (ptr_M = M->rel + M->cols*(row_num - 1) + 1,
-            ptr_r = row->rel + 1, ptr_end = ptr_M + M->cols;
-            ptr_M <= ptr_end; ptr_r ++, ptr_M ++)
-       { *ptr_r = *ptr_M; }
-
-    /* now imaginary part */
-       for (ptr_M = M->iel + M->cols*(row_num - 1) + 1,
-            ptr_r = row->iel + 1, ptr_end = ptr_M + M->cols;
-            ptr_M <= ptr_end; ptr_r ++, ptr_M ++)
+     /* real and imaginary parts are interleaved */
+       for (ptr_M = M->rel + 2*(M->cols*(row_num - 1) + 1),
+            ptr_r = row->rel + 2, ptr_end = row->iel + 2*M->cols;
+            ptr_r <= ptr_end; ptr_r ++, ptr_M ++)
        { *ptr_r = *ptr_M; }
 
        break;
@@ -123,19 +117,9 @@ real *ptr_r, *ptr_M, *ptr_end;
 
      case(NUM_COMPLEX):
      {
-     /* first real part */
-       for ( ptr_r = row->rel + 1, ptr_end = ptr_r + M->cols;
-             ptr_r <= ptr_end; ptr_r ++)
-       { *ptr_r = 0.; }
-
-       *(row->rel + row_num) = *(M->rel + row_num);
-
-    /* now imaginary part */
-       for ( ptr_r = row->iel + 1, ptr_end = ptr_r + M->cols;
-             ptr_r <= ptr_end; ptr_r ++)
-       { *ptr_r = 0.; }
-
-       *(row->iel + row_num) = *(M->iel + row_num);
+     /* real and imaginary parts are interleaved (row is zero already) */
+       *(row->rel + 2*row_num) = *(M->rel + 2*row_num);
+       *(row->iel + 2*row_num) = *(M->iel + 2*row_num);
 
        break;
      } /* case COMPLEX */
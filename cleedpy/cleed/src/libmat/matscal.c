@@ -90,18 +90,23 @@ mat matscal( mat Mr, mat Mi, real num_r, real num_i )
     else                    /* num is complex */
     {
       register real *ptr_end;
-      register real *ptrr, *ptri;
+      register real *ptrr, *ptri, *ptro;
+      real *rel_old;
 
-      Mr->iel = (real*)calloc( Mr->cols*Mr->rows * 1, sizeof(real));
+      /* convert to a complex matrix (interleaved, see mat_def.h) */
+      rel_old = Mr->rel;
+      Mr->rel = matel_alloc(2*(Mr->cols*Mr->rows + 1));
+      Mr->iel = Mr->rel + 1;
       Mr->num_type = NUM_COMPLEX;
 
-      for( ptrr = Mr->rel + 1, ptri = Mr->iel + 1,
-           ptr_end = Mr->rel + Mr->cols*Mr->rows;
-           ptrr <= ptr_end; ptrr ++, ptri ++)
+      for( ptrr = Mr->rel + 2, ptri = Mr->iel + 2, ptro = rel_old + 1,
+           ptr_end = Mr->rel + 2*Mr->cols*Mr->rows;
+           ptrr <= ptr_end; ptrr += 2, ptri += 2, ptro ++)
       {
-        *ptrr = *ptrr * num_r;   /* real part */
-        *ptri = *ptrr * num_i;   /* imaginary part */
+        *ptrr = *ptro * num_r;   /* real part */
+        *ptri = *ptro * num_i;   /* imaginary part */
       }
+      matel_free(rel_old);
     }
     break;
    }  /* case REAL */
@@ -121,9 +126,9 @@ mat matscal( mat Mr, mat Mi, real num_r, real num_i )
 #ifdef CONTROL
     fprintf(STDCTR," (matscal) entering real loop\n");
 #endif
-    for( ptrr = Mr->rel + 1, ptri = Mr->iel + 1,
-         ptr_end = Mr->rel + Mr->cols*Mr->rows;
-         ptrr <= ptr_end; ptrr ++, ptri ++)
+    for( ptrr = Mr->rel + 2, ptri = Mr->iel + 2,
+         ptr_end = Mr->rel + 2*Mr->cols*Mr->rows;
+         ptrr <= ptr_end; ptrr += 2, ptri += 2)
     {
       faux  = *ptrr * num_r - *ptri * num_i;   /* real part */
       *ptri = *ptrr * num_i + *ptri * num_r;   /* imaginary part */
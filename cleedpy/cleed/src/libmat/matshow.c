@@ -133,7 +133,7 @@ int max_c;
         {
          for (i_c = 1; i_c <= M->cols; i_c ++ )
          {
-           if(i_r == i_c) fprintf(STDOUT,CFORM_2, M->rel[i_r], M->iel[i_r]);
+           if(i_r == i_c) fprintf(STDOUT,CFORM_2, M->rel[2*i_r], M->iel[2*i_r]);
            else           fprintf(STDOUT,C_DIAFORM);
          }
          fprintf(STDOUT,"\n");
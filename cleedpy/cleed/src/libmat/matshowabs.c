@@ -122,7 +122,7 @@ real faux;
         {
          for (i_c = 1; i_c <= maxcol; ++i_c)
          {
-           if(i_r == i_c) fprintf(STDOUT,RFORM, cri_abs(M->rel[i_r], M->iel[i_r]));
+           if(i_r == i_c) fprintf(STDOUT,RFORM, cri_abs(M->rel[2*i_r], M->iel[2*i_r]));
            else           fprintf(STDOUT,R_DIAFORM);
          }
          fprintf(STDOUT,"\n");
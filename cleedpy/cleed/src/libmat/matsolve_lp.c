@@ -0,0 +1,218 @@
+/*********************************************************************
+  file contains function:
+
+  matsolve
+
+    Solve a system of linear equations with several right hand sides
+    by LU decomposition (LAPACK/cblas).
+
+*********************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mat_blas.h"
+#include "mat_lapack.h"
+#include "mat.h"
+
+/*
+#define CONTROL
+*/
+#define ERROR
+
+#define EXIT_ON_ERROR
+
+/********************************************************************/
+
+mat matsolve( mat X, mat A, mat B)
+
+/*********************************************************************
+  Solve A * X = B for X (real or complex).
+
+  parameters:
+  X - output: pointer to the solution. X can be equal to B (but not
+      to A). If NULL, the pointer will be created and returned.
+  A - input: square matrix of coefficients. A is overwritten by its
+      LU factors.
+  B - input: right hand sides (one per column). B may be real if A is
+      complex, as long as X is not equal to B.
+
+  design:
+  This replaces matinv(A_1, A) followed by matmul(X, A_1, B): the LU
+  factorisation and the triangular solves need about a third of the
+  operations of the explicit inverse and the product, and they are
+  more accurate.
+
+  The matrices are stored row by row, i.e. LAPACK sees A^t and X^t.
+  A^t is factorised by Xgetrf (A^t = P*L*U) and
+     X^t * P*L*U = B^t
+  is solved by two triangular solves from the right (Xtrsm), which
+  leaves X^t * P in X. The interchanges of P are finally applied to the
+  rows of X in reverse order.
+
+  return value: X (NULL if failed and EXIT_ON_ERROR is not defined)
+
+*********************************************************************/
+{
+int i, n, n_rhs, info;
+int stride;
+int *ipiv;
+
+real *lapack_a, *lapack_x;
+
+/*********************************************************************
+  check input matrices
+*********************************************************************/
+
+ if ((matcheck(A) < 1) || (matcheck(B) < 1))
+ {
+#ifdef ERROR
+  fprintf(STDERR,"*** error (matsolve): invalid input matrices\n");
+#endif
+#ifdef EXIT_ON_ERROR
+  exit(1);
+#else
+  return(NULL);
+#endif
+ }
+
+ if ( (A->mat_type != MAT_SQUARE) || (A->rows != A->cols) ||
+      (A->cols != B->rows) || (X == A) )
+ {
+#ifdef ERROR
+  fprintf(STDERR,
+  "*** error (matsolve): dimensions of input matrices do not match\n");
+#endif
+#ifdef EXIT_ON_ERROR
+  exit(1);
+#else
+  return(NULL);
+#endif
+ }
+
+ if ( (A->num_type != B->num_type) &&
+      ( (A->num_type != NUM_COMPLEX) || (X == B) ) )
+ {
+#ifdef ERROR
+  fprintf(STDERR,"*** error (matsolve): improper types of input matrices\n");
+#endif
+#ifdef EXIT_ON_ERROR
+  exit(1);
+#else
+  return(NULL);
+#endif
+ }
+
+ n = A->rows;
+ n_rhs = B->cols;
+
+/*********************************************************************
+  Copy the right hand sides into X (converted, if B is real).
+*********************************************************************/
+
+ if (B->num_type == A->num_type)
+   X = matcop(X, B);
+ else
+ {
+   X = matalloc(X, B->rows, B->cols, NUM_COMPLEX);
+   mat2cblas(X->rel + 2, NUM_COMPLEX, B);
+ }
+
+ stride = (A->num_type == NUM_COMPLEX) ? 2 : 1;
+ lapack_a = A->rel + stride;
+ lapack_x = X->rel + stride;
+
+ ipiv = (int *)malloc( n * sizeof(int));
+
+/*********************************************************************
+  Factorise A^t and solve.
+*********************************************************************/
+
+ switch(A->num_type)
+ {
+   case (NUM_REAL):
+   {
+     if ( sizeof(real) == sizeof(float) ) {
+       sgetrf_(&n, &n, (float*)lapack_a, &n, ipiv, &info);
+       info_check("sgetrf", info);
+       cblas_strsm(CblasColMajor, CblasRight, CblasUpper, CblasNoTrans,
+                   CblasNonUnit, n_rhs, n, 1.0, (float*)lapack_a, n,
+                   (float*)lapack_x, n_rhs);
+       cblas_strsm(CblasColMajor, CblasRight, CblasLower, CblasNoTrans,
+                   CblasUnit, n_rhs, n, 1.0, (float*)lapack_a, n,
+                   (float*)lapack_x, n_rhs);
+       for (i = n-1; i >= 0; i--)
+         if (ipiv[i] != i+1)
+           cblas_sswap(n_rhs, (float*)lapack_x + i*n_rhs, 1,
+                       (float*)lapack_x + (ipiv[i]-1)*n_rhs, 1);
+     }
+     else if ( sizeof(real) == sizeof(double) ) {
+       dgetrf_(&n, &n, (double*)lapack_a, &n, ipiv, &info);
+       info_check("dgetrf", info);
+       cblas_dtrsm(CblasColMajor, CblasRight, CblasUpper, CblasNoTrans,
+                   CblasNonUnit, n_rhs, n, 1.0, (double*)lapack_a, n,
+                   (double*)lapack_x, n_rhs);
+       cblas_dtrsm(CblasColMajor, CblasRight, CblasLower, CblasNoTrans,
+                   CblasUnit, n_rhs, n, 1.0, (double*)lapack_a, n,
+                   (double*)lapack_x, n_rhs);
+       for (i = n-1; i >= 0; i--)
+         if (ipiv[i] != i+1)
+           cblas_dswap(n_rhs, (double*)lapack_x + i*n_rhs, 1,
+                       (double*)lapack_x + (ipiv[i]-1)*n_rhs, 1);
+     } else {
+       fprintf(stderr, "matsolve: unexpected sizeof(real)=%lu\n", sizeof(real));
+       exit(1);
+     }
+     break;
+   }  /* REAL */
+
+   case (NUM_COMPLEX):
+   {
+     if ( sizeof(real) == sizeof(float) ) {
+       float alpha[2] = { 1.0, 0.0 } ;
+       cgetrf_(&n, &n, lapack_a, &n, ipiv, &info);
+       info_check("cgetrf", info);
+       cblas_ctrsm(CblasColMajor, CblasRight, CblasUpper, CblasNoTrans,
+                   CblasNonUnit, n_rhs, n, alpha, lapack_a, n,
+                   lapack_x, n_rhs);
+       cblas_ctrsm(CblasColMajor, CblasRight, CblasLower, CblasNoTrans,
+                   CblasUnit, n_rhs, n, alpha, lapack_a, n,
+                   lapack_x, n_rhs);
+       for (i = n-1; i >= 0; i--)
+         if (ipiv[i] != i+1)
+           cblas_cswap(n_rhs, (float*)lapack_x + 2*i*n_rhs, 1,
+                       (float*)lapack_x + 2*(ipiv[i]-1)*n_rhs, 1);
+     }
+     else if ( sizeof(real) == sizeof(double) ) {
+       double alpha[2] = { 1.0, 0.0 } ;
+       zgetrf_(&n, &n, lapack_a, &n, ipiv, &info);
+       info_check("zgetrf", info);
+       cblas_ztrsm(CblasColMajor, CblasRight, CblasUpper, CblasNoTrans,
+                   CblasNonUnit, n_rhs, n, alpha, lapack_a, n,
+                   lapack_x, n_rhs);
+       cblas_ztrsm(CblasColMajor, CblasRight, CblasLower, CblasNoTrans,
+                   CblasUnit, n_rhs, n, alpha, lapack_a, n,
+                   lapack_x, n_rhs);
+       for (i = n-1; i >= 0; i--)
+         if (ipiv[i] != i+1)
+           cblas_zswap(n_rhs, (double*)lapack_x + 2*i*n_rhs, 1,
+                       (double*)lapack_x + 2*(ipiv[i]-1)*n_rhs, 1);
+     } else {
+       fprintf(stderr, "matsolve: unexpected sizeof(real)=%lu\n", sizeof(real));
+       exit(1);
+     }
+     break;
+   }  /* COMPLEX */
+ }  /* switch num_type */
+
+#ifdef CONTROL
+ fprintf(STDCTR, " (matsolve) ipiv: ");
+ for (i=0; i<n; i++) fprintf(STDCTR," %d", ipiv[i]);
+ fprintf(STDCTR,"\n");
+#endif
+
+ free(ipiv);
+ return(X);
+}  /* end of function matsolve */
+/********************************************************************/
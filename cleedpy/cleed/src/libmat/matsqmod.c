@@ -82,10 +82,10 @@ mat Maux;
 
      case(NUM_COMPLEX):
      {
-       for(ptr_r = M->rel+1, ptr_i = M->iel+1, ptr_sq = Maux->rel+1,
-           ptr_end = M->rel + M->cols;
+       for(ptr_r = M->rel+2, ptr_i = M->iel+2, ptr_sq = Maux->rel+1,
+           ptr_end = M->rel + 2*M->cols;
            ptr_r <= ptr_end;
-           ptr_r ++, ptr_i ++, ptr_sq ++)
+           ptr_r += 2, ptr_i += 2, ptr_sq ++)
        {
          *ptr_sq = SQUARE(*ptr_r) + SQUARE(*ptr_i);
        }
@@ -116,10 +116,10 @@ mat Maux;
 
      case(NUM_COMPLEX):
      {
-       for(ptr_r = M->rel+1, ptr_i = M->iel+1, ptr_sq = Maux->rel+1,
-           ptr_end = M->rel + M->cols*M->rows;
+       for(ptr_r = M->rel+2, ptr_i = M->iel+2, ptr_sq = Maux->rel+1,
+           ptr_end = M->rel + 2*M->cols*M->rows;
            ptr_r <= ptr_end;
-           ptr_r ++, ptr_i ++, ptr_sq ++)
+           ptr_r += 2, ptr_i += 2, ptr_sq ++)
        {
          *ptr_sq = SQUARE(*ptr_r) + SQUARE(*ptr_i);
        }
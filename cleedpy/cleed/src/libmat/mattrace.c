@@ -62,14 +62,10 @@ int nn;
     {
       *(tra->rel) = 0.;
       *(tra->iel) = 0.;
-      for (ptr = M->rel + 1, ptr_end = M->rel + nn; ptr <= ptr_end; ptr++ )
-      {
-        *(tra->rel) += *ptr;
-      }
-
-      for (ptr = M->iel + 1, ptr_end = M->iel + nn; ptr <= ptr_end; ptr++ )
+      for (ptr = M->rel + 2, ptr_end = M->rel + 2*nn; ptr <= ptr_end; ptr += 2 )
       {
         *(tra->rel) += *ptr;
+        *(tra->iel) += *(ptr+1);
       }
       break;
     } /* case COMPLEX */
@@ -74,7 +74,8 @@ mat Maux;
  }
  else
  {
-   Maux = matcop(NULL,M);
+   /* a copy of M is only needed if the result overwrites it */
+   Maux = (Mt == M) ? matcop(NULL,M) : M;
    Mt = matalloc(Mt, Maux->cols, Maux->rows, Maux->num_type);
 
    switch(M->num_type)
@@ -98,39 +99,25 @@ mat Maux;
      case(NUM_COMPLEX):
      {
    /*
-     rel
+     real and imaginary parts are interleaved
    */
        ptr_o_end = Maux->rel;
        for(i_r = 1; i_r <= Maux->rows; i_r ++)
        {
-         ptr_o = ptr_o_end + 1;
-         ptr_o_end += Maux->cols;
-         ptr_t = Mt->rel + i_r;
-         for(; ptr_o <= ptr_o_end; ptr_o ++, ptr_t += Mt->cols)
-         {
-           *ptr_t = *ptr_o;
-         }
-       } /* for i_r */
-
-   /*
-     iel
-   */
-       ptr_o_end = Maux->iel;
-       for(i_r = 1; i_r <= Maux->rows; i_r ++)
-       {
-         ptr_o = ptr_o_end + 1;
-         ptr_o_end += Maux->cols;
-         ptr_t = Mt->iel + i_r;
-         for(; ptr_o <= ptr_o_end; ptr_o ++, ptr_t += Mt->cols)
+         ptr_o = ptr_o_end + 2;
+         ptr_o_end += 2*Maux->cols;
+         ptr_t = Mt->rel + 2*i_r;
+         for(; ptr_o <= ptr_o_end; ptr_o += 2, ptr_t += 2*Mt->cols)
          {
            *ptr_t = *ptr_o;
+           *(ptr_t+1) = *(ptr_o+1);
          }
        } /* for i_r */
        break;
      } /* NUM_COMPLEX */
 
    }  /* switch */
-   matfree(Maux);
+   if(Maux != M) matfree(Maux);
    return(Mt);
  } /* else */
 } /* end of function mattrans */
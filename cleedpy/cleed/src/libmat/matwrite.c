@@ -16,7 +16,6 @@ GH/07.08.95 - Creation (copy from matext)
 /*
 #define ERROR
 */
-#define CONTROL
 #define ERROR
 #define EXIT_ON_ERROR
 
@@ -97,13 +96,14 @@ int tot_size;
    tot_size = sizeof(struct mat_str);
 
 /*
-  Write real parts first (for real and complex matrices)
+  Write matrix elements (complex matrices: real and imaginary parts
+  interleaved as in memory)
 */
-   n_el = M->cols * M->rows;
-   if( fwrite(M->rel+1, sizeof(real), n_el, file) != n_el )
+   n_el = M->cols * M->rows * MAT_STRIDE(M);
+   if( fwrite(M->rel + MAT_STRIDE(M), sizeof(real), n_el, file) != n_el )
    {
 #ifdef ERROR
- fprintf(STDERR,"*** error (matwrite): output error while writing reals\n");
+ fprintf(STDERR,"*** error (matwrite): output error while writing elements\n");
 #endif
 #ifdef EXIT_ON_ERROR
      exit(1);
@@ -112,30 +112,12 @@ int tot_size;
 #endif
    }
    tot_size += n_el * sizeof(real);
-
-/*
-  For complex matrix copy also imag. parts.
-*/
-   if(M->num_type == NUM_COMPLEX)
-   {
-     if( fwrite(M->iel+1, sizeof(real), n_el, file) != n_el )
-     {
-#ifdef ERROR
- fprintf(STDERR,"*** error (matwrite): output error while writing imags\n");
-#endif
-#ifdef EXIT_ON_ERROR
-       exit(1);
-#else
-       return(-1);
-#endif
-     }
-     tot_size += n_el * sizeof(real);
-   } /* NUM_COMPLEX */
  }     /* else */
 
-#ifdef CONTROL
- fprintf(STDCTR,"(matwrite): %d bytes written\n", tot_size);
-#endif
+ if(LOG_ON(LOG_MAT, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(matwrite): %d bytes written\n", tot_size);
+ }
 
  return(tot_size);
 } /* end of function matwrite */
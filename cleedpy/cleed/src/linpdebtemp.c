@@ -28,7 +28,6 @@ GH/27.09.00 - bug fix in Debye Waller-Temp input
 #define CONTROL_X
 #define CONTROL
 */
-#define CONTROL
 #define WARNING
 #define ERROR
 
@@ -129,10 +128,11 @@ real faux;                    /* dummy variable */
  calculate dr2
 *********************************************************************/
 
-#ifdef CONTROL
- fprintf(STDCTR, "(inp_debtemp): Debye = %.1f, Mass = %.1f, Temp. = %.1f\n",
-         deb_temp, mass, temp);
-#endif
+ if(LOG_ON(LOG_INP, LOG_CONTROL))
+ {
+   fprintf(STDCTR, "(inp_debtemp): Debye = %.1f, Mass = %.1f, Temp. = %.1f\n",
+           deb_temp, mass, temp);
+ }
 
  faux = temp / deb_temp;
 
@@ -149,10 +149,11 @@ real faux;                    /* dummy variable */
    dr2 = 0.5 * PREF_DEBWAL / (mass * deb_temp) * R_sqrt(0.0625 + faux*faux);
  }
 
-#ifdef CONTROL
- fprintf(STDCTR, "(inp_debtemp): dr2 = %.3f dr1 = %.3f \n",
-         dr2 * BOHR * BOHR, R_sqrt(dr2)*BOHR );
-#endif
+ if(LOG_ON(LOG_INP, LOG_CONTROL))
+ {
+   fprintf(STDCTR, "(inp_debtemp): dr2 = %.3f dr1 = %.3f \n",
+           dr2 * BOHR * BOHR, R_sqrt(dr2)*BOHR );
+ }
 
  return(dr2);
 }  /* end of function inp_debtemp */
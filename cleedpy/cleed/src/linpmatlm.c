@@ -23,7 +23,6 @@ numbers and store in natural order.
 /*
 #define CONTROL
 */
-#define CONTROL
 #define WARNING
 #define ERROR
 
@@ -130,9 +129,10 @@ FILE *inp_stream;
 
  eng = R_sqrt(2* eng);
 
-#ifdef CONTROL
- fprintf(STDCTR, " (inp_mat_lm): l_max_in: %d, eng %f)\n", l_max_in, eng);
-#endif
+    if(LOG_ON(LOG_INP, LOG_CONTROL))
+    {
+      fprintf(STDCTR, " (inp_mat_lm): l_max_in: %d, eng %f)\n", l_max_in, eng);
+    }
 
 
 /**********************************************************************
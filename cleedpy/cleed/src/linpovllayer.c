@@ -28,8 +28,6 @@ Changes:
 #define CONTROL
 #define CONTROL_X
 */
-#define CONTROL
-#define CONTROL_X
 
 #define WARNING
 #define ERROR
@@ -92,11 +90,12 @@ int *no_of_atoms;        /* intermediate storage for number of atoms in layer */
 real faux;
 real vaux[4];
 
-#ifdef CONTROL
- fprintf(STDCTR,
-  "(inp_ovl_layer): entering inp_ovl_layer MIN_DIST= %.3f, n_atoms = %d\n",
-  MIN_DIST*BOHR, par->natoms);
-#endif
+ if(LOG_ON(LOG_INP, LOG_CONTROL))
+ {
+   fprintf(STDCTR,
+    "(inp_ovl_layer): entering inp_ovl_layer MIN_DIST= %.3f, n_atoms = %d\n",
+    MIN_DIST*BOHR, par->natoms);
+ }
 /************************************************************************
   predefine some often used variables
 *************************************************************************/
@@ -138,12 +137,13 @@ real vaux[4];
  for(i_atoms=1; i_atoms<n_atoms; i_atoms++)
  {
 
-#ifdef CONTROL
-   fprintf(STDCTR,"(inp_ovl_layer): pos: %.4f %.4f %.4f dist: %.4f\n",
-   atom_list[i_atoms].pos[1]*BOHR, atom_list[i_atoms].pos[2]*BOHR,
-   atom_list[i_atoms].pos[3]*BOHR,
-   R_fabs(atom_list[i_atoms-1].pos[3]+vaux[3]-atom_list[i_atoms].pos[3])*BOHR);
-#endif
+   if(LOG_ON(LOG_INP, LOG_CONTROL))
+   {
+     fprintf(STDCTR,"(inp_ovl_layer): pos: %.4f %.4f %.4f dist: %.4f\n",
+     atom_list[i_atoms].pos[1]*BOHR, atom_list[i_atoms].pos[2]*BOHR,
+     atom_list[i_atoms].pos[3]*BOHR,
+     R_fabs(atom_list[i_atoms-1].pos[3]+vaux[3]-atom_list[i_atoms].pos[3])*BOHR);
+   }
 
    if( R_fabs(atom_list[i_atoms-1].pos[3]+vaux[3] - atom_list[i_atoms].pos[3])
         > MIN_DIST )
@@ -157,10 +157,11 @@ real vaux[4];
    - set up new origin of the layer (vaux);
    - increase i_layer;
 **********************************************************************/
-#ifdef CONTROL
-     fprintf(STDCTR,"(inp_ovl_layer): new layer, no_of_atoms[%d] = %d\n",
-                     i_layer, no_of_atoms[i_layer]);
-#endif
+     if(LOG_ON(LOG_INP, LOG_CONTROL))
+     {
+       fprintf(STDCTR,"(inp_ovl_layer): new layer, no_of_atoms[%d] = %d\n",
+                       i_layer, no_of_atoms[i_layer]);
+     }
 
 /* set up new inter layer vector (vec) */
      *(vec + 3*i_layer + 1) = 0.;
@@ -209,10 +210,11 @@ real vaux[4];
  - If so, reset vec and atom_list[n_atoms-1].pos.
 **********************************************************************/
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(inp_ovl_layer): no_of_atoms[%d] = %d\n",
-                     i_layer, no_of_atoms[i_layer]);
-#endif
+ if(LOG_ON(LOG_INP, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(inp_ovl_layer): no_of_atoms[%d] = %d\n",
+                       i_layer, no_of_atoms[i_layer]);
+ }
  if(no_of_atoms[i_layer] == 1)
  {
    if(i_layer == 0)
@@ -245,13 +247,14 @@ real vaux[4];
   Make shure that all inter layer vectors are the shortest possible.
 *************************************************************************/
 
-#ifdef CONTROL_X
- for(i=0; i< i_layer; i++)
- fprintf(STDCTR,"(inp_ovl_layer): vec_org: %.4f %.4f %.4f \n",
-                 *(vec+3*i+1) *BOHR,
-                 *(vec+3*i+2) *BOHR,
-                 *(vec+3*i+3) *BOHR);
-#endif
+ if(LOG_ON(LOG_INP, LOG_CONTROL_X))
+ {
+   for(i=0; i< i_layer; i++)
+   fprintf(STDCTR,"(inp_ovl_layer): vec_org: %.4f %.4f %.4f \n",
+                   *(vec+3*i+1) *BOHR,
+                   *(vec+3*i+2) *BOHR,
+                   *(vec+3*i+3) *BOHR);
+ }
 
  for(i=0; i< i_layer; i++)
  {
@@ -271,13 +274,14 @@ real vaux[4];
    } /* for i_c, i_d */
  } /* for i */
 
-#ifdef CONTROL_X
- for(i=0; i< i_layer; i++)
- fprintf(STDCTR,"(inp_ovl_layer): vec_mod: %.4f %.4f %.4f \n",
-                 *(vec+3*i+1) *BOHR,
-                 *(vec+3*i+2) *BOHR,
-                 *(vec+3*i+3) *BOHR);
-#endif
+ if(LOG_ON(LOG_INP, LOG_CONTROL_X))
+ {
+   for(i=0; i< i_layer; i++)
+   fprintf(STDCTR,"(inp_ovl_layer): vec_mod: %.4f %.4f %.4f \n",
+                   *(vec+3*i+1) *BOHR,
+                   *(vec+3*i+2) *BOHR,
+                   *(vec+3*i+3) *BOHR);
+ }
 
 /************************************************************************
   Allocate array "layers" and copy all relevant information from
@@ -289,10 +293,11 @@ real vaux[4];
 
 /* Allocate */
 
-#ifdef CONTROL
- fprintf(STDCTR,"(inp_ovl_layer): overlayer atoms split up into %d layers\n",
-         i_layer);
-#endif
+ if(LOG_ON(LOG_INP, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(inp_ovl_layer): overlayer atoms split up into %d layers\n",
+           i_layer);
+ }
 
  if( (par->layers = (struct layer_str *)
       malloc( i_layer * sizeof(struct layer_str) ) ) == NULL)
@@ -356,11 +361,12 @@ real vaux[4];
    Allocate structure element atoms in layer and copy the appropriate
    entries from list atom_list into par->layers[i].atoms
 */
-#ifdef CONTROL_X
-   fprintf(STDCTR,"(inp_ovl_layer): no_of_atoms[%d] = %d\n", i, no_of_atoms[i]);
-   fprintf(STDCTR,"(inp_ovl_layer): par->layers[%d].natoms = %d\n",
-                  i, par->layers[i].natoms);
-#endif
+   if(LOG_ON(LOG_INP, LOG_CONTROL_X))
+   {
+     fprintf(STDCTR,"(inp_ovl_layer): no_of_atoms[%d] = %d\n", i, no_of_atoms[i]);
+     fprintf(STDCTR,"(inp_ovl_layer): par->layers[%d].natoms = %d\n",
+                    i, par->layers[i].natoms);
+   }
 
    par->layers[i].atoms =
      (struct atom_str *) malloc( no_of_atoms[i] * sizeof(struct atom_str) );
@@ -369,10 +375,11 @@ real vaux[4];
    {
      if(atom_list[i_atoms].layer == i)
      {
-#ifdef CONTROL_X
-       fprintf(STDCTR,"(inp_ovl_layer): i_d = %d, i_atoms = %d\n",
-       i_d, i_atoms);
-#endif
+       if(LOG_ON(LOG_INP, LOG_CONTROL_X))
+       {
+         fprintf(STDCTR,"(inp_ovl_layer): i_d = %d, i_atoms = %d\n",
+         i_d, i_atoms);
+       }
        par->layers[i].atoms[i_d].layer = i;
        par->layers[i].atoms[i_d].type = atom_list[i_atoms].type;
        par->layers[i].atoms[i_d].t_type = atom_list[i_atoms].t_type;
@@ -404,10 +411,11 @@ real vaux[4];
  free(vec);
  free(no_of_atoms);
 
-#ifdef CONTROL
- fprintf(STDCTR,
-  "(inp_ovl_layer): leaving inp_ovl_layer, return value = %d\n", i_layer);
-#endif
+ if(LOG_ON(LOG_INP, LOG_CONTROL))
+ {
+   fprintf(STDCTR,
+    "(inp_ovl_layer): leaving inp_ovl_layer, return value = %d\n", i_layer);
+ }
 
  return(i_layer);
 } /* end of function inp_ovl_layer */
@@ -173,7 +173,8 @@ int inp_phase_nd( char * filename, real * dr, int t_type, struct phs_str **p_phs
             {
                 sscanf(linebuffer + i_str, "%le", phs_shifts->pshift+i_eng*nl+i);
                 while((linebuffer[i_str] == ' ') || (linebuffer[i_str] == '-')) i_str ++;
-                while((linebuffer[i_str] != ' ') && (linebuffer[i_str] != '-')) i_str ++;
+                while((linebuffer[i_str] != ' ') && (linebuffer[i_str] != '-') &&
+                      (linebuffer[i_str] != '\0')) i_str ++;
             }
         }
         else
@@ -183,6 +184,7 @@ int inp_phase_nd( char * filename, real * dr, int t_type, struct phs_str **p_phs
             break;
         }
     }
+    fclose(inp_stream);
     phs_shifts->neng = i_eng;
 
     if(phs_shifts->neng != neng)
@@ -1,8 +1,9 @@
 /*********************************************************************
 GH/29.09.00
   file contains function:
-
-  inp_rdbul
+  inp_rdbul_nd
+  inp_bul_preset
+  inp_bul_setup
 
 Changes:
 
@@ -71,18 +72,15 @@ int inp_rdbul_nd (struct cryst_str **p_bulk_par, struct phs_str **p_phs_shifts,
     int i_c, i_str;
     int i_com;
     int i_atoms;
-    int i_layer;
 
     int *index;
 
-    real faux;                    /* dummy variable */
     real a1[4], a2[4], a3[4];     /* vectors: 1=x, 2=y, 3=z, 0 is not used */
     real vaux[4];                 /* dummy vector */
 
     struct cryst_str *bulk_par;   /* use *bulk_par instead of the pointer
                                     p_bulk_par */
 
-    struct atom_str atom_aux;     /* used for sorting atoms */
     struct atom_str * atoms_rd;   /* this vector of structure atom_str is
                                     used to read and treat the input atomic
                                     properties and will be copied into bulk_par
@@ -97,41 +95,17 @@ int inp_rdbul_nd (struct cryst_str **p_bulk_par, struct phs_str **p_phs_shifts,
     /********************************************************************
      Preset parameters
     - allocate atoms_rd (1 unit)
-    - allocate bulk_par->comments (1 unit)
-    - set m_trans, m_super, m_recip to identity
-    - set ai[j] and bulk_par->b[i] to 0.
-    - set ntypes to zero.
-    - set temperature (bulk_par->temp) to room temperature (DEF_TEMP = 300K);
-    - set symmetry flags to no symmetry.
+    - set ai[j] to 0.
+    - preset bulk_par (inp_bul_preset)
     ********************************************************************/
 
     atoms_rd = (struct atom_str *)malloc(2 * sizeof(struct atom_str) );
     i_atoms = 0;
-
-    bulk_par->m_plane = (real *)malloc( sizeof(real));
-    bulk_par->comments = (char * *)malloc( sizeof(char *));
-    *(bulk_par->comments) = NULL;
     i_com = 0;
 
-    bulk_par->m_trans[1] = bulk_par->m_trans[4] = 1.;
-    bulk_par->m_trans[2] = bulk_par->m_trans[3] = 0.;
-
-    bulk_par->m_super[1] = bulk_par->m_super[4] = 1.;
-    bulk_par->m_super[2] = bulk_par->m_super[3] = 0.;
-
-    bulk_par->m_recip[1] = bulk_par->m_recip[4] = 1.;
-    bulk_par->m_recip[2] = bulk_par->m_recip[3] = 0.;
-
     for(i_c = 0; i_c < 4; i_c ++) a1[i_c] = a2[i_c] = a3[i_c] = 0.;
-    for(i_c = 0; i_c < 5; i_c ++) bulk_par->b[i_c] = 0.;
-
-    bulk_par->temp = DEF_TEMP;
 
-    bulk_par->ntypes = 0;
-
-    bulk_par->n_rot = 1;
-    bulk_par->rot_axis[1] = bulk_par->rot_axis[2] = 0.;
-    bulk_par->n_mir = 0;
+    inp_bul_preset(bulk_par);
 
     /********************************************************************
      Open and Read input file
@@ -142,11 +116,13 @@ int inp_rdbul_nd (struct cryst_str **p_bulk_par, struct phs_str **p_phs_shifts,
         exit(1);
     }
 
-    fprintf(STDCTR,"(inp_rdbul): Reading file \"%s\"\n",filename);
+    if (LOG_ON(LOG_INP, LOG_CONTROL))
+        fprintf(STDCTR,"(inp_rdbul): Reading file \"%s\"\n",filename);
 
     while ( fgets(linebuffer, STRSZ, inp_stream) != NULL)
     {
-        fprintf(STDCTR,">>> %s", linebuffer);
+        if (LOG_ON(LOG_INP, LOG_CONTROL_X))
+            fprintf(STDCTR,">>> %s", linebuffer);
         /* find first non blank character */
         for(i_str = 0;  *(linebuffer+i_str) == ' '; i_str++);
         switch( *(linebuffer+i_str) )
@@ -222,7 +198,7 @@ int inp_rdbul_nd (struct cryst_str **p_bulk_par, struct phs_str **p_phs_shifts,
             case ('c'): case ('C'):
             {
                 bulk_par->comments = ( char * * ) realloc(bulk_par->comments, (i_com+2) * sizeof(char *) );
-                *(bulk_par->comments + i_com) = (char *)calloc(strlen(filename) + strlen(linebuffer) + 2 - i_str, sizeof(char));
+                *(bulk_par->comments + i_com) = (char *)calloc(strlen(filename) + strlen(linebuffer) + 3 - i_str, sizeof(char));
                 *(bulk_par->comments + i_com+1) = NULL;
                 sprintf(*(bulk_par->comments + i_com), "(%s): %s", filename, linebuffer+i_str+2);
                 i_com ++;
@@ -326,7 +302,8 @@ int inp_rdbul_nd (struct cryst_str **p_bulk_par, struct phs_str **p_phs_shifts,
                         if(iaux >= 8) bulk_par->temp = vaux[3];
                         vaux[0] = inp_debtemp(vaux[1] , vaux[2] , bulk_par->temp );
                         vaux[1] = vaux[2] = vaux[3] = R_sqrt(vaux[0]) / SQRT3;
-                        fprintf(STDCTR, "(inp_rdbul): temp = %.1f dr = %.3f\n", bulk_par->temp, vaux[1] * SQRT3*BOHR );
+                        if (LOG_ON(LOG_INP, LOG_CONTROL))
+                            fprintf(STDCTR, "(inp_rdbul): temp = %.1f dr = %.3f\n", bulk_par->temp, vaux[1] * SQRT3*BOHR );
                     }
                     else
                     {
@@ -399,15 +376,187 @@ int inp_rdbul_nd (struct cryst_str **p_bulk_par, struct phs_str **p_phs_shifts,
         } /* switch linebuffer */
     } /* while: read input file */
 
-    close(inp_stream);
+    fclose(inp_stream);
 
     /************************************************************************
         END OF INPUT
+        Process the input (inp_bul_setup).
+    *************************************************************************/
+
+    i_atoms = inp_bul_setup(bulk_par, atoms_rd, i_atoms, a1, a2, a3);
+    free(atoms_rd);
+
+    if (LOG_ON(LOG_INP, LOG_CONTROL))
+    {
+        printf("***********************(inp_rdbul)***********************\n");
+        printf("potentials:\n");
+        printf("\tvr: %7.4f eV  vi: %7.4f eV\n", (bulk_par->vr)*HART, (bulk_par->vi)*HART);
+
+        printf("\nbulk unit cell:\n");
+        printf("\ta1:  (%7.4f  %7.4f  %7.4f) A\n", a1[1]*BOHR, a1[2]*BOHR, a1[3]*BOHR);
+        printf("\ta2:  (%7.4f  %7.4f  %7.4f) A\n", a2[1]*BOHR, a2[2]*BOHR, a2[3]*BOHR);
+        printf("\ta3:  (%7.4f  %7.4f  %7.4f) A\n", a3[1]*BOHR, a3[2]*BOHR, a3[3]*BOHR);
+
+        printf("\n     reciprocal lattice: \n");
+        printf("\ta1*: (%7.4f  %7.4f) A^-1\n", bulk_par->a_1[1]/BOHR, bulk_par->a_1[2]/BOHR);
+        printf("\ta2*: (%7.4f  %7.4f) A^-1\n", bulk_par->a_1[3]/BOHR, bulk_par->a_1[4]/BOHR);
+
+        printf("\nsuperstructure unit cell:\n");
+        printf("\t(%5.2f %5.2f)\tb1:  (%7.4f  %7.4f) A\n", bulk_par->m_super[1], bulk_par->m_super[2], bulk_par->b[1]*BOHR, bulk_par->b[3]*BOHR);
+        printf("\t(%5.2f %5.2f)\tb2:  (%7.4f  %7.4f) A\n", bulk_par->m_super[3], bulk_par->m_super[4], bulk_par->b[2]*BOHR, bulk_par->b[4]*BOHR);
+
+        printf("\n     reciprocal lattice: \n");
+        printf("\t(%5.2f %5.2f)\tb1*: (%7.4f  %7.4f) A^-1\n", bulk_par->m_recip[1], bulk_par->m_recip[2], bulk_par->b_1[1]/BOHR, bulk_par->b_1[2]/BOHR);
+        printf("\t(%5.2f %5.2f)\tb2*: (%7.4f  %7.4f) A^-1\n", bulk_par->m_recip[3], bulk_par->m_recip[4], bulk_par->b_1[3]/BOHR, bulk_par->b_1[4]/BOHR);
+
+        printf("\npositions(bulk):\n");
+
+        for(i=0; i < bulk_par->nlayers; i++)
+        {
+            printf("\n->\tvec: (%7.4f  %7.4f  %7.4f) A\n\n", bulk_par->layers[i].vec_from_last[1]*BOHR, bulk_par->layers[i].vec_from_last[2]*BOHR, bulk_par->layers[i].vec_from_last[3]*BOHR );
+
+            if( bulk_par->layers[i].periodic == 0 )
+                printf("np:");
+            else
+                printf("p: ");
+
+            for( j = 0; j < bulk_par->layers[i].natoms; j ++)
+            {
+                printf("\tpos: (%7.4f  %7.4f  %7.4f) A\tlayer: %d type: %d atom: %d\n",
+                        bulk_par->layers[i].atoms[j].pos[1]*BOHR,
+                        bulk_par->layers[i].atoms[j].pos[2]*BOHR,
+                        bulk_par->layers[i].atoms[j].pos[3]*BOHR,
+                        bulk_par->layers[i].atoms[j].layer,
+                        bulk_par->layers[i].atoms[j].type, j);
+            }
+        }
+
+        printf("\n->\tvec: (%7.4f  %7.4f  %7.4f) A\n\n",
+                bulk_par->layers[bulk_par->nlayers-1].vec_to_next[1]*BOHR,
+                bulk_par->layers[bulk_par->nlayers-1].vec_to_next[2]*BOHR,
+                bulk_par->layers[bulk_par->nlayers-1].vec_to_next[3]*BOHR );
+
+        printf("M_trans:\n");
+        printf("\t%7.4f  %7.4f\n", bulk_par->m_trans[1], bulk_par->m_trans[2]);
+        printf("\t%7.4f  %7.4f\n", bulk_par->m_trans[3], bulk_par->m_trans[4]);
+        printf("comments:\n");
+
+        for( i=0; i<i_com; i++)
+        {
+            printf("\t%s", *(bulk_par->comments + i));
+        }
+
+        fprintf(STDCTR,"phase shifts:\n");
+        fprintf(STDCTR,"\t%d different sets of phase shifts used:\n", bulk_par->ntypes);
+        for(i_c = 0; i_c < bulk_par->ntypes; i_c ++)
+            fprintf(STDCTR,"\t(%d) %s (%d energies, lmax = %d)\tV<dr^2>_T = %.3f A^2\n",
+                    i_c,
+                    (*(p_phs_shifts)+i_c)->input_file,
+                    (*(p_phs_shifts)+i_c)->neng,
+                    (*(p_phs_shifts)+i_c)->lmax,
+                    R_sqrt( (*(p_phs_shifts)+i_c)->dr[0] ) *BOHR);
+
+        printf("***********************(inp_rdbul)***********************\n");
+    }
+
+    /************************************************************************
+     write the structures phs_shifts and bulk_par back.
+    *************************************************************************/
+
+    *p_bulk_par = bulk_par;
+
+    return(1);
+}
+
+
+/********************************************************************/
+
+void inp_bul_preset(struct cryst_str *bulk_par)
+/*********************************************************************
+  Preset the bulk parameters before input
+
+  - allocate bulk_par->comments (1 unit)
+  - set m_trans, m_super, m_recip to identity
+  - set bulk_par->b[i] to 0.
+  - set ntypes to zero.
+  - set temperature (bulk_par->temp) to room temperature (DEF_TEMP = 300K);
+  - set symmetry flags to no symmetry.
+
+  The superstructure matrix read from input must be stored in m_recip,
+  superstructure lattice vectors (if any) in b before calling
+  inp_bul_setup.
+
+*********************************************************************/
+{
+    int i;
+
+    bulk_par->m_plane = (real *)malloc( sizeof(real));
+    bulk_par->comments = (char * *)malloc( sizeof(char *));
+    *(bulk_par->comments) = NULL;
+
+    bulk_par->m_trans[1] = bulk_par->m_trans[4] = 1.;
+    bulk_par->m_trans[2] = bulk_par->m_trans[3] = 0.;
+
+    bulk_par->m_super[1] = bulk_par->m_super[4] = 1.;
+    bulk_par->m_super[2] = bulk_par->m_super[3] = 0.;
+
+    bulk_par->m_recip[1] = bulk_par->m_recip[4] = 1.;
+    bulk_par->m_recip[2] = bulk_par->m_recip[3] = 0.;
+
+    for(i = 0; i < 5; i ++) bulk_par->b[i] = 0.;
+
+    bulk_par->temp = DEF_TEMP;
+
+    bulk_par->ntypes = 0;
+
+    bulk_par->n_rot = 1;
+    bulk_par->rot_axis[1] = bulk_par->rot_axis[2] = 0.;
+    bulk_par->n_mir = 0;
+}
+
+/********************************************************************/
+
+int inp_bul_setup(struct cryst_str *bulk_par, struct atom_str *atoms_rd, int n_atoms, real *a1, real *a2, real *a3)
+/*********************************************************************
+  Process the bulk parameters after input
+
+  INPUT
+
+  bulk_par: preset by inp_bul_preset; vr, vi, ntypes, m_recip
+            (superstructure matrix) and b (if specified) are set.
+  atoms_rd: n_atoms atoms (positions in Bohr); space for n_atoms+1
+            elements is needed. The list is modified.
+  a1, a2, a3: lattice vectors of the bulk unit cell (Bohr, 1=x, 2=y, 3=z);
+              modified to the vectors actually used.
+
+  DESIGN
+
+  - check and store the lattice vectors (a, a_1, m_trans).
+  - superstructure (m_super, m_recip, b, b_1).
+  - move the atoms into the unit cell, sort them and distribute them
+    to layers (inp_bul_layer).
+  - find the minimum interlayer distance dmin.
+
+  RETURN VALUES
+
+    number of bulk atoms used.
+
+*********************************************************************/
+{
+    int i,j, iaux;
+    int i_layer;
+
+    real faux;
+    real vaux[4];
+
+    struct atom_str atom_aux;     /* used for sorting atoms */
+
+    /************************************************************************
         Check the number of bulk atoms. Exit if zero
     *************************************************************************/
-    if(i_atoms < 1)
+    if(n_atoms < 1)
     {
-        fprintf(STDERR, "*** error (inp_rdbul): could not find any bulk atoms (i_atoms = %d)\n", i_atoms);
+        fprintf(STDERR, "*** error (inp_rdbul): could not find any bulk atoms (n_atoms = %d)\n", n_atoms);
         exit(1);
     }
 
@@ -536,10 +685,13 @@ int inp_rdbul_nd (struct cryst_str **p_bulk_par, struct phs_str **p_phs_shifts,
         bulk_par->m_super[2] = bulk_par->m_super[4];
         bulk_par->m_super[4] = faux;
     }
-   fprintf(STDCTR,"M_super: %5.2f %5.2f\n", bulk_par->m_super[1], bulk_par->m_super[2]);
-   fprintf(STDCTR,"         %5.2f %5.2f\n", bulk_par->m_super[3], bulk_par->m_super[4]);
-   fprintf(STDCTR,"b1: %5.2f %5.2f\n", bulk_par->b[1]*BOHR,bulk_par->b[3]*BOHR);
-   fprintf(STDCTR,"b2: %5.2f %5.2f\n", bulk_par->b[2]*BOHR,bulk_par->b[4]*BOHR);
+    if (LOG_ON(LOG_INP, LOG_CONTROL))
+    {
+        fprintf(STDCTR,"M_super: %5.2f %5.2f\n", bulk_par->m_super[1], bulk_par->m_super[2]);
+        fprintf(STDCTR,"         %5.2f %5.2f\n", bulk_par->m_super[3], bulk_par->m_super[4]);
+        fprintf(STDCTR,"b1: %5.2f %5.2f\n", bulk_par->b[1]*BOHR,bulk_par->b[3]*BOHR);
+        fprintf(STDCTR,"b2: %5.2f %5.2f\n", bulk_par->b[2]*BOHR,bulk_par->b[4]*BOHR);
+    }
 
 
     // Area of superstructure unit cell in multiples of the (1x1) unit cell = det(m_super)
@@ -555,9 +707,12 @@ int inp_rdbul_nd (struct cryst_str **p_bulk_par, struct phs_str **p_phs_shifts,
     bulk_par->m_recip[3] = -faux * bulk_par->m_super[2];
     bulk_par->m_recip[4] = +faux * bulk_par->m_super[1];
 
-   fprintf(STDCTR,"M_recip: %5.2f %5.2f\n", bulk_par->m_recip[1], bulk_par->m_recip[2]);
-   fprintf(STDCTR,"         %5.2f %5.2f\n", bulk_par->m_recip[3], bulk_par->m_recip[4]);
-   fprintf(STDCTR,"area_sup: %5.2f\n", bulk_par->rel_area_sup);
+    if (LOG_ON(LOG_INP, LOG_CONTROL))
+    {
+        fprintf(STDCTR,"M_recip: %5.2f %5.2f\n", bulk_par->m_recip[1], bulk_par->m_recip[2]);
+        fprintf(STDCTR,"         %5.2f %5.2f\n", bulk_par->m_recip[3], bulk_par->m_recip[4]);
+        fprintf(STDCTR,"area_sup: %5.2f\n", bulk_par->rel_area_sup);
+    }
 
     /*
         Calculate reciprocal superstructure vectors: b_1 = 2PI * b^-1
@@ -580,7 +735,7 @@ int inp_rdbul_nd (struct cryst_str **p_bulk_par, struct phs_str **p_phs_shifts,
     => subtract the integer surplus from pos.
     *************************************************************************/
 
-    for(i = 0; i < i_atoms; i ++ )
+    for(i = 0; i < n_atoms; i ++ )
     {
         vaux[1] = (atoms_rd[i].pos[1] * bulk_par->a_1[1] + atoms_rd[i].pos[2] * bulk_par->a_1[2]) / (2. * PI);
         vaux[2] = (atoms_rd[i].pos[1] * bulk_par->a_1[3] + atoms_rd[i].pos[2] * bulk_par->a_1[4]) / (2. * PI);
@@ -601,8 +756,8 @@ int inp_rdbul_nd (struct cryst_str **p_bulk_par, struct phs_str **p_phs_shifts,
     }
     // Sort the atoms specified through atoms.pos according to their z coordinates (largest z first).
 
-    for(i=0; i<i_atoms; i++)
-        for(j=i+1; j<i_atoms; j++)
+    for(i=0; i<n_atoms; i++)
+        for(j=i+1; j<n_atoms; j++)
         {
             if( atoms_rd[i].pos[3] < atoms_rd[j].pos[3])
             {
@@ -615,20 +770,20 @@ int inp_rdbul_nd (struct cryst_str **p_bulk_par, struct phs_str **p_phs_shifts,
     /* Check if the z-coordinates of all atoms are within the unit
     cell. Those which are not, will be neglected. */
 
-    for(i=0; i<i_atoms; i++)
+    for(i=0; i<n_atoms; i++)
     {
         if(atoms_rd[i].pos[3] - atoms_rd[0].pos[3] < a3[3])
         {
             fprintf(STDWAR, "* warning (inp_rdbul): Some coordinates of bulk atoms exceede the\n");
             fprintf(STDWAR, "                       bulk unit cell and will not be considered:\n");
-            for(j = i; j < i_atoms; j ++)
-                fprintf(STDWAR," %s \t %7.4f  %7.4f  %7.4f\n", phaseinp, atoms_rd[j].pos[1]*BOHR, atoms_rd[j].pos[2]*BOHR, atoms_rd[j].pos[3]*BOHR);
+            for(j = i; j < n_atoms; j ++)
+                fprintf(STDWAR," type %d \t %7.4f  %7.4f  %7.4f\n", atoms_rd[j].type, atoms_rd[j].pos[1]*BOHR, atoms_rd[j].pos[2]*BOHR, atoms_rd[j].pos[3]*BOHR);
             break;
         }
     }
-    i_atoms = i;
-    atoms_rd[i_atoms].type = I_END_OF_LIST;
-    bulk_par->natoms = i_atoms;
+    n_atoms = i;
+    atoms_rd[n_atoms].type = I_END_OF_LIST;
+    bulk_par->natoms = n_atoms;
 
     /************************************************************************
         - Distribute the atoms to layers.
@@ -636,7 +791,6 @@ int inp_rdbul_nd (struct cryst_str **p_bulk_par, struct phs_str **p_phs_shifts,
     *************************************************************************/
 
     i_layer = inp_bul_layer(bulk_par, atoms_rd, a3);
-    free(atoms_rd);
 
     bulk_par->dmin = R_fabs(bulk_par->layers[0].vec_from_last[3]);
     for(i=0; i < bulk_par->nlayers - 1 /* origin is not relevant */; i++)
@@ -644,82 +798,5 @@ int inp_rdbul_nd (struct cryst_str **p_bulk_par, struct phs_str **p_phs_shifts,
         bulk_par->dmin = MIN(bulk_par->dmin, R_fabs(bulk_par->layers[i].vec_to_next[3]) );
     }
 
-
-    printf("***********************(inp_rdbul)***********************\n");
-    printf("potentials:\n");
-    printf("\tvr: %7.4f eV  vi: %7.4f eV\n", (bulk_par->vr)*HART, (bulk_par->vi)*HART);
-
-    printf("\nbulk unit cell:\n");
-    printf("\ta1:  (%7.4f  %7.4f  %7.4f) A\n", a1[1]*BOHR, a1[2]*BOHR, a1[3]*BOHR);
-    printf("\ta2:  (%7.4f  %7.4f  %7.4f) A\n", a2[1]*BOHR, a2[2]*BOHR, a2[3]*BOHR);
-    printf("\ta3:  (%7.4f  %7.4f  %7.4f) A\n", a3[1]*BOHR, a3[2]*BOHR, a3[3]*BOHR);
-
-    printf("\n     reciprocal lattice: \n");
-    printf("\ta1*: (%7.4f  %7.4f) A^-1\n", bulk_par->a_1[1]/BOHR, bulk_par->a_1[2]/BOHR);
-    printf("\ta2*: (%7.4f  %7.4f) A^-1\n", bulk_par->a_1[3]/BOHR, bulk_par->a_1[4]/BOHR);
-
-    printf("\nsuperstructure unit cell:\n");
-    printf("\t(%5.2f %5.2f)\tb1:  (%7.4f  %7.4f) A\n", bulk_par->m_super[1], bulk_par->m_super[2], bulk_par->b[1]*BOHR, bulk_par->b[3]*BOHR);
-    printf("\t(%5.2f %5.2f)\tb2:  (%7.4f  %7.4f) A\n", bulk_par->m_super[3], bulk_par->m_super[4], bulk_par->b[2]*BOHR, bulk_par->b[4]*BOHR);
-
-    printf("\n     reciprocal lattice: \n");
-    printf("\t(%5.2f %5.2f)\tb1*: (%7.4f  %7.4f) A^-1\n", bulk_par->m_recip[1], bulk_par->m_recip[2], bulk_par->b_1[1]/BOHR, bulk_par->b_1[2]/BOHR);
-    printf("\t(%5.2f %5.2f)\tb2*: (%7.4f  %7.4f) A^-1\n", bulk_par->m_recip[3], bulk_par->m_recip[4], bulk_par->b_1[3]/BOHR, bulk_par->b_1[4]/BOHR);
-
-    printf("\npositions(bulk):\n");
-
-    for(i=0; i < bulk_par->nlayers; i++)
-    {
-        printf("\n->\tvec: (%7.4f  %7.4f  %7.4f) A\n\n", bulk_par->layers[i].vec_from_last[1]*BOHR, bulk_par->layers[i].vec_from_last[2]*BOHR, bulk_par->layers[i].vec_from_last[3]*BOHR );
-
-        if( bulk_par->layers[i].periodic == 0 )
-            printf("np:");
-        else
-            printf("p: ");
-
-        for( j = 0; j < bulk_par->layers[i].natoms; j ++)
-        {
-            printf("\tpos: (%7.4f  %7.4f  %7.4f) A\tlayer: %d type: %d atom: %d\n",
-                    bulk_par->layers[i].atoms[j].pos[1]*BOHR,
-                    bulk_par->layers[i].atoms[j].pos[2]*BOHR,
-                    bulk_par->layers[i].atoms[j].pos[3]*BOHR,
-                    bulk_par->layers[i].atoms[j].layer,
-                    bulk_par->layers[i].atoms[j].type, j);
-        }
-    }
-
-    printf("\n->\tvec: (%7.4f  %7.4f  %7.4f) A\n\n",
-            bulk_par->layers[bulk_par->nlayers-1].vec_to_next[1]*BOHR,
-            bulk_par->layers[bulk_par->nlayers-1].vec_to_next[2]*BOHR,
-            bulk_par->layers[bulk_par->nlayers-1].vec_to_next[3]*BOHR );
-
-    printf("M_trans:\n");
-    printf("\t%7.4f  %7.4f\n", bulk_par->m_trans[1], bulk_par->m_trans[2]);
-    printf("\t%7.4f  %7.4f\n", bulk_par->m_trans[3], bulk_par->m_trans[4]);
-    printf("comments:\n");
-
-    for( i=0; i<i_com; i++)
-    {
-        printf("\t%s", *(bulk_par->comments + i));
-    }
-
-    fprintf(STDCTR,"phase shifts:\n");
-    fprintf(STDCTR,"\t%d different sets of phase shifts used:\n", bulk_par->ntypes);
-    for(i_c = 0; i_c < bulk_par->ntypes; i_c ++)
-        fprintf(STDCTR,"\t(%d) %s (%d energies, lmax = %d)\tV<dr^2>_T = %.3f A^2\n",
-                i_c,
-                (*(p_phs_shifts)+i_c)->input_file,
-                (*(p_phs_shifts)+i_c)->neng,
-                (*(p_phs_shifts)+i_c)->lmax,
-                R_sqrt( (*(p_phs_shifts)+i_c)->dr[0] ) *BOHR);
-
-    printf("***********************(inp_rdbul)***********************\n");
-
-    /************************************************************************
-     write the structures phs_shifts and bulk_par back.
-    *************************************************************************/
-
-    *p_bulk_par = bulk_par;
-
-    return(1);
+    return(n_atoms);
 }
@@ -1,8 +1,9 @@
 /*********************************************************************
 GH/29.09.00
-  file contains function:
+  file contains functions:
 
-  inp_rdovl
+  inp_rdovl_nd
+  inp_ovl_atoms
 
 Changes:
 
@@ -34,7 +35,6 @@ GH/29.09.00 - calculate dr2 for dmt input in function inp_debtemp
 #define CONTROL_X
 #define CONTROL
 */
-#define CONTROL
 
 #define WARNING
 #define ERROR
@@ -49,7 +49,7 @@ GH/29.09.00 - calculate dr2 for dmt input in function inp_debtemp
 
 /********************************************************************/
 
-int inp_rdovl_nd (struct cryst_str **p_over_par, struct phs_str **p_phs_shifts, struct cryst_str *bulk_par, char *filename, char *phase_path, int *n_phase_shifts)
+int inp_rdovl_nd (struct cryst_str **p_over_par, struct phs_str **p_phs_shifts, struct cryst_str *bulk_par, char *filename, char *phase_path, int *n_phase_shifts, struct atom_str **p_atoms)
 /*********************************************************************
   Read all the overlayer parameters that do change during a search
 
@@ -65,6 +65,10 @@ int inp_rdovl_nd (struct cryst_str **p_over_par, struct phs_str **p_phs_shifts,
 
   The atoms are in order of increasing z before they enter inp_ovl_layer.
 
+  If p_atoms is not NULL, the list of overlayer atoms in input order
+  (terminated by type = I_END_OF_LIST) is written to *p_atoms and
+  can later be handed to inp_ovl_atoms again.
+
   RETURN VALUES
 
     1 if ok.
@@ -84,18 +88,15 @@ int i,j, iaux;                /* counter, dummy  variables */
 int i_c, i_str;
 int i_com;
 int i_atoms;
-int i_layer;
 
 int *index;
 
-real faux;                    /* dummy variable */
 real a1[4], a2[4], a3[4];     /* vectors: 1=x, 2=y, 3=z, 0 is not used */
 real vaux[4];                 /* dummy vector */
 
 struct cryst_str *over_par;   /* use *over_par instead of the pointer
                                  p_over_par */
 
-struct atom_str atom_aux;     /* used for sorting atoms */
 struct atom_str *atoms_rd;    /* this vector of structure atom_str is
                                  used to read and treat the input atomic
                                  properties and will be copied into over_par
@@ -151,14 +152,16 @@ struct atom_str *atoms_rd;    /* this vector of structure atom_str is
 #endif
  }
 
-#ifdef CONTROL
- fprintf(STDCTR,"(inp_rdovl): Reading file \"%s\"\n",filename);
-#endif
+ if(LOG_ON(LOG_INP, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(inp_rdovl): Reading file \"%s\"\n",filename);
+ }
  while ( fgets(linebuffer, STRSZ, inp_stream) != NULL)
  {
-#ifdef CONTROL_X
-   fprintf(STDCTR,"(inp_rdovl): %s", linebuffer);
-#endif
+   if(LOG_ON(LOG_INP, LOG_CONTROL_X))
+   {
+     fprintf(STDCTR,"(inp_rdovl): %s", linebuffer);
+   }
    /* find first non blank character */
    for( i_str = 0;  *(linebuffer+i_str) == ' '; i_str ++);
    switch( *(linebuffer+i_str) )
@@ -172,7 +175,7 @@ struct atom_str *atoms_rd;    /* this vector of structure atom_str is
                            over_par->comments, (i_com+2) * sizeof(char *) );
 
        *(over_par->comments + i_com) = (char *)calloc(
-            strlen(filename) + strlen(linebuffer) + 2 - i_str,
+            strlen(filename) + strlen(linebuffer) + 3 - i_str,
             sizeof(char));
        *(over_par->comments + i_com+1) = NULL;
 
@@ -280,10 +283,11 @@ struct atom_str *atoms_rd;    /* this vector of structure atom_str is
              vaux[0] = inp_debtemp(vaux[1] , vaux[2] , bulk_par->temp );
              vaux[1] = vaux[2] = vaux[3] = R_sqrt(vaux[0])/SQRT3;
 
-#ifdef CONTROL_X
-             fprintf(STDCTR, "(inp_rdovl): temp = %.1f dr = %.3f\n",
-             bulk_par->temp, vaux[1] * SQRT3 * BOHR);
-#endif
+             if(LOG_ON(LOG_INP, LOG_CONTROL_X))
+             {
+               fprintf(STDCTR, "(inp_rdovl): temp = %.1f dr = %.3f\n",
+               bulk_par->temp, vaux[1] * SQRT3 * BOHR);
+             }
            }
          else
            {
@@ -372,21 +376,129 @@ struct atom_str *atoms_rd;    /* this vector of structure atom_str is
    } /* switch linebuffer */
  }   /* while: read input file */
 
- close(inp_stream);
+ fclose(inp_stream);
 
 /************************************************************************
   END OF INPUT
 
-  Start processing input data if there were any (i_atoms > 0)
+  Distribute the atoms to layers and find the minimum interlayer
+  distance (inp_ovl_atoms).
 *************************************************************************/
 
-#ifdef CONTROL_X
- fprintf(STDCTR, "(inp_rdovl): start processing: i_atoms = %d\n", i_atoms);
-#endif
  atoms_rd[i_atoms].type = I_END_OF_LIST;
- over_par->natoms = i_atoms;
+ inp_ovl_atoms(over_par, bulk_par, atoms_rd, i_atoms);
+
+ if(p_atoms != NULL) *p_atoms = atoms_rd;
+ else free(atoms_rd);
+
+ if(LOG_ON(LOG_INP, LOG_CONTROL))
+ {
+   printf("***********************(inp_rdovl)***********************\n");
+   printf("\npositions (overlayer):\n");
+
+   printf("\n\tdmin (bulk and overlayer): %.4f\n", over_par->dmin*BOHR);
+
+   for(i=0; i < over_par->nlayers; i++)
+   {
+     printf("\n->\tvec: (%7.4f  %7.4f  %7.4f) A\n\n",
+              over_par->layers[i].vec_from_last[1]*BOHR,
+              over_par->layers[i].vec_from_last[2]*BOHR,
+              over_par->layers[i].vec_from_last[3]*BOHR );
+
+     if( over_par->layers[i].periodic == 0 ) printf("np:");
+     else         printf("p: ");
+
+     for( j = 0; j < over_par->layers[i].natoms; j ++)
+     {
+       printf("\tpos: (%7.4f  %7.4f  %7.4f) A\tlayer: %d type: %d atom: %d\n",
+               over_par->layers[i].atoms[j].pos[1]*BOHR,
+               over_par->layers[i].atoms[j].pos[2]*BOHR,
+               over_par->layers[i].atoms[j].pos[3]*BOHR,
+               over_par->layers[i].atoms[j].layer,
+               over_par->layers[i].atoms[j].type, j);
+     }
+   }
+
+   printf("\n->\tvec: (%7.4f  %7.4f  %7.4f) A\n\n",
+            over_par->layers[over_par->nlayers-1].vec_to_next[1]*BOHR,
+            over_par->layers[over_par->nlayers-1].vec_to_next[2]*BOHR,
+            over_par->layers[over_par->nlayers-1].vec_to_next[3]*BOHR );
+
+   printf("comments:\n");
+
+   for( i=0; i<i_com; i++)
+   {
+     printf("\t%s", *(over_par->comments + i));
+   }
+
+   fprintf(STDCTR,"phase shifts:\n");
+   fprintf(STDCTR,"\t%d different sets of phase shifts used:\n",
+           over_par->ntypes);
+   for(i_c = 0; i_c < over_par->ntypes; i_c ++)
+     fprintf(STDCTR,"\t(%d) %s (%d energies, lmax = %d)\tV<dr^2>_T = %.3f A^2\n",
+             i_c,
+             (*(p_phs_shifts)+i_c)->input_file,
+             (*(p_phs_shifts)+i_c)->neng,
+             (*(p_phs_shifts)+i_c)->lmax,
+             R_sqrt( (*(p_phs_shifts)+i_c)->dr[0] ) *BOHR);
+
+   printf("***********************(inp_rdovl)***********************\n");
+ }
+
+
+/************************************************************************
+ write the structures phs_shifts and over_par back.
+*************************************************************************/
+
+ *p_over_par = over_par;
+
+ return(1);
+}
+
+/*======================================================================*/
+/*======================================================================*/
+
+int inp_ovl_atoms(struct cryst_str *over_par, struct cryst_str *bulk_par,
+                  struct atom_str *atoms, int n_atoms)
+/*********************************************************************
+  Set up the overlayer layers from a list of atoms:
+
+  - move the atoms into the 2-dim superstructure unit cell;
+  - sort them by z and distribute them to layers (inp_ovl_layer);
+  - find the min. interlayer distance of bulk and overlayer.
+
+  The list atoms (n_atoms entries, in input order) is not modified.
+  over_par->layers must not contain a previous layer list (it is
+  overwritten without being freed). bulk_par->dmin must be the min.
+  interlayer distance of the bulk alone, it is replaced by the
+  min. distance of bulk and overlayer.
+
+  RETURN VALUES
 
- if(i_atoms > 0)
+    number of atoms in the overlayer.
+
+*********************************************************************/
+{
+int i,j, iaux;
+int i_layer;
+
+real faux;                    /* dummy variable */
+real vaux[4];                 /* dummy vector */
+
+struct atom_str atom_aux;     /* used for sorting atoms */
+struct atom_str *atoms_rd;    /* working copy of atoms */
+
+
+ if(LOG_ON(LOG_INP, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR, "(inp_ovl_atoms): start processing: n_atoms = %d\n", n_atoms);
+ }
+ atoms_rd = (struct atom_str *)malloc((n_atoms+1) * sizeof(struct atom_str));
+ memcpy(atoms_rd, atoms, n_atoms * sizeof(struct atom_str));
+ atoms_rd[n_atoms].type = I_END_OF_LIST;
+ over_par->natoms = n_atoms;
+
+ if(n_atoms > 0)
  {
 /************************************************************************
  Move all atomic positions specified in atoms.pos into the 2-dim bulk unit
@@ -396,7 +508,7 @@ struct atom_str *atoms_rd;    /* this vector of structure atom_str is
  => subtract the integer surplus from pos.
 *************************************************************************/
 
-   for(i = 0; i < i_atoms; i ++ )
+   for(i = 0; i < n_atoms; i ++ )
    {
      vaux[1] = (atoms_rd[i].pos[1] * bulk_par->b_1[1] +
                 atoms_rd[i].pos[2] * bulk_par->b_1[2]) / (2. * PI);
@@ -423,11 +535,12 @@ struct atom_str *atoms_rd;    /* this vector of structure atom_str is
   coordinates (smallest z first).
 *************************************************************************/
 
-#ifdef CONTROL_X
- fprintf(STDCTR, "(inp_rdovl): sorting \n");
-#endif
-   for(i=0; i<i_atoms; i++)
-     for(j=i+1; j<i_atoms; j++)
+   if(LOG_ON(LOG_INP, LOG_CONTROL_X))
+   {
+     fprintf(STDCTR, "(inp_ovl_atoms): sorting \n");
+   }
+   for(i=0; i<n_atoms; i++)
+     for(j=i+1; j<n_atoms; j++)
      {
        if( atoms_rd[i].pos[3] > atoms_rd[j].pos[3])
        {
@@ -444,7 +557,6 @@ struct atom_str *atoms_rd;    /* this vector of structure atom_str is
 
     i_layer = inp_ovl_layer(over_par, atoms_rd);
 
-  free(atoms_rd);
 
 /*
    Find the minimum interlayer distance in bulk and overlayer.
@@ -458,22 +570,24 @@ struct atom_str *atoms_rd;    /* this vector of structure atom_str is
                   bulk_par->layers[bulk_par->nlayers-1].vec_to_next[3] );
    over_par->dmin = MIN(over_par->dmin, faux);
 
-#ifdef CONTROL
-   fprintf(STDCTR, "(inp_rdovl): bulk - overlayer distance = %5.2f\n",
-                   faux*BOHR);
-#endif
+   if(LOG_ON(LOG_INP, LOG_CONTROL))
+   {
+     fprintf(STDCTR, "(inp_ovl_atoms): bulk - overlayer distance = %5.2f\n",
+                     faux*BOHR);
+   }
 
    for(i=1; i < over_par->nlayers; i++)
    {
-#ifdef CONTROL
-     fprintf(STDCTR, "(inp_rdovl): interlayer distance [%d] = %5.2f\n",
-             i, over_par->layers[i].vec_from_last[3]*BOHR);
-#endif
+     if(LOG_ON(LOG_INP, LOG_CONTROL))
+     {
+       fprintf(STDCTR, "(inp_ovl_atoms): interlayer distance [%d] = %5.2f\n",
+               i, over_par->layers[i].vec_from_last[3]*BOHR);
+     }
      over_par->dmin =
           MIN(over_par->dmin, R_fabs(over_par->layers[i].vec_from_last[3]) );
    }
 
- }    /* if i_atoms > 0 */
+ }    /* if n_atoms > 0 */
  else /* no atoms in overlayer */
  {
    over_par->nlayers = 0;
@@ -489,65 +603,6 @@ struct atom_str *atoms_rd;    /* this vector of structure atom_str is
  bulk_par->ntypes = over_par->ntypes;
  bulk_par->n_rot = over_par->n_rot;
 
-#ifdef CONTROL
- printf("***********************(inp_rdovl)***********************\n");
- printf("\npositions (overlayer):\n");
-
- printf("\n\tdmin (bulk and overlayer): %.4f\n", over_par->dmin*BOHR);
-
- for(i=0; i < over_par->nlayers; i++)
- {
-   printf("\n->\tvec: (%7.4f  %7.4f  %7.4f) A\n\n",
-            over_par->layers[i].vec_from_last[1]*BOHR,
-            over_par->layers[i].vec_from_last[2]*BOHR,
-            over_par->layers[i].vec_from_last[3]*BOHR );
-
-   if( over_par->layers[i].periodic == 0 ) printf("np:");
-   else         printf("p: ");
-
-   for( j = 0; j < over_par->layers[i].natoms; j ++)
-   {
-     printf("\tpos: (%7.4f  %7.4f  %7.4f) A\tlayer: %d type: %d atom: %d\n",
-             over_par->layers[i].atoms[j].pos[1]*BOHR,
-             over_par->layers[i].atoms[j].pos[2]*BOHR,
-             over_par->layers[i].atoms[j].pos[3]*BOHR,
-             over_par->layers[i].atoms[j].layer,
-             over_par->layers[i].atoms[j].type, j);
-   }
- }
-
- printf("\n->\tvec: (%7.4f  %7.4f  %7.4f) A\n\n",
-          over_par->layers[over_par->nlayers-1].vec_to_next[1]*BOHR,
-          over_par->layers[over_par->nlayers-1].vec_to_next[2]*BOHR,
-          over_par->layers[over_par->nlayers-1].vec_to_next[3]*BOHR );
-
- printf("comments:\n");
-
- for( i=0; i<i_com; i++)
- {
-   printf("\t%s", *(over_par->comments + i));
- }
-
- fprintf(STDCTR,"phase shifts:\n");
- fprintf(STDCTR,"\t%d different sets of phase shifts used:\n",
-         over_par->ntypes);
- for(i_c = 0; i_c < over_par->ntypes; i_c ++)
-   fprintf(STDCTR,"\t(%d) %s (%d energies, lmax = %d)\tV<dr^2>_T = %.3f A^2\n",
-           i_c,
-           (*(p_phs_shifts)+i_c)->input_file,
-           (*(p_phs_shifts)+i_c)->neng,
-           (*(p_phs_shifts)+i_c)->lmax,
-           R_sqrt( (*(p_phs_shifts)+i_c)->dr[0] ) *BOHR);
-
- printf("***********************(inp_rdovl)***********************\n");
-#endif
-
-
-/************************************************************************
- write the structures phs_shifts and over_par back.
-*************************************************************************/
-
- *p_over_par = over_par;
-
- return(1);
-}
+ free(atoms_rd);
+ return(n_atoms);
+}  /* end of function inp_ovl_atoms */
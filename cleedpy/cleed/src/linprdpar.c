@@ -3,6 +3,7 @@
   file contains function:
 
   inp_rdpar
+  inp_par_setup
 
 CHANGES:
 
@@ -71,6 +72,14 @@ int inp_rdpar(struct var_str ** p_var_par,
   ef: eng_par->fin = final energy
   es: eng_par->stp = energy step
 
+  gs: var_par->mbg_solver = solution of the giant matrix equations of
+                     composite layers:
+                     0 (MBG_LU, default): LU decomposition;
+                     1 (MBG_GMRES): iterative (GMRES), matrix-free;
+                     2 (MBG_INV): explicit inversion.
+  gt: var_par->mbg_tol = relative residual for MBG_GMRES (default:
+                     MBG_TOLERANCE).
+
   it: var_par->theta = polar angle of incidence (default: 0.).
   ip: var_par->phi   = azimuthal angle of incidence (default: 0.).
   ep: var_par->epsilon = convergence criterion for wave functions (default:
@@ -80,6 +89,12 @@ int inp_rdpar(struct var_str ** p_var_par,
                      from the largest energy according to:
                        l_max = R * k_max
 
+  ls: var_par->lsum  = method for the lattice sums of periodic planes:
+                     0 (LSUM_REAL, default): real space summation;
+                     1 (LSUM_EWALD): Ewald summation;
+                     2 (LSUM_AUTO): Ewald summation for weak damping,
+                     otherwise real space summation.
+
   ve: var_par->vi_exp = exponent for the imag. part of opt. potential.
 
   The other values of the structure var_par are preset as follows:
@@ -96,6 +111,9 @@ int inp_rdpar(struct var_str ** p_var_par,
     real epsilon; ->  (set in inp_rdpar)
     int  l_max;   ->  (set in inp_rdpar)
     mat  p_tl;    ->  NULL
+    int  lsum;    ->  (set in inp_rdpar)
+    int  mbg_solver; -> (set in inp_rdpar)
+    real mbg_tol; ->  (set in inp_rdpar)
 
   Function calls:
 
@@ -105,7 +123,6 @@ struct var_str *var_par;
 struct eng_str *eng_par;
 
 int i_str;                      /* counter variables */
-int i_c;                        /* dummy variables */
 
 real faux;
 
@@ -137,26 +154,16 @@ char linebuffer[STRSZ];         /* input buffer */
 
 /********************************************************************
   Preset elements of var_par
+  (the remaining elements are preset in inp_par_setup)
 ********************************************************************/
 
-/* not to be read in this function: */
-  var_par->eng_r = 0.;
-  var_par->eng_i = 0.;
-  var_par->eng_v = 0.;
-
-  var_par->vi_pre = bulk_par->vi;
   var_par->vi_exp = 0.;
-  var_par->vr     = bulk_par->vr;
-
-  for( i_c = 0; i_c <=3; i_c ++)
-    var_par->k_in[i_c] = 0.;
-
-  var_par->p_tl = NULL;
-
-/* to be read in this function: */
   var_par->theta = var_par->phi = 0.;
   var_par->epsilon = WAVE_TOLERANCE;
   var_par->l_max = 0;
+  var_par->lsum = LSUM_REAL;
+  var_par->mbg_solver = MBG_LU;
+  var_par->mbg_tol = MBG_TOLERANCE;
 
   eng_par->ini = eng_par->fin = 0.;
   eng_par->stp = 4./HART;
@@ -246,6 +253,31 @@ char linebuffer[STRSZ];         /* input buffer */
        break;
      } /* case 'e' */
 
+     case ('g'): case ('G'):
+   /***********************************
+     input of parameters for the
+     giant matrix of composite layers
+   ***********************************/
+     {
+       switch( *(linebuffer+i_str+1) )
+       {
+         case('s'): {
+           sscanf(linebuffer+i_str+3 ,"%d", &(var_par->mbg_solver) );
+           break; }
+
+         case('t'): {
+#ifdef REAL_IS_DOUBLE
+           sscanf(linebuffer+i_str+3 ,"%lf", &(var_par->mbg_tol) );
+#endif
+#ifdef REAL_IS_FLOAT
+           sscanf(linebuffer+i_str+3 ,"%f", &(var_par->mbg_tol) );
+#endif
+           break; }
+       }
+
+       break;
+     } /* case 'g' */
+
      case ('i'): case ('I'):
    /***********************************
      input of angles of incidence
@@ -286,6 +318,9 @@ char linebuffer[STRSZ];         /* input buffer */
          case('m'): {
            sscanf(linebuffer+i_str+3 ,"%d", &(var_par->l_max) );
            break; }
+         case('s'): {
+           sscanf(linebuffer+i_str+3 ,"%d", &(var_par->lsum) );
+           break; }
        }
 
      } /* case 'l' */
@@ -350,13 +385,69 @@ char linebuffer[STRSZ];         /* input buffer */
    }   /* switch linebuffer */
  }     /* while .... */
 
- close(inp_stream);
+ fclose(inp_stream);
 
 /************************************************************************
   END OF INPUT
   Start controlling and processing input data.
 *************************************************************************/
 
+ if(inp_par_setup(var_par, eng_par, bulk_par) < 0) return(-1);
+
+/************************************************************************
+  Write eng_par and var_par back to their pointers and return.
+*************************************************************************/
+
+  *p_eng_par = eng_par;
+  *p_var_par = var_par;
+  return(1);
+}  /* end of function (inp_rdpar) */
+
+/********************************************************************/
+
+int inp_par_setup(struct var_str * var_par,
+                  struct eng_str * eng_par,
+                  struct cryst_str * bulk_par)
+/*********************************************************************
+  Check the input parameters and preset the remaining elements of
+  var_par.
+
+  INPUT:
+
+  struct var_str * var_par - theta, phi, epsilon, l_max and vi_exp
+            must be set.
+  struct eng_str * eng_par - ini, fin and stp must be set.
+  struct cryst_str * bulk_par - bulk crystal parameters (must contain
+            valid values for vr and vi).
+
+  DESIGN:
+
+  The other values of the structure var_par are preset as described
+  for inp_rdpar. l_max <= 0 is replaced by a value calculated from the
+  final energy.
+
+  RETURN VALUES:
+
+   1 if ok.
+  -1 if failed (and EXIT_ON_ERROR is not defined)
+
+*********************************************************************/
+{
+int i_c;
+real faux;
+
+  var_par->eng_r = 0.;
+  var_par->eng_i = 0.;
+  var_par->eng_v = 0.;
+
+  var_par->vi_pre = bulk_par->vi;
+  var_par->vr     = bulk_par->vr;
+
+  for( i_c = 0; i_c <=3; i_c ++)
+    var_par->k_in[i_c] = 0.;
+
+  var_par->p_tl = NULL;
+
 /************************************************************************
   ENERGIES:
   - error message if eng_par->ini <= 0.
@@ -430,10 +521,6 @@ fprintf(STDCTR,
 #endif
  }
 
-/************************************************************************
-  Write eng_par and var_par back to their pointers and return.
-*************************************************************************/
-
 #ifdef CONTROL
    fprintf(STDCTR,"\nparameter structure:\n");
    fprintf(STDCTR,"\tvr:\t%.2f eV,\tvi:\t%.2f eV (pref), (expt: %.2f)\n",
@@ -446,7 +533,5 @@ fprintf(STDCTR,
  "******************************(inp_rdpar)*****************************\n");
 #endif
 
-  *p_eng_par = eng_par;
-  *p_var_par = var_par;
   return(1);
-}  /* end of function (inp_rdpar) */
+}  /* end of function (inp_par_setup) */
@@ -0,0 +1,281 @@
+/*********************************************************************
+  file contains functions:
+
+  inp_strbul_nd
+     Set up the bulk parameters from structures in memory.
+  inp_strpar
+     Set up the energy loop parameters from structures in memory.
+  inp_strovl_nd
+     Set up the overlayer parameters from structures in memory.
+
+  These are the counterparts of inp_rdbul_nd, inp_rdpar and
+  inp_rdovl_nd for callers that hold the input in memory already
+  (e.g. the Python interface) and do not want to write and re-parse
+  an input file. Everything that follows the input itself is done by
+  the same functions as for file input (inp_bul_setup, inp_par_setup,
+  inp_ovl_atoms).
+
+  Input atoms are taken from all layers of the input structure
+  (layers[0 .. nlayers-1], natoms atoms each). Positions are in Bohr,
+  energies in Hartree, angles in radians. The type of an input atom is
+  an index into the list of input phase shifts phs_in (terminated by
+  lmax = I_END_OF_LIST), of which only input_file (full path), dr and
+  t_type are used; the phase shifts themselves are read from the files
+  by inp_phase_nd.
+
+*********************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "leed.h"
+#include "leed_def.h"
+
+#define ERROR
+#define EXIT_ON_ERROR
+
+/*======================================================================*/
+
+static struct atom_str *inp_str_atoms(struct cryst_str *cryst_in,
+                                      struct phs_str *phs_in,
+                                      struct phs_str **p_phs_shifts,
+                                      int *n_phase_shifts,
+                                      int *p_n_atoms, int *p_ntypes)
+/*********************************************************************
+  Collect the atoms of all input layers into one list (space for an
+  additional terminating element) and replace their input types by
+  the index of the phase shifts read through inp_phase_nd.
+*********************************************************************/
+{
+int i_lay, i_atom, i;
+int n_atoms, n_phs;
+int type;
+
+struct atom_str *atoms_rd;
+
+ for(n_phs = 0; phs_in[n_phs].lmax != I_END_OF_LIST; n_phs ++);
+
+ n_atoms = 0;
+ for(i_lay = 0; i_lay < cryst_in->nlayers; i_lay ++)
+   n_atoms += cryst_in->layers[i_lay].natoms;
+
+ atoms_rd = (struct atom_str *)malloc((n_atoms+1) * sizeof(struct atom_str));
+
+ i = 0;
+ for(i_lay = 0; i_lay < cryst_in->nlayers; i_lay ++)
+ {
+   for(i_atom = 0; i_atom < cryst_in->layers[i_lay].natoms; i_atom ++, i ++)
+   {
+     memcpy(atoms_rd+i, cryst_in->layers[i_lay].atoms+i_atom,
+            sizeof(struct atom_str));
+
+     type = atoms_rd[i].type;
+     if( (type < 0) || (type >= n_phs) )
+     {
+#ifdef ERROR
+       fprintf(STDERR,
+         "*** error (inp_str_atoms): atom %d: no phase shifts for type %d\n",
+         i, type);
+#endif
+       free(atoms_rd);
+#ifdef EXIT_ON_ERROR
+       exit(1);
+#else
+       return(NULL);
+#endif
+     }
+
+     atoms_rd[i].t_type = phs_in[type].t_type;
+     atoms_rd[i].type = inp_phase_nd(phs_in[type].input_file, phs_in[type].dr,
+                                     phs_in[type].t_type, p_phs_shifts,
+                                     n_phase_shifts);
+     *p_ntypes = MAX(atoms_rd[i].type+1, *p_ntypes);
+   }
+ }
+ atoms_rd[n_atoms].type = I_END_OF_LIST;
+
+ *p_n_atoms = n_atoms;
+ return(atoms_rd);
+}
+
+/*======================================================================*/
+/*======================================================================*/
+
+int inp_strbul_nd(struct cryst_str **p_bulk_par, struct phs_str **p_phs_shifts,
+                  struct cryst_str *bulk_in, real *a3_in,
+                  struct phs_str *phs_in, int *n_phase_shifts)
+/*********************************************************************
+  Set up the bulk parameters from memory (see inp_rdbul_nd).
+
+  INPUT
+
+  struct cryst_str *bulk_in - input bulk parameters:
+       vr, vi: optical potential (vr < 0, vi > 0);
+       temp: temperature (<= 0: DEF_TEMP);
+       a[1..4]: a1 and a2 (a1x = a[1], a2x = a[2], a1y = a[3], a2y = a[4]);
+       m_super[1..4]: superstructure matrix (m1 = m_super[1,2],
+                      m2 = m_super[3,4]) with respect to a1, a2;
+       b[1..4]: superstructure vectors, if not zero they override
+                m_super (as 'b1', 'b2' in the input file);
+       nlayers, layers: bulk atoms.
+  real *a3_in - 3rd bulk lattice vector (1=x, 2=y, 3=z).
+  struct phs_str *phs_in - input phase shifts (see above).
+
+  RETURN VALUES
+
+    1 if ok.
+   -1 if failed (and EXIT_ON_ERROR is not defined)
+
+*********************************************************************/
+{
+int i, n_atoms;
+
+real a1[4], a2[4], a3[4];
+
+struct cryst_str *bulk_par;
+struct atom_str *atoms_rd;
+
+ if (*p_bulk_par == NULL)
+   *p_bulk_par = (struct cryst_str *)malloc( sizeof(struct cryst_str) );
+ bulk_par = *p_bulk_par;
+
+ inp_bul_preset(bulk_par);
+
+ bulk_par->vr = bulk_in->vr;
+ bulk_par->vi = bulk_in->vi;
+ if(bulk_in->temp > 0.) bulk_par->temp = bulk_in->temp;
+
+ a1[0] = a2[0] = a3[0] = 0.;
+ a1[1] = bulk_in->a[1]; a1[2] = bulk_in->a[3]; a1[3] = 0.;
+ a2[1] = bulk_in->a[2]; a2[2] = bulk_in->a[4]; a2[3] = 0.;
+ for(i = 1; i <= 3; i ++) a3[i] = a3_in[i];
+
+ /* superstructure matrix is stored in m_recip as for file input */
+ for(i = 1; i <= 4; i ++)
+ {
+   bulk_par->m_recip[i] = bulk_in->m_super[i];
+   bulk_par->b[i] = bulk_in->b[i];
+ }
+
+ atoms_rd = inp_str_atoms(bulk_in, phs_in, p_phs_shifts, n_phase_shifts,
+                          &n_atoms, &bulk_par->ntypes);
+ if(atoms_rd == NULL) return(-1);
+
+ inp_bul_setup(bulk_par, atoms_rd, n_atoms, a1, a2, a3);
+ free(atoms_rd);
+
+ return(1);
+}  /* end of function inp_strbul_nd */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int inp_strpar(struct var_str **p_var_par, struct eng_str **p_eng_par,
+               struct cryst_str *bulk_par,
+               struct var_str *var_in, struct eng_str *eng_in)
+/*********************************************************************
+  Set up the energy loop parameters from memory (see inp_rdpar).
+
+  INPUT
+
+  struct cryst_str *bulk_par - bulk parameters (inp_strbul_nd).
+  struct var_str *var_in - theta, phi, epsilon, l_max and vi_exp are used.
+  struct eng_str *eng_in - ini, fin and stp.
+
+  RETURN VALUES
+
+    1 if ok.
+   -1 if failed (and EXIT_ON_ERROR is not defined)
+
+*********************************************************************/
+{
+struct var_str *var_par;
+struct eng_str *eng_par;
+
+ if (*p_var_par == NULL)
+   *p_var_par = (struct var_str *)malloc( sizeof(struct var_str) );
+ var_par = *p_var_par;
+
+ if (*p_eng_par == NULL)
+   *p_eng_par = (struct eng_str *)malloc( sizeof(struct eng_str) );
+ eng_par = *p_eng_par;
+
+ var_par->theta   = var_in->theta;
+ var_par->phi     = var_in->phi;
+ var_par->epsilon = var_in->epsilon;
+ var_par->l_max   = var_in->l_max;
+ var_par->vi_exp  = var_in->vi_exp;
+ var_par->lsum    = var_in->lsum;
+ var_par->mbg_solver = var_in->mbg_solver;
+ var_par->mbg_tol = var_in->mbg_tol;
+
+ eng_par->ini = eng_in->ini;
+ eng_par->fin = eng_in->fin;
+ eng_par->stp = eng_in->stp;
+
+ return(inp_par_setup(var_par, eng_par, bulk_par));
+}  /* end of function inp_strpar */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int inp_strovl_nd(struct cryst_str **p_over_par, struct phs_str **p_phs_shifts,
+                  struct cryst_str *bulk_par, struct cryst_str *over_in,
+                  struct phs_str *phs_in, int *n_phase_shifts,
+                  struct atom_str **p_atoms)
+/*********************************************************************
+  Set up the overlayer parameters from memory (see inp_rdovl_nd).
+
+  INPUT
+
+  struct cryst_str *bulk_par - bulk parameters (inp_strbul_nd).
+  struct cryst_str *over_in - input overlayer parameters:
+       vr: real part of the optical potential (0.: use the bulk value);
+       nlayers, layers: overlayer atoms.
+  struct phs_str *phs_in - input phase shifts (see above).
+
+  If p_atoms is not NULL, the list of overlayer atoms in input order
+  (terminated by type = I_END_OF_LIST) is written to *p_atoms.
+
+  RETURN VALUES
+
+    number of overlayer atoms.
+   -1 if failed (and EXIT_ON_ERROR is not defined)
+
+*********************************************************************/
+{
+int n_atoms;
+
+struct cryst_str *over_par;
+struct atom_str *atoms_rd;
+
+ if (*p_over_par == NULL)
+   *p_over_par = (struct cryst_str *)malloc( sizeof(struct cryst_str) );
+ over_par = *p_over_par;
+ memcpy(over_par, bulk_par, sizeof(struct cryst_str) );
+
+ over_par->layers = NULL;
+
+ over_par->comments = (char * *)malloc( sizeof(char *) );
+ *(over_par->comments) = NULL;
+
+ over_par->temp = DEF_TEMP;
+ over_par->n_rot = bulk_par->n_rot;
+ over_par->rot_axis[1] = bulk_par->rot_axis[1];
+ over_par->rot_axis[2] = bulk_par->rot_axis[2];
+
+ if(over_in->vr != 0.) over_par->vr = over_in->vr;
+
+ atoms_rd = inp_str_atoms(over_in, phs_in, p_phs_shifts, n_phase_shifts,
+                          &n_atoms, &over_par->ntypes);
+ if(atoms_rd == NULL) return(-1);
+
+ inp_ovl_atoms(over_par, bulk_par, atoms_rd, n_atoms);
+
+ if(p_atoms != NULL) *p_atoms = atoms_rd;
+ else free(atoms_rd);
+
+ return(n_atoms);
+}  /* end of function inp_strovl_nd */
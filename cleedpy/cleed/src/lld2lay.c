@@ -33,7 +33,8 @@ Changes:
 /*======================================================================*/
 /*======================================================================*/
 
-int ld_2lay ( mat *p_Tpp_ab, mat *p_Tmm_ab, mat *p_Rpm_ab, mat *p_Rmp_ab,
+int ld_2lay ( struct ctx_str *ctx,
+              mat *p_Tpp_ab, mat *p_Tmm_ab, mat *p_Rpm_ab, mat *p_Rmp_ab,
               mat Tpp_a,  mat Tmm_a,  mat Rpm_a,  mat Rmp_a,
               mat Tpp_b,  mat Tmm_b,  mat Rpm_b,  mat Rmp_b,
               struct beam_str *beams, real *vec_ab )
@@ -45,6 +46,9 @@ int ld_2lay ( mat *p_Tpp_ab, mat *p_Tmm_ab, mat *p_Rpm_ab, mat *p_Rmp_ab,
 
  INPUT:
 
+   struct ctx_str *ctx - (input) calculation context; the temporary
+                  matrices are kept in ctx->ld2lay between calls.
+
    mat *p_Tpp_ab - (output) pointer to transmission matrix (++) of the stack "ab".
    mat *p_Tmm_ab - (output) pointer to transmission matrix (--) of the stack "ab".
    mat *p_Rpm_ab - (output) pointer to reflection matrix (+-) of the stack "ab".
@@ -75,7 +79,7 @@ int ld_2lay ( mat *p_Tpp_ab, mat *p_Tmm_ab, mat *p_Rpm_ab, mat *p_Rmp_ab,
 
    matcop
    matmul
-   matinv
+   matsolve
 
  RETURN VALUES:
 
@@ -88,14 +92,16 @@ int n_beams, nn_beams;                   /* total number of beams */
 real faux_r, faux_i;
 real *ptr_r, *ptr_i, *ptr_end;
 
-static mat Pp = NULL, Pm = NULL, Maux_a = NULL, Maux_b = NULL;
-static mat Tpp_ab = NULL, Tmm_ab = NULL, Rpm_ab = NULL, Rmp_ab = NULL;
+mat Pp, Pm, Maux_a, Maux_b, Maux_c;
+mat Tpp_ab, Tmm_ab, Rpm_ab, Rmp_ab;
 
 
-/*
- Pp = Pm = Maux_a = Maux_b = NULL;
- Tpp_ab = Tmm_ab = Rpm_ab = Rmp_ab = NULL;
-*/
+/* temporary storage is reused from the previous call */
+ Pp = ctx->ld2lay.Pp;         Pm = ctx->ld2lay.Pm;
+ Maux_a = ctx->ld2lay.Maux_a; Maux_b = ctx->ld2lay.Maux_b;
+ Maux_c = ctx->ld2lay.Maux_c;
+ Tpp_ab = ctx->ld2lay.Tpp_ab; Tmm_ab = ctx->ld2lay.Tmm_ab;
+ Rpm_ab = ctx->ld2lay.Rpm_ab; Rmp_ab = ctx->ld2lay.Rmp_ab;
 
 /*************************************************************************
   Check arguments:
@@ -111,8 +117,8 @@ static mat Tpp_ab = NULL, Tmm_ab = NULL, Rpm_ab = NULL, Rmp_ab = NULL;
  n_beams = Tpp_a->cols;
  nn_beams = n_beams * n_beams;
 
- Pp = matalloc(NULL, n_beams, 1, NUM_COMPLEX );
- Pm = matalloc(NULL, n_beams, 1, NUM_COMPLEX );
+ Pp = matalloc(Pp, n_beams, 1, NUM_COMPLEX );
+ Pm = matalloc(Pm, n_beams, 1, NUM_COMPLEX );
 
 #ifdef CONTROL
  fprintf(STDCTR, "(ld_2lay): vec_ab(%.2f %.2f %.2f) = vec_from_last\n",
@@ -132,18 +138,19 @@ static mat Tpp_ab = NULL, Tmm_ab = NULL, Rpm_ab = NULL, Rmp_ab = NULL;
             (beams+k)->k_r[3] * vec_ab[3];
    faux_i = (beams+k)->k_i[3] * vec_ab[3];
 
-   cri_expi(Pp->rel+k+1, Pp->iel+k+1, faux_r, faux_i);
+   cri_expi(Pp->rel+2*(k+1), Pp->iel+2*(k+1), faux_r, faux_i);
 
    faux_r -= 2. * (beams+k)->k_r[3] * vec_ab[3];
 
-   cri_expi(Pm->rel+k+1, Pm->iel+k+1, -faux_r, faux_i);
+   cri_expi(Pm->rel+2*(k+1), Pm->iel+2*(k+1), -faux_r, faux_i);
 
 #ifdef CONTROL
    fprintf(STDCTR," Pp = (%6.3f,%6.3f), Pm = (%6.3f,%6.3f)",
-           Pp->rel[k+1], Pp->iel[k+1], Pm->rel[k+1], Pm->iel[k+1]);
+           Pp->rel[2*(k+1)], Pp->iel[2*(k+1)],
+           Pm->rel[2*(k+1)], Pm->iel[2*(k+1)]);
 
    cri_mul(&faux_r,&faux_i,
-           Pp->rel[k+1],Pp->iel[k+1],Pm->rel[k+1],Pm->iel[k+1]);
+           Pp->rel[2*(k+1)],Pp->iel[2*(k+1)],Pm->rel[2*(k+1)],Pm->iel[2*(k+1)]);
    fprintf(STDCTR,": (%6.3f,%6.3f)\n", faux_r, faux_i);
 #endif
  }
@@ -159,40 +166,37 @@ static mat Tpp_ab = NULL, Tmm_ab = NULL, Rpm_ab = NULL, Rmp_ab = NULL;
  for(k = 1; k <= n_beams; k ++)
  {
 
-   faux_r = *(Pm->rel+k);
-   faux_i = *(Pm->iel+k);
+   faux_r = *(Pm->rel+2*k);
+   faux_i = *(Pm->iel+2*k);
 
-   ptr_end = Maux_a->rel+nn_beams;
-   for (ptr_r = Maux_a->rel+k, ptr_i = Maux_a->iel+k;
-        ptr_r <= ptr_end; ptr_r += n_beams,  ptr_i += n_beams)
+   ptr_end = Maux_a->rel+2*nn_beams;
+   for (ptr_r = Maux_a->rel+2*k, ptr_i = Maux_a->iel+2*k;
+        ptr_r <= ptr_end; ptr_r += 2*n_beams,  ptr_i += 2*n_beams)
      cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
 
-   faux_r = - *(Pp->rel+k);
-   faux_i = - *(Pp->iel+k);
+   faux_r = - *(Pp->rel+2*k);
+   faux_i = - *(Pp->iel+2*k);
 
-   ptr_end = Maux_b->rel+nn_beams;
-   for (ptr_r = Maux_b->rel+k, ptr_i = Maux_b->iel+k;
-        ptr_r <= ptr_end; ptr_r += n_beams,  ptr_i += n_beams)
+   ptr_end = Maux_b->rel+2*nn_beams;
+   for (ptr_r = Maux_b->rel+2*k, ptr_i = Maux_b->iel+2*k;
+        ptr_r <= ptr_end; ptr_r += 2*n_beams,  ptr_i += 2*n_beams)
      cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
 
  }
 
 /*************************************************************************
   (i) Calculate the quantities
-      -(Ra+- P- Rb-+ P+) = Maux_a * Maux_b (-> Tpp_ab)  and
-      -(Rb-+ P+ Ra+- P-) = Maux_b * Maux_a (-> Tmm_ab)
+      -(Ra+- P- Rb-+ P+) = Maux_a * Maux_b  and
+      -(Rb-+ P+ Ra+- P-) = Maux_b * Maux_a (-> Maux_c)
       and add unity.
 
- (ii) Matrix inversion:
-       Tpp_ab = ( I  - (Ra+- P- Rb-+ P+))^(-1)
-       Tmm_ab = ( I  - (Rb-+ P+ Ra+- P-))^(-1)
-
-(iii) Multiply with T++_a or T--_b, respectively and store the matrices in
-      Tpp_ab and Tmm_ab respectively:
+ (ii) Solve the linear equations (LU decomposition of Maux_c, no
+      explicit inverse) with the right hand sides T++_a or T--_b,
+      respectively and store the solutions in Tpp_ab and Tmm_ab:
        Tpp_ab = ( I - (Ra+- P- Rb-+ P+))^(-1) * Ta++
        Tmm_ab = ( I - (Rb-+ P+ Ra+- P-))^(-1) * Tb--
 
- (iv) Prepare Rpm_ab and Rmp_ab:
+(iii) Prepare Rpm_ab and Rmp_ab:
       Rpm_ab ->
          Ra+- P- * ( I - (Rb-+ P+ Ra+- P-))^(-1) * Tb-- = Maux_a * Tmm_ab
       Rmp_ab ->
@@ -200,35 +204,34 @@ static mat Tpp_ab = NULL, Tmm_ab = NULL, Rpm_ab = NULL, Rmp_ab = NULL;
       (the sign will be corrected later on)
 *************************************************************************/
 
-/* (i) */
- Tpp_ab = matmul(Tpp_ab, Maux_a, Maux_b);
- Tmm_ab = matmul(Tmm_ab, Maux_b, Maux_a);
-
- for(k = 1; k <= nn_beams; k+= Maux_b->cols + 1)
- {
-   Tpp_ab->rel[k] += 1.;
-   Tmm_ab->rel[k] += 1.;
- }
+/* (i), (ii) for Tpp_ab */
+ Maux_c = matmul(Maux_c, Maux_a, Maux_b);
+ for(k = 1; k <= nn_beams; k+= Maux_c->cols + 1)
+   Maux_c->rel[2*k] += 1.;
 
 #ifdef CONTROL
  fprintf(STDCTR,
-"(ld_2lay): Tpp_ab = matmul(Tpp_ab, Maux_a, Maux_b)\n");
- matshow(Tpp_ab);
- fprintf(STDCTR,
-"(ld_2lay): Tmm_ab = matmul(Tmm_ab, Maux_b, Maux_a)\n");
- matshow(Tmm_ab);
+"(ld_2lay): I + matmul(Maux_a, Maux_b)\n");
+ matshow(Maux_c);
 #endif
 
-/* (ii) */
- Tpp_ab = matinv(Tpp_ab, Tpp_ab);
- Tmm_ab = matinv(Tmm_ab, Tmm_ab);
+ Tpp_ab = matsolve(Tpp_ab, Maux_c, Tpp_a);
 
-/* (iii) */
- Tpp_ab = matmul(Tpp_ab, Tpp_ab, Tpp_a);
- Tmm_ab = matmul(Tmm_ab, Tmm_ab, Tmm_b);
+/* (i), (ii) for Tmm_ab */
+ Maux_c = matmul(Maux_c, Maux_b, Maux_a);
+ for(k = 1; k <= nn_beams; k+= Maux_c->cols + 1)
+   Maux_c->rel[2*k] += 1.;
 
+#ifdef CONTROL
+ fprintf(STDCTR,
+"(ld_2lay): I + matmul(Maux_b, Maux_a)\n");
+ matshow(Maux_c);
+#endif
+
+ Tmm_ab = matsolve(Tmm_ab, Maux_c, Tmm_b);
 
-/* (iv) */
+
+/* (iii) */
  Rpm_ab = matmul(Rpm_ab, Maux_a, Tmm_ab);
  Rmp_ab = matmul(Rmp_ab, Maux_b, Tpp_ab);
 
@@ -243,20 +246,20 @@ static mat Tpp_ab = NULL, Tmm_ab = NULL, Rpm_ab = NULL, Rmp_ab = NULL;
 
  for(k = 1; k <= n_beams; k ++)
  {
-   faux_r = *(Pm->rel+k);
-   faux_i = *(Pm->iel+k);
+   faux_r = *(Pm->rel+2*k);
+   faux_i = *(Pm->iel+2*k);
 
-   ptr_end=Maux_a->rel+nn_beams;
-   for (ptr_r = Maux_a->rel+k, ptr_i = Maux_a->iel+k;
-        ptr_r <= ptr_end; ptr_r += n_beams, ptr_i += n_beams)
+   ptr_end=Maux_a->rel+2*nn_beams;
+   for (ptr_r = Maux_a->rel+2*k, ptr_i = Maux_a->iel+2*k;
+        ptr_r <= ptr_end; ptr_r += 2*n_beams, ptr_i += 2*n_beams)
      cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
 
-   faux_r = *(Pp->rel+k);
-   faux_i = *(Pp->iel+k);
+   faux_r = *(Pp->rel+2*k);
+   faux_i = *(Pp->iel+2*k);
 
-   ptr_end=Maux_b->rel+nn_beams;
-   for (ptr_r = Maux_b->rel+k, ptr_i = Maux_b->iel+k;
-        ptr_r <= ptr_end;  ptr_r += n_beams, ptr_i += n_beams)
+   ptr_end=Maux_b->rel+2*nn_beams;
+   for (ptr_r = Maux_b->rel+2*k, ptr_i = Maux_b->iel+2*k;
+        ptr_r <= ptr_end;  ptr_r += 2*n_beams, ptr_i += 2*n_beams)
      cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
  }
 
@@ -288,24 +291,14 @@ static mat Tpp_ab = NULL, Tmm_ab = NULL, Rpm_ab = NULL, Rmp_ab = NULL;
 /* (iii) */
 
 /* Rpm_ab: */
- ptr_end = Rpm_ab->rel + nn_beams;
- for(ptr_r = Rpm_ab->rel+1, ptr_i = Rpm_b->rel+1;
-     ptr_r <= ptr_end; ptr_r ++, ptr_i ++)
-   *ptr_r += *ptr_i;
-
- ptr_end = Rpm_ab->iel + nn_beams;
- for(ptr_r = Rpm_ab->iel+1, ptr_i = Rpm_b->iel+1;
+ ptr_end = Rpm_ab->rel + 2*nn_beams + 1;
+ for(ptr_r = Rpm_ab->rel+2, ptr_i = Rpm_b->rel+2;
      ptr_r <= ptr_end; ptr_r ++, ptr_i ++)
    *ptr_r += *ptr_i;
 
 /* Rmp_ab: */
- ptr_end = Rmp_ab->rel + nn_beams;
- for(ptr_r = Rmp_ab->rel+1, ptr_i = Rmp_a->rel+1;
-     ptr_r <= ptr_end; ptr_r ++, ptr_i ++)
-   *ptr_r = *ptr_i - *ptr_r;
-
- ptr_end = Rmp_ab->iel + nn_beams;
- for(ptr_r = Rmp_ab->iel+1, ptr_i = Rmp_a->iel+1;
+ ptr_end = Rmp_ab->rel + 2*nn_beams + 1;
+ for(ptr_r = Rmp_ab->rel+2, ptr_i = Rmp_a->rel+2;
      ptr_r <= ptr_end; ptr_r ++, ptr_i ++)
    *ptr_r = *ptr_i - *ptr_r;
 
@@ -333,6 +326,11 @@ static mat Tpp_ab = NULL, Tmm_ab = NULL, Rpm_ab = NULL, Rmp_ab = NULL;
  matfree(Rpm_ab);
  matfree(Rmp_ab);
 */
+ ctx->ld2lay.Pp = Pp;         ctx->ld2lay.Pm = Pm;
+ ctx->ld2lay.Maux_a = Maux_a; ctx->ld2lay.Maux_b = Maux_b;
+ ctx->ld2lay.Maux_c = Maux_c;
+ ctx->ld2lay.Tpp_ab = Tpp_ab; ctx->ld2lay.Tmm_ab = Tmm_ab;
+ ctx->ld2lay.Rpm_ab = Rpm_ab; ctx->ld2lay.Rmp_ab = Rmp_ab;
 
  return(1);
 }
@@ -123,15 +123,16 @@ mat Res;                           /* result will be copied to Rpm_ab */
             (beams+k)->k_r[3] * vec_ab[3];
    faux_i = (beams+k)->k_i[3] * vec_ab[3];
 
-   cri_expi(Pp->rel+k+1, Pp->iel+k+1, faux_r, faux_i);
+   cri_expi(Pp->rel+2*(k+1), Pp->iel+2*(k+1), faux_r, faux_i);
 
    faux_r -= 2 * (beams+k)->k_r[3] * vec_ab[3];
 
-   cri_expi(Pm->rel+k+1, Pm->iel+k+1, -faux_r, faux_i);
+   cri_expi(Pm->rel+2*(k+1), Pm->iel+2*(k+1), -faux_r, faux_i);
 
 /*
    printf("\tPp = (%6.3f,%6.3f), Pm = (%6.3f,%6.3f)\n",
-           Pp->rel[k+1], Pp->iel[k+1], Pm->rel[k+1], Pm->iel[k+1]);
+           Pp->rel[2*(k+1)], Pp->iel[2*(k+1)],
+           Pm->rel[2*(k+1)], Pm->iel[2*(k+1)]);
 */
  }
 
@@ -145,20 +146,20 @@ mat Res;                           /* result will be copied to Rpm_ab */
 
  for(k = 1; k <= n_beams; k ++)
  {
-   faux_r = *(Pm->rel+k);
-   faux_i = *(Pm->iel+k);
+   faux_r = *(Pm->rel+2*k);
+   faux_i = *(Pm->iel+2*k);
 
-   ptr_end = Maux_a->rel+nn_beams;
-   for (ptr_r = Maux_a->rel+k, ptr_i = Maux_a->iel+k;
-        ptr_r <= ptr_end; ptr_r += n_beams,  ptr_i += n_beams)
+   ptr_end = Maux_a->rel+2*nn_beams;
+   for (ptr_r = Maux_a->rel+2*k, ptr_i = Maux_a->iel+2*k;
+        ptr_r <= ptr_end; ptr_r += 2*n_beams,  ptr_i += 2*n_beams)
      cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
 
-   faux_r = - *(Pp->rel+k);
-   faux_i = - *(Pp->iel+k);
+   faux_r = - *(Pp->rel+2*k);
+   faux_i = - *(Pp->iel+2*k);
 
-   ptr_end = Maux_b->rel+nn_beams;
-   for (ptr_r = Maux_b->rel+k, ptr_i = Maux_b->iel+k;
-        ptr_r <= ptr_end; ptr_r += n_beams,  ptr_i += n_beams)
+   ptr_end = Maux_b->rel+2*nn_beams;
+   for (ptr_r = Maux_b->rel+2*k, ptr_i = Maux_b->iel+2*k;
+        ptr_r <= ptr_end; ptr_r += 2*n_beams,  ptr_i += 2*n_beams)
      cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
  }
 
@@ -167,15 +168,14 @@ mat Res;                           /* result will be copied to Rpm_ab */
       -(Rb-+ P+ Ra+- P-) = Maux_b * Maux_a (-> Maux_b)
       and add unity.
 
- (ii) Matrix inversion:
-       Maux_b = ( I  - (Rb-+ P+ Ra+- P-))^(-1)
+ (ii) Solve the linear equations with the right hand side T--_b
+      (LU decomposition of Maux_b, no explicit inverse) and store the
+      solution in Res:
+       Res = ( I - (Rb-+ P+ Ra+- P-))^(-1) * Tb--
 
-(iii) Multiply with T--_b and store the result in Maux_b:
-       Maux_b = ( I - (Rb-+ P+ Ra+- P-))^(-1) * Tb--
-
- (iv) Prepare Res:
+(iii) Prepare Res:
       Res ->
-         Ra+- P- * ( I - (Rb-+ P+ Ra+- P-))^(-1) * Tb-- = Maux_a * Maux_b
+         Ra+- P- * ( I - (Rb-+ P+ Ra+- P-))^(-1) * Tb-- = Maux_a * Res
 *************************************************************************/
 
 /* (i) */
@@ -183,17 +183,14 @@ mat Res;                           /* result will be copied to Rpm_ab */
 
  for(k = 1; k <= nn_beams; k+= Maux_b->cols + 1)
  {
-   Maux_b->rel[k] += 1.;
+   Maux_b->rel[2*k] += 1.;
  }
 
 /* (ii) */
- Maux_b = matinv(Maux_b, Maux_b);
+ Res = matsolve(Res, Maux_b, Tmm_b);
 
 /* (iii) */
- Maux_b = matmul(Maux_b, Maux_b, Tmm_b);
-
-/* (iv) */
- Res = matmul(Res, Maux_a, Maux_b);
+ Res = matmul(Res, Maux_a, Res);
 
 /*************************************************************************
   Prepare Maux_b = (Tb++ P+):
@@ -205,12 +202,12 @@ mat Res;                           /* result will be copied to Rpm_ab */
 
  for(k = 1; k <= n_beams; k ++)
  {
-   faux_r = *(Pp->rel+k);
-   faux_i = *(Pp->iel+k);
+   faux_r = *(Pp->rel+2*k);
+   faux_i = *(Pp->iel+2*k);
 
-   ptr_end=Maux_b->rel+nn_beams;
-   for (ptr_r = Maux_b->rel+k, ptr_i = Maux_b->iel+k;
-        ptr_r <= ptr_end;  ptr_r += n_beams, ptr_i += n_beams)
+   ptr_end=Maux_b->rel+2*nn_beams;
+   for (ptr_r = Maux_b->rel+2*k, ptr_i = Maux_b->iel+2*k;
+        ptr_r <= ptr_end;  ptr_r += 2*n_beams, ptr_i += 2*n_beams)
      cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
  }
 
@@ -227,13 +224,8 @@ mat Res;                           /* result will be copied to Rpm_ab */
  Res = matmul(Res, Maux_b, Res);
 
 /* (ii) */
- ptr_end = Res->rel + nn_beams;
- for(ptr_r = Res->rel+1, ptr_i = Rpm_b->rel+1;
-     ptr_r <= ptr_end; ptr_r ++, ptr_i ++)
-   *ptr_r += *ptr_i;
-
- ptr_end = Res->iel + nn_beams;
- for(ptr_r = Res->iel+1, ptr_i = Rpm_b->iel+1;
+ ptr_end = Res->rel + 2*nn_beams + 1;
+ for(ptr_r = Res->rel+2, ptr_i = Rpm_b->rel+2;
      ptr_r <= ptr_end; ptr_r ++, ptr_i ++)
    *ptr_r += *ptr_i;
 
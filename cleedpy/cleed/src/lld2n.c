@@ -27,8 +27,6 @@
 #define CONTROL
 #define WARNING
 */
-#define CONTROL_X
-#define CONTROL
 #define ERROR
 #define EXIT_ON_ERROR
 
@@ -39,7 +37,8 @@
 /*======================================================================*/
 /*======================================================================*/
 
-mat ld_2n (   mat Rpm,
+mat ld_2n (   struct ctx_str *ctx,
+              mat Rpm,
               mat Tpp_a,  mat Tmm_a,  mat Rpm_a,  mat Rmp_a,
               struct beam_str *beams, real *vec_aa )
 
@@ -50,6 +49,8 @@ mat ld_2n (   mat Rpm,
 
  INPUT:
 
+   struct ctx_str *ctx - (input) calculation context passed to ld_2lay.
+
    mat Rmp   - (output) reflection matrix (-+) of the stack "aaaa...".
 
    mat Tpp_a - (input) transmission matrix (++) of the layer "a".
@@ -90,13 +91,16 @@ mat ld_2n (   mat Rpm,
 {
 int k;
 int i_layer, nn_beams;                   /* total number of beams */
+long n_iter;
 
 real abs_new;
+double t_start;
 real *ptr_r, *ptr_i, *ptr_end;
 
 mat Tpp, Tmm, Rmp;
 
  Tpp = Tmm = Rmp = NULL;
+ t_start = prof_time(ctx->prof);
 
 /*************************************************************************
   Check arguments and copy to internal variables:
@@ -110,37 +114,40 @@ mat Tpp, Tmm, Rmp;
 
  abs_new = matabs(Tpp);
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(ld_2n):vec between periodic stacks(%.3f %.3f %.3f)\n",
-         vec_aa[1] * BOHR,vec_aa[2] * BOHR,vec_aa[3] * BOHR);
-#endif
+ if(LOG_ON(LOG_LD, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(ld_2n):vec between periodic stacks(%.3f %.3f %.3f)\n",
+           vec_aa[1] * BOHR,vec_aa[2] * BOHR,vec_aa[3] * BOHR);
+ }
 
- for (i_layer = 1; abs_new >  LD_TOLERANCE; i_layer *= 2)
+ for (i_layer = 1, n_iter = 0; abs_new >  LD_TOLERANCE; i_layer *= 2, n_iter ++)
      /*
        Tpp^2 (= abs_new^2) is approx. contribution to reflection matrix
        of electrons backscattered from the last layer.
      */
  {
-   ld_2lay( &Tpp, &Tmm, &Rpm, &Rmp,
+   ld_2lay( ctx, &Tpp, &Tmm, &Rpm, &Rmp,
             Tpp, Tmm, Rpm, Rmp, Tpp, Tmm, Rpm, Rmp,
             beams, vec_aa);
 
    abs_new = matabs(Tpp)/(Tpp->cols*Tpp->rows);
 
-#ifdef CONTROL_X
-   fprintf(STDCTR,
-     "(ld_2n): No. of layers (i_layer) = %3d, abs_new = %.1e, tol = %.1e\n",
-     i_layer, abs_new, LD_TOLERANCE);
-#endif
+   if(LOG_ON(LOG_LD, LOG_CONTROL_X))
+   {
+     fprintf(STDCTR,
+       "(ld_2n): No. of layers (i_layer) = %3d, abs_new = %.1e, tol = %.1e\n",
+       i_layer, abs_new, LD_TOLERANCE);
+   }
  }
 
-#ifdef CONTROL
+ if(LOG_ON(LOG_LD, LOG_CONTROL))
+ {
    fprintf(STDCTR,
            "\n(ld_2n): No. of layers included in final iteration: %d;\n",
            i_layer);
    fprintf(STDCTR,"         modulus of transmission matrix: %.0e (tol: %.0e)\n",
            abs_new, LD_TOLERANCE);
-#endif
+ }
 
 /*
  matshowabs(Rpm);
@@ -150,6 +157,7 @@ mat Tpp, Tmm, Rmp;
  matfree(Tmm);
  matfree(Rmp);
 
+ prof_add(ctx->prof, PROF_BULK, t_start, n_iter);
  return(Rpm);
 }
 
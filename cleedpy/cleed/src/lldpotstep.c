@@ -116,11 +116,11 @@ mat Res;                           /* result will be copied to Rpm_ab */
             (beams+k)->k_r[3] * vec_ab[3];
    faux_i = (beams+k)->k_i[3] * vec_ab[3];
 
-   cri_expi(Pp->rel+k+1, Pp->iel+k+1, faux_r, faux_i);
+   cri_expi(Pp->rel+2*(k+1), Pp->iel+2*(k+1), faux_r, faux_i);
 
    faux_r -= 2 * (beams+k)->k_r[3] * vec_ab[3];
 
-   cri_expi(Pm->rel+k+1, Pm->iel+k+1, -faux_r, faux_i);
+   cri_expi(Pm->rel+2*(k+1), Pm->iel+2*(k+1), -faux_r, faux_i);
 
  }
 /*************************************************************************
@@ -133,13 +133,13 @@ mat Res;                           /* result will be copied to Rpm_ab */
    faux_r = 2*eng_vac - SQUARE((beams+k)->k_par);
    if (faux_r >= 0.)
    {
-     kv->rel[k+1] = sqrt(faux_r);
-     kv->iel[k+1] = 0.;
+     kv->rel[2*(k+1)] = sqrt(faux_r);
+     kv->iel[2*(k+1)] = 0.;
    }
    else
    {
-     kv->rel[k+1] = 0.;
-     kv->iel[k+1] = sqrt(-faux_r);
+     kv->rel[2*(k+1)] = 0.;
+     kv->iel[2*(k+1)] = sqrt(-faux_r);
    }
  }
 
@@ -152,12 +152,12 @@ mat Res;                           /* result will be copied to Rpm_ab */
 
  for(k = 1; k <= n_beams; k ++)
  {
-   faux_r = *(Pm->rel+k);
-   faux_i = *(Pm->iel+k);
+   faux_r = *(Pm->rel+2*k);
+   faux_i = *(Pm->iel+2*k);
 
-   ptr_end = Maux_a->rel+nn_beams;
-   for (ptr_r = Maux_a->rel+k, ptr_i = Maux_a->iel+k;
-        ptr_r <= ptr_end; ptr_r += n_beams,  ptr_i += n_beams)
+   ptr_end = Maux_a->rel+2*nn_beams;
+   for (ptr_r = Maux_a->rel+2*k, ptr_i = Maux_a->iel+2*k;
+        ptr_r <= ptr_end; ptr_r += 2*n_beams,  ptr_i += 2*n_beams)
      cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
  }
 
@@ -173,30 +173,33 @@ mat Res;                           /* result will be copied to Rpm_ab */
  for(k = 1; k <= n_beams; k ++)
  {
    cri_div(&faux_r, &faux_i,
-         (beams+k-1)->k_r[3] - kv->rel[k], (beams+k-1)->k_i[3] - kv->iel[k],
-         (beams+k-1)->k_r[3] + kv->rel[k], (beams+k-1)->k_i[3] + kv->iel[k]);
-   cri_mul(&faux_r, &faux_i, Pp->rel[k], Pp->iel[k], faux_r, faux_i);
-
-   ptr_end = Maux_b->rel + k*Maux_b->cols;
-   for (ptr_r = Maux_b->rel + (k-1)*Maux_b->cols + 1,
-        ptr_i = Maux_b->iel + (k-1)*Maux_b->cols + 1;
-        ptr_r <= ptr_end; ptr_r ++,  ptr_i ++)
+         (beams+k-1)->k_r[3] - kv->rel[2*k],
+         (beams+k-1)->k_i[3] - kv->iel[2*k],
+         (beams+k-1)->k_r[3] + kv->rel[2*k],
+         (beams+k-1)->k_i[3] + kv->iel[2*k]);
+   cri_mul(&faux_r, &faux_i, Pp->rel[2*k], Pp->iel[2*k], faux_r, faux_i);
+
+   ptr_end = Maux_b->rel + 2*k*Maux_b->cols;
+   for (ptr_r = Maux_b->rel + 2*(k-1)*Maux_b->cols + 2,
+        ptr_i = Maux_b->iel + 2*(k-1)*Maux_b->cols + 2;
+        ptr_r <= ptr_end; ptr_r += 2,  ptr_i += 2)
      cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
  }
 
 /* add unity */
  for(k = 1; k <= nn_beams; k+= Maux_b->cols + 1)
  {
-   Maux_b->rel[k] += 1.;
+   Maux_b->rel[2*k] += 1.;
  }
 
 /*************************************************************************
-  (i) Matrix inversion:
-       Maux_b = ( I  - (Rb-+ P+ Ra+- P-))^(-1)
+  (i) Set up the right hand side (T--(00), 0, ..., 0) in Res, since only
+      the first column of Tb-- is nonzero.
+      (First allocate Res)
 
- (ii) Multiply the first row with T--(00) and store the result in Res:
+ (ii) Solve the linear equations (LU decomposition of Maux_b, no
+      explicit inverse) and store the solution in Res:
        Res = ( I - (Rb-+ P+ Ra+- P-))^(-1)k1 * Tb--(00)
-      (First allocate Res)
 
 (iii) Prepare Res:
        Res ->
@@ -204,21 +207,18 @@ mat Res;                           /* result will be copied to Rpm_ab */
 *************************************************************************/
 
 /* (i) */
- Maux_b = matinv(Maux_b, Maux_b);
-
-/* (ii) */
 
 /* T-(00) = 2*kv / (kv + kc) */
  cri_div(&faux_r, &faux_i,
-         2*kv->rel[1], 2*kv->iel[1],
-         beams->k_r[3] + kv->rel[1], beams->k_i[3] + kv->iel[1]);
+         2*kv->rel[2], 2*kv->iel[2],
+         beams->k_r[3] + kv->rel[2], beams->k_i[3] + kv->iel[2]);
 
-/* Multiply first column with T-(00) */
- Res = matcol(Res, Maux_b, 1);
- for(k = 1; k <= n_beams; k ++)
- {
-   cri_mul(Res->rel+k, Res->iel+k, Res->rel[k], Res->iel[k], faux_r, faux_i);
- }
+ Res = matalloc(Res, n_beams, 1, NUM_COMPLEX);
+ Res->rel[2] = faux_r;
+ Res->iel[2] = faux_i;
+
+/* (ii) */
+ Res = matsolve(Res, Maux_b, Res);
 
 /* (iii) */
  Res = matmul(Res, Maux_a, Res);
@@ -237,20 +237,22 @@ mat Res;                           /* result will be copied to Rpm_ab */
  {
    cri_div(&faux_r, &faux_i,
          2*((beams+k-1)->k_r[3]), 2*((beams+k-1)->k_i[3]),
-         (beams+k-1)->k_r[3] + kv->rel[k], (beams+k-1)->k_i[3] + kv->iel[k]);
-   cri_mul(&faux_r, &faux_i, Pp->rel[k], Pp->iel[k], faux_r, faux_i);
+         (beams+k-1)->k_r[3] + kv->rel[2*k],
+         (beams+k-1)->k_i[3] + kv->iel[2*k]);
+   cri_mul(&faux_r, &faux_i, Pp->rel[2*k], Pp->iel[2*k], faux_r, faux_i);
 
-   cri_mul(Res->rel+k, Res->iel+k, Res->rel[k], Res->iel[k], faux_r, faux_i);
+   cri_mul(Res->rel+2*k, Res->iel+2*k,
+           Res->rel[2*k], Res->iel[2*k], faux_r, faux_i);
  }
 
 /* (ii) */
 
  cri_div(&faux_r, &faux_i,
-      - beams->k_r[3] + kv->rel[1], - beams->k_i[3] + kv->iel[1],
-      beams->k_r[3] + kv->rel[1], beams->k_i[3] + kv->iel[1]);
+      - beams->k_r[3] + kv->rel[2], - beams->k_i[3] + kv->iel[2],
+      beams->k_r[3] + kv->rel[2], beams->k_i[3] + kv->iel[2]);
 
- Res->rel[1] += faux_r;
- Res->iel[1] += faux_i;
+ Res->rel[2] += faux_r;
+ Res->iel[2] += faux_i;
 
 /*************************************************************************
  - Write the result to the output pointer
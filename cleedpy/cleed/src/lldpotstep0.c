@@ -117,7 +117,7 @@ mat Maux;                          /* temp. storage space */
             ((beams+k-1)->k_r[3] + beams->k_r[3]) * vec_ab[3];
    faux_i = ((beams+k-1)->k_i[3] + beams->k_i[3]) * vec_ab[3];
 
-   cri_expi(Maux->rel+k, Maux->iel+k, faux_r, faux_i);
+   cri_expi(Maux->rel+2*k, Maux->iel+2*k, faux_r, faux_i);
 
 /* sqrt(cos(out)/cos(in)): */
    faux_r = 2 * eng_vac -
@@ -125,10 +125,11 @@ mat Maux;                          /* temp. storage space */
    faux_i = 2 * eng_vac - SQUARE(beams->k_r[1]) - SQUARE(beams->k_r[2]);
    faux_r = R_sqrt(faux_r/faux_i);
    faux_r = R_sqrt(faux_r);
-   cri_mul(Maux->rel+k, Maux->iel+k, faux_r, 0., Maux->rel[k], Maux->iel[k]);
+   cri_mul(Maux->rel+2*k, Maux->iel+2*k,
+           faux_r, 0., Maux->rel[2*k], Maux->iel[2*k]);
 
-   cri_mul(Maux->rel+k, Maux->iel+k,
-           Rpm_a->rel[l], Rpm_a->iel[l], Maux->rel[k], Maux->iel[k]);
+   cri_mul(Maux->rel+2*k, Maux->iel+2*k,
+           Rpm_a->rel[2*l], Rpm_a->iel[2*l], Maux->rel[2*k], Maux->iel[2*k]);
 
  }
 
@@ -0,0 +1,300 @@
+/*********************************************************************
+  file contains functions:
+
+  lmc_alloc
+     Create a cache for layer scattering matrices of an energy list.
+  lmc_free
+     Free the cache and all matrices stored in it.
+  lmc_get
+     Retrieve the scattering matrices of a layer from the cache.
+  lmc_put
+     Store the scattering matrices of a layer in the cache.
+  lsc_alloc
+     Create a cache for partial overlayer stacks of an energy list.
+  lsc_free
+     Free the stack cache and all matrices stored in it.
+  lsc_get
+     Find the largest partial stack that is still valid.
+  lsc_put
+     Store the reflection matrix of a partial stack.
+
+*********************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "leed.h"
+
+/*======================================================================*/
+/*======================================================================*/
+
+struct lmc_str *lmc_alloc(int n_eng, int n_max)
+
+/************************************************************************
+
+ Create a cache for the layer scattering matrices of n_eng energies
+ with room for n_max layers per energy.
+
+ RETURN VALUES:
+
+   pointer to the new cache.
+
+*************************************************************************/
+{
+struct lmc_str *lmc;
+
+ lmc = (struct lmc_str *) calloc(1, sizeof(struct lmc_str));
+ lmc->n_eng = n_eng;
+ lmc->n_max = n_max;
+ lmc->clock = (unsigned long long *) calloc(n_eng, sizeof(unsigned long long));
+ lmc->entry = (struct lmc_entry_str *)
+              calloc(n_eng * n_max, sizeof(struct lmc_entry_str));
+
+ return(lmc);
+}  /* end of function lmc_alloc */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int lmc_free(struct lmc_str *lmc)
+{
+int i;
+struct lmc_entry_str *entry;
+
+ if(lmc == NULL) return(0);
+
+ for(i = 0; i < lmc->n_eng * lmc->n_max; i ++)
+ {
+   entry = lmc->entry + i;
+   if(entry->Tpp != NULL) matfree(entry->Tpp);
+   if(entry->Tmm != NULL) matfree(entry->Tmm);
+   if(entry->Rpm != NULL) matfree(entry->Rpm);
+   if(entry->Rmp != NULL) matfree(entry->Rmp);
+ }
+
+ free(lmc->clock);
+ free(lmc->entry);
+ free(lmc);
+ return(1);
+}  /* end of function lmc_free */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int lmc_get(struct lmc_str *lmc, int i_eng, real eng,
+            unsigned long long key, unsigned long long beam_key,
+            mat *p_Tpp, mat *p_Tmm, mat *p_Rpm, mat *p_Rmp)
+
+/************************************************************************
+
+ Look up the scattering matrices of a layer with content key (see
+ rbc_layer_key) for energy i_eng and beam list beam_key.
+
+ DESIGN:
+
+   The matrices are not copied: *p_Tpp etc. point to the matrices in
+   the cache, which must not be modified or freed by the caller. They
+   stay valid until the next call of lmc_put for the same energy.
+
+ RETURN VALUES:
+
+   1 if the entry was found.
+   0 otherwise (*p_Tpp etc. are unchanged).
+
+*************************************************************************/
+{
+int i;
+struct lmc_entry_str *entry;
+
+ entry = lmc->entry + i_eng * lmc->n_max;
+ for(i = 0; i < lmc->n_max; i ++, entry ++)
+ {
+   if( (entry->used != 0) && (entry->key == key) &&
+       (entry->beam_key == beam_key) && (entry->eng == eng) )
+   {
+     entry->used = ++ lmc->clock[i_eng];
+     *p_Tpp = entry->Tpp;
+     *p_Tmm = entry->Tmm;
+     *p_Rpm = entry->Rpm;
+     *p_Rmp = entry->Rmp;
+     return(1);
+   }
+ }
+ return(0);
+}  /* end of function lmc_get */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int lmc_put(struct lmc_str *lmc, int i_eng, real eng,
+            unsigned long long key, unsigned long long beam_key,
+            mat Tpp, mat Tmm, mat Rpm, mat Rmp)
+
+/************************************************************************
+
+ Store copies of the scattering matrices of a layer for energy i_eng.
+ If all entries of this energy are taken, the one that has not been
+ used for the longest time is replaced.
+
+ Different threads may store entries of different energies at the same
+ time.
+
+*************************************************************************/
+{
+int i;
+struct lmc_entry_str *entry, *oldest;
+
+ entry = oldest = lmc->entry + i_eng * lmc->n_max;
+ for(i = 0; i < lmc->n_max; i ++, entry ++)
+ {
+   if(entry->used < oldest->used) oldest = entry;
+ }
+
+ oldest->Tpp = matcop(oldest->Tpp, Tpp);
+ oldest->Tmm = matcop(oldest->Tmm, Tmm);
+ oldest->Rpm = matcop(oldest->Rpm, Rpm);
+ oldest->Rmp = matcop(oldest->Rmp, Rmp);
+ oldest->eng = eng;
+ oldest->key = key;
+ oldest->beam_key = beam_key;
+ oldest->used = ++ lmc->clock[i_eng];
+ return(1);
+}  /* end of function lmc_put */
+
+/*======================================================================*/
+/*======================================================================*/
+
+struct lsc_str *lsc_alloc(int n_eng)
+
+/************************************************************************
+
+ Create a cache for the reflection matrices of partial overlayer stacks
+ for n_eng energies.
+
+ RETURN VALUES:
+
+   pointer to the new cache.
+
+*************************************************************************/
+{
+struct lsc_str *lsc;
+
+ lsc = (struct lsc_str *) calloc(1, sizeof(struct lsc_str));
+ lsc->n_eng = n_eng;
+ lsc->stack = (struct lsc_eng_str *) calloc(n_eng, sizeof(struct lsc_eng_str));
+
+ return(lsc);
+}  /* end of function lsc_alloc */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int lsc_free(struct lsc_str *lsc)
+{
+int i_eng, i;
+struct lsc_eng_str *stack;
+
+ if(lsc == NULL) return(0);
+
+ for(i_eng = 0; i_eng < lsc->n_eng; i_eng ++)
+ {
+   stack = lsc->stack + i_eng;
+   for(i = 0; i < stack->n_alloc; i ++)
+     if(stack->R_tot[i] != NULL) matfree(stack->R_tot[i]);
+   free(stack->key);
+   free(stack->R_tot);
+ }
+
+ free(lsc->stack);
+ free(lsc);
+ return(1);
+}  /* end of function lsc_free */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int lsc_get(struct lsc_str *lsc, int i_eng, real eng,
+            unsigned long long beam_key, unsigned long long *keys, int n_layers,
+            mat *p_R_tot)
+
+/************************************************************************
+
+ Find the largest partial stack of energy i_eng that is still valid.
+
+ INPUT:
+
+   unsigned long long *keys - keys of the current stacks up to layer
+            0 .. n_layers-1 (see rbc_stack_key).
+
+ DESIGN:
+
+   The stacks are compared from the bottom upwards; the first one with
+   a different key ends the search. *p_R_tot points to the matrix in
+   the cache, which must not be modified or freed by the caller. It
+   stays valid until the next call of lsc_put for the same energy.
+
+ RETURN VALUES:
+
+   number of layers of the stack found (*p_R_tot is its reflection
+   matrix); 0 if none is valid (*p_R_tot is unchanged).
+
+*************************************************************************/
+{
+int i;
+struct lsc_eng_str *stack;
+
+ stack = lsc->stack + i_eng;
+ if( (stack->eng != eng) || (stack->beam_key != beam_key) ) return(0);
+
+ for(i = 0; (i < n_layers) && (i < stack->n_layers); i ++)
+   if(stack->key[i] != keys[i]) break;
+
+ if(i > 0) *p_R_tot = stack->R_tot[i-1];
+ return(i);
+}  /* end of function lsc_get */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int lsc_put(struct lsc_str *lsc, int i_eng, real eng,
+            unsigned long long beam_key, int i_layer, unsigned long long key,
+            mat R_tot)
+
+/************************************************************************
+
+ Store a copy of the reflection matrix R_tot of the stack up to layer
+ i_layer (key) for energy i_eng. All stacks above i_layer become
+ invalid, as do all stacks if eng or beam_key differ from the ones
+ stored.
+
+ Different threads may store entries of different energies at the same
+ time.
+
+*************************************************************************/
+{
+int i;
+struct lsc_eng_str *stack;
+
+ stack = lsc->stack + i_eng;
+ if( (stack->eng != eng) || (stack->beam_key != beam_key) )
+ {
+   stack->n_layers = 0;
+   stack->eng = eng;
+   stack->beam_key = beam_key;
+ }
+
+ if(i_layer >= stack->n_alloc)
+ {
+   stack->key = (unsigned long long *)
+                realloc(stack->key, (i_layer + 1) * sizeof(unsigned long long));
+   stack->R_tot = (mat *) realloc(stack->R_tot, (i_layer + 1) * sizeof(mat));
+   for(i = stack->n_alloc; i <= i_layer; i ++) stack->R_tot[i] = NULL;
+   stack->n_alloc = i_layer + 1;
+ }
+
+ stack->R_tot[i_layer] = matcop(stack->R_tot[i_layer], R_tot);
+ stack->key[i_layer] = key;
+ stack->n_layers = MIN(stack->n_layers, i_layer) + 1;
+ return(1);
+}  /* end of function lsc_put */
@@ -0,0 +1,219 @@
+/*********************************************************************
+  file contains functions:
+
+  lsm_alloc
+     Create a cache for the lattice sums of ms_lsum_ii.
+  lsm_free
+     Free the cache and all lattice sums stored in it.
+  lsm_get
+     Retrieve a lattice sum from the cache.
+  lsm_put
+     Store a lattice sum in the cache.
+
+*********************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "leed.h"
+
+#define LSM_N_SLOT 256        /* number of hash slots (power of 2) */
+
+/*======================================================================*/
+/*======================================================================*/
+
+/*
+  FNV-1a hash of all input the lattice sum depends on.
+*/
+static unsigned long long lsm_hash(struct lsm_entry_str *key)
+{
+const unsigned char *p;
+unsigned long long h = 14695981039346656037ULL;
+size_t i;
+
+ p = (const unsigned char *) key->par;
+ for(i = 0; i < sizeof(key->par); i ++)
+ {
+   h ^= p[i];
+   h *= 1099511628211ULL;
+ }
+ h ^= (unsigned long long) key->l_max;
+ h *= 1099511628211ULL;
+ return(h);
+}
+
+/*
+  Fill in the parameters of an entry.
+*/
+static void lsm_set_key(struct lsm_entry_str *key, real k_r, real k_i,
+                        real *k_in, real *a, int l_max, real epsilon)
+{
+ key->par[0] = k_r;
+ key->par[1] = k_i;
+ key->par[2] = k_in[1];
+ key->par[3] = k_in[2];
+ key->par[4] = a[1];
+ key->par[5] = a[2];
+ key->par[6] = a[3];
+ key->par[7] = a[4];
+ key->par[8] = epsilon;
+ key->l_max = l_max;
+ key->hash = lsm_hash(key);
+}
+
+/*
+  Entry with the same parameters as key (NULL if there is none).
+*/
+static struct lsm_entry_str *lsm_find(struct lsm_str *lsm,
+                                      struct lsm_entry_str *key)
+{
+int i;
+struct lsm_entry_str *entry;
+
+ for(entry = lsm->slot[key->hash & (LSM_N_SLOT - 1)];
+     entry != NULL; entry = entry->next)
+ {
+   if( (entry->hash != key->hash) || (entry->l_max != key->l_max) ) continue;
+   for(i = 0; (i < LSM_N_PAR) && (entry->par[i] == key->par[i]); i ++);
+   if(i == LSM_N_PAR) return(entry);
+ }
+ return(NULL);
+}
+
+/*======================================================================*/
+/*======================================================================*/
+
+struct lsm_str *lsm_alloc(int n_max)
+
+/************************************************************************
+
+ Create a cache for at most n_max lattice sums.
+
+ DESIGN:
+
+   The lattice sum Llm of a Bravais lattice (ms_lsum_ii) only depends
+   on the complex wave number, the parallel component of the incident
+   wave vector, the lattice vectors, l_max and epsilon, but not on the
+   atom positions. The cache is shared by all calculation contexts of a
+   session (ctx->lsm), so a lattice sum is computed once for all layers
+   with the same lattice and for all later evaluations.
+
+   Entries are never replaced; once the cache is full, new lattice sums
+   are no longer stored.
+
+ RETURN VALUES:
+
+   pointer to the new cache.
+
+*************************************************************************/
+{
+struct lsm_str *lsm;
+
+ lsm = (struct lsm_str *) calloc(1, sizeof(struct lsm_str));
+ lsm->n_max = n_max;
+ lsm->slot = (struct lsm_entry_str **)
+             calloc(LSM_N_SLOT, sizeof(struct lsm_entry_str *));
+
+ return(lsm);
+}  /* end of function lsm_alloc */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int lsm_free(struct lsm_str *lsm)
+{
+int i;
+struct lsm_entry_str *entry, *next;
+
+ if(lsm == NULL) return(0);
+
+ for(i = 0; i < LSM_N_SLOT; i ++)
+   for(entry = lsm->slot[i]; entry != NULL; entry = next)
+   {
+     next = entry->next;
+     matfree(entry->Llm);
+     free(entry);
+   }
+
+ free(lsm->slot);
+ free(lsm);
+ return(1);
+}  /* end of function lsm_free */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int lsm_get(struct lsm_str *lsm, mat *p_Llm, real k_r, real k_i,
+            real *k_in, real *a, int l_max, real epsilon)
+
+/************************************************************************
+
+ Look up the lattice sum for the parameters of ms_lsum_ii and copy it
+ into *p_Llm.
+
+ RETURN VALUES:
+
+   1 if the entry was found.
+   0 otherwise (*p_Llm is unchanged).
+
+*************************************************************************/
+{
+int found;
+struct lsm_entry_str key, *entry;
+
+ lsm_set_key(&key, k_r, k_i, k_in, a, l_max, epsilon);
+
+ found = 0;
+#pragma omp critical (lsm_cache)
+ {
+   entry = lsm_find(lsm, &key);
+   if(entry != NULL)
+   {
+     *p_Llm = matcop(*p_Llm, entry->Llm);
+     found = 1;
+   }
+ }
+
+ return(found);
+}  /* end of function lsm_get */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int lsm_put(struct lsm_str *lsm, mat Llm, real k_r, real k_i,
+            real *k_in, real *a, int l_max, real epsilon)
+
+/************************************************************************
+
+ Store a copy of the lattice sum Llm for the parameters of ms_lsum_ii.
+
+ RETURN VALUES:
+
+   1 if Llm was stored.
+   0 if the cache is full or the entry exists already.
+
+*************************************************************************/
+{
+int stored;
+struct lsm_entry_str key, *entry;
+
+ lsm_set_key(&key, k_r, k_i, k_in, a, l_max, epsilon);
+
+ stored = 0;
+#pragma omp critical (lsm_cache)
+ {
+   if( (lsm->n_entries < lsm->n_max) && (lsm_find(lsm, &key) == NULL) )
+   {
+     entry = (struct lsm_entry_str *) malloc(sizeof(struct lsm_entry_str));
+     *entry = key;
+     entry->Llm = matcop(NULL, Llm);
+     entry->next = lsm->slot[key.hash & (LSM_N_SLOT - 1)];
+     lsm->slot[key.hash & (LSM_N_SLOT - 1)] = entry;
+     lsm->n_entries ++;
+     stored = 1;
+   }
+ }
+
+ return(stored);
+}  /* end of function lsm_put */
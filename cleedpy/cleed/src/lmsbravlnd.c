@@ -26,11 +26,6 @@ GH/05.07.03
 
 #include "leed.h"
 
-
-#define CONTROL_X
-#define CONTROL
-
-
 #define WARNING
 #define ERROR
 
@@ -40,7 +35,8 @@ GH/05.07.03
 
 /*======================================================================*/
 
-int ms_bravl_nd ( mat *p_Tpp, mat *p_Tmm, mat *p_Rpm, mat *p_Rmp,
+int ms_bravl_nd ( struct ctx_str *ctx,
+                 mat *p_Tpp, mat *p_Tmm, mat *p_Rpm, mat *p_Rmp,
                  struct var_str *v_par,
                  struct layer_str * layer,
                  struct beam_str * beams)
@@ -51,6 +47,10 @@ int ms_bravl_nd ( mat *p_Tpp, mat *p_Tmm, mat *p_Rpm, mat *p_Rmp,
 
  INPUT:
 
+   struct ctx_str *ctx - (input) calculation context. The lattice sum,
+              the scattering matrix and the spherical harmonics of the
+              previous call are kept in ctx->bravl and reused if possible.
+
    mat * p_Tpp, p_Tmm, p_Rpm p_Rmp - (output) pointers to Bravais layer
               diffraction matrices in k-space:
               Tpp  k(+) -> k(+) (transmission matrix)
@@ -107,16 +107,7 @@ int ms_bravl_nd ( mat *p_Tpp, mat *p_Tmm, mat *p_Rpm, mat *p_Rmp,
 
 *************************************************************************/
 {
-
-static int old_set  = I_END_OF_LIST;
-static int old_n_beams  = I_END_OF_LIST;
-static int old_type = I_END_OF_LIST;
-static int old_l_max = I_END_OF_LIST;
-
-static real old_eng = F_END_OF_LIST;
-
-static mat Llm = NULL, Tii = NULL;
-static mat Yin_p = NULL, Yin_m = NULL, Yout_p = NULL, Yout_m = NULL;
+struct bravl_str *cache = &ctx->bravl;
 
 int n_beams, i_beams;
 int l_max;
@@ -125,6 +116,7 @@ int iaux, i_c;
 
 real pref_i, faux_r, faux_i;
 real *ptr_r, *ptr_i;
+double t_start;
 
 mat Maux;
 
@@ -140,10 +132,11 @@ mat Maux;
 
  for(n_beams = 0; (beams + n_beams)->k_par != F_END_OF_LIST; n_beams ++);
 
-#ifdef CONTROL
- fprintf(STDCTR,"(ms_bravl): l_max = %d, No of beams = %d, atom type = %d\n",
-         l_max, n_beams, i_type);
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(ms_bravl): l_max = %d, No of beams = %d, atom type = %d\n",
+           l_max, n_beams, i_type);
+ }
 
 /*************************************************************************
  Check if t_type has the right value
@@ -171,38 +164,43 @@ mat Maux;
    atom type has changed.
 *************************************************************************/
 
- if( (old_eng     != v_par->eng_r) ||
-     (old_set     != beams->set)   ||
-     (old_n_beams != n_beams)      ||
-     (old_l_max   != l_max)           )
+ if( (cache->eng     != v_par->eng_r) ||
+     (cache->set     != beams->set)   ||
+     (cache->n_beams != n_beams)      ||
+     (cache->l_max   != l_max)           )
  {
-#ifdef CONTROL
- fprintf(STDCTR,"(ms_bravl): recalculate lattice sum etc.\n");
-#endif
+   if(LOG_ON(LOG_MS, LOG_CONTROL))
+   {
+     fprintf(STDCTR,"(ms_bravl): recalculate lattice sum etc.\n");
+   }
 
 /* calculate lattice sum */
-   Llm = ms_lsum_ii ( Llm, beams->k_r[0], beams->k_i[0], beams->k_r,
+   t_start = prof_time(ctx->prof);
+   cache->Llm = ms_lsum_ii ( ctx, cache->Llm, beams->k_r[0], beams->k_i[0], beams->k_r,
                       layer->a_lat, 2*l_max, v_par->epsilon );
+   prof_add(ctx->prof, PROF_LSUM, t_start, 1);
 /* calculate scattering matrix */
+   t_start = prof_time(ctx->prof);
    if(t_type == T_DIAG)
    {
-     Tii = ms_tmat_ii( Tii, Llm, v_par->p_tl[i_type], l_max);
-     Tii = mattrans(Tii, Tii);
+     cache->Tii = ms_tmat_ii( ctx, cache->Tii, cache->Llm, v_par->p_tl[i_type], l_max);
+     cache->Tii = mattrans(cache->Tii, cache->Tii);
    }
    else if(t_type == T_NOND)
    {
-     Tii = ms_tmat_nd_ii( Tii, Llm, v_par->p_tl[i_type], l_max);
+     cache->Tii = ms_tmat_nd_ii( ctx, cache->Tii, cache->Llm, v_par->p_tl[i_type], l_max);
    }
+   prof_add(ctx->prof, PROF_TMAT, t_start, 1);
 
 /* Yout_p = Y(k+) */
-   Yout_p = ms_ymat(Yout_p, l_max, beams, n_beams);
+   cache->Yout_p = ms_ymat(ctx, cache->Yout_p, l_max, beams, n_beams);
 /* Yout_m = Y(k-) */
-   Yout_m = ms_yp_ym(Yout_m, Yout_p);
+   cache->Yout_m = ms_yp_ym(cache->Yout_m, cache->Yout_p);
 
 /* Yin_p: Y*(k+) for transmission matrix. */
-   Yin_p = ms_yp_yxp(Yin_p, Yout_p);
+   cache->Yin_p = ms_yp_yxp(cache->Yin_p, cache->Yout_p);
 /* Yin_m: Y*(k-) for reflection matrix. */
-   Yin_m = ms_yp_yxm(Yin_m, Yout_p);
+   cache->Yin_m = ms_yp_yxm(cache->Yin_m, cache->Yout_p);
 
   /**********************************************************************
    Loop over k' (exit beams: rows of Yout_p):
@@ -212,25 +210,25 @@ mat Maux;
 
    pref_i = 8.*PI*PI / (beams->k_r[0] * layer->rel_area);
 
-   ptr_r = Yout_p->rel + 1;
-   ptr_i = Yout_p->iel + 1;
-   for(i_beams = 0; i_beams < Yout_p->rows; i_beams ++)
+   ptr_r = cache->Yout_p->rel + 2;
+   ptr_i = cache->Yout_p->iel + 2;
+   for(i_beams = 0; i_beams < cache->Yout_p->rows; i_beams ++)
    {
      cri_mul(&faux_r, &faux_i, 0., pref_i,
              (beams+i_beams)->Akz_r, (beams+i_beams)->Akz_i);
-     for(i_c = 0; i_c < Yout_p->cols; i_c ++, ptr_r ++, ptr_i ++ )
+     for(i_c = 0; i_c < cache->Yout_p->cols; i_c ++, ptr_r += 2, ptr_i += 2 )
      {
        cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
      }
    }  /* i_beams */
 
-   ptr_r = Yout_m->rel + 1;
-   ptr_i = Yout_m->iel + 1;
-   for(i_beams = 0; i_beams < Yout_m->rows; i_beams ++)
+   ptr_r = cache->Yout_m->rel + 2;
+   ptr_i = cache->Yout_m->iel + 2;
+   for(i_beams = 0; i_beams < cache->Yout_m->rows; i_beams ++)
    {
      cri_mul(&faux_r, &faux_i, 0., pref_i,
              (beams+i_beams)->Akz_r, (beams+i_beams)->Akz_i);
-     for(i_c = 0; i_c < Yout_m->cols; i_c ++, ptr_r ++, ptr_i ++ )
+     for(i_c = 0; i_c < cache->Yout_m->cols; i_c ++, ptr_r += 2, ptr_i += 2 )
      {
        cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
      }
@@ -244,25 +242,29 @@ mat Maux;
    the scattering matrix has to be recalculated if atom type is different.
   *************************************************************************/
 
-   if( old_type != i_type )
+   if( cache->type != i_type )
    {
-#ifdef CONTROL
- fprintf(STDCTR,"(ms_bravl): recalculate scattering matrix.\n");
-#endif
+     if(LOG_ON(LOG_MS, LOG_CONTROL))
+     {
+       fprintf(STDCTR,"(ms_bravl): recalculate scattering matrix.\n");
+     }
 
   /* calculate scattering matrix */
+     t_start = prof_time(ctx->prof);
      if(t_type == T_DIAG)
      {
-       Tii = ms_tmat_ii( Tii, Llm, v_par->p_tl[i_type], l_max);
-       Tii = mattrans(Tii, Tii);
+       cache->Tii = ms_tmat_ii( ctx, cache->Tii, cache->Llm, v_par->p_tl[i_type], l_max);
+       cache->Tii = mattrans(cache->Tii, cache->Tii);
      }
      else if(t_type == T_NOND)
      {
-       Tii = ms_tmat_nd_ii( Tii, Llm, v_par->p_tl[i_type], l_max);
-#ifdef CONTROL
- fprintf(STDCTR,"(ms_bravl): T_NOND \n");
-#endif
+       cache->Tii = ms_tmat_nd_ii( ctx, cache->Tii, cache->Llm, v_par->p_tl[i_type], l_max);
+       if(LOG_ON(LOG_MS, LOG_CONTROL))
+       {
+         fprintf(STDCTR,"(ms_bravl): T_NOND \n");
+       }
      }
+     prof_add(ctx->prof, PROF_TMAT, t_start, 1);
 
    } /* if i_type */
  }
@@ -271,15 +273,17 @@ mat Maux;
 /**********************************************************************
  Matrix product Yout (exit beams) * Tii * Yin (inc. beams)
 **********************************************************************/
- Maux = matmul(Maux, Yout_p, Tii);
+ Maux = matmul(Maux, cache->Yout_p, cache->Tii);
+
+ *p_Rpm = matmul(*p_Rpm, Maux, cache->Yin_m);
+ *p_Tpp = matmul(*p_Tpp, Maux, cache->Yin_p);
 
- *p_Rpm = matmul(*p_Rpm, Maux, Yin_m);
- *p_Tpp = matmul(*p_Tpp, Maux, Yin_p);
+ Maux = matmul(Maux, cache->Yout_m, cache->Tii);
 
- Maux = matmul(Maux, Yout_m, Tii);
+ *p_Tmm = matmul(*p_Tmm, Maux, cache->Yin_m);
+ *p_Rmp = matmul(*p_Rmp, Maux, cache->Yin_p);
 
- *p_Tmm = matmul(*p_Tmm, Maux, Yin_m);
- *p_Rmp = matmul(*p_Rmp, Maux, Yin_p);
+ matfree(Maux);
 
 
 /**********************************************************************
@@ -289,18 +293,18 @@ mat Maux;
  iaux = (*p_Tpp)->rows * (*p_Tpp)->cols;
  for(i_c = 1; i_c <= iaux; i_c += (*p_Tpp)->cols + 1)
  {
-   (*p_Tpp)->rel[i_c] += 1.;
-   (*p_Tmm)->rel[i_c] += 1.;
+   (*p_Tpp)->rel[2*i_c] += 1.;
+   (*p_Tmm)->rel[2*i_c] += 1.;
  }
 
 /**********************************************************************
   Update energy, beam_set, and beam_num, l_max, i_type
 **********************************************************************/
-   old_eng = v_par->eng_r;
-   old_set = beams->set;
-   old_n_beams = n_beams;
-   old_l_max = l_max;
-   old_type = i_type;
+   cache->eng = v_par->eng_r;
+   cache->set = beams->set;
+   cache->n_beams = n_beams;
+   cache->l_max = l_max;
+   cache->type = i_type;
 
  return(1);
 } /* end of function ms_bravl_nd */
@@ -46,8 +46,6 @@
 #define CONTROL
 */
 
-#define CONTROL
-
 #define CPUTIME
 #define WARNING
 #define ERROR
@@ -55,7 +53,7 @@
 #define EXIT_ON_ERROR
 
 #ifdef CPUTIME
-#define CTIME(x) cpu_time(STDCPU,x)
+#define CTIME(x) ((LOG_ON(LOG_MS, LOG_CONTROL))? cpu_time(STDCPU,x): 0.)
 #else
 #define CTIME(x)
 #endif
@@ -68,11 +66,321 @@
 #define K_TOLERANCE 0.0001                  /* tolerance in k_par */
 #endif
 
+/*
+  Pair of atoms (i_atoms < j_atoms) in the giant matrix and the distinct
+  interlayer propagators (blocks) Tjj * Gji and Tii * Gij.
+*/
+struct compl_pair_str
+{
+ int i_atoms, j_atoms;
+ int i_lsum;          /* entry of ctx->lsij for d_ij = rj - ri */
+ int flip;            /* 1 if d_ij is the inverse of the entry's vector */
+ int i_blk;           /* propagator blocks of the pair */
+};
+
+struct compl_blk_str
+{
+ int i_lsum;          /* entry of ctx->lsij */
+ int type_p, type_m;  /* atom types multiplied with Llm_p and Llm_m */
+ mat G_p, G_m;        /* Tii * Gij for Llm_p and Llm_m */
+};
+
+/*
+  Giant matrix Mbg as a sum of the propagator blocks (MBG_GMRES) and the
+  inverse diagonal blocks of the atomic planes (preconditioner).
+*/
+struct compl_op_str
+{
+ int n_atoms, l_max_2;
+ int n_pairs;
+ struct compl_pair_str *pairs;
+ struct compl_blk_str *blks;
+
+ int n_planes;
+ int *plane_atoms;    /* atoms of plane p: plane_atoms[plane_off[p] ...] */
+ int *plane_off;      /* (n_planes + 1 entries) */
+ mat *P_inv;          /* inverse diagonal block of plane p (NULL: 1 atom) */
+};
+
 /*======================================================================*/
 /*======================================================================*/
 
+static void compl_lsij_key(struct lsij_str *lsij, real k_r, real k_i,
+                           real *k_in, real *a, int l_max, real epsilon)
+
+/************************************************************************
+
+ Make sure that the interlayer lattice sums stored in lsij belong to the
+ parameters k_r, ..., epsilon (see ms_lsum_ij), otherwise discard them.
+
+ The lattice sums only depend on the interlayer vector and on the
+ parameters, which are the same for all composite layers of an energy;
+ the sums are therefore shared by all layers until the energy changes.
 
-int ms_compl_nd ( mat *p_Tpp, mat *p_Tmm, mat *p_Rpm, mat *p_Rmp,
+*************************************************************************/
+{
+int i;
+real par[LSM_N_PAR];
+
+ par[0] = k_r;
+ par[1] = k_i;
+ par[2] = k_in[1];
+ par[3] = k_in[2];
+ par[4] = a[1];
+ par[5] = a[2];
+ par[6] = a[3];
+ par[7] = a[4];
+ par[8] = epsilon;
+
+ for(i = 0; (i < LSM_N_PAR) && (lsij->par[i] == par[i]); i ++);
+ if( (i == LSM_N_PAR) && (lsij->l_max == l_max) ) return;
+
+ for(i = 0; i < lsij->n_entries; i ++)
+ {
+   matfree(lsij->Llm_p[i]);
+   matfree(lsij->Llm_m[i]);
+ }
+ lsij->n_entries = 0;
+
+ for(i = 0; i < LSM_N_PAR; i ++) lsij->par[i] = par[i];
+ lsij->l_max = l_max;
+}
+
+/*
+  Entry of lsij for the vector d_ij or its inverse (flip = 1), a new entry
+  (Llm_p/m = NULL) is added if there is none.
+*/
+static int compl_lsij_find(struct lsij_str *lsij, real *d_ij, int *flip)
+{
+int i;
+real *d;
+
+ for(i = 0, d = lsij->d_ij; i < lsij->n_entries; i ++, d += 4)
+ {
+   if( (R_fabs(d[1] - d_ij[1]) < GEO_TOLERANCE) &&
+       (R_fabs(d[2] - d_ij[2]) < GEO_TOLERANCE) &&
+       (R_fabs(d[3] - d_ij[3]) < GEO_TOLERANCE) )
+   {
+     *flip = 0;
+     return(i);
+   }
+   if( (R_fabs(d[1] + d_ij[1]) < GEO_TOLERANCE) &&
+       (R_fabs(d[2] + d_ij[2]) < GEO_TOLERANCE) &&
+       (R_fabs(d[3] + d_ij[3]) < GEO_TOLERANCE) )
+   {
+     *flip = 1;
+     return(i);
+   }
+ }
+
+ if(lsij->n_entries == lsij->n_alloc)
+ {
+   lsij->n_alloc = MAX(2*lsij->n_alloc, 16);
+   lsij->d_ij  = (real *) realloc(lsij->d_ij, 4*lsij->n_alloc * sizeof(real));
+   lsij->Llm_p = (mat *) realloc(lsij->Llm_p, lsij->n_alloc * sizeof(mat));
+   lsij->Llm_m = (mat *) realloc(lsij->Llm_m, lsij->n_alloc * sizeof(mat));
+ }
+
+ d = lsij->d_ij + 4*i;
+ d[1] = d_ij[1];
+ d[2] = d_ij[2];
+ d[3] = d_ij[3];
+ lsij->Llm_p[i] = lsij->Llm_m[i] = NULL;
+ lsij->n_entries ++;
+
+ *flip = 0;
+ return(i);
+}
+
+/*
+  Y = Mbg * X for the giant matrix in compl_op_str
+  (Mbg = identity + one propagator block per pair of atoms).
+*/
+static mat compl_mbg_op(mat Y, mat X, void *data)
+{
+struct compl_op_str *op = (struct compl_op_str *) data;
+struct compl_pair_str *pair;
+struct compl_blk_str *blk;
+
+int i_pair, i_atoms, n_el;
+real *ptr_y, *ptr_x, *ptr_end;
+
+mat *X_a;                       /* rows of X belonging to atom i */
+mat G_ji, G_ij, Maux;
+
+ n_el = 2 * op->l_max_2 * X->cols;
+
+ X_a = (mat *) malloc(op->n_atoms * sizeof(mat));
+ for(i_atoms = 0; i_atoms < op->n_atoms; i_atoms ++)
+   X_a[i_atoms] = matext(NULL, X, i_atoms*op->l_max_2 + 1,
+                         (i_atoms+1)*op->l_max_2, 1, X->cols);
+
+ Y = matcop(Y, X);
+ Maux = NULL;
+
+ for(i_pair = 0; i_pair < op->n_pairs; i_pair ++)
+ {
+   pair = op->pairs + i_pair;
+   blk = op->blks + pair->i_blk;
+   G_ji = (pair->flip == 0) ? blk->G_p : blk->G_m;   /* block (j,i) */
+   G_ij = (pair->flip == 0) ? blk->G_m : blk->G_p;   /* block (i,j) */
+
+   Maux = matmul(Maux, G_ji, X_a[pair->i_atoms]);
+   for(ptr_y = Y->rel + 2 + pair->j_atoms * n_el, ptr_x = Maux->rel + 2,
+       ptr_end = ptr_y + n_el; ptr_y < ptr_end; ptr_y ++, ptr_x ++)
+     *ptr_y += *ptr_x;
+
+   Maux = matmul(Maux, G_ij, X_a[pair->j_atoms]);
+   for(ptr_y = Y->rel + 2 + pair->i_atoms * n_el, ptr_x = Maux->rel + 2,
+       ptr_end = ptr_y + n_el; ptr_y < ptr_end; ptr_y ++, ptr_x ++)
+     *ptr_y += *ptr_x;
+ }
+
+ for(i_atoms = 0; i_atoms < op->n_atoms; i_atoms ++) matfree(X_a[i_atoms]);
+ free(X_a);
+ if(Maux != NULL) matfree(Maux);
+
+ return(Y);
+}
+
+/*
+  Z = P^-1 * V (block Jacobi preconditioner): P is the block diagonal
+  part of Mbg formed by the atomic planes.
+*/
+static mat compl_mbg_prec(mat Z, mat V, void *data)
+{
+struct compl_op_str *op = (struct compl_op_str *) data;
+
+int i_plane, i_atoms, i, n_el;
+
+mat V_p, Maux;
+
+ n_el = 2 * op->l_max_2 * V->cols;
+
+ Z = matcop(Z, V);
+ V_p = Maux = NULL;
+
+ for(i_plane = 0; i_plane < op->n_planes; i_plane ++)
+ {
+   if(op->P_inv[i_plane] == NULL) continue;
+
+   V_p = matalloc(V_p, op->P_inv[i_plane]->cols, V->cols, NUM_COMPLEX);
+   for(i = op->plane_off[i_plane]; i < op->plane_off[i_plane+1]; i ++)
+   {
+     i_atoms = op->plane_atoms[i];
+     memcpy(V_p->rel + 2 + (i - op->plane_off[i_plane]) * n_el,
+            V->rel + 2 + i_atoms * n_el, n_el * sizeof(real));
+   }
+
+   Maux = matmul(Maux, op->P_inv[i_plane], V_p);
+
+   for(i = op->plane_off[i_plane]; i < op->plane_off[i_plane+1]; i ++)
+   {
+     i_atoms = op->plane_atoms[i];
+     memcpy(Z->rel + 2 + i_atoms * n_el,
+            Maux->rel + 2 + (i - op->plane_off[i_plane]) * n_el,
+            n_el * sizeof(real));
+   }
+ }
+
+ if(V_p != NULL) matfree(V_p);
+ if(Maux != NULL) matfree(Maux);
+
+ return(Z);
+}
+
+/*
+  Set up the preconditioner of compl_mbg_prec: group the atoms into
+  planes (z within GEO_TOLERANCE) and invert the diagonal block of Mbg
+  belonging to each plane with more than one atom.
+*/
+static void compl_mbg_planes(struct compl_op_str *op, struct atom_str *atoms)
+{
+int i_atoms, j_atoms, i, j, n_p;
+int i_a, j_a, off_row, off_col;
+int *done;
+
+struct compl_pair_str *pair;
+struct compl_blk_str *blk;
+
+mat P;
+
+ op->plane_atoms = (int *) malloc(op->n_atoms * sizeof(int));
+ op->plane_off = (int *) malloc((op->n_atoms + 1) * sizeof(int));
+ op->P_inv = (mat *) calloc(op->n_atoms, sizeof(mat));
+ done = (int *) calloc(op->n_atoms, sizeof(int));
+
+ for(i_atoms = 0, op->n_planes = 0, n_p = 0; i_atoms < op->n_atoms; i_atoms ++)
+ {
+   if(done[i_atoms]) continue;
+   op->plane_off[op->n_planes] = n_p;
+   for(j_atoms = i_atoms; j_atoms < op->n_atoms; j_atoms ++)
+     if( !done[j_atoms] &&
+         (R_fabs((atoms+j_atoms)->pos[3] - (atoms+i_atoms)->pos[3])
+          < GEO_TOLERANCE) )
+     {
+       op->plane_atoms[n_p ++] = j_atoms;
+       done[j_atoms] = 1;
+     }
+   op->n_planes ++;
+ }
+ op->plane_off[op->n_planes] = n_p;
+ free(done);
+
+ for(i = 0; i < op->n_planes; i ++)
+ {
+   n_p = op->plane_off[i+1] - op->plane_off[i];
+   if(n_p < 2) continue;
+
+   P = matalloc(NULL, n_p * op->l_max_2, n_p * op->l_max_2, NUM_COMPLEX);
+   for(j = 0; j < n_p * op->l_max_2; j ++)
+     P->rel[2*(j * P->cols + j + 1)] = 1.;
+
+   for(i_atoms = 0; i_atoms < n_p; i_atoms ++)
+   for(j_atoms = i_atoms + 1; j_atoms < n_p; j_atoms ++)
+   {
+     /* pairs are numbered (0,1), (0,2), ... (0,n-1), (1,2), ... */
+     i_a = MIN(op->plane_atoms[op->plane_off[i] + i_atoms],
+               op->plane_atoms[op->plane_off[i] + j_atoms]);
+     j_a = MAX(op->plane_atoms[op->plane_off[i] + i_atoms],
+               op->plane_atoms[op->plane_off[i] + j_atoms]);
+     pair = op->pairs + i_a*op->n_atoms - i_a*(i_a+1)/2 + j_a - i_a - 1;
+     blk = op->blks + pair->i_blk;
+
+     /* offsets of the atoms pair->i_atoms (row) and pair->j_atoms (col) */
+     if(i_a == op->plane_atoms[op->plane_off[i] + i_atoms])
+     {
+       off_row = i_atoms * op->l_max_2 + 1;
+       off_col = j_atoms * op->l_max_2 + 1;
+     }
+     else
+     {
+       off_row = j_atoms * op->l_max_2 + 1;
+       off_col = i_atoms * op->l_max_2 + 1;
+     }
+
+     if(pair->flip == 0)
+     {
+       P = matins(P, blk->G_p, off_col, off_row);
+       P = matins(P, blk->G_m, off_row, off_col);
+     }
+     else
+     {
+       P = matins(P, blk->G_m, off_col, off_row);
+       P = matins(P, blk->G_p, off_row, off_col);
+     }
+   }
+
+   op->P_inv[i] = matinv(P, P);
+ }
+}
+
+/*======================================================================*/
+/*======================================================================*/
+
+
+int ms_compl_nd ( struct ctx_str *ctx,
+               mat *p_Tpp, mat *p_Tmm, mat *p_Rpm, mat *p_Rmp,
                struct var_str *v_par,
                struct layer_str * layer,
                struct beam_str * beams)
@@ -83,6 +391,8 @@ int ms_compl_nd ( mat *p_Tpp, mat *p_Tmm, mat *p_Rpm, mat *p_Rmp,
 
  INPUT:
 
+   struct ctx_str *ctx - (input) calculation context.
+
    mat * p_Tpp, p_Tmm, p_Rpm, p_Rmp - (output) pointers to composite layer
               diffraction matrices in k-space.
               Tpp  k(+) -> k(+) (transmission matrix)
@@ -134,6 +444,20 @@ int ms_compl_nd ( mat *p_Tpp, mat *p_Tmm, mat *p_Rpm, mat *p_Rmp,
        Projection of the origin to the atomic subplane with the largest
        z coordinate (atom No. n_atoms-1):
 
+  The interlayer lattice sums only depend on d_ij = rj - ri. Each distinct
+  vector (d_ij and -d_ij count as one) is summed once per energy; the
+  sums are kept in ctx->lsij for the other composite layers of the same
+  energy. Pairs of atoms with the same vector and the same atom types
+  share the propagators Tii * Gij. Both are calculated with
+  ctx->n_threads threads.
+
+  The giant matrix equations Mbg * X = (R_p R_m) are solved according to
+  v_par->mbg_solver: by LU decomposition (MBG_LU, ms_partsolve), by
+  inversion of Mbg (MBG_INV, ms_partinv) or iteratively (MBG_GMRES,
+  ms_gmres). The latter never sets up Mbg: the products with Mbg are
+  formed from the shared propagators and the block-Jacobi preconditioner
+  consists of the inverse diagonal blocks of the atomic subplanes.
+
  FUNCTION CALLS
 
   matarralloc
@@ -150,6 +474,8 @@ int ms_compl_nd ( mat *p_Tpp, mat *p_Tmm, mat *p_Rpm, mat *p_Rmp,
   ms_tmat_ij
 
   ms_partinv
+  ms_partsolve
+  ms_gmres
 
  RETURN VALUES:
 
@@ -166,7 +492,12 @@ int i_type, t_type, n_type;
 int n_atoms, i_atoms, j_atoms;
 int n_beams, k, l;
 int n_plane;
+int n_pairs, i_pair;            /* pairs of atoms (i_atoms < j_atoms) */
+int n_lsum, i_lsum;             /* interlayer lattice sums (ctx->lsij) */
+int n_blks, i_blk;              /* distinct interlayer propagators */
+long n_calls;
 
+double t_start;                 /* profiling (ctx->prof) */
 
 real d_ij[4];
 real faux_r, faux_i;
@@ -180,20 +511,22 @@ real *ptr_r, *ptr_i, *ptr_end;
 struct atom_str * atoms;        /* atomic positions and scattering properties */
 
 mat Ylm;                        /* spherical harmonics (for exit beams) */
-mat Llm_ij, Llm_ji;             /* interlayer lattice sums */
-mat Maux, Mbg, Mark;            /* dummy matrices */
+mat Llm_ii;                     /* Bravais lattice sum */
+mat Maux, Mbg;                  /* dummy matrices */
 mat L_p, L_m, R_p, R_m;         /* dummy matrices */
 
 mat Tpp, Tmm, Rpm, Rmp;         /* Layer diffraction matrices in k-space
                                    will be copied to output */
 mat * p_Tii;                    /* Array of Bravais layer scattering matrices */
 
+struct compl_pair_str *pairs, *pair;
+struct compl_blk_str *blks;
+struct compl_op_str mbg_op;     /* Mbg for MBG_GMRES */
+
  Ylm = NULL;
 
- Llm_ij = NULL;
- Llm_ji = NULL;
+ Llm_ii = NULL;
 
- Mark = NULL;
  Maux = NULL;
  Mbg = NULL;
 
@@ -273,10 +606,11 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
  z_min = z_max = (atoms+0)->pos[3];
  l_max = 1;
 
-#ifdef CONTROL
- fprintf(STDCTR,"(ms_compl_nd): z_min = z_max =%f n_atoms = %d\n",
-         z_min,n_atoms);
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(ms_compl_nd): z_min = z_max =%f n_atoms = %d\n",
+           z_min,n_atoms);
+ }
 
  for(i_atoms = 0; i_atoms < n_atoms; i_atoms ++)
  {
@@ -284,9 +618,10 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
 /* copy atom information */
    memcpy( atoms+i_atoms, layer->atoms+i_atoms, sizeof (struct atom_str) );
 
-#ifdef CONTROL
- fprintf(STDCTR,"(ms_compl_nd):atom%d  z = %.3f\n",i_atoms,(layer->atoms+i_atoms)->pos[3]);
-#endif
+   if(LOG_ON(LOG_MS, LOG_CONTROL))
+   {
+     fprintf(STDCTR,"(ms_compl_nd):atom%d  z = %.3f\n",i_atoms,(layer->atoms+i_atoms)->pos[3]);
+   }
 
 /* find n_type and z_min/z_max */
    n_type = MAX( (atoms+i_atoms)->type, n_type);
@@ -300,8 +635,8 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
    if(t_type == T_DIAG)
    {
      for( iaux = v_par->l_max;
-          (cri_abs( (v_par->p_tl[i_type])->rel[iaux+1],
-                    (v_par->p_tl[i_type])->iel[iaux+1] )
+          (cri_abs( (v_par->p_tl[i_type])->rel[2*(iaux+1)],
+                    (v_par->p_tl[i_type])->iel[2*(iaux+1)] )
           < v_par->epsilon ) && (iaux > 1);
           iaux --)
      {;}
@@ -313,10 +648,11 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
    l_max = MAX(l_max, iaux);
  }
 
-#ifdef CONTROL
- fprintf(STDCTR,"(ms_compl_nd): z_min = %f  z_max =%f lmax = %d\n",
-         z_min,z_max,l_max);
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(ms_compl_nd): z_min = %f  z_max =%f lmax = %d\n",
+           z_min,z_max,l_max);
+ }
 
  (atoms+n_atoms)->type = I_END_OF_LIST;   /* terminate list atoms */
  n_type ++;                               /* n_type = number of types */
@@ -327,11 +663,12 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
 */
  l_max_2 = (l_max+1)*(l_max+1);
 
-#ifdef CONTROL
- fprintf(STDCTR,"(ms_compl_nd): l_max = %d, No of beams = %d, No of atoms = %d\n",
-         l_max, n_beams, n_atoms);
- fprintf(STDCTR,"(ms_compl_nd): before sorting:\n");
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(ms_compl_nd): l_max = %d, No of beams = %d, No of atoms = %d\n",
+           l_max, n_beams, n_atoms);
+   fprintf(STDCTR,"(ms_compl_nd): before sorting:\n");
+ }
 
 /* (ii)a
    Find plane containing most atoms
@@ -354,18 +691,20 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
      n_plane = iaux;
      z_plane = (atoms+i_atoms)->pos[3];
    }
-#ifdef CONTROL
-   fprintf(STDCTR,"\t(%d) pos: (%5.2f,%5.2f,%5.2f) A type: %d\n",
-           i_atoms, (atoms+i_atoms)->pos[1]*BOHR,
-           (atoms+i_atoms)->pos[2]*BOHR, (atoms+i_atoms)->pos[3]*BOHR,
-           (atoms+i_atoms)->type);
-#endif
+   if(LOG_ON(LOG_MS, LOG_CONTROL))
+   {
+     fprintf(STDCTR,"\t(%d) pos: (%5.2f,%5.2f,%5.2f) A type: %d\n",
+             i_atoms, (atoms+i_atoms)->pos[1]*BOHR,
+             (atoms+i_atoms)->pos[2]*BOHR, (atoms+i_atoms)->pos[3]*BOHR,
+             (atoms+i_atoms)->type);
+   }
  }    /* for i_atoms */
 
-#ifdef CONTROL
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
    fprintf(STDCTR,"(ms_compl_nd): z_plane: %.4f, n_plane: %d\n",
            z_plane*BOHR, n_plane);
-#endif
+ }
 
 /* (ii)b
    Move atoms of the most populated plane to the front of atoms list
@@ -393,16 +732,17 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
    }  /* if R_fabs ... */
  }  /* for i_atoms */
 
-#ifdef CONTROL
- fprintf(STDCTR,"(ms_compl_nd): after sorting:\n");
- for(i_atoms = 0; i_atoms < n_atoms; i_atoms ++)
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
  {
-   fprintf(STDCTR,"\t(%d) pos: (%5.2f,%5.2f,%5.2f) A type: %d %d\n",
-           i_atoms, (atoms+i_atoms)->pos[1]*BOHR,
-           (atoms+i_atoms)->pos[2]*BOHR, (atoms+i_atoms)->pos[3]*BOHR,
-           (atoms+i_atoms)->type, (atoms+i_atoms)->t_type);
- }  /* for i_atoms */
-#endif
+   fprintf(STDCTR,"(ms_compl_nd): after sorting:\n");
+   for(i_atoms = 0; i_atoms < n_atoms; i_atoms ++)
+   {
+     fprintf(STDCTR,"\t(%d) pos: (%5.2f,%5.2f,%5.2f) A type: %d %d\n",
+             i_atoms, (atoms+i_atoms)->pos[1]*BOHR,
+             (atoms+i_atoms)->pos[2]*BOHR, (atoms+i_atoms)->pos[3]*BOHR,
+             (atoms+i_atoms)->type, (atoms+i_atoms)->t_type);
+   }  /* for i_atoms */
+ }
 
 /**********************************************************************
   Create Bravais layer scattering matrices Tii
@@ -432,24 +772,29 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
    }
  }
 
-#ifdef CONTROL_X
+ if(LOG_ON(LOG_MS, LOG_CONTROL_X))
+ {
    fprintf(STDCTR,"(ms_compl_nd):  Calculate Bravais lattice sum\n");
-#endif
+ }
 
 /* Calculate Bravais lattice sum (only once) */
- Llm_ij = ms_lsum_ii(Llm_ij, beams->k_r[0], beams->k_i[0],
+ t_start = prof_time(ctx->prof);
+ Llm_ii = ms_lsum_ii(ctx, Llm_ii, beams->k_r[0], beams->k_i[0],
                      v_par->k_in, layer->a_lat, 2 * l_max, v_par->epsilon );
+ prof_add(ctx->prof, PROF_LSUM, t_start, 1);
 
-#ifdef CONTROL_X
+ if(LOG_ON(LOG_MS, LOG_CONTROL_X))
+ {
    fprintf(STDCTR,"(ms_compl_nd):  Calculate scattering matrices\n");
-#endif
+ }
 
 /**********************************************************************
    Compute scattering matrices Tii[type] for Bravais lattices and store
    in p_Tii
 **********************************************************************/
 
- for(i_atoms = 0; i_atoms < n_atoms; i_atoms ++)
+ t_start = prof_time(ctx->prof);
+ for(i_atoms = 0, n_calls = 0; i_atoms < n_atoms; i_atoms ++)
  {
    i_type = (atoms+i_atoms)->type;
    t_type = (atoms+i_atoms)->t_type;
@@ -458,25 +803,27 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
 */
    if( p_Tii [i_type] == NULL )
    {
-#ifdef CONTROL
-     fprintf(STDCTR,"(ms_compl_nd):  before ms_tmat_ii (%d): i_type = %d",
-             i_atoms, i_type);
-     if(t_type == T_DIAG)
-       fprintf(STDCTR," t_type = %d (T_DIAG)\n", t_type);
-     else if(t_type == T_NOND)
-       fprintf(STDCTR," t_type = %d (T_NOND)\n", t_type);
-#endif
+     n_calls ++;
+     if(LOG_ON(LOG_MS, LOG_CONTROL))
+     {
+       fprintf(STDCTR,"(ms_compl_nd):  before ms_tmat_ii (%d): i_type = %d",
+               i_atoms, i_type);
+       if(t_type == T_DIAG)
+         fprintf(STDCTR," t_type = %d (T_DIAG)\n", t_type);
+       else if(t_type == T_NOND)
+         fprintf(STDCTR," t_type = %d (T_NOND)\n", t_type);
+     }
      if(t_type == T_DIAG)
      {
        p_Tii[i_type] =
-         ms_tmat_ii( p_Tii[i_type], Llm_ij, v_par->p_tl[i_type], l_max);
+         ms_tmat_ii( ctx, p_Tii[i_type], Llm_ii, v_par->p_tl[i_type], l_max);
        p_Tii[i_type] =
          mattrans(p_Tii [i_type], p_Tii [i_type]);
      }
      else if(t_type == T_NOND)
      {
        p_Tii[i_type] =
-         ms_tmat_nd_ii( p_Tii[i_type], Llm_ij, v_par->p_tl[i_type], l_max);
+         ms_tmat_nd_ii( ctx, p_Tii[i_type], Llm_ii, v_par->p_tl[i_type], l_max);
      }
      else
      {
@@ -494,129 +841,236 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
 
 /* Multiply matrix elements of Tii[type] with -1/2k0 */
      cri_div(&faux_r, &faux_i, -0.5, 0., beams->k_r[0], beams->k_i[0]);
-     for(ptr_r = (p_Tii[i_type])->rel + 1, ptr_i = (p_Tii[i_type])->iel + 1,
+     for(ptr_r = (p_Tii[i_type])->rel + 2, ptr_i = (p_Tii[i_type])->iel + 2,
          ptr_end = (p_Tii[i_type])->rel +
-                   (p_Tii[i_type])->cols * (p_Tii[i_type])->rows;
-         ptr_r <= ptr_end; ptr_r ++, ptr_i ++)
+                   2 * (p_Tii[i_type])->cols * (p_Tii[i_type])->rows;
+         ptr_r <= ptr_end; ptr_r += 2, ptr_i += 2)
      { cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i); }
 
    } /* if == NULL */
  } /* for i_atoms */
+ prof_add(ctx->prof, PROF_TMAT, t_start, n_calls);
+
+ matfree(Llm_ii);
 
 /**********************************************************************
   Giant Matrix Inversion
   - Allocate giant matrix Mbg to be inverted.
-  - Create interlayer propagators Gij/Gji (Maux)
-  - Calculate -Tii * Gij and -Tjj * Gji and copy into Mbg.
-  - Add identity to Mbg and invert giant matrix.
-  - free storage space for interlayer lattice sums.
+  - Find the distinct interlayer vectors d_ij = rj - ri of all pairs of
+    atoms and calculate the lattice sums of those which are not stored
+    in ctx->lsij yet (in parallel).
+  - Create the distinct interlayer propagators Tjj * Gji and Tii * Gij
+    (in parallel) and copy them into Mbg.
+  - Add identity to Mbg and invert giant matrix (MBG_INV only).
+  - For MBG_GMRES, Mbg is not set up; the propagators are kept for the
+    products with Mbg (compl_mbg_op).
 **********************************************************************/
 
- iaux = l_max_2 * n_atoms;
- Mbg  = matalloc(Mbg, iaux, iaux, NUM_COMPLEX);
- Mark = matalloc(Mark, n_atoms, n_atoms, NUM_REAL);
-
- for(i_atoms = 0, off_row = 1; i_atoms < n_atoms;
-     i_atoms ++, off_row += l_max_2)
+ if(v_par->mbg_solver != MBG_GMRES)
  {
-   for(j_atoms = i_atoms + 1, off_col = off_row + l_max_2;
-       j_atoms < n_atoms;
-       j_atoms ++, off_col += l_max_2)
-   if( RMATEL(i_atoms+1, j_atoms+1, Mark) != 1.)
-   {
-/* d_ij = vector rj - ri */
-     d_ij[1] = (atoms+j_atoms)->pos[1] - (atoms+i_atoms)->pos[1];
-     d_ij[2] = (atoms+j_atoms)->pos[2] - (atoms+i_atoms)->pos[2];
-     d_ij[3] = (atoms+j_atoms)->pos[3] - (atoms+i_atoms)->pos[3];
+   iaux = l_max_2 * n_atoms;
+   Mbg  = matalloc(Mbg, iaux, iaux, NUM_COMPLEX);
+ }
 
-#ifdef CONTROL
-   fprintf(STDCTR,"(ms_compl_nd): d(%d->%d) = (%5.2f, %5.2f, %5.2f) A\n",
-           i_atoms, j_atoms, d_ij[1]*BOHR, d_ij[2]*BOHR, d_ij[3]*BOHR);
+ n_pairs = n_atoms * (n_atoms - 1) / 2;
+ pairs = (struct compl_pair_str *)
+         malloc( MAX(n_pairs, 1) * sizeof(struct compl_pair_str) );
+ blks  = (struct compl_blk_str *)
+         malloc( MAX(n_pairs, 1) * sizeof(struct compl_blk_str) );
+ if( (pairs == NULL) || (blks == NULL) )
+ {
+#ifdef ERROR
+   fprintf(STDERR,"*** error (ms_compl_nd): Allocation error for pairs\n");
 #endif
-
-     ms_lsum_ij ( &Llm_ij, &Llm_ji, beams->k_r[0], beams->k_i[0],
-                  v_par->k_in, layer->a_lat, d_ij, 2 * l_max, v_par->epsilon );
-#ifdef CONTROL_LSUM
-     fprintf(STDCTR,"(ms_compl_nd): Lij\n");
-     Maux = mattrans(Maux, Llm_ij);
-     matshow(Maux);
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(-1);
 #endif
+ }
+
 /*
-   Copy matrix Tjj * Gji to position (j,i) = (off_col,off_row)
-    and matrix Tii * Gij to position (i,j) = (off_row,off_col)
+   (i) Canonical interlayer vectors:
+   A vector d_ij and its inverse -d_ij share one entry of ctx->lsij, since
+   ms_lsum_ij calculates the lattice sums for both (Llm_p and Llm_m):
+     Gij(d_ij) from Llm_p, Gji(d_ij) from Llm_m  (flip = 0),
+     Gij(d_ij) from Llm_m, Gji(d_ij) from Llm_p  (flip = 1).
+   Pairs with the same entry and the same atom types have the same
+   propagators (blks).
 */
-     Maux = ms_tmat_ij( Maux, Llm_ij,
-                        p_Tii[(atoms+j_atoms)->type], l_max);
-     Mbg  = matins(Mbg, Maux, off_col, off_row);
+ compl_lsij_key(&ctx->lsij, beams->k_r[0], beams->k_i[0],
+                v_par->k_in, layer->a_lat, 2 * l_max, v_par->epsilon);
+ n_lsum = ctx->lsij.n_entries;
+ n_blks = 0;
+
+ for(i_atoms = 0, i_pair = 0; i_atoms < n_atoms; i_atoms ++)
+ for(j_atoms = i_atoms + 1; j_atoms < n_atoms; j_atoms ++, i_pair ++)
+ {
+/* d_ij = vector rj - ri */
+   d_ij[1] = (atoms+j_atoms)->pos[1] - (atoms+i_atoms)->pos[1];
+   d_ij[2] = (atoms+j_atoms)->pos[2] - (atoms+i_atoms)->pos[2];
+   d_ij[3] = (atoms+j_atoms)->pos[3] - (atoms+i_atoms)->pos[3];
+
+   pair = pairs + i_pair;
+   pair->i_atoms = i_atoms;
+   pair->j_atoms = j_atoms;
+   pair->i_lsum = compl_lsij_find(&ctx->lsij, d_ij, &pair->flip);
+
+   if(pair->flip == 0)
+   {
+     i_type = (atoms+j_atoms)->type;
+     t_type = (atoms+i_atoms)->type;
+   }
+   else
+   {
+     i_type = (atoms+i_atoms)->type;
+     t_type = (atoms+j_atoms)->type;
+   }
+
+   for(i_blk = 0; i_blk < n_blks; i_blk ++)
+   {
+     if( (blks[i_blk].i_lsum == pair->i_lsum) &&
+         (blks[i_blk].type_p == i_type) && (blks[i_blk].type_m == t_type) )
+       break;
+   }
+   if(i_blk == n_blks)
+   {
+     blks[i_blk].i_lsum = pair->i_lsum;
+     blks[i_blk].type_p = i_type;
+     blks[i_blk].type_m = t_type;
+     blks[i_blk].G_p = blks[i_blk].G_m = NULL;
+     n_blks ++;
+   }
+   pair->i_blk = i_blk;
+
+   if(LOG_ON(LOG_MS, LOG_CONTROL))
+   {
+     fprintf(STDCTR,"(ms_compl_nd): d(%d->%d) = (%5.2f, %5.2f, %5.2f) A"
+             " -> lsum %d%s\n", i_atoms, j_atoms,
+             d_ij[1]*BOHR, d_ij[2]*BOHR, d_ij[3]*BOHR,
+             pair->i_lsum, (pair->flip)?" (inverse)":"");
+   }
+ } /* for i_atoms, j_atoms */
 
-     Maux = ms_tmat_ij( Maux, Llm_ji,
-                        p_Tii[(atoms+i_atoms)->type], l_max);
-     Mbg  = matins(Mbg, Maux, off_row, off_col);
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(ms_compl_nd): %d pairs, %d lattice sums (%d new), "
+           "%d propagators\n", n_pairs, ctx->lsij.n_entries,
+           ctx->lsij.n_entries - n_lsum, n_blks);
+ }
 
 /*
-   - Mark the positions in Mark.
-   - Check for other occurences of the same interlayer vector
+   (ii) Lattice sums of the new interlayer vectors and propagators
+   (the C.G. coefficients must not be recalculated inside the loop).
 */
+ ctx_cg_coef(ctx, l_max);
 
-     RMATEL(i_atoms+1, j_atoms+1, Mark) = 1.;
-     RMATEL(j_atoms+1, i_atoms+1, Mark) = 1.;
+ t_start = prof_time(ctx->prof);
+#pragma omp parallel for schedule(dynamic,1) num_threads(ctx->n_threads) \
+        if(ctx->n_threads > 1)
+ for(i_lsum = n_lsum; i_lsum < ctx->lsij.n_entries; i_lsum ++)
+ {
+   ms_lsum_ij ( ctx, ctx->lsij.Llm_p + i_lsum, ctx->lsij.Llm_m + i_lsum,
+                beams->k_r[0], beams->k_i[0], v_par->k_in, layer->a_lat,
+                ctx->lsij.d_ij + 4*i_lsum, 2 * l_max, v_par->epsilon );
+#ifdef CONTROL_LSUM
+   fprintf(STDCTR,"(ms_compl_nd): Lij (%d)\n", i_lsum);
+   matshow(ctx->lsij.Llm_p[i_lsum]);
+#endif
+ }
+ prof_add(ctx->prof, PROF_LSUM, t_start, ctx->lsij.n_entries - n_lsum);
+
+ t_start = prof_time(ctx->prof);
+#pragma omp parallel for schedule(dynamic,1) num_threads(ctx->n_threads) \
+        if(ctx->n_threads > 1)
+ for(i_blk = 0; i_blk < n_blks; i_blk ++)
+ {
+   blks[i_blk].G_p = ms_tmat_ij( ctx, NULL,
+                                 ctx->lsij.Llm_p[blks[i_blk].i_lsum],
+                                 p_Tii[blks[i_blk].type_p], l_max);
+   blks[i_blk].G_m = ms_tmat_ij( ctx, NULL,
+                                 ctx->lsij.Llm_m[blks[i_blk].i_lsum],
+                                 p_Tii[blks[i_blk].type_m], l_max);
+ }
+ prof_add(ctx->prof, PROF_TMAT, t_start, 2*n_blks);
 
-     for( k = i_atoms + 1; k < n_atoms; k ++)
-     for( l = i_atoms + 1; l < n_atoms; l ++)
-     {
-      if( (R_fabs((atoms+l)->pos[1]-(atoms+k)->pos[1]-d_ij[1]) < GEO_TOLERANCE)
-       && (R_fabs((atoms+l)->pos[2]-(atoms+k)->pos[2]-d_ij[2]) < GEO_TOLERANCE)
-       && (R_fabs((atoms+l)->pos[3]-(atoms+k)->pos[3]-d_ij[3]) < GEO_TOLERANCE))
-       {
 /*
-         Maux = matmul(Maux, p_Tii[(atoms+k)->type] , Maux1);
-         Mbg  = matins(Mbg, Maux, k*l_max_2+1, l*l_max_2+1);
-         Maux = matmul(Maux, p_Tii[(atoms+l)->type] , Maux2);
-         Mbg  = matins(Mbg, Maux, l*l_max_2+1, k*l_max_2+1);
-         RMATEL(k+1, l+1, Mark) = 1.;
-         RMATEL(l+1, k+1, Mark) = 1.;
+   (iii) Copy matrix Tjj * Gji to position (j,i) = (off_col,off_row)
+    and matrix Tii * Gij to position (i,j) = (off_row,off_col)
 */
-         ;
-#ifdef CONTROL
-       fprintf(STDCTR,"(ms_compl_nd):         = d(%d->%d)\n", k, l);
-#endif
-       } /* if R_fabs ... */
-     } /* for k,l */
-   } /* for j_atoms / if not marked */
- } /* for i_atoms */
+ if(v_par->mbg_solver == MBG_GMRES)
+ {
+   mbg_op.n_atoms = n_atoms;
+   mbg_op.l_max_2 = l_max_2;
+   mbg_op.n_pairs = n_pairs;
+   mbg_op.pairs = pairs;
+   mbg_op.blks = blks;
+   compl_mbg_planes(&mbg_op, atoms);
+ }
+ else
+ {
+   for(i_pair = 0; i_pair < n_pairs; i_pair ++)
+   {
+     pair = pairs + i_pair;
+     off_row = pair->i_atoms * l_max_2 + 1;
+     off_col = pair->j_atoms * l_max_2 + 1;
+
+     if(pair->flip == 0)
+     {
+       Mbg = matins(Mbg, blks[pair->i_blk].G_p, off_col, off_row);
+       Mbg = matins(Mbg, blks[pair->i_blk].G_m, off_row, off_col);
+     }
+     else
+     {
+       Mbg = matins(Mbg, blks[pair->i_blk].G_m, off_col, off_row);
+       Mbg = matins(Mbg, blks[pair->i_blk].G_p, off_row, off_col);
+     }
+   }
 
- matfree(Llm_ij);
- matfree(Llm_ji);
- matfree(Mark);
+   for(i_blk = 0; i_blk < n_blks; i_blk ++)
+   {
+     matfree(blks[i_blk].G_p);
+     matfree(blks[i_blk].G_m);
+   }
+   free(blks);
+   free(pairs);
 
 /* Add identity to Mbg */
- for(ptr_r = Mbg->rel+1, ptr_end = Mbg->rel + Mbg->cols*Mbg->rows;
-     ptr_r <= ptr_end; ptr_r += Mbg->cols +1)
-   *ptr_r += 1.;
-
-#ifdef CONTROL
-   fprintf(STDCTR,
-   "(ms_compl_nd): giant matrix inversion (%d x %d), E = %.1f eV ...\n",
-   Mbg->cols, Mbg->rows, v_par->eng_v*HART);
-#endif
+   for(ptr_r = Mbg->rel+2, ptr_end = Mbg->rel + 2*Mbg->cols*Mbg->rows;
+       ptr_r <= ptr_end; ptr_r += 2*(Mbg->cols +1))
+     *ptr_r += 1.;
 
 #ifdef CONTROL_MBG
    matnattovht(Mbg, l_max, n_atoms);
 #endif
+ }
+
+ if(v_par->mbg_solver == MBG_INV)
+ {
+   if(LOG_ON(LOG_MS, LOG_CONTROL))
+   {
+     fprintf(STDCTR,
+     "(ms_compl_nd): giant matrix inversion (%d x %d), E = %.1f eV ...\n",
+     Mbg->cols, Mbg->rows, v_par->eng_v*HART);
+   }
 
- CTIME("(ms_compl_nd): before giant matrix inversion");
+   CTIME("(ms_compl_nd): before giant matrix inversion");
 
- Mbg = ms_partinv(Mbg, Mbg, n_plane, l_max);
+   t_start = prof_time(ctx->prof);
+   Mbg = ms_partinv(Mbg, Mbg, n_plane, l_max);
+   prof_add(ctx->prof, PROF_MBG, t_start, 1);
 
 /*  ALTERNATIVES
- Mbg = matinv(Mbg, Mbg);
- Mbg = ms_partinv(Mbg, Mbg, n_plane, l_max);
+   Mbg = matinv(Mbg, Mbg);
+   Mbg = ms_partinv(Mbg, Mbg, n_plane, l_max);
 */
 
-#ifdef CONTROL
-   fprintf(STDCTR,"(ms_compl_nd): ... completed\n");
-#endif
- CTIME("(ms_compl_nd): after giant matrix inversion");
+   if(LOG_ON(LOG_MS, LOG_CONTROL))
+   {
+     fprintf(STDCTR,"(ms_compl_nd): ... completed\n");
+   }
+   CTIME("(ms_compl_nd): after giant matrix inversion");
+ }
 
 /**********************************************************************
   Prepare matrices for conversion into plane waves:
@@ -639,14 +1093,15 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
 
  pref_i = -16.*PI*PI / layer->rel_area;
 
-#ifdef CONTROL
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
    fprintf(STDCTR,"(ms_compl_nd): relative u.c. area: %.3f\n", layer->rel_area);
-#endif
+ }
 
 
 /* calculate spherical harmonics Ylm */
 
- Ylm = ms_ymat(Ylm, l_max, beams, n_beams);
+ Ylm = ms_ymat(ctx, Ylm, l_max, beams, n_beams);
 
 /* allocate storage space (Ylm->rows = number of beams) */
  iaux = l_max_2 * n_atoms;
@@ -657,10 +1112,11 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
  R_m = matalloc(R_m, iaux, n_beams, NUM_COMPLEX);
 
 
-#ifdef CONTROL
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
    fprintf(STDCTR,"(ms_compl_nd): Prepare matrices R_x and L_x (%d x %d)\n",
            n_beams, iaux);
-#endif
+ }
 
  for(i_atoms = 0; i_atoms < n_atoms; i_atoms ++)
  {
@@ -680,10 +1136,10 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
               +(beams+k)->k_r[3] * (atoms+i_atoms)->pos[3];
      faux_i = +(beams+k)->k_i[3] * (atoms+i_atoms)->pos[3];
      cri_expi(&faux_r, &faux_i, faux_r, faux_i);
-     for(ptr_r = Maux->rel + k + 1,
-         ptr_i = Maux->iel + k + 1,
-         ptr_end = Maux->rel + Maux->cols*Maux->rows;
-         ptr_r <= ptr_end; ptr_r += Maux->cols, ptr_i += Maux->cols)
+     for(ptr_r = Maux->rel + 2*(k + 1),
+         ptr_i = Maux->iel + 2*(k + 1),
+         ptr_end = Maux->rel + 2*Maux->cols*Maux->rows;
+         ptr_r <= ptr_end; ptr_r += 2*Maux->cols, ptr_i += 2*Maux->cols)
      { cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i); }
    } /* k */
 
@@ -711,10 +1167,10 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
               -(beams+k)->k_r[3] * (atoms+i_atoms)->pos[3];
      faux_i = -(beams+k)->k_i[3] * (atoms+i_atoms)->pos[3];
      cri_expi(&faux_r, &faux_i, faux_r, faux_i);
-     for(ptr_r = Maux->rel + k + 1,
-         ptr_i = Maux->iel + k + 1,
-         ptr_end = Maux->rel + Maux->cols*Maux->rows;
-         ptr_r <= ptr_end; ptr_r += Maux->cols, ptr_i += Maux->cols)
+     for(ptr_r = Maux->rel + 2*(k + 1),
+         ptr_i = Maux->iel + 2*(k + 1),
+         ptr_end = Maux->rel + 2*Maux->cols*Maux->rows;
+         ptr_r <= ptr_end; ptr_r += 2*Maux->cols, ptr_i += 2*Maux->cols)
      { cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i); }
    } /* k */
 
@@ -739,10 +1195,10 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
              (beams+k)->Akz_r, (beams+k)->Akz_i);
      cri_mul (&faux_r, &faux_i, faux_r, faux_i, 0., pref_i);
 
-     for(ptr_r = Maux->rel + k*Maux->cols + 1,
-         ptr_i = Maux->iel + k*Maux->cols + 1,
-         ptr_end = ptr_r + Maux->cols;
-         ptr_r < ptr_end; ptr_r ++,  ptr_i ++)
+     for(ptr_r = Maux->rel + 2*(k*Maux->cols + 1),
+         ptr_i = Maux->iel + 2*(k*Maux->cols + 1),
+         ptr_end = ptr_r + 2*Maux->cols;
+         ptr_r < ptr_end; ptr_r += 2,  ptr_i += 2)
      { cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i); }
    } /* k */
 
@@ -774,10 +1230,10 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
              (beams+k)->Akz_r, (beams+k)->Akz_i);
      cri_mul (&faux_r, &faux_i, faux_r, faux_i, 0., pref_i);
 
-     for(ptr_r = Maux->rel + k*Maux->cols + 1,
-         ptr_i = Maux->iel + k*Maux->cols + 1,
-         ptr_end = ptr_r + Maux->cols;
-         ptr_r < ptr_end; ptr_r ++,  ptr_i ++)
+     for(ptr_r = Maux->rel + 2*(k*Maux->cols + 1),
+         ptr_i = Maux->iel + 2*(k*Maux->cols + 1),
+         ptr_end = ptr_r + 2*Maux->cols;
+         ptr_r < ptr_end; ptr_r += 2,  ptr_i += 2)
      { cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i); }
    } /* k */
 
@@ -789,25 +1245,88 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
  matfree(Ylm);
 
 /**********************************************************************
- Multiply matrices: L*Mbg*R
+ Solve Mbg * X = (R_p R_m) and multiply: L*X
+ (both right hand sides with one decomposition of Mbg or in one
+ iteration) or, for MBG_INV, multiply L*Mbg*R.
 **********************************************************************/
 
- Maux = matmul(Maux, Mbg, R_p);
- Tpp = matmul(Tpp, L_p, Maux);
- Rmp = matmul(Rmp, L_m, Maux);
+ if(v_par->mbg_solver == MBG_INV)
+ {
+   Maux = matmul(Maux, Mbg, R_p);
+   Tpp = matmul(Tpp, L_p, Maux);
+   Rmp = matmul(Rmp, L_m, Maux);
 
- Maux = matmul(Maux, Mbg, R_m);
- Tmm = matmul(Tmm, L_m, Maux);
- Rpm = matmul(Rpm, L_p, Maux);
+   Maux = matmul(Maux, Mbg, R_m);
+   Tmm = matmul(Tmm, L_m, Maux);
+   Rpm = matmul(Rpm, L_p, Maux);
 
- CTIME("(ms_compl_nd): after multiplication R * Mbg * L");
+   CTIME("(ms_compl_nd): after multiplication R * Mbg * L");
+ }
+ else
+ {
+   Maux = matalloc(Maux, R_p->rows, 2*n_beams, NUM_COMPLEX);
+   Maux = matins(Maux, R_p, 1, 1);
+   Maux = matins(Maux, R_m, 1, n_beams+1);
 
-#ifdef CONTROL
-   fprintf(STDCTR,"(ms_compl_nd): ... completed\n");
+   CTIME("(ms_compl_nd): before giant matrix solution");
+   t_start = prof_time(ctx->prof);
+   if(v_par->mbg_solver == MBG_GMRES)
+   {
+     iaux = ms_gmres(&R_p, Maux, compl_mbg_op, compl_mbg_prec, &mbg_op,
+                     v_par->mbg_tol, MBG_MAX_ITER);
+     if(LOG_ON(LOG_MS, LOG_CONTROL))
+     {
+       fprintf(STDCTR,"(ms_compl_nd): GMRES (%d x %d, %d right hand sides)"
+               ": %d iterations, E = %.1f eV\n", R_p->rows, R_p->rows,
+               2*n_beams, abs(iaux), v_par->eng_v*HART);
+     }
+#ifdef WARNING
+     if(iaux < 0)
+       fprintf(STDWAR," * warning (ms_compl_nd): GMRES did not converge "
+               "within %d iterations (E = %.1f eV)\n",
+               -iaux, v_par->eng_v*HART);
 #endif
+     if(ctx->prof != NULL) ctx->prof->mbg_iter += abs(iaux);
+   }
+   else
+     R_p = ms_partsolve(R_p, Mbg, Maux, n_plane, l_max);
+   prof_add(ctx->prof, PROF_MBG, t_start, 1);
+   CTIME("(ms_compl_nd): after giant matrix solution");
+
+   Maux = matmul(Maux, L_p, R_p);
+   Tpp = matext(Tpp, Maux, 1, n_beams, 1, n_beams);
+   Rpm = matext(Rpm, Maux, 1, n_beams, n_beams+1, 2*n_beams);
+
+   Maux = matmul(Maux, L_m, R_p);
+   Rmp = matext(Rmp, Maux, 1, n_beams, 1, n_beams);
+   Tmm = matext(Tmm, Maux, 1, n_beams, n_beams+1, 2*n_beams);
+
+   CTIME("(ms_compl_nd): after multiplication L * X");
+ }
+
+ if(v_par->mbg_solver == MBG_GMRES)
+ {
+   for(i_blk = 0; i_blk < n_blks; i_blk ++)
+   {
+     matfree(blks[i_blk].G_p);
+     matfree(blks[i_blk].G_m);
+   }
+   for(i_blk = 0; i_blk < mbg_op.n_planes; i_blk ++)
+     if(mbg_op.P_inv[i_blk] != NULL) matfree(mbg_op.P_inv[i_blk]);
+   free(mbg_op.P_inv);
+   free(mbg_op.plane_atoms);
+   free(mbg_op.plane_off);
+   free(blks);
+   free(pairs);
+ }
+
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(ms_compl_nd): ... completed\n");
+ }
 
  matfree(Maux);
- matfree(Mbg);
+ if(Mbg != NULL) matfree(Mbg);
 
 /**********************************************************************
  Extrapolation of origin and Prefactor:
@@ -843,9 +1362,10 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
   - reuse R_p/m
 **********************************************************************/
 
-#ifdef CONTROL
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
    fprintf(STDCTR,"(ms_compl_nd): origin shift ... \n");
-#endif
+ }
 
  L_p = matalloc(L_p, 1, n_beams, NUM_COMPLEX);
  L_m = matalloc(L_m, 1, n_beams, NUM_COMPLEX);
@@ -862,17 +1382,17 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
 
    faux_r = +(beams+k)->k_r[3] * z_max;
    faux_i = +(beams+k)->k_i[3] * z_max;
-   cri_expi(R_m->rel+k+1, R_m->iel+k+1, faux_r, faux_i);
-   L_p->rel[k+1] = R_m->rel[k+1];
-   L_p->iel[k+1] = R_m->iel[k+1];
+   cri_expi(R_m->rel+2*(k+1), R_m->iel+2*(k+1), faux_r, faux_i);
+   L_p->rel[2*(k+1)] = R_m->rel[2*(k+1)];
+   L_p->iel[2*(k+1)] = R_m->iel[2*(k+1)];
 
 /* R_p (exp[- ik(+)zmin) = L_m (exp[+ ik(-)zmin) */
 
    faux_r = -(beams+k)->k_r[3] * z_min;
    faux_i = -(beams+k)->k_i[3] * z_min;
-   cri_expi(R_p->rel+k+1, R_p->iel+k+1, faux_r, faux_i);
-   L_m->rel[k+1] = R_p->rel[k+1];
-   L_m->iel[k+1] = R_p->iel[k+1];
+   cri_expi(R_p->rel+2*(k+1), R_p->iel+2*(k+1), faux_r, faux_i);
+   L_m->rel[2*(k+1)] = R_p->rel[2*(k+1)];
+   L_m->iel[2*(k+1)] = R_p->iel[2*(k+1)];
 
  } /* k */
 
@@ -885,56 +1405,56 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
   Tpp
 */
  for(k = 1; k <= Tpp->rows; k++)         /* loop over row No's (1st index) */
-   for(ptr_r = Tpp->rel + (k-1)*Tpp->cols + 1,
-       ptr_i = Tpp->iel + (k-1)*Tpp->cols + 1,
-       ptr_end = ptr_r + Tpp->cols, l = 1;
+   for(ptr_r = Tpp->rel + 2*((k-1)*Tpp->cols + 1),
+       ptr_i = Tpp->iel + 2*((k-1)*Tpp->cols + 1),
+       ptr_end = ptr_r + 2*Tpp->cols, l = 1;
        ptr_r < ptr_end;
-       ptr_r ++, ptr_i ++, l ++)         /* loop over col No's (2nd index) */
+       ptr_r += 2, ptr_i += 2, l ++)     /* loop over col No's (2nd index) */
    {
-     cri_mul(ptr_r, ptr_i, *(L_p->rel+k), *(L_p->iel+k), *ptr_r, *ptr_i);
-     cri_mul(ptr_r, ptr_i, *(R_p->rel+l), *(R_p->iel+l), *ptr_r, *ptr_i);
+     cri_mul(ptr_r, ptr_i, *(L_p->rel+2*k), *(L_p->iel+2*k), *ptr_r, *ptr_i);
+     cri_mul(ptr_r, ptr_i, *(R_p->rel+2*l), *(R_p->iel+2*l), *ptr_r, *ptr_i);
    }
 
 /*
   Tmm
 */
  for(k = 1; k <= Tmm->rows; k++)         /* loop over row No's (1st index) */
-   for(ptr_r = Tmm->rel + (k-1)*Tmm->cols + 1,
-       ptr_i = Tmm->iel + (k-1)*Tmm->cols + 1,
-       ptr_end = ptr_r + Tmm->cols, l = 1;
+   for(ptr_r = Tmm->rel + 2*((k-1)*Tmm->cols + 1),
+       ptr_i = Tmm->iel + 2*((k-1)*Tmm->cols + 1),
+       ptr_end = ptr_r + 2*Tmm->cols, l = 1;
        ptr_r < ptr_end;
-       ptr_r ++, ptr_i ++, l ++)         /* loop over col No's (2nd index) */
+       ptr_r += 2, ptr_i += 2, l ++)     /* loop over col No's (2nd index) */
    {
-     cri_mul(ptr_r, ptr_i, *(L_m->rel+k), *(L_m->iel+k), *ptr_r, *ptr_i);
-     cri_mul(ptr_r, ptr_i, *(R_m->rel+l), *(R_m->iel+l), *ptr_r, *ptr_i);
+     cri_mul(ptr_r, ptr_i, *(L_m->rel+2*k), *(L_m->iel+2*k), *ptr_r, *ptr_i);
+     cri_mul(ptr_r, ptr_i, *(R_m->rel+2*l), *(R_m->iel+2*l), *ptr_r, *ptr_i);
    }
 
 /*
   Rpm
 */
  for(k = 1; k <= Rpm->rows; k++)         /* loop over row No's (1st index) */
-   for(ptr_r = Rpm->rel + (k-1)*Rpm->cols + 1,
-       ptr_i = Rpm->iel + (k-1)*Rpm->cols + 1,
-       ptr_end = ptr_r + Rpm->cols, l = 1;
+   for(ptr_r = Rpm->rel + 2*((k-1)*Rpm->cols + 1),
+       ptr_i = Rpm->iel + 2*((k-1)*Rpm->cols + 1),
+       ptr_end = ptr_r + 2*Rpm->cols, l = 1;
        ptr_r < ptr_end;
-       ptr_r ++, ptr_i ++, l ++)         /* loop over col No's (2nd index) */
+       ptr_r += 2, ptr_i += 2, l ++)     /* loop over col No's (2nd index) */
    {
-     cri_mul(ptr_r, ptr_i, *(L_p->rel+k), *(L_p->iel+k), *ptr_r, *ptr_i);
-     cri_mul(ptr_r, ptr_i, *(R_m->rel+l), *(R_m->iel+l), *ptr_r, *ptr_i);
+     cri_mul(ptr_r, ptr_i, *(L_p->rel+2*k), *(L_p->iel+2*k), *ptr_r, *ptr_i);
+     cri_mul(ptr_r, ptr_i, *(R_m->rel+2*l), *(R_m->iel+2*l), *ptr_r, *ptr_i);
    }
 
 /*
   Rmp
 */
  for(k = 1; k <= Rmp->rows; k++)         /* loop over row No's (1st index) */
-   for(ptr_r = Rmp->rel + (k-1)*Rmp->cols + 1,
-       ptr_i = Rmp->iel + (k-1)*Rmp->cols + 1,
-       ptr_end = ptr_r + Rmp->cols, l = 1;
+   for(ptr_r = Rmp->rel + 2*((k-1)*Rmp->cols + 1),
+       ptr_i = Rmp->iel + 2*((k-1)*Rmp->cols + 1),
+       ptr_end = ptr_r + 2*Rmp->cols, l = 1;
        ptr_r < ptr_end;
-       ptr_r ++, ptr_i ++, l ++)         /* loop over col No's (2nd index) */
+       ptr_r += 2, ptr_i += 2, l ++)     /* loop over col No's (2nd index) */
    {
-     cri_mul(ptr_r, ptr_i, *(L_m->rel+k), *(L_m->iel+k), *ptr_r, *ptr_i);
-     cri_mul(ptr_r, ptr_i, *(R_p->rel+l), *(R_p->iel+l), *ptr_r, *ptr_i);
+     cri_mul(ptr_r, ptr_i, *(L_m->rel+2*k), *(L_m->iel+2*k), *ptr_r, *ptr_i);
+     cri_mul(ptr_r, ptr_i, *(R_p->rel+2*l), *(R_p->iel+2*l), *ptr_r, *ptr_i);
    }
 
 /*
@@ -946,7 +1466,8 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
  {
 /* exp[-ikz(+) * (zn - z1)] */
    cri_mul(&faux_r, &faux_i,
-           L_p->rel[k+1], L_p->iel[k+1], R_p->rel[k+1], R_p->iel[k+1]);
+           L_p->rel[2*(k+1)], L_p->iel[2*(k+1)],
+           R_p->rel[2*(k+1)], R_p->iel[2*(k+1)]);
 
 #ifdef CONTROL_XX
    pref_r = cri_abs(faux_r, faux_i);
@@ -954,15 +1475,16 @@ fprintf(STDERR," *** error (ms_compl_nd): invalid input matrix (4th argument)\n"
                     k, faux_r, faux_i, pref_r);
 #endif
 
-   *(Tmm->rel+iaux) += faux_r;
-   *(Tmm->iel+iaux) += faux_i;
-   *(Tpp->rel+iaux) += faux_r;
-   *(Tpp->iel+iaux) += faux_i;
+   *(Tmm->rel+2*iaux) += faux_r;
+   *(Tmm->iel+2*iaux) += faux_i;
+   *(Tpp->rel+2*iaux) += faux_r;
+   *(Tpp->iel+2*iaux) += faux_i;
  }
 
-#ifdef CONTROL
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
    fprintf(STDCTR,"(ms_compl_nd): ... completed\n");
-#endif
+ }
 
 /**********************************************************************
  Free dummy matrices and copy results to p_R/T**
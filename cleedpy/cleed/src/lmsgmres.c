@@ -0,0 +1,405 @@
+/*********************************************************************
+  file contains functions:
+
+  ms_gmres
+
+    Solve a system of linear equations with several right hand sides
+    iteratively (restarted GMRES).
+
+*********************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "leed.h"
+
+/*
+#define CONTROL
+*/
+#define ERROR
+
+#define EXIT_ON_ERROR
+
+#define GMRES_RESTART 30        /* max. dimension of the Krylov space */
+
+/*======================================================================*/
+/*======================================================================*/
+
+/*
+  Column norms of the complex n x k matrix M: norm[c] = |M(.,c)|
+*/
+static void gmres_norm(real *norm, mat M)
+{
+int r, c, k;
+real *ptr;
+
+ k = M->cols;
+ for(c = 0; c < k; c ++) norm[c] = 0.;
+ for(r = 0, ptr = M->rel + 2; r < M->rows; r ++)
+   for(c = 0; c < k; c ++, ptr += 2)
+     norm[c] += ptr[0]*ptr[0] + ptr[1]*ptr[1];
+ for(c = 0; c < k; c ++) norm[c] = R_sqrt(norm[c]);
+}
+
+/*
+  M(.,c) = M(.,c) * fac[c] (real factors)
+*/
+static void gmres_scale(mat M, real *fac)
+{
+int r, c, k;
+real *ptr;
+
+ k = M->cols;
+ for(r = 0, ptr = M->rel + 2; r < M->rows; r ++)
+   for(c = 0; c < k; c ++, ptr += 2)
+   {
+     ptr[0] *= fac[c];
+     ptr[1] *= fac[c];
+   }
+}
+
+/*
+  Column dot products dot[c] = V(.,c)^+ * W(.,c) (complex, interleaved)
+*/
+static void gmres_dot(real *dot, mat V, mat W)
+{
+int r, c, k;
+real *ptr_v, *ptr_w;
+
+ k = V->cols;
+ for(c = 0; c < 2*k; c ++) dot[c] = 0.;
+ for(r = 0, ptr_v = V->rel + 2, ptr_w = W->rel + 2; r < V->rows; r ++)
+   for(c = 0; c < k; c ++, ptr_v += 2, ptr_w += 2)
+   {
+     dot[2*c]   += ptr_v[0]*ptr_w[0] + ptr_v[1]*ptr_w[1];
+     dot[2*c+1] += ptr_v[0]*ptr_w[1] - ptr_v[1]*ptr_w[0];
+   }
+}
+
+/*
+  W(.,c) = W(.,c) + fac[c] * V(.,c) (complex factors, interleaved)
+*/
+static void gmres_axpy(mat W, real *fac, mat V)
+{
+int r, c, k;
+real *ptr_v, *ptr_w;
+
+ k = V->cols;
+ for(r = 0, ptr_v = V->rel + 2, ptr_w = W->rel + 2; r < V->rows; r ++)
+   for(c = 0; c < k; c ++, ptr_v += 2, ptr_w += 2)
+   {
+     ptr_w[0] += fac[2*c]*ptr_v[0] - fac[2*c+1]*ptr_v[1];
+     ptr_w[1] += fac[2*c]*ptr_v[1] + fac[2*c+1]*ptr_v[0];
+   }
+}
+
+/*======================================================================*/
+/*======================================================================*/
+
+int ms_gmres ( mat *p_X, mat B,
+               mat (*op)(mat, mat, void *), mat (*prec)(mat, mat, void *),
+               void *data, real tol, int max_iter )
+
+/************************************************************************
+
+ DESCRIPTION:
+
+   Solve A * X = B iteratively for all columns of B.
+
+ INPUT:
+
+   mat *p_X - output: pointer to the solution (dimension of B).
+   mat B    - input: right hand sides (complex, one per column).
+   op       - input: function Y = op(Y, X, data) that returns A * X.
+   prec     - input: function Z = prec(Z, V, data) that returns M^-1 * V
+              for a preconditioner M ~ A (NULL: no preconditioning).
+              Y and Z are allocated by op/prec if they are NULL.
+   void *data - input: passed to op and prec.
+   real tol - input: relative residual |B - A*X| / |B| to be reached for
+              each column.
+   int max_iter - input: max. number of iterations (products with A).
+
+ DESIGN:
+
+ Restarted GMRES (Saad and Schultz, SIAM J. Sci. Stat. Comput. 7 (1986)
+ 856) with preconditioning from the right, i.e. the Krylov space of
+ A * M^-1 is built and X = M^-1 * U.
+
+ The columns of B are solved simultaneously: every column has its own
+ Krylov basis, Hessenberg matrix and Givens rotations, but the basis
+ vectors of all columns are stored as the columns of one matrix, so that
+ op and prec are called once per iteration for all of them (i.e. they
+ can use matrix-matrix products). Iterations continue until the residual
+ of every column is below tol; the space is restarted after
+ GMRES_RESTART iterations.
+
+ RETURN VALUE:
+
+  number of iterations if all columns converged,
+  -(number of iterations) if max_iter was reached before.
+
+*************************************************************************/
+{
+int n, k, m;
+int i, j, c;
+int it, n_basis, conv;
+
+real faux, faux_r, faux_i;
+real h_r, h_i, a_abs;
+real res;
+
+real *b_norm, *norm;           /* column norms */
+real *dot;                     /* column dot products */
+real *h;                       /* Hessenberg matrices */
+real *cs, *sn;                 /* Givens rotations */
+real *g;                       /* rotated residual vectors */
+real *y;                       /* coefficients of the basis vectors */
+
+mat X, W, Z;
+mat *V;                        /* Krylov basis */
+
+ if( (matcheck(B) < 1) || (B->num_type != NUM_COMPLEX) )
+ {
+#ifdef ERROR
+   fprintf(STDERR," *** error (ms_gmres): improper right hand sides\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(0);
+#endif
+ }
+
+ n = B->rows;
+ k = B->cols;
+ m = GMRES_RESTART;
+
+/*
+  element (i,j) of the Hessenberg matrix of column c:
+  h[2*((c*(m+1) + i)*m + j)] (real part), ... + 1 (imag. part)
+*/
+ b_norm = (real *) malloc(k * sizeof(real));
+ norm   = (real *) malloc(k * sizeof(real));
+ dot    = (real *) malloc(2*k * sizeof(real));
+ h      = (real *) calloc(2*(m+1)*m*k, sizeof(real));
+ cs     = (real *) calloc(m*k, sizeof(real));
+ sn     = (real *) calloc(2*m*k, sizeof(real));
+ g      = (real *) calloc(2*(m+1)*k, sizeof(real));
+ y      = (real *) calloc(2*m*k, sizeof(real));
+ V      = (mat *) calloc(m+1, sizeof(mat));
+
+ X = W = Z = NULL;
+
+ X = matalloc(*p_X, n, k, NUM_COMPLEX);
+
+ gmres_norm(b_norm, B);
+ for(c = 0; c < k; c ++)
+   if(b_norm[c] == 0.) b_norm[c] = 1.;
+
+ it = 0;
+ conv = 0;
+ while(!conv)
+ {
+/*
+  Residual V[0] = B - A*X, normalised, g = (|V[0]|, 0, ...)
+*/
+   V[0] = matcop(V[0], B);
+   if(it > 0)
+   {
+     W = (*op)(W, X, data);
+     for(c = 0; c < 2*k; c ++) dot[c] = (c % 2) ? 0. : -1.;
+     gmres_axpy(V[0], dot, W);
+   }
+
+   gmres_norm(norm, V[0]);
+   for(c = 0, res = 0.; c < k; c ++)
+   {
+     g[2*c*(m+1)]     = norm[c];
+     g[2*c*(m+1) + 1] = 0.;
+     res = MAX(res, norm[c] / b_norm[c]);
+     norm[c] = (norm[c] > 0.) ? 1./norm[c] : 0.;
+   }
+   gmres_scale(V[0], norm);
+
+   if( (res <= tol) || (it >= max_iter) )
+   {
+     conv = (res <= tol);
+     break;
+   }
+
+/*
+  Arnoldi iterations
+*/
+   for(j = 0, n_basis = 0; (j < m) && (it < max_iter); j ++)
+   {
+     it ++;
+     n_basis = j + 1;
+
+     if(prec != NULL)
+     {
+       Z = (*prec)(Z, V[j], data);
+       W = (*op)(W, Z, data);
+     }
+     else
+       W = (*op)(W, V[j], data);
+
+     /* modified Gram-Schmidt */
+     for(i = 0; i <= j; i ++)
+     {
+       gmres_dot(dot, V[i], W);
+       for(c = 0; c < k; c ++)
+       {
+         h[2*((c*(m+1) + i)*m + j)]     = dot[2*c];
+         h[2*((c*(m+1) + i)*m + j) + 1] = dot[2*c+1];
+       }
+       for(c = 0; c < 2*k; c ++) dot[c] = -dot[c];
+       gmres_axpy(W, dot, V[i]);
+     }
+
+     gmres_norm(norm, W);
+     V[j+1] = matcop(V[j+1], W);
+     for(c = 0; c < k; c ++)
+     {
+       h[2*((c*(m+1) + j+1)*m + j)]     = norm[c];
+       h[2*((c*(m+1) + j+1)*m + j) + 1] = 0.;
+       norm[c] = (norm[c] > 0.) ? 1./norm[c] : 0.;
+     }
+     gmres_scale(V[j+1], norm);
+
+     /* Givens rotations: apply the old ones, eliminate h(j+1,j) */
+     for(c = 0, res = 0.; c < k; c ++)
+     {
+       real *hc = h + 2*c*(m+1)*m;
+       real *sc = sn + 2*c*m;
+       real *gc = g + 2*c*(m+1);
+
+       for(i = 0; i < j; i ++)
+       {
+         /* (x,y) -> (cs*x + sn*y, -conj(sn)*x + cs*y) */
+         cri_mul(&faux_r, &faux_i, sc[2*i], sc[2*i+1],
+                 hc[2*((i+1)*m + j)], hc[2*((i+1)*m + j) + 1]);
+         h_r = cs[c*m + i]*hc[2*(i*m + j)]     + faux_r;
+         h_i = cs[c*m + i]*hc[2*(i*m + j) + 1] + faux_i;
+
+         cri_mul(&faux_r, &faux_i, sc[2*i], -sc[2*i+1],
+                 hc[2*(i*m + j)], hc[2*(i*m + j) + 1]);
+         hc[2*((i+1)*m + j)]     = cs[c*m + i]*hc[2*((i+1)*m + j)]     - faux_r;
+         hc[2*((i+1)*m + j) + 1] = cs[c*m + i]*hc[2*((i+1)*m + j) + 1] - faux_i;
+
+         hc[2*(i*m + j)]     = h_r;
+         hc[2*(i*m + j) + 1] = h_i;
+       }
+
+       /* h(j+1,j) is real */
+       h_r = hc[2*((j+1)*m + j)];
+       a_abs = cri_abs(hc[2*(j*m + j)], hc[2*(j*m + j) + 1]);
+       faux = R_hypot(a_abs, h_r);
+       if(faux == 0.)
+       {
+         cs[c*m + j] = 1.;
+         sc[2*j] = sc[2*j+1] = 0.;
+       }
+       else if(a_abs == 0.)
+       {
+         cs[c*m + j] = 0.;
+         sc[2*j] = 1.;
+         sc[2*j+1] = 0.;
+         hc[2*(j*m + j)] = faux;
+         hc[2*(j*m + j) + 1] = 0.;
+       }
+       else
+       {
+         cs[c*m + j] = a_abs / faux;
+         sc[2*j]   = hc[2*(j*m + j)]     / a_abs * h_r / faux;
+         sc[2*j+1] = hc[2*(j*m + j) + 1] / a_abs * h_r / faux;
+         hc[2*(j*m + j)]     *= faux / a_abs;
+         hc[2*(j*m + j) + 1] *= faux / a_abs;
+       }
+       hc[2*((j+1)*m + j)] = hc[2*((j+1)*m + j) + 1] = 0.;
+
+       /* g(j+1) = -conj(sn)*g(j), g(j) = cs*g(j) */
+       cri_mul(&gc[2*(j+1)], &gc[2*(j+1) + 1],
+               -sc[2*j], sc[2*j+1], gc[2*j], gc[2*j+1]);
+       gc[2*j]   *= cs[c*m + j];
+       gc[2*j+1] *= cs[c*m + j];
+
+       res = MAX(res, cri_abs(gc[2*(j+1)], gc[2*(j+1) + 1]) / b_norm[c]);
+     }
+
+#ifdef CONTROL
+     fprintf(STDCTR,"(ms_gmres): iteration %d, residual %.3e\n", it, res);
+#endif
+     if(res <= tol) break;
+   }  /* j */
+
+/*
+  Solve the triangular systems H*y = g and update X = X + M^-1 * V*y
+*/
+   for(c = 0; c < k; c ++)
+   {
+     real *hc = h + 2*c*(m+1)*m;
+     real *gc = g + 2*c*(m+1);
+     real *yc = y + 2*c*m;
+
+     for(i = n_basis - 1; i >= 0; i --)
+     {
+       faux_r = gc[2*i];
+       faux_i = gc[2*i+1];
+       for(j = i + 1; j < n_basis; j ++)
+       {
+         cri_mul(&h_r, &h_i, hc[2*(i*m + j)], hc[2*(i*m + j) + 1],
+                 yc[2*j], yc[2*j+1]);
+         faux_r -= h_r;
+         faux_i -= h_i;
+       }
+       if( (hc[2*(i*m + i)] == 0.) && (hc[2*(i*m + i) + 1] == 0.) )
+         yc[2*i] = yc[2*i+1] = 0.;
+       else
+         cri_div(&yc[2*i], &yc[2*i+1], faux_r, faux_i,
+                 hc[2*(i*m + i)], hc[2*(i*m + i) + 1]);
+     }
+   }
+
+   W = matalloc(W, n, k, NUM_COMPLEX);
+   for(i = 0; i < n_basis; i ++)
+   {
+     for(c = 0; c < k; c ++)
+     {
+       dot[2*c]   = y[2*(c*m + i)];
+       dot[2*c+1] = y[2*(c*m + i) + 1];
+     }
+     gmres_axpy(W, dot, V[i]);
+   }
+   if(prec != NULL) Z = (*prec)(Z, W, data);
+   else             Z = matcop(Z, W);
+
+   for(c = 0; c < 2*k; c ++) dot[c] = (c % 2) ? 0. : 1.;
+   gmres_axpy(X, dot, Z);
+ }  /* while */
+
+#ifdef CONTROL
+ fprintf(STDCTR,"(ms_gmres): %d iterations, residual %.3e (%d columns)\n",
+         it, res, k);
+#endif
+
+ for(i = 0; i <= m; i ++)
+   if(V[i] != NULL) matfree(V[i]);
+ free(V);
+ if(W != NULL) matfree(W);
+ if(Z != NULL) matfree(Z);
+
+ free(b_norm);
+ free(norm);
+ free(dot);
+ free(h);
+ free(cs);
+ free(sn);
+ free(g);
+ free(y);
+
+ *p_X = X;
+ return(conv ? it : -it);
+} /* end of function ms_gmres */
+
+/*======================================================================*/
@@ -0,0 +1,553 @@
+/*********************************************************************
+  file contains functions:
+
+  ms_lsum_ii_ew
+     Calculate the lattice sum Llm for a periodic plane of scatterers
+     by Ewald summation (reciprocal and real space parts).
+  ms_lsum_ewald
+     Decide whether a lattice sum is calculated by Ewald summation.
+
+*********************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "leed.h"
+
+/*
+#define CONTROL
+*/
+#define ERROR
+
+#define EXIT_ON_ERROR
+
+#ifndef WAVE_TOLERANCE          /* should be defined in "leed_def.h" */
+#define WAVE_TOLERANCE 1.e-4
+#endif
+
+/*
+ Parameters of the Ewald summation:
+
+ LSUM_EW_AMP  - the reciprocal and the real space parts grow like
+                exp(Re(k^2)/(4 eta^2)) while their sum does not. The Ewald
+                parameter eta is not chosen smaller than needed to limit
+                this factor to exp(LSUM_EW_AMP).
+ LSUM_EW_CUT  - terms are neglected if their Gaussian factor is smaller
+                than epsilon * exp(-LSUM_EW_CUT).
+ LSUM_EW_RATIO - (LSUM_AUTO) the Ewald summation is used if it needs
+                fewer than 1/LSUM_EW_RATIO of the lattice points of the
+                real space summation.
+*/
+#define LSUM_EW_AMP   3.
+#define LSUM_EW_CUT   4.
+#define LSUM_EW_RATIO 4.
+
+#define SQRT_PI 1.77245385090551602730
+
+/*======================================================================*/
+/*======================================================================*/
+
+static real lsum_ew_eta(real k_r, real k_i, real area)
+
+/************************************************************************
+ Ewald parameter eta^2 for the wave number k = k_r + i*k_i and the area
+ of the unit cell: pi/area balances the number of lattice points in real
+ and reciprocal space; for large k it is increased (see LSUM_EW_AMP).
+*************************************************************************/
+{
+real eta2;
+
+ eta2 = (k_r*k_r - k_i*k_i) / (4.*LSUM_EW_AMP);
+ return( MAX(eta2, PI/area) );
+}
+
+/*======================================================================*/
+/*======================================================================*/
+
+static real lsum_ew_lneps(real epsilon, int l_max)
+
+/************************************************************************
+ -ln of the smallest Gaussian factor of the terms included in the Ewald
+ summation (epsilon >= 1. specifies a radius for the real space
+ summation, use the default accuracy then). The terms of high l decay
+ more slowly, roughly by a factor e per l.
+*************************************************************************/
+{
+ if (epsilon >= 1.) epsilon = WAVE_TOLERANCE;
+ return( - R_log(epsilon) + LSUM_EW_CUT + l_max );
+}
+
+/*======================================================================*/
+/*======================================================================*/
+
+int ms_lsum_ewald ( int method, real k_r, real k_i, real *a, int l_max,
+                    real epsilon )
+
+/************************************************************************
+
+ Decide whether the lattice sum for a periodic plane of scatterers is
+ calculated by Ewald summation (ms_lsum_ii_ew) or in real space
+ (ms_lsum_ii).
+
+ INPUT:
+
+   int method - LSUM_REAL, LSUM_EWALD or LSUM_AUTO (see leed_def.h).
+   real k_r, k_i, *a, l_max, epsilon - see ms_lsum_ii.
+
+ DESIGN:
+
+   The number of lattice points of the real space summation grows like
+   (ln(epsilon)/k_i)^2 / area, while the number of lattice points needed
+   by the Ewald summation does not depend on k_i. With LSUM_AUTO the
+   Ewald summation is therefore chosen for weak damping, if it needs
+   distinctly fewer lattice points (LSUM_EW_RATIO).
+
+ RETURN VALUES:
+
+   1 for Ewald summation, 0 for real space summation.
+
+*************************************************************************/
+{
+real area, eta2, ln_eps;
+real r_max, n_real, n_ewald;
+
+ if (method == LSUM_REAL)  return(0);
+ if (method == LSUM_EWALD) return(1);
+
+ area = R_fabs(a[1]*a[4] - a[3]*a[2]);
+
+/* real space: lattice points within r_max */
+ if (epsilon < 1.) r_max = - R_log(epsilon) / k_i;
+ else              r_max = epsilon;
+ n_real = PI * r_max * r_max / area;
+
+/*
+  Ewald: lattice points within sqrt(ln_eps)/eta and reciprocal lattice
+  points within 2*eta*sqrt(ln_eps) around the circle |q| = k_r.
+*/
+ eta2 = lsum_ew_eta(k_r, k_i, area);
+ ln_eps = lsum_ew_lneps(epsilon, l_max);
+ n_ewald = PI * ln_eps / (eta2 * area) +
+           (k_r*k_r + 4.*eta2*ln_eps) * area / (4.*PI);
+
+ return( n_ewald * LSUM_EW_RATIO < n_real );
+}  /* end of function ms_lsum_ewald */
+
+/*======================================================================*/
+/*======================================================================*/
+
+mat ms_lsum_ii_ew ( struct ctx_str *ctx, mat Llm, real k_r, real k_i,
+                    real *k_in, real *a, int l_max, real epsilon )
+
+/************************************************************************
+
+ Calculate the lattice sum Llm for a periodic plane of scatterers by
+ Ewald summation (same result as ms_lsum_ii).
+
+ INPUT:
+
+   see ms_lsum_ii.
+
+ DESIGN:
+
+   ms_lsum_ii sums
+
+     Dlm = sum(R != 0) [ H(1)l(k*|R|) * exp( i(kin*R + m*phi(R)) ) ]
+
+   in real space, which needs all lattice points within the radius
+   -ln(epsilon)/k_i. Here Dlm is split according to Kambe
+   (Z. Naturforsch. 22a (1967) 322) by means of the integral
+   representation (k = k_r + i*k_i)
+
+     H(1)l(k*r) = -2i/sqrt(PI) * (2r)^l / k^(l+1) *
+                  int(0,inf) [ xi^2l * exp(-r^2 xi^2 + k^2/(4 xi^2)) ] dxi
+
+   at the Ewald parameter eta into:
+
+   - reciprocal space (xi < eta), by Poisson summation over the beams
+     q = kin + g (m' = |m|, n = (l-m')/2, gam = (q^2 - k^2)/4):
+
+     D1lm = 2PI/A * i^m' * sum(g) [ q^m' * exp(i*m*phi(q)) * n!/2^(m'+1) *
+            sum(j=0,n) [ (-1)^j * C(n+m',n-j)/j! * (q^2/4)^j *
+                     1/2 * gam^(n-j-1/2) * Gamma(1/2-n+j, gam/eta^2) ] ]
+
+     (only for even l+m; the other Dlm are multiplied by zero in Llm).
+     Gamma(1/2-p, x) is calculated from Gamma(1/2, x) = sqrt(PI)erfc(sqrt(x))
+     by downward recursion.
+
+   - real space (xi > eta):
+
+     D2lm = sum(R != 0) [ exp(i*kin*R) * R^l * exp(i*m*phi(R)) * Il(R) ]
+
+     Il(R) = int(eta,inf) [ xi^2l * exp(-R^2 xi^2 + k^2/(4 xi^2)) ] dxi
+
+     I(0) and I(-1) are given by complex error functions (c_erfc), the
+     higher Il by upward recursion.
+
+   - the term R = 0, which is included in D1lm, is subtracted (l = 0).
+
+   Both parts converge like Gaussians, independent of k_i.
+
+ RETURN VALUES:
+
+   NULL if failed (and EXIT_ON_ERROR is not defined)
+
+   Llm (may be different from input parameter), see ms_lsum_ii.
+
+*************************************************************************/
+{
+int l, m, mp, n, j, p;
+int i, iaux;
+int n1, n2, n1_max, n2_max;
+int n_max;
+
+real area, eta, eta2, ln_eps;
+real k2_r, k2_i;                /* k^2 */
+real a1_x, a1_y, a2_x, a2_y;    /* lattice vectors */
+real b1_x, b1_y, b2_x, b2_y;    /* reciprocal lattice vectors */
+real q_x, q_y, q2, q2_max;
+real r_x, r_y, r_abs, r2, r2_max;
+real faux, faux_r, faux_i;
+real fr, fi;
+real gam_r, gam_i, sg_r, sg_i;  /* gam and sqrt(gam) */
+real sx_r, sx_i, x_r, x_i;      /* sqrt(x) and x = gam/eta^2 */
+real ex_r, ex_i;                /* exp(-x) */
+real sp_r, sp_i;                /* sqrt(x)^(1-2p) */
+real xi_r, xi_i;                /* 1/x */
+real gp_r, gp_i;                /* gam^(p-1/2) */
+real g_r, g_i;                  /* Gamma(1/2-p, x) */
+real e1_r, e1_i, e2_r, e2_i;
+real i0_r, i0_i, im1_r, im1_i;
+real ee_r, ee_i;
+real ekr_r, ekr_i;              /* exp(i*kin*R) */
+real s_r, s_i;
+
+real *fac;                      /* factorials */
+real *coef;                     /* coefficients of D1lm */
+real *w_r, *w_i;                /* gam^(p-1/2) Gamma(1/2-p, x) */
+real *qp;                       /* (q^2)^j */
+real *z_r, *z_i;                /* (q_x + i q_y)^m or exp(i*m*phi(R)) */
+real *il_r, *il_i;              /* Il(R) */
+real *d1_r, *d1_i;              /* D1lm */
+real *d2_r, *d2_i;              /* D2lm */
+
+mat Ylm;
+
+/**************************************************************************
+  Check arguments: k_i
+**************************************************************************/
+
+ if( k_i <= 0.)                /* no convergence */
+ {
+#ifdef ERROR
+   fprintf(STDERR,
+           " *** error (ms_lsum_ii_ew): damping too small: k_i = %.2e\n", k_i);
+#endif
+
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(NULL);
+#endif
+ }
+
+/**************************************************************************
+  Allocate storage
+**************************************************************************/
+
+ iaux = (l_max + 1)*(l_max + 1);
+ Llm = matalloc( Llm, iaux, 1, NUM_COMPLEX );
+
+ n_max = l_max/2;
+
+ fac  = (real *)malloc( (l_max + 2) * sizeof(real) );
+ qp   = (real *)malloc( (n_max + 1) * sizeof(real) );
+ w_r  = (real *)malloc( (n_max + 1) * sizeof(real) );
+ w_i  = (real *)malloc( (n_max + 1) * sizeof(real) );
+ z_r  = (real *)malloc( (l_max + 1) * sizeof(real) );
+ z_i  = (real *)malloc( (l_max + 1) * sizeof(real) );
+ il_r = (real *)malloc( (l_max + 2) * sizeof(real) );
+ il_i = (real *)malloc( (l_max + 2) * sizeof(real) );
+ d1_r = (real *)calloc( iaux, sizeof(real) );
+ d1_i = (real *)calloc( iaux, sizeof(real) );
+ d2_r = (real *)calloc( iaux, sizeof(real) );
+ d2_i = (real *)calloc( iaux, sizeof(real) );
+
+/*
+  Coefficients of D1lm in the order of the loops over l, m' and j:
+  n!/2^(m'+1) * (-1)^j * C(n+m',n-j)/j! / 4^j * 1/2
+*/
+ for(fac[0] = 1., i = 1; i <= l_max + 1; i ++) fac[i] = fac[i-1] * i;
+
+ for(iaux = 0, l = 0; l <= l_max; l ++)
+   for(mp = l%2; mp <= l; mp += 2)
+     iaux += (l - mp)/2 + 1;
+ coef = (real *)malloc( iaux * sizeof(real) );
+
+ for(i = 0, l = 0; l <= l_max; l ++)
+   for(mp = l%2; mp <= l; mp += 2)
+   {
+     n = (l - mp)/2;
+     for(j = 0, faux = ldexp(1., -(mp+2)); j <= n; j ++, faux *= -0.25)
+       coef[i ++] = faux * fac[n] * fac[n+mp] /
+                    (fac[n-j] * fac[mp+j] * fac[j]);
+   }
+
+/**************************************************************************
+  Some often used values
+**************************************************************************/
+
+ a1_x = a[1]; a1_y = a[3];
+ a2_x = a[2]; a2_y = a[4];
+
+ faux = a1_x*a2_y - a1_y*a2_x;
+ area = R_fabs(faux);
+
+ b1_x =  2.*PI * a2_y / faux; b1_y = -2.*PI * a2_x / faux;
+ b2_x = -2.*PI * a1_y / faux; b2_y =  2.*PI * a1_x / faux;
+
+ k2_r = k_r*k_r - k_i*k_i;
+ k2_i = 2.*k_r*k_i;
+
+ eta2 = lsum_ew_eta(k_r, k_i, area);
+ eta = R_sqrt(eta2);
+ ln_eps = lsum_ew_lneps(epsilon, l_max);
+
+/*
+  Cut off: Re(x) = (q^2 - Re(k^2))/(4 eta^2) < ln_eps in reciprocal space,
+  R^2 eta^2 - Re(k^2)/(4 eta^2) < ln_eps in real space.
+*/
+ q2_max = MAX(k2_r, 0.) + 4.*eta2*ln_eps;
+ r2_max = (ln_eps + MAX(k2_r, 0.)/(4.*eta2)) / eta2;
+
+#ifdef CONTROL
+ fprintf(STDCTR,
+   "(ms_lsum_ii_ew): eta = %.3f A^-1, q_max = %.3f A^-1, r_max = %.3f A\n",
+   eta/BOHR, R_sqrt(q2_max)/BOHR, R_sqrt(r2_max)*BOHR);
+#endif
+
+/**************************************************************************
+  Reciprocal space: sum over q = kin + n1*b1 + n2*b2
+**************************************************************************/
+
+ faux = R_sqrt(q2_max) + R_hypot(k_in[1], k_in[2]);
+ n1_max = (int) (faux * R_hypot(b2_x, b2_y) * area / (4.*PI*PI)) + 1;
+ n2_max = (int) (faux * R_hypot(b1_x, b1_y) * area / (4.*PI*PI)) + 1;
+
+ for(n1 = -n1_max; n1 <= n1_max; n1 ++)
+   for(n2 = -n2_max; n2 <= n2_max; n2 ++)
+   {
+     q_x = k_in[1] + n1*b1_x + n2*b2_x;
+     q_y = k_in[2] + n1*b1_y + n2*b2_y;
+     q2 = q_x*q_x + q_y*q_y;
+     if (q2 > q2_max) continue;
+
+   /* gam = (q^2 - k^2)/4, x = gam/eta^2 (sqrt with Re > 0) */
+     gam_r = 0.25*(q2 - k2_r);
+     gam_i = -0.25*k2_i;
+     cri_sqrt(&sg_r, &sg_i, gam_r, gam_i);
+     sx_r = sg_r/eta; sx_i = sg_i/eta;
+     x_r = gam_r/eta2; x_i = gam_i/eta2;
+     cri_exp(&ex_r, &ex_i, -x_r, -x_i);
+     cri_div(&xi_r, &xi_i, 1., 0., x_r, x_i);
+
+   /*
+     w(p) = gam^(p-1/2) * Gamma(1/2-p, x):
+     Gamma(1/2, x) = sqrt(PI) erfc(sqrt(x))
+     Gamma(1/2-p, x) = (Gamma(3/2-p, x) - x^(1/2-p) exp(-x)) / (1/2-p)
+   */
+     c_erfc(&g_r, &g_i, sx_r, sx_i);
+     g_r *= SQRT_PI; g_i *= SQRT_PI;
+     cri_div(&gp_r, &gp_i, 1., 0., sg_r, sg_i);
+     cri_div(&sp_r, &sp_i, 1., 0., sx_r, sx_i);
+     cri_mul(w_r, w_i, gp_r, gp_i, g_r, g_i);
+     for(p = 1; p <= n_max; p ++)
+     {
+       cri_mul(&faux_r, &faux_i, sp_r, sp_i, ex_r, ex_i);
+       g_r = (g_r - faux_r) / (0.5 - p);
+       g_i = (g_i - faux_i) / (0.5 - p);
+       cri_mul(&gp_r, &gp_i, gp_r, gp_i, gam_r, gam_i);
+       cri_mul(&sp_r, &sp_i, sp_r, sp_i, xi_r, xi_i);
+       cri_mul(w_r+p, w_i+p, gp_r, gp_i, g_r, g_i);
+     }
+
+     for(qp[0] = 1., j = 1; j <= n_max; j ++) qp[j] = qp[j-1] * q2;
+
+   /* z(m') = i^m' * (q_x + i q_y)^m' */
+     z_r[0] = 1.; z_i[0] = 0.;
+     for(mp = 1; mp <= l_max; mp ++)
+       cri_mul(z_r+mp, z_i+mp, z_r[mp-1], z_i[mp-1], -q_y, q_x);
+
+     for(i = 0, l = 0; l <= l_max; l ++)
+     {
+       iaux = l*(l+1);
+       for(mp = l%2; mp <= l; mp += 2)
+       {
+         n = (l - mp)/2;
+         for(s_r = s_i = 0., j = 0; j <= n; j ++, i ++)
+         {
+           s_r += coef[i] * qp[j] * w_r[n-j];
+           s_i += coef[i] * qp[j] * w_i[n-j];
+         }
+
+       /* + m: i^m' (q_x + i q_y)^m', - m: i^m' (q_x - i q_y)^m' */
+         cri_mul(&faux_r, &faux_i, s_r, s_i, z_r[mp], z_i[mp]);
+         d1_r[iaux + mp] += faux_r;
+         d1_i[iaux + mp] += faux_i;
+         if (mp > 0)
+         {
+           cri_mul(&faux_r, &faux_i, s_r, s_i,
+                   M1P(mp)*z_r[mp], -M1P(mp)*z_i[mp]);
+           d1_r[iaux - mp] += faux_r;
+           d1_i[iaux - mp] += faux_i;
+         }
+       }   /* m' */
+     }   /* l */
+   }   /* n1, n2 */
+
+/**************************************************************************
+  Real space: sum over R = n1*a1 + n2*a2 != 0
+**************************************************************************/
+
+ faux = R_sqrt(r2_max);
+ n1_max = (int) (faux * R_hypot(a2_x, a2_y) / area) + 1;
+ n2_max = (int) (faux * R_hypot(a1_x, a1_y) / area) + 1;
+
+/* exp(-R^2 eta^2 + k^2/(4 eta^2)) without R */
+ cri_exp(&ee_r, &ee_i, 0.25*k2_r/eta2, 0.25*k2_i/eta2);
+
+ for(n1 = -n1_max; n1 <= n1_max; n1 ++)
+   for(n2 = -n2_max; n2 <= n2_max; n2 ++)
+   {
+     r_x = n1*a1_x + n2*a2_x;
+     r_y = n1*a1_y + n2*a2_y;
+     r2 = r_x*r_x + r_y*r_y;
+     if ( (r2 > r2_max) || ((n1 == 0) && (n2 == 0)) ) continue;
+     r_abs = R_sqrt(r2);
+
+   /*
+     e1 = exp(-ikR) erfc(R eta - ik/(2 eta))
+     e2 = exp(+ikR) erfc(R eta + ik/(2 eta))
+   */
+     c_erfc(&faux_r, &faux_i, r_abs*eta + 0.5*k_i/eta, -0.5*k_r/eta);
+     cri_expi(&fr, &fi, -k_r*r_abs, -k_i*r_abs);
+     cri_mul(&e1_r, &e1_i, faux_r, faux_i, fr, fi);
+     c_erfc(&faux_r, &faux_i, r_abs*eta - 0.5*k_i/eta, 0.5*k_r/eta);
+     cri_expi(&fr, &fi, k_r*r_abs, k_i*r_abs);
+     cri_mul(&e2_r, &e2_i, faux_r, faux_i, fr, fi);
+
+   /*
+     I(0)  = sqrt(PI)/(4R) (e1 + e2)
+     I(-1) = sqrt(PI)/(4b) (e2 - e1), b = -ik/2
+   */
+     faux = SQRT_PI/(4.*r_abs);
+     i0_r = faux*(e1_r + e2_r);
+     i0_i = faux*(e1_i + e2_i);
+     cri_div(&faux_r, &faux_i, 0., 0.5*SQRT_PI, k_r, k_i);
+     cri_mul(&im1_r, &im1_i, faux_r, faux_i, e2_r - e1_r, e2_i - e1_i);
+
+   /*
+     Il = ( (2l-1) I(l-1) - k^2/2 I(l-2) + eta^(2l-1) * exp(-R^2 eta^2 + k^2/(4 eta^2)) )
+          / (2 R^2)
+   */
+     faux = R_exp(-r2*eta2);
+     fr = faux*ee_r/eta;
+     fi = faux*ee_i/eta;
+     il_r[0] = i0_r; il_i[0] = i0_i;
+     for(l = 1; l <= l_max; l ++)
+     {
+       fr *= eta2; fi *= eta2;
+       if (l == 1) { g_r = im1_r; g_i = im1_i; }
+       else        { g_r = il_r[l-2]; g_i = il_i[l-2]; }
+       cri_mul(&faux_r, &faux_i, 0.5*k2_r, 0.5*k2_i, g_r, g_i);
+       il_r[l] = ((2*l - 1)*il_r[l-1] - faux_r + fr) / (2.*r2);
+       il_i[l] = ((2*l - 1)*il_i[l-1] - faux_i + fi) / (2.*r2);
+     }
+
+   /* exp(i*kin*R) * R^l * Il */
+     cri_expi(&ekr_r, &ekr_i, k_in[1]*r_x + k_in[2]*r_y, 0.);
+     for(faux = 1., l = 0; l <= l_max; l ++, faux *= r_abs)
+     {
+       cri_mul(il_r+l, il_i+l, il_r[l], il_i[l], ekr_r, ekr_i);
+       il_r[l] *= faux;
+       il_i[l] *= faux;
+     }
+
+   /* exp(i*m*phi(R)) */
+     z_r[0] = 1.; z_i[0] = 0.;
+     for(mp = 1; mp <= l_max; mp ++)
+       cri_mul(z_r+mp, z_i+mp, z_r[mp-1], z_i[mp-1], r_x/r_abs, r_y/r_abs);
+
+     for(l = 0; l <= l_max; l ++)
+     {
+       iaux = l*(l+1);
+       for(mp = l%2; mp <= l; mp += 2)
+       {
+         cri_mul(&faux_r, &faux_i, il_r[l], il_i[l], z_r[mp], z_i[mp]);
+         d2_r[iaux + mp] += faux_r;
+         d2_i[iaux + mp] += faux_i;
+         if (mp > 0)
+         {
+           cri_mul(&faux_r, &faux_i, il_r[l], il_i[l], z_r[mp], -z_i[mp]);
+           d2_r[iaux - mp] += faux_r;
+           d2_i[iaux - mp] += faux_i;
+         }
+       }   /* m' */
+     }   /* l */
+   }   /* n1, n2 */
+
+/**************************************************************************
+  Dlm = -2i/sqrt(PI) * 2^l / k^(l+1) * (2PI/A * D1lm + D2lm - D3lm)
+
+  D3(00) (R = 0) = int(0,eta) [ exp(k^2/(4 xi^2)) ] dxi
+                 = eta * exp(k^2/(4 eta^2)) + i*sqrt(PI)*k/2 * erfc(-ik/(2 eta))
+**************************************************************************/
+
+ c_erfc(&faux_r, &faux_i, 0.5*k_i/eta, -0.5*k_r/eta);
+ cri_mul(&faux_r, &faux_i, faux_r, faux_i, -0.5*SQRT_PI*k_i, 0.5*SQRT_PI*k_r);
+ d2_r[0] -= eta*ee_r + faux_r;
+ d2_i[0] -= eta*ee_i + faux_i;
+
+/* fr + i fi = -2i/sqrt(PI) / k */
+ cri_div(&fr, &fi, 0., -2./SQRT_PI, k_r, k_i);
+ cri_div(&s_r, &s_i, 2., 0., k_r, k_i);       /* 2/k */
+
+/*
+  Llm(l,m) = 4PI * Yl-m(0,0) * D(l,-m) (see ms_lsum_ii); the factors
+  (-1)^m * 4PI * Ylm(0,0) are stored in Ylm.
+*/
+ Ylm = r_ylm(NULL, ctx->ylmc, 0., 0., l_max);
+
+ for(l = 0, i = 1; l <= l_max; l ++)
+ {
+   faux = M1P(l)*4.*PI;
+   iaux = l*(l+1);
+   for(m = -l; m <= l; m++, i++)
+   {
+     if ( ! ODD(l+m) )
+     {
+       faux_r = 2.*PI/area * d1_r[iaux - m] + d2_r[iaux - m];
+       faux_i = 2.*PI/area * d1_i[iaux - m] + d2_i[iaux - m];
+       cri_mul(&faux_r, &faux_i, faux_r, faux_i, fr, fi);
+       Llm->rel[2*i] = faux_r * faux * Ylm->rel[2*i];
+       Llm->iel[2*i] = faux_i * faux * Ylm->rel[2*i];
+     }
+     faux = -faux;
+   }
+   cri_mul(&fr, &fi, fr, fi, s_r, s_i);
+ }
+
+ matfree(Ylm);
+ free(fac);
+ free(coef);
+ free(qp);
+ free(w_r);  free(w_i);
+ free(z_r);  free(z_i);
+ free(il_r); free(il_i);
+ free(d1_r); free(d1_i);
+ free(d2_r); free(d2_i);
+
+ return(Llm);
+
+} /* end of function ms_lsum_ii_ew */
@@ -33,6 +33,8 @@ Changes:
 #define WARN_LEVEL 1000
 #endif
 
+#define LSUM_BATCH 64          /* lattice points per call of c_hank1_vec */
+
 #ifdef NOT      /***************/
 static mat Ylm = NULL;         /* contains spherical harmonics Y(0,0) */
 static real * expm_r = NULL;   /* storage space */
@@ -43,7 +45,231 @@ static int l_max_y = -1;       /* maximum l for the above arrays */
 /*======================================================================*/
 /*======================================================================*/
 
-mat ms_lsum_ii ( mat Llm, real k_r, real k_i, real *k_in, real *a,
+static void lsum_ii_add ( mat Llm, int n, real *pts_x, real *pts_y,
+                          real *pts_r, real *h_r, real *h_i, real *k_in,
+                          int l_max, real *expm_r, real *expm_i )
+
+/************************************************************************
+
+ Add the contributions of n lattice points (pts_x, pts_y; |r| = pts_r)
+ and their inverse (-r) to the lattice sum Llm (without the factor
+ 4PI * Yl-m, see ms_lsum_ii).
+
+ The Hankel functions of the points are stored as calculated by
+ c_hank1_vec: H(1)l(k*|r_j|) = h_r[l*n + j] + i*h_i[l*n + j].
+
+*************************************************************************/
+{
+int j, l, m, off;
+
+real r_x, r_y, r_abs;
+real hl_r, hl_i;
+real faux_r, faux_i;
+real faux2_r, faux2_i;
+real exp_phi_i, exp_phi_r;
+real exp_ikr_i, exp_ikr_r;
+
+ for(j = 0; j < n; j ++)
+ {
+   r_x = pts_x[j];
+   r_y = pts_y[j];
+   r_abs = pts_r[j];
+
+   exp_phi_r =  r_x/r_abs;                        /*   cos(phi(r)) */
+   exp_phi_i = -r_y/r_abs;                        /* - sin(phi(r)) */
+
+   expm_r[0] = 1.; expm_i[0] = 0.;
+
+/***********************
+  Two cases:
+   - k_in != 0,
+   - k_in == 0. makes things much more easier.
+***********************/
+
+   if( (k_in[1] == 0.) && (k_in[2] == 0.) )
+   {
+   /* First l = 0:  +/- r */
+
+     Llm->rel[2] += 2*h_r[j];
+     Llm->iel[2] += 2*h_i[j];
+
+/*
+        Now all other l,m:
+
+  Summation over +/- r (phi / phi + PI) and +/- m
+
+  for even m's != 0:
+     exp (-im (phi+PI)) = exp (-im phi)
+  => add contributions from the two half lattices for even m's
+
+  for odd m's:
+     exp (-im (phi+PI)) = -exp (-im phi)
+  => cancellation of the two half lattices for odd m's
+
+  Because Y(0,0) = 0. for odd (l+m), only even l's have nonzero elements
+  in Llm.
+
+  => skip summation for odd l's
+*/
+     for(l = 2; l <= l_max; l+= 2)
+     {
+       cri_mul(expm_r+l-1, expm_i+l-1,
+               expm_r[l-2], expm_i[l-2], exp_phi_r, exp_phi_i);
+       cri_mul(expm_r+l, expm_i+l,
+               expm_r[l-1], expm_i[l-1], exp_phi_r, exp_phi_i);
+
+       off = l*(l+1) + 1;
+       hl_r = h_r[l*n + j];
+       hl_i = h_i[l*n + j];
+
+   /* First m = 0, exp(-im*phi) = 1. */
+       Llm->rel[2*off] += 2*hl_r;
+       Llm->iel[2*off] += 2*hl_i;
+
+   /* Now all other m's (+ m and - m in the same loop) */
+       for(m = 2; m <= l; m +=2 )
+       {
+       /* + m: */
+         cri_mul(&faux_r, &faux_i, expm_r[m], expm_i[m], hl_r, hl_i);
+         Llm->rel[2*(off + m)] += 2*faux_r;
+         Llm->iel[2*(off + m)] += 2*faux_i;
+
+       /* - m: exp(-i(-m) phi) = exp(-im phi)* */
+         cri_mul(&faux_r, &faux_i, expm_r[m], -expm_i[m], hl_r, hl_i);
+         Llm->rel[2*(off - m)] += 2*faux_r;
+         Llm->iel[2*(off - m)] += 2*faux_i;
+       }   /* m */
+     }   /* l */
+   }    /* end of k_in == 0. */
+
+   else /* k_in != 0. */
+   {
+     faux_r = k_in[1]*r_x + k_in[2]*r_y;
+     cri_expi(&exp_ikr_r, &exp_ikr_i, faux_r, 0.); /* exp(i*k_in*r) */
+
+   /* first l = 0 */
+
+     /* + r */
+     cri_mul(&faux_r, &faux_i, exp_ikr_r, exp_ikr_i, h_r[j], h_i[j]);
+     Llm->rel[2] += faux_r;
+     Llm->iel[2] += faux_i;
+
+     /* - r */
+     cri_mul(&faux_r, &faux_i, exp_ikr_r,-exp_ikr_i, h_r[j], h_i[j]);
+     Llm->rel[2] += faux_r;
+     Llm->iel[2] += faux_i;
+
+   /* Now all other l,m */
+     for(l = 1; l <= l_max; l++ )
+     {
+       off = l*(l+1) + 1;
+       cri_mul(expm_r+l, expm_i+l,
+               expm_r[l-1], expm_i[l-1], exp_phi_r, exp_phi_i);
+       hl_r = h_r[l*n + j];
+       hl_i = h_i[l*n + j];
+
+/*
+  Summation over +/- r (phi / phi + PI) and +/- m
+
+  for even m's != 0:
+     exp (-im (phi+PI)) = exp (-im phi)
+     exp (ik(-r) )     = (exp (ikr) )*
+
+  for odd m's:
+     exp (-im (phi+PI)) = -exp (-im phi)
+     exp (ik(-r) )     = (exp (ikr) )*
+
+  => no cancellation.
+
+  Because Y(0,0) = 0. for odd (l+m), only even l's have nonzero elements
+  in Llm.
+
+  => skip summation for odd (l+m)'s
+*/
+       if(ODD(l))
+       {
+     /*
+       Loop over all odd m's (+ m and - m in the same loop)
+     */
+         for(m = 1; m <= l; m += 2)
+         {
+       /* + m: */
+           cri_mul(&faux_r, &faux_i, expm_r[m], expm_i[m], hl_r, hl_i);
+         /* + r */
+           cri_mul(&faux2_r, &faux2_i, exp_ikr_r, exp_ikr_i, faux_r, faux_i);
+           Llm->rel[2*(off + m)] += faux2_r;
+           Llm->iel[2*(off + m)] += faux2_i;
+         /* - r  '-' for odd m's */
+           cri_mul(&faux2_r, &faux2_i, exp_ikr_r,-exp_ikr_i,-faux_r,-faux_i);
+           Llm->rel[2*(off + m)] += faux2_r;
+           Llm->iel[2*(off + m)] += faux2_i;
+
+       /* - m: exp(-i(-m) phi) = exp(-im phi)* */
+           cri_mul(&faux_r, &faux_i, expm_r[m], -expm_i[m], hl_r, hl_i);
+         /* + r */
+           cri_mul(&faux2_r, &faux2_i, exp_ikr_r, exp_ikr_i, faux_r, faux_i);
+           Llm->rel[2*(off - m)] += faux2_r;
+           Llm->iel[2*(off - m)] += faux2_i;
+         /* - r  '-' for odd m's */
+           cri_mul(&faux2_r, &faux2_i, exp_ikr_r,-exp_ikr_i,-faux_r,-faux_i);
+           Llm->rel[2*(off - m)] += faux2_r;
+           Llm->iel[2*(off - m)] += faux2_i;
+         }   /* m */
+       }      /* odd l's */
+       else   /* even l's */
+       {
+     /*
+       Loop over all even m's:
+       - First m = 0, exp(-im*phi) = 1.
+       - Then all other even m's.
+     */
+
+     /* First m = 0, exp(-im*phi) = 1. */
+       /* + r */
+         cri_mul(&faux_r, &faux_i, exp_ikr_r, exp_ikr_i, hl_r, hl_i);
+         Llm->rel[2*off] += faux_r;
+         Llm->iel[2*off] += faux_i;
+       /* - r  */
+         cri_mul(&faux_r, &faux_i, exp_ikr_r,-exp_ikr_i, hl_r, hl_i);
+         Llm->rel[2*off] += faux_r;
+         Llm->iel[2*off] += faux_i;
+
+   /* Now all other even m's (+ m and - m in the same loop) */
+         for(m = 2; m <= l; m += 2)
+         {
+       /* + m: */
+           cri_mul(&faux_r, &faux_i, expm_r[m], expm_i[m], hl_r, hl_i);
+         /* + r */
+           cri_mul(&faux2_r, &faux2_i, exp_ikr_r, exp_ikr_i, faux_r, faux_i);
+           Llm->rel[2*(off + m)] += faux2_r;
+           Llm->iel[2*(off + m)] += faux2_i;
+         /* - r  '+' for even m's */
+           cri_mul(&faux2_r, &faux2_i, exp_ikr_r,-exp_ikr_i, faux_r, faux_i);
+           Llm->rel[2*(off + m)] += faux2_r;
+           Llm->iel[2*(off + m)] += faux2_i;
+
+       /* - m: exp(-i(-m) phi) = exp(-im phi)* */
+           cri_mul(&faux_r, &faux_i, expm_r[m], -expm_i[m], hl_r, hl_i);
+         /* + r */
+           cri_mul(&faux2_r, &faux2_i, exp_ikr_r, exp_ikr_i, faux_r, faux_i);
+           Llm->rel[2*(off - m)] += faux2_r;
+           Llm->iel[2*(off - m)] += faux2_i;
+         /* - r  '+' for even m's */
+           cri_mul(&faux2_r, &faux2_i, exp_ikr_r,-exp_ikr_i,faux_r,faux_i);
+           Llm->rel[2*(off - m)] += faux2_r;
+           Llm->iel[2*(off - m)] += faux2_i;
+         }   /* m */
+       }   /* even l's */
+     }   /* l */
+   }  /* end of k_in != 0 */
+ }  /* j */
+
+} /* end of function lsum_ii_add */
+
+/*======================================================================*/
+/*======================================================================*/
+
+mat ms_lsum_ii ( struct ctx_str *ctx, mat Llm, real k_r, real k_i, real *k_in, real *a,
                  int l_max, real epsilon )
 
 /************************************************************************
@@ -52,6 +278,7 @@ mat ms_lsum_ii ( mat Llm, real k_r, real k_i, real *k_in, real *a,
 
  INPUT:
 
+   struct ctx_str *ctx (Ylm coefficients)
    mat Llm
    real k_r, k_i
    real k_in   Incident k-vector: k_in[1] = k_in_x, k_in[2] = k_in_y.
@@ -129,10 +356,16 @@ mat ms_lsum_ii ( mat Llm, real k_r, real k_i, real *k_in, real *a,
    I.e. index(l,m) = l*(l+1) + m + 1. Note that, like usually for matrices,
    the first array element Llm[0] is not occupied.
 
+   If the context has a lattice sum cache (ctx->lsm), Llm is taken from
+   there if it was calculated before for the same parameters, otherwise
+   it is stored there.
+
+   Depending on ctx->lsum and the damping (ms_lsum_ewald), Llm is
+   calculated by Ewald summation (ms_lsum_ii_ew) instead.
+
 *************************************************************************/
 {
 int l,m;                       /* quantum numbers l,m */
-int off;                       /* offset in the arrays Ylm and Llm */
 int i, iaux;
 
 int n1, n1_max;                /* counters for lattice vectors */
@@ -145,18 +378,18 @@ real r0_x, r0_y, r_x, r_y;     /* lattice vectors */
 real r_max, r_abs;
 real a1_x, a1_y, a2_x, a2_y;   /* basic lattice vectors */
 
-real faux_r, faux_i;
-real faux2_r, faux2_i;
-real exp_phi_i, exp_phi_r;
-real exp_ikr_i, exp_ikr_r;
+real faux_r;
 
 real *expm_r, *expm_i;         /* storage space */
 
+int n_pts;                     /* batch of lattice points */
+real pts_x[LSUM_BATCH], pts_y[LSUM_BATCH], pts_r[LSUM_BATCH];
+real z_r[LSUM_BATCH], z_i[LSUM_BATCH];
+real *h_r, *h_i;               /* Hankel functions of the batch */
+
 mat Ylm;                       /* contains spherical harmonics Y(0,0) */
-mat Hl;                        /* Hankel function */
 
  Ylm = NULL;
- Hl = NULL;
 
 /**************************************************************************
   Check arguments: k_i
@@ -178,6 +411,18 @@ mat Hl;                        /* Hankel function */
 #endif
  }
 
+ if( (ctx->lsm != NULL) &&
+     lsm_get(ctx->lsm, &Llm, k_r, k_i, k_in, a, l_max, epsilon) )
+   return(Llm);
+
+ if( ms_lsum_ewald(ctx->lsum, k_r, k_i, a, l_max, epsilon) )
+ {
+   Llm = ms_lsum_ii_ew(ctx, Llm, k_r, k_i, k_in, a, l_max, epsilon);
+   if(ctx->lsm != NULL)
+     lsm_put(ctx->lsm, Llm, k_r, k_i, k_in, a, l_max, epsilon);
+   return(Llm);
+ }
+
 /*
   Allocate memory for Llm (and preset all Llm with zero).
 */
@@ -185,19 +430,22 @@ mat Hl;                        /* Hankel function */
  Llm = matalloc( Llm, iaux, 1, NUM_COMPLEX );
 
 /*
- -Calculate the spherical harmonics Ylm(0,0), if not done already,
-  and multiply with factor 4PI.
+ -Calculate the spherical harmonics Ylm(0,0) and multiply with factor
+  4PI.
   Note that 4PI * Yl-m(0,0) = (-1)^m * 4PI * Ylm(0,0) is stored
   in the array Ylm and not Ylm(0,0).
 
- -Allocate storage space expm, if necessary.
+ -Allocate storage space expm.
 */
 
 
  expm_r = (real *)calloc ( l_max+1, sizeof(real) );
  expm_i = (real *)calloc ( l_max+1, sizeof(real) );
 
- Ylm = r_ylm(Ylm, 0., 0., l_max);
+ h_r = (real *)malloc ( (MAX(l_max,1)+1)*LSUM_BATCH * sizeof(real) );
+ h_i = (real *)malloc ( (MAX(l_max,1)+1)*LSUM_BATCH * sizeof(real) );
+
+ Ylm = r_ylm(Ylm, ctx->ylmc, 0., 0., l_max);
 
  for(l = 0, i = 1; l <= l_max; l ++)
  {
@@ -207,40 +455,11 @@ mat Hl;                        /* Hankel function */
 /*
   Ylm(0,0) is purely real => only multiply Ylm->rel
 */
-     Ylm->rel[i] *= faux_r;
+     Ylm->rel[2*i] *= faux_r;
      faux_r = -faux_r;
    }
  }
 
-#ifdef NOT
-
- if (l_max > l_max_y)
- {
-   Ylm = r_ylm(Ylm, 0., 0., l_max);
-   l_max_y = l_max;
-
-   for(l = 0, i = 1; l <= l_max; l ++)
-   {
-     faux_r = M1P(l)*4.*PI;
-     for(m = -l; m <= l; m++, i++)
-     {
-   /*
-     Ylm(0,0) is purely real => only multiply Ylm->rel
-   */
-       Ylm->rel[i] *= faux_r;
-       faux_r = -faux_r;
-     }
-   }
-
-   if (expm_r == NULL) expm_r = (real *)calloc (l_max+1, sizeof(real) );
-   else         expm_r = (real *)realloc(expm_r, l_max+1*sizeof(real) );
-
-   if (expm_i == NULL) expm_i = (real *)calloc (l_max+1, sizeof(real) );
-   else         expm_i = (real *)realloc(expm_i, l_max+1*sizeof(real) );
- }
-
-#endif
-
 /*
   Some often used values
 */
@@ -281,276 +500,58 @@ mat Hl;                        /* Hankel function */
 
 
 /***********************
-  Two cases:
-   - k_in != 0,
-   - k_in == 0. makes things much more easier.
-***********************/
-
-/***********************
-  Fist: k_in == 0.
-  (Alternatively:
-   if (R_hypot(k_in[1], k_in[2]) < Tolerance) )
-***********************/
- if( (k_in[1] == 0.) && (k_in[2] == 0.) )
- {
-/*
- loop over lattice vectors a1 and a2:
+ Loop over lattice vectors a1 and a2:
  n1 >= 0: Only one half of the lattice. The other half is added within the
           m - loop: phi(-r) = phi(r) + PI.
-*/
-
-   n1_max = (int) R_sqrt(r_max * f2 / (f1*f2 - f12*f12) );
-
-   for ( n1 = 0, r0_x = 0., r0_y = 0.;
-         n1 <= n1_max;
-         r0_x += a1_x, r0_y += a1_y, n1 ++ )
-   {
-     faux_r = R_sqrt( fb*n1*n1 + fc );
-     n2_min = (int) (fa*n1 - faux_r);
-     n2_max = (int) (fa*n1 + faux_r);
-
-
-     for ( n2 = n2_min, r_x = r0_x + n2_min*a2_x, r_y = r0_y + n2_min*a2_y;
-           n2 <= n2_max; r_x += a2_x, r_y += a2_y, n2 ++ )
-     {
-     /*
-       The origin is not included in the summation.
-     */
-       if ((n1 == 0) && (n2 == 0)) break;
-
-       r_abs = R_hypot(r_x, r_y);
-       Hl = c_hank1 ( Hl, k_r*r_abs, k_i*r_abs, l_max);
-
-       exp_phi_r =  r_x/r_abs;                        /*   cos(phi(r)) */
-       exp_phi_i = -r_y/r_abs;                        /* - sin(phi(r)) */
-
-/*
- loops over l and m:
-*/
-     /* First l = 0:  +/- r */
-
-       expm_r[0] = 1.; expm_i[0] = 0.;
-
-       Llm->rel[1] += 2*Hl->rel[1];
-       Llm->iel[1] += 2*Hl->iel[1];
-
-/*
-        Now all other l,m:
-
-  Summation over +/- r (phi / phi + PI) and +/- m
-
-  for even m's != 0:
-     exp (-im (phi+PI)) = exp (-im phi)
-  => add contributions from the two half lattices for even m's
-
-  for odd m's:
-     exp (-im (phi+PI)) = -exp (-im phi)
-  => cancellation of the two half lattices for odd m's
-
-  Because Y(0,0) = 0. for odd (l+m), only even l's have nonzero elements
-  in Llm.
-
-  => skip summation for odd l's
-*/
-       for(l = 2; l <= l_max; l+= 2)
-       {
-         cri_mul(expm_r+l-1, expm_i+l-1,
-                 expm_r[l-2], expm_i[l-2], exp_phi_r, exp_phi_i);
-         cri_mul(expm_r+l, expm_i+l,
-                 expm_r[l-1], expm_i[l-1], exp_phi_r, exp_phi_i);
-
-         off = l*(l+1) + 1;
-
-     /* First m = 0, exp(-im*phi) = 1. */
-         Llm->rel[off] += 2*Hl->rel[l+1];
-         Llm->iel[off] += 2*Hl->iel[l+1];
-
-     /* Now all other m's (+ m and - m in the same loop) */
-         for(m = 2; m <= l; m +=2 )
-         {
-         /* + m: */
-           cri_mul(&faux_r, &faux_i,
-                   expm_r[m], expm_i[m], Hl->rel[l+1], Hl->iel[l+1]);
-           Llm->rel[off + m] += 2*faux_r;
-           Llm->iel[off + m] += 2*faux_i;
-
-         /* - m: exp(-i(-m) phi) = exp(-im phi)* */
-           cri_mul(&faux_r, &faux_i,
-                   expm_r[m], -expm_i[m], Hl->rel[l+1], Hl->iel[l+1]);
-           Llm->rel[off - m] += 2*faux_r;
-           Llm->iel[off - m] += 2*faux_i;
-         }   /* m */
-       }   /* l */
-     }   /* lattice vectors a2 */
-   }   /* lattice vectors a1 */
- }    /* end of k_in == 0. */
 
-/***********************
-  Now: k_in != 0.
+ The lattice points are collected in batches of LSUM_BATCH; the Hankel
+ functions of a whole batch are calculated at once (c_hank1_vec) and
+ the contributions of the batch are added to Llm by lsum_ii_add.
 ***********************/
 
- else /* k_in != 0. */
- {
-/*
- loop over lattice vectors a1 and a2:
- n1 >= 0: Only one half of the lattice. The other half is added within the
-          m - loop: phi(-r) = phi(r) + PI.
-*/
+ n_pts = 0;
+ n1_max = (int) R_sqrt(r_max * f2 / (f1*f2 - f12*f12) );
 
-   Hl = NULL;
-   n1_max = (int) R_sqrt(r_max * f2 / (f1*f2 - f12*f12) );
-
-   for ( n1 = 0, r0_x = 0., r0_y = 0.;
-         n1 <= n1_max;
-         r0_x += a1_x, r0_y += a1_y, n1 ++ )
-   {
-     faux_r = R_sqrt( fb*n1*n1 + fc );
-     n2_min = (int) (fa*n1 - faux_r);
-     n2_max = (int) (fa*n1 + faux_r);
+ for ( n1 = 0, r0_x = 0., r0_y = 0.;
+       n1 <= n1_max;
+       r0_x += a1_x, r0_y += a1_y, n1 ++ )
+ {
+   faux_r = R_sqrt( fb*n1*n1 + fc );
+   n2_min = (int) (fa*n1 - faux_r);
+   n2_max = (int) (fa*n1 + faux_r);
 
-     for ( n2 = n2_min, r_x = r0_x + n2_min*a2_x, r_y = r0_y + n2_min*a2_y;
+   for ( n2 = n2_min, r_x = r0_x + n2_min*a2_x, r_y = r0_y + n2_min*a2_y;
          n2 <= n2_max; r_x += a2_x, r_y += a2_y, n2 ++ )
-     {
-     /*
-       The origin is not included in the summation.
-     */
-       if ((n1 == 0) && (n2 == 0)) break;
-
-       r_abs = R_hypot(r_x, r_y);
-       Hl = c_hank1 ( Hl, k_r*r_abs, k_i*r_abs, l_max);
-
-       exp_phi_r =  r_x/r_abs;                        /*   cos(phi(r)) */
-       exp_phi_i = -r_y/r_abs;                        /* - sin(phi(r)) */
-
-       faux_r = k_in[1]*r_x + k_in[2]*r_y;
-       cri_expi(&exp_ikr_r, &exp_ikr_i, faux_r, 0.); /* exp(i*k_in*r) */
-
-/*
-  loops over l and m:
-*/
-     /* first l = 0 */
-
-       expm_r[0] = 1.; expm_i[0] = 0.;
-
-       /* + r */
-       cri_mul(&faux_r, &faux_i, exp_ikr_r, exp_ikr_i, Hl->rel[1], Hl->iel[1]);
-       Llm->rel[1] += faux_r;
-       Llm->iel[1] += faux_i;
-
-       /* - r */
-       cri_mul(&faux_r, &faux_i, exp_ikr_r,-exp_ikr_i, Hl->rel[1], Hl->iel[1]);
-       Llm->rel[1] += faux_r;
-       Llm->iel[1] += faux_i;
-
-     /* Now all other l,m */
-       for(l = 1; l <= l_max; l++ )
-       {
-         off = l*(l+1) + 1;
-         cri_mul(expm_r+l, expm_i+l,
-                 expm_r[l-1], expm_i[l-1], exp_phi_r, exp_phi_i);
-
-/*
-  Summation over +/- r (phi / phi + PI) and +/- m
-
-  for even m's != 0:
-     exp (-im (phi+PI)) = exp (-im phi)
-     exp (ik(-r) )     = (exp (ikr) )*
-
-  for odd m's:
-     exp (-im (phi+PI)) = -exp (-im phi)
-     exp (ik(-r) )     = (exp (ikr) )*
-
-  => no cancellation.
+   {
+   /*
+     The origin is not included in the summation.
+   */
+     if ((n1 == 0) && (n2 == 0)) break;
 
-  Because Y(0,0) = 0. for odd (l+m), only even l's have nonzero elements
-  in Llm.
+     r_abs = R_hypot(r_x, r_y);
+     pts_x[n_pts] = r_x;
+     pts_y[n_pts] = r_y;
+     pts_r[n_pts] = r_abs;
+     z_r[n_pts] = k_r*r_abs;
+     z_i[n_pts] = k_i*r_abs;
+     n_pts ++;
 
-  => skip summation for odd (l+m)'s
-*/
-         if(ODD(l))
-         {
-       /*
-         Loop over all odd m's (+ m and - m in the same loop)
-       */
-           for(m = 1; m <= l; m += 2)
-           {
-         /* + m: */
-             cri_mul(&faux_r, &faux_i,
-                     expm_r[m], expm_i[m], Hl->rel[l+1], Hl->iel[l+1]);
-           /* + r */
-             cri_mul(&faux2_r, &faux2_i, exp_ikr_r, exp_ikr_i, faux_r, faux_i);
-             Llm->rel[off + m] += faux2_r;
-             Llm->iel[off + m] += faux2_i;
-           /* - r  '-' for odd m's */
-             cri_mul(&faux2_r, &faux2_i, exp_ikr_r,-exp_ikr_i,-faux_r,-faux_i);
-             Llm->rel[off + m] += faux2_r;
-             Llm->iel[off + m] += faux2_i;
-
-         /* - m: exp(-i(-m) phi) = exp(-im phi)* */
-             cri_mul(&faux_r, &faux_i,
-                     expm_r[m], -expm_i[m], Hl->rel[l+1], Hl->iel[l+1]);
-           /* + r */
-             cri_mul(&faux2_r, &faux2_i, exp_ikr_r, exp_ikr_i, faux_r, faux_i);
-             Llm->rel[off - m] += faux2_r;
-             Llm->iel[off - m] += faux2_i;
-           /* - r  '-' for odd m's */
-             cri_mul(&faux2_r, &faux2_i, exp_ikr_r,-exp_ikr_i,-faux_r,-faux_i);
-             Llm->rel[off - m] += faux2_r;
-             Llm->iel[off - m] += faux2_i;
-           }   /* m */
-         }      /* odd l's */
-         else   /* even l's */
-         {
-       /*
-         Loop over all even m's:
-         - First m = 0, exp(-im*phi) = 1.
-         - Then all other even m's.
-       */
+     if(n_pts == LSUM_BATCH)
+     {
+       c_hank1_vec(h_r, h_i, z_r, z_i, n_pts, l_max);
+       lsum_ii_add(Llm, n_pts, pts_x, pts_y, pts_r, h_r, h_i,
+                   k_in, l_max, expm_r, expm_i);
+       n_pts = 0;
+     }
+   }   /* lattice vectors a2 */
+ }   /* lattice vectors a1 */
 
-       /* First m = 0, exp(-im*phi) = 1. */
-         /* + r */
-           cri_mul(&faux_r, &faux_i,
-                   exp_ikr_r, exp_ikr_i, Hl->rel[l+1], Hl->iel[l+1]);
-           Llm->rel[off] += faux_r;
-           Llm->iel[off] += faux_i;
-         /* - r  */
-           cri_mul(&faux_r, &faux_i,
-                   exp_ikr_r,-exp_ikr_i, Hl->rel[l+1], Hl->iel[l+1]);
-           Llm->rel[off] += faux_r;
-           Llm->iel[off] += faux_i;
-
-     /* Now all other even m's (+ m and - m in the same loop) */
-           for(m = 2; m <= l; m += 2)
-           {
-         /* + m: */
-             cri_mul(&faux_r, &faux_i,
-                     expm_r[m], expm_i[m], Hl->rel[l+1], Hl->iel[l+1]);
-           /* + r */
-             cri_mul(&faux2_r, &faux2_i, exp_ikr_r, exp_ikr_i, faux_r, faux_i);
-             Llm->rel[off + m] += faux2_r;
-             Llm->iel[off + m] += faux2_i;
-           /* - r  '+' for even m's */
-             cri_mul(&faux2_r, &faux2_i, exp_ikr_r,-exp_ikr_i, faux_r, faux_i);
-             Llm->rel[off + m] += faux2_r;
-             Llm->iel[off + m] += faux2_i;
-
-         /* - m: exp(-i(-m) phi) = exp(-im phi)* */
-             cri_mul(&faux_r, &faux_i,
-                     expm_r[m], -expm_i[m], Hl->rel[l+1], Hl->iel[l+1]);
-           /* + r */
-             cri_mul(&faux2_r, &faux2_i, exp_ikr_r, exp_ikr_i, faux_r, faux_i);
-             Llm->rel[off - m] += faux2_r;
-             Llm->iel[off - m] += faux2_i;
-           /* - r  '+' for even m's */
-             cri_mul(&faux2_r, &faux2_i, exp_ikr_r,-exp_ikr_i,faux_r,faux_i);
-             Llm->rel[off - m] += faux2_r;
-             Llm->iel[off - m] += faux2_i;
-           }   /* even l's */
-         }   /* m */
-       }   /* l */
-     }   /* lattice vectors a2 */
-   }   /* lattice vectors a1 */
- }  /* end of k_in != 0 */
+ if(n_pts > 0)
+ {
+   c_hank1_vec(h_r, h_i, z_r, z_i, n_pts, l_max);
+   lsum_ii_add(Llm, n_pts, pts_x, pts_y, pts_r, h_r, h_i,
+               k_in, l_max, expm_r, expm_i);
+ }
 
 
 /***********************
@@ -565,14 +566,18 @@ mat Hl;                        /* Hankel function */
  /*
    Ylm(0,0) is purely real => only multiply with Ylm->rel
  */
-    Llm->rel[i] *= Ylm->rel[i];
-    Llm->iel[i] *= Ylm->rel[i];
+    Llm->rel[2*i] *= Ylm->rel[2*i];
+    Llm->iel[2*i] *= Ylm->rel[2*i];
  }
 
- matfree(Hl);
  matfree(Ylm);
  free(expm_r);
  free(expm_i);
+ free(h_r);
+ free(h_i);
+
+ if(ctx->lsm != NULL)
+   lsm_put(ctx->lsm, Llm, k_r, k_i, k_in, a, l_max, epsilon);
 
  return(Llm);
 
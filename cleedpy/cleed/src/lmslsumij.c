@@ -40,10 +40,103 @@ GH/18.09.02 - change summation boundaries for n1 and n2 so that they comply
 #define GEO_TOLERANCE 0.0001
 #endif
 
+#define LSUM_BATCH 64          /* lattice points per call of c_hank1_vec */
+
 /*======================================================================*/
 /*======================================================================*/
 
-int ms_lsum_ij ( mat *p_Llm_p, mat *p_Llm_m,
+static void lsum_ij_add ( struct ctx_str *ctx, mat Llm_p, mat Llm_m,
+                          mat pref, int n, real *pts_x, real *pts_y,
+                          real *pts_r, real *d_ij, real *h_r, real *h_i,
+                          real *k_in, int l_max, mat *p_Ylm )
+
+/************************************************************************
+
+ Add the contributions of n lattice points P = (pts_x, pts_y)
+ (|P + d_ij| = pts_r) to the lattice sums Llm_p and Llm_m (see
+ ms_lsum_ij).
+
+ The Hankel functions of the points are stored as calculated by
+ c_hank1_vec: H(1)l(k*|P_j + d_ij|) = h_r[l*n + j] + i*h_i[l*n + j].
+ *p_Ylm is used as storage for the spherical harmonics.
+
+*************************************************************************/
+{
+int j, l, m, off;
+
+real r_x, r_y, r_z, r_abs, r_phi;
+real faux_r, faux_i;
+real fauxp_r, fauxp_i;
+real fauxm_r, fauxm_i;
+real exp_ikp_i, exp_ikp_r;
+
+mat Ylm;
+
+ Ylm = *p_Ylm;
+ r_z = +d_ij[3];
+
+ for(j = 0; j < n; j ++)
+ {
+   r_x = +d_ij[1] + pts_x[j];
+   r_y = +d_ij[2] + pts_y[j];
+   r_abs = pts_r[j];
+
+ /*
+    Prepare arguments for Ylm:
+      cos(theta) = r_z/r_abs
+      phi = arctan(r_y/r_x)
+ */
+   r_phi = R_atan2(r_y, r_x);
+   Ylm = r_ylm(Ylm, ctx->ylmc, r_z/r_abs, r_phi, l_max);
+
+ /* Prepare prefactor exp(-ikP) */
+   faux_r = +k_in[1]*pts_x[j] + k_in[2]*pts_y[j];
+   cri_expi(&exp_ikp_r, &exp_ikp_i, -faux_r, 0.); /* exp(-i*k_in*p) */
+
+ /*
+   loops over l and m:
+ */
+   for(l = 0; l <= l_max; l++ )
+   {
+     off = l*(l+1) + 1;
+
+ /*
+   calculate m-independent prefactors:
+    (-1)^l * -8PI * (i)^(l+1) * Hl * exp(-ikP)  for Llm_p
+             -8PI * (i)^(l+1) * Hl * exp(+ikP)  for Llm_m
+ */
+     cri_mul(&faux_r, &faux_i, pref->rel[2*(l+1)], pref->iel[2*(l+1)],
+             h_r[l*n + j], h_i[l*n + j]);
+
+     cri_mul(&fauxp_r, &fauxp_i, faux_r, faux_i,
+             exp_ikp_r, +exp_ikp_i);              /* for Llm_p */
+
+     cri_mul(&fauxm_r, &fauxm_i, faux_r, faux_i,
+             exp_ikp_r, -exp_ikp_i);              /* for Llm_m */
+
+     for(m = -l; m <= l; m ++)
+     {
+     /* Hl * exp(-ikp) * Ylm  */
+       cri_mul(&faux_r, &faux_i, Ylm->rel[2*(off+m)], Ylm->iel[2*(off+m)],
+               fauxp_r, fauxp_i);
+       Llm_p->rel[2*(off + m)] += faux_r*M1P(l+m);
+       Llm_p->iel[2*(off + m)] += faux_i*M1P(l+m);
+
+       cri_mul(&faux_r, &faux_i, Ylm->rel[2*(off+m)], Ylm->iel[2*(off+m)],
+               fauxm_r, fauxm_i);
+       Llm_m->rel[2*(off + m)] += faux_r*M1P(m);
+       Llm_m->iel[2*(off + m)] += faux_i*M1P(m);
+     }  /* m */
+   }    /* l */
+ }  /* j */
+
+ *p_Ylm = Ylm;
+} /* end of function lsum_ij_add */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int ms_lsum_ij ( struct ctx_str *ctx, mat *p_Llm_p, mat *p_Llm_m,
                  real k_r, real k_i, real *k_in,
                  real *a, real *d_ij,
                  int l_max, real epsilon )
@@ -56,6 +149,7 @@ int ms_lsum_ij ( mat *p_Llm_p, mat *p_Llm_m,
 
  INPUT:
 
+   struct ctx_str *ctx - (input) calculation context (Ylm coefficients).
    mat *p_Llm_p, *p_Llm_m - (pointer to output) lattice sums for +/- d_ij
                (see below).
    real k_r, k_i - (input) real and imag.part of |k|.
@@ -160,9 +254,9 @@ int ms_lsum_ij ( mat *p_Llm_p, mat *p_Llm_m,
 
 *************************************************************************/
 {
-int l,m;                       /* quantum numbers l,m */
-int off;                       /* offset in the arrays Ylm and Llm */
-int i, iaux;
+int l;                         /* quantum number l */
+int iaux;
+int n_pts;                     /* number of points in the current batch */
 
 int n1, n1_min, n1_max;        /* counters for lattice vectors */
 int n2, n2_min, n2_max;
@@ -173,20 +267,21 @@ real fa, fb, fc;
 
 real r0_x, r0_y, r_x, r_y, r_z;     /* lattice vectors between the planes */
 real p0_x, p0_y, p_x, p_y;          /* lattice vectors in the plane */
-real r_max, r_abs, r_phi;
+real r_max, r_abs;
 real a1_x, a1_y, a2_x, a2_y;        /* basic lattice vectors */
 
 real faux_r, faux_i;
-real fauxp_r, fauxp_i;
-real fauxm_r, fauxm_i;
-real exp_ikp_i, exp_ikp_r;
 
 mat Llm_p, Llm_m;              /* lattice sums */
-mat Hl;                        /* Hankel function */
-mat Ylm;                       /* spherical harmonics */
 mat pref;                      /* -8*PI * i^(l+1) */
 
-Hl = Ylm = pref = NULL;
+mat Ylm;                       /* spherical harmonics */
+
+real pts_x[LSUM_BATCH], pts_y[LSUM_BATCH], pts_r[LSUM_BATCH];
+real z_r[LSUM_BATCH], z_i[LSUM_BATCH];
+real *h_r, *h_i;               /* Hankel functions of the batch */
+
+Ylm = pref = NULL;
 
 Llm_p = *p_Llm_p;
 Llm_m = *p_Llm_m;
@@ -228,10 +323,16 @@ Llm_m = *p_Llm_m;
  pref->iel[0] = - 8*PI*k_i;
  for(l = 1; l <= iaux; l ++)
  {
-    pref->rel[l] = -pref->iel[l-1];
-    pref->iel[l] =  pref->rel[l-1];
+    pref->rel[2*l] = -pref->iel[2*(l-1)];
+    pref->iel[2*l] =  pref->rel[2*(l-1)];
  }
 
+/*
+  Storage for the Hankel functions of a batch of lattice points
+*/
+ h_r = (real *)malloc ( (MAX(l_max,1)+1)*LSUM_BATCH * sizeof(real) );
+ h_i = (real *)malloc ( (MAX(l_max,1)+1)*LSUM_BATCH * sizeof(real) );
+
 /*
   Quantities used to calculate the cut off radius and counters:
 */
@@ -300,6 +401,8 @@ Llm_m = *p_Llm_m;
 
    faux_r = -fb / fa;
 
+   n_pts = 0;
+
    n1_min = (int) R_nint(faux_r + faux_i);
    n1_max = (int) R_nint(faux_r - faux_i);
 
@@ -354,68 +457,36 @@ Llm_m = *p_Llm_m;
        if ( (r_abs < r_max) && (r_abs > GEO_TOLERANCE ) )
        {
          r_abs = R_sqrt(r_abs);
-         Hl = c_hank1 ( Hl, k_r*r_abs, k_i*r_abs, l_max);
-
-       /*
-          Prepare arguments for Ylm:
-            cos(theta) = r_z/r_abs
-            phi = arctan(r_y/r_x)
-       */
-         r_phi = R_atan2(r_y, r_x);
-         Ylm = r_ylm(Ylm, r_z/r_abs, r_phi, l_max);
-
-       /* Prepare prefactor exp(-ikP) */
-         faux_r = +k_in[1]*p_x + k_in[2]*p_y;
-         cri_expi(&exp_ikp_r, &exp_ikp_i, -faux_r, 0.); /* exp(-i*k_in*p) */
-
-       /*
-         loops over l and m:
-       */
-         for(l = 0; l <= l_max; l++ )
+         pts_x[n_pts] = p_x;
+         pts_y[n_pts] = p_y;
+         pts_r[n_pts] = r_abs;
+         z_r[n_pts] = k_r*r_abs;
+         z_i[n_pts] = k_i*r_abs;
+         n_pts ++;
+
+         if(n_pts == LSUM_BATCH)
          {
-           off = l*(l+1) + 1;
-
-       /*
-         calculate m-independent prefactors:
-          (-1)^l * -8PI * (i)^(l+1) * Hl * exp(-ikP)  for Llm_p
-                   -8PI * (i)^(l+1) * Hl * exp(+ikP)  for Llm_m
-       */
-           cri_mul(&faux_r, &faux_i, pref->rel[l+1], pref->iel[l+1],
-                   Hl->rel[l+1], Hl->iel[l+1]);
-
-           cri_mul(&fauxp_r, &fauxp_i, faux_r, faux_i,
-                   exp_ikp_r, +exp_ikp_i);              /* for Llm_p */
-
-/*
-           faux_r *= M1P(l);
-           faux_i *= M1P(l);
-*/
-           cri_mul(&fauxm_r, &fauxm_i, faux_r, faux_i,
-                   exp_ikp_r, -exp_ikp_i);              /* for Llm_m */
-
-
-           for(m = -l; m <= l; m ++)
-           {
-           /* Hl * exp(-ikp) * Ylm  */
-             cri_mul(&faux_r, &faux_i, Ylm->rel[off+m], Ylm->iel[off+m],
-                     fauxp_r, fauxp_i);
-             Llm_p->rel[off + m] += faux_r*M1P(l+m);
-             Llm_p->iel[off + m] += faux_i*M1P(l+m);
-
-             cri_mul(&faux_r, &faux_i, Ylm->rel[off+m], Ylm->iel[off+m],
-                     fauxm_r, fauxm_i);
-             Llm_m->rel[off + m] += faux_r*M1P(m);
-             Llm_m->iel[off + m] += faux_i*M1P(m);
-           }  /* m */
-         }    /* l */
+           c_hank1_vec(h_r, h_i, z_r, z_i, n_pts, l_max);
+           lsum_ij_add(ctx, Llm_p, Llm_m, pref, n_pts, pts_x, pts_y, pts_r,
+                       d_ij, h_r, h_i, k_in, l_max, &Ylm);
+           n_pts = 0;
+         }
        }    /* if r < r_max */
      }  /* lattice vectors a2 */
    }    /* lattice vectors a1 */
+
+   if(n_pts > 0)
+   {
+     c_hank1_vec(h_r, h_i, z_r, z_i, n_pts, l_max);
+     lsum_ij_add(ctx, Llm_p, Llm_m, pref, n_pts, pts_x, pts_y, pts_r,
+                 d_ij, h_r, h_i, k_in, l_max, &Ylm);
+   }
  }  /* end of k_in != 0 */
 
  matfree(pref);
- matfree(Hl);
- matfree(Ylm);
+ if(Ylm != NULL) matfree(Ylm);
+ free(h_r);
+ free(h_i);
 
  return(1);
 
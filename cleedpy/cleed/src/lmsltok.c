@@ -193,13 +193,13 @@ mat Maux;
 
  pref_i = 8.*PI*PI / (beams->k_r[0] * rel_area);
 
- ptr_r = Mkk->rel + 1;
- ptr_i = Mkk->iel + 1;
+ ptr_r = Mkk->rel + 2;
+ ptr_i = Mkk->iel + 2;
  for(i_r = 0; i_r < Mkk->rows; i_r ++)
  {
    cri_mul(&faux_r, &faux_i, 0., pref_i,
            (beams+i_r)->Akz_r, (beams+i_r)->Akz_i);
-   for(i_c = 0; i_c < Mkk->cols; i_c ++, ptr_r ++, ptr_i ++ )
+   for(i_c = 0; i_c < Mkk->cols; i_c ++, ptr_r += 2, ptr_i += 2 )
    {
      cri_mul(ptr_r, ptr_i, *ptr_r, *ptr_i, faux_r, faux_i);
    }
@@ -212,7 +212,7 @@ mat Maux;
  {
    iaux = Mkk->rows * Mkk->cols;
    for(i_r = 1; i_r <= iaux; i_r += Mkk->cols + 1)
-     *(Mkk->rel+i_r) += unsc;
+     *(Mkk->rel+2*i_r) += unsc;
  }
  return(Mkk);
 
@@ -22,7 +22,6 @@
 #define CONTROL_X
 */
 
-#define CONTROL
 #define WARNING
 #define ERROR
 
@@ -146,7 +145,7 @@ mat UL, UR, LL, LR;
   - UL separates into two blocks with even (l1+m1), (l2+m2) and odd
     (l1+m1), (l2+m2) which are stored in Maux_a and Maux_b, respectively.
 *************************************************************************/
- for(i_atoms_1 = 0, iev2 = 1, iod2 = 1, ptr_1 = UL->rel+1, ptr_2 = UL->iel+1;
+ for(i_atoms_1 = 0, iev2 = 1, iod2 = 1, ptr_1 = UL->rel+2, ptr_2 = UL->iel+2;
      i_atoms_1 < first_atoms; i_atoms_1 ++)
  {
    for(l1 = 0; l1 <= l_max; l1 ++)
@@ -158,14 +157,14 @@ mat UL, UR, LL, LR;
        {
          for(l2 = 0; l2 <= l_max; l2 ++)
          {
-           for(m2 = -l2; m2 <= l2; m2 ++, ptr_1 ++, ptr_2 ++)
+           for(m2 = -l2; m2 <= l2; m2 ++, ptr_1 += 2, ptr_2 += 2)
            {
              if(ODD(l2+m2))
              {
                if( odd1)
                {
-                 Maux_b->rel[iod2] = *ptr_1;
-                 Maux_b->iel[iod2] = *ptr_2;
+                 Maux_b->rel[2*iod2] = *ptr_1;
+                 Maux_b->iel[2*iod2] = *ptr_2;
                  iod2++;
                }
              }
@@ -173,8 +172,8 @@ mat UL, UR, LL, LR;
              {
                if(!odd1)
                {
-                 Maux_a->rel[iev2] = *ptr_1;
-                 Maux_a->iel[iev2] = *ptr_2;
+                 Maux_a->rel[2*iev2] = *ptr_1;
+                 Maux_a->iel[2*iev2] = *ptr_2;
                  iev2++;
                }
              }  /* else */
@@ -185,9 +184,10 @@ mat UL, UR, LL, LR;
    }  /* l1 */
  }  /* i_atoms_1 */
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(ms_partinv): UL, Maux_a/od: \n");
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(ms_partinv): UL, Maux_a/od: \n");
+ }
 
 /*************************************************************************
  Matrix inversion: (Maux_a/od)^-1
@@ -196,15 +196,16 @@ mat UL, UR, LL, LR;
  Maux_a = matinv(Maux_a, Maux_a);
  Maux_b = matinv(Maux_b, Maux_b);
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(ms_partinv): (Maux_b)^-1: \n");
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(ms_partinv): (Maux_b)^-1: \n");
+ }
 
 /*************************************************************************
   Copy (Maux_a)^-1 and (Maux_b)^-1 back into UL in the natural order.
 *************************************************************************/
 
- for(i_atoms_1 = 0, iev2 = 1, iod2 = 1, ptr_1 = UL->rel+1, ptr_2 = UL->iel+1;
+ for(i_atoms_1 = 0, iev2 = 1, iod2 = 1, ptr_1 = UL->rel+2, ptr_2 = UL->iel+2;
      i_atoms_1 < first_atoms; i_atoms_1 ++)
  {
    for(l1 = 0; l1 <= l_max; l1 ++)
@@ -216,14 +217,14 @@ mat UL, UR, LL, LR;
        {
          for(l2 = 0; l2 <= l_max; l2 ++)
          {
-           for(m2 = -l2; m2 <= l2; m2 ++, ptr_1 ++, ptr_2 ++)
+           for(m2 = -l2; m2 <= l2; m2 ++, ptr_1 += 2, ptr_2 += 2)
            {
              if(ODD(l2+m2))
              {
                if( odd1)
                {
-                 *ptr_1 = Maux_b->rel[iod2];
-                 *ptr_2 = Maux_b->iel[iod2];
+                 *ptr_1 = Maux_b->rel[2*iod2];
+                 *ptr_2 = Maux_b->iel[2*iod2];
                  iod2++;
                }
                else
@@ -236,8 +237,8 @@ mat UL, UR, LL, LR;
              {
                if(!odd1)
                {
-                 *ptr_1 = Maux_a->rel[iev2];
-                 *ptr_2 = Maux_a->iel[iev2];
+                 *ptr_1 = Maux_a->rel[2*iev2];
+                 *ptr_2 = Maux_a->iel[2*iev2];
                  iev2++;
                }
                else
@@ -262,9 +263,10 @@ mat UL, UR, LL, LR;
  iaux = first_atoms * (l_max + 1)*(l_max + 1);
  if(iaux == Mbg->cols)
  {
-#ifdef CONTROL
- fprintf(STDCTR,"(ms_partinv): All atoms are in the same plane.\n");
-#endif
+   if(LOG_ON(LOG_MS, LOG_CONTROL))
+   {
+     fprintf(STDCTR,"(ms_partinv): All atoms are in the same plane.\n");
+   }
 
    matfree(Maux_a);
    matfree(Maux_b);
@@ -300,44 +302,44 @@ mat UL, UR, LL, LR;
  LL = matext(LL, Mbg, iaux+1, Mbg->rows, 1, iaux);
  LR = matext(LR, Mbg, iaux+1, Mbg->rows, iaux+1, Mbg->cols);
 
-#ifdef CONTROL
- fprintf(STDCTR,"\n(ms_partinv):\tUL(%d x %d) UR(%d x %d)\n",
-                 UL->rows,UL->cols, UR->rows,UR->cols);
- fprintf(STDCTR,"\t\tLL(%d x %d) LR(%d x %d)\n",
-                 LL->rows,LL->cols, LR->rows,LR->cols);
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"\n(ms_partinv):\tUL(%d x %d) UR(%d x %d)\n",
+                   UL->rows,UL->cols, UR->rows,UR->cols);
+   fprintf(STDCTR,"\t\tLL(%d x %d) LR(%d x %d)\n",
+                   LL->rows,LL->cols, LR->rows,LR->cols);
+ }
 
 /*
   Maux_a = (LL*UL^-1)
   Maux_b = (LL*UL^-1)*UR ) = Maux_a * UR
 */
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(ms_partinv): Maux_a\n");
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(ms_partinv): Maux_a\n");
+ }
 
  Maux_a = matmul(Maux_a, LL, UL);
-#ifdef CONTROL_X
- fprintf(STDCTR,"(ms_partinv): Maux_b\n");
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(ms_partinv): Maux_b\n");
+ }
 
  Maux_b = matmul(Maux_b, Maux_a, UR);
 
 /*
-   Maux_b = -(LR - (LL*UL^-1)*UR) = Maux_b - LR (first real then imag. part)
+   Maux_b = -(LR - (LL*UL^-1)*UR) = Maux_b - LR (real and imag. parts)
    LR = Maux_b^-1 = -S
 */
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(ms_partinv): LR\n");
-#endif
-
- iaux = LR->cols * LR->rows;
- for(ptr_1 = LR->rel+1, ptr_2 = Maux_b->rel+1, ptr_end = LR->rel+iaux;
-     ptr_1 <= ptr_end; ptr_1 ++, ptr_2 ++)
- { *ptr_2 -= *ptr_1; }
+ if(LOG_ON(LOG_MS, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(ms_partinv): LR\n");
+ }
 
- for(ptr_1 = LR->iel+1, ptr_2 = Maux_b->iel+1, ptr_end = LR->iel+iaux;
+ iaux = 2 * LR->cols * LR->rows;
+ for(ptr_1 = LR->rel+2, ptr_2 = Maux_b->rel+2, ptr_end = LR->rel+iaux+1;
      ptr_1 <= ptr_end; ptr_1 ++, ptr_2 ++)
  { *ptr_2 -= *ptr_1; }
 
@@ -349,9 +351,10 @@ mat UL, UR, LL, LR;
   Q -> UR = - (UL^-1)*UR * S = Maux_b * LR
 */
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(ms_partinv): LL, UR\n");
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(ms_partinv): LL, UR\n");
+ }
 
  Maux_b = matmul(Maux_b, UL, UR);
 
@@ -363,36 +366,30 @@ mat UL, UR, LL, LR;
           = UL - Maux_b * LL
 */
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(ms_partinv): UL\n");
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(ms_partinv): UL\n");
+ }
 
  Maux_b = matmul(Maux_b, Maux_b, LL);
 
- iaux = UL->cols * UL->rows;
- for(ptr_1 = UL->rel+1, ptr_2 = Maux_b->rel+1, ptr_end = UL->rel+iaux;
-     ptr_1 <= ptr_end; ptr_1 ++, ptr_2 ++)
- { *ptr_1 -= *ptr_2; }
-
- for(ptr_1 = UL->iel+1, ptr_2 = Maux_b->iel+1, ptr_end = UL->iel+iaux;
+ iaux = 2 * UL->cols * UL->rows;
+ for(ptr_1 = UL->rel+2, ptr_2 = Maux_b->rel+2, ptr_end = UL->rel+iaux+1;
      ptr_1 <= ptr_end; ptr_1 ++, ptr_2 ++)
  { *ptr_1 -= *ptr_2; }
 
 /*
   S -> LR = -LR
 */
-#ifdef CONTROL_X
- fprintf(STDCTR,"(ms_partinv): S\n");
-#endif
-
- iaux = LR->cols * LR->rows;
- for(ptr_1 = LR->rel+1, ptr_2 = LR->iel+1, ptr_end = LR->rel+iaux;
-     ptr_1 <= ptr_end; ptr_1 ++, ptr_2 ++)
+ if(LOG_ON(LOG_MS, LOG_CONTROL_X))
  {
-   *ptr_1 = -*ptr_1;
-   *ptr_2 = -*ptr_2;
+   fprintf(STDCTR,"(ms_partinv): S\n");
  }
 
+ iaux = 2 * LR->cols * LR->rows;
+ for(ptr_1 = LR->rel+2, ptr_end = LR->rel+iaux+1; ptr_1 <= ptr_end; ptr_1 ++)
+ { *ptr_1 = -*ptr_1; }
+
  matfree(Maux_a);
  matfree(Maux_b);
 
@@ -401,9 +398,10 @@ mat UL, UR, LL, LR;
   LR (lower right) into Minv.
 *************************************************************************/
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(ms_partinv): insert\n");
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(ms_partinv): insert\n");
+ }
 
  Minv = matalloc(Minv, Mbg->rows, Mbg->cols, NUM_COMPLEX);
 
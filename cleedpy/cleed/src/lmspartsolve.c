@@ -0,0 +1,285 @@
+/*********************************************************************
+  file contains functions:
+
+  ms_partsolve
+
+    Solve the giant scattering matrix equations by partitioning.
+
+*********************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "leed.h"
+
+/*
+#define CONTROL
+*/
+#define ERROR
+
+#define EXIT_ON_ERROR
+
+/*======================================================================*/
+/*======================================================================*/
+
+/*
+  Copy n_cols complex elements from row src_row (starting at column
+  src_col) of Msrc to row dst_row (starting at dst_col) of Mdst.
+*/
+static void partsolve_row(mat Mdst, int dst_row, int dst_col,
+                          mat Msrc, int src_row, int src_col, int n_cols)
+{
+ memcpy(Mdst->rel + 2*((dst_row - 1)*Mdst->cols + dst_col),
+        Msrc->rel + 2*((src_row - 1)*Msrc->cols + src_col),
+        2 * n_cols * sizeof(real));
+}
+
+/*======================================================================*/
+/*======================================================================*/
+
+mat ms_partsolve ( mat X, mat Mbg, mat B, int first_atoms, int l_max)
+
+/************************************************************************
+
+ DESCRIPTION:
+
+   Solve Mbg * X = B by partitioning Mbg.
+
+ INPUT:
+
+   mat X    - output: solution (dimension of B). Must not be Mbg or B.
+   mat Mbg  - input: giant scattering matrix (dimension N * (l_max +1)^2).
+   mat B    - input: right hand sides (one per column, N * (l_max +1)^2
+              rows).
+
+   int first_atoms - number of atoms which are in the same plane.
+   int l_max - max angular momentum quantum number.
+
+ DESIGN:
+
+ This replaces the inversion of Mbg (ms_partinv) and the multiplication
+ of the inverse with B where only the product (Mbg^-1) * B is needed.
+ With the same partitioning as in ms_partinv,
+
+           Mbg = (UL UR)    X = (X1)    B = (B1)
+                 (LL LR)        (X2)        (B2)
+
+ the solution is obtained from
+
+        (Y_B Y_U) = (UL^-1) * (B1 UR)
+        S  = LR - LL*Y_U
+        X2 = S^-1 * (B2 - LL*Y_B)
+        X1 = Y_B - Y_U * X2
+
+ where the products with inverse matrices are calculated by LU
+ decomposition (matsolve). UL (first_atoms atoms in the same plane) is
+ blockdiagonal in even and odd (l+m); the rows of (B1 UR) are therefore
+ split accordingly and the two blocks are decomposed separately.
+
+ If all atoms are in the same plane, X = UL^-1 * B.
+
+ FUNCTION CALLS:
+
+  matalloc
+  matfree
+  matcheck
+  matext
+  matmul
+  matsolve
+
+ RETURN VALUE:
+
+  X, if o.k.
+  NULL if failed (and EXIT_ON_ERROR is not defined).
+
+*************************************************************************/
+{
+int i, k;
+int l, m;
+int l_max_2;
+int n, n1, n2, n_b, n_c;         /* dimensions */
+int n_ev, n_od;
+int i_ev, i_od;
+
+int *odd;                        /* parity of (l+m) for each index lm */
+
+real *ptr_1, *ptr_2, *ptr_end;
+
+mat A_ev, A_od;                  /* even/odd blocks of UL */
+mat C_ev, C_od;                  /* even/odd rows of (B1 UR), (Y_B Y_U) */
+mat Y, Y_U, LL, LR, Maux_a, Maux_b;
+
+ A_ev = A_od = C_ev = C_od = NULL;
+ Y = Y_U = LL = LR = Maux_a = Maux_b = NULL;
+
+ if( (matcheck(Mbg) < 1) || (matcheck(B) < 1) ||
+     (Mbg->rows != Mbg->cols) || (B->rows != Mbg->rows) ||
+     (X == Mbg) || (X == B) )
+ {
+#ifdef ERROR
+   fprintf(STDERR," *** error (ms_partsolve): improper input matrices\n");
+#endif
+#ifdef EXIT_ON_ERROR
+   exit(1);
+#else
+   return(NULL);
+#endif
+ }
+
+ l_max_2 = (l_max + 1)*(l_max + 1);
+
+ n   = Mbg->rows;
+ n1  = first_atoms * l_max_2;
+ n2  = n - n1;
+ n_b = B->cols;
+ n_c = n_b + n2;
+
+ n_ev = first_atoms * (l_max + 1)*(l_max + 2)/2;
+ n_od = first_atoms * (l_max + 1)*l_max/2;
+
+ odd = (int *) malloc(l_max_2 * sizeof(int));
+ for(l = 0, k = 0; l <= l_max; l ++)
+   for(m = -l; m <= l; m ++, k ++)
+     odd[k] = ODD(l+m);
+
+/*************************************************************************
+  Split UL into the blocks with even and odd (l+m) and the rows of
+  (B1 UR) accordingly.
+*************************************************************************/
+
+ A_ev = matalloc(A_ev, n_ev, n_ev, NUM_COMPLEX);
+ A_od = matalloc(A_od, n_od, n_od, NUM_COMPLEX);
+ C_ev = matalloc(C_ev, n_ev, n_c, NUM_COMPLEX);
+ C_od = matalloc(C_od, n_od, n_c, NUM_COMPLEX);
+
+ for(i = 0, i_ev = 1, i_od = 1; i < n1; i ++)
+ {
+   ptr_1 = Mbg->rel + 2*(i*n + 1);
+   if(odd[i % l_max_2])
+   {
+     for(k = 0, ptr_2 = A_od->rel + 2*((i_od-1)*n_od + 1); k < n1; k ++)
+       if(odd[k % l_max_2])
+       {
+         ptr_2[0] = ptr_1[2*k];
+         ptr_2[1] = ptr_1[2*k + 1];
+         ptr_2 += 2;
+       }
+     partsolve_row(C_od, i_od, 1, B, i+1, 1, n_b);
+     if(n2 > 0) partsolve_row(C_od, i_od, n_b+1, Mbg, i+1, n1+1, n2);
+     i_od ++;
+   }
+   else
+   {
+     for(k = 0, ptr_2 = A_ev->rel + 2*((i_ev-1)*n_ev + 1); k < n1; k ++)
+       if(!odd[k % l_max_2])
+       {
+         ptr_2[0] = ptr_1[2*k];
+         ptr_2[1] = ptr_1[2*k + 1];
+         ptr_2 += 2;
+       }
+     partsolve_row(C_ev, i_ev, 1, B, i+1, 1, n_b);
+     if(n2 > 0) partsolve_row(C_ev, i_ev, n_b+1, Mbg, i+1, n1+1, n2);
+     i_ev ++;
+   }
+ }
+
+/*************************************************************************
+  (Y_B Y_U) = UL^-1 * (B1 UR)
+*************************************************************************/
+
+ C_ev = matsolve(C_ev, A_ev, C_ev);
+ C_od = matsolve(C_od, A_od, C_od);
+
+ matfree(A_ev);
+ matfree(A_od);
+
+/* Reinsert the rows in the natural order (into X if n2 = 0) */
+ if(n2 == 0)
+   Y = X = matalloc(X, n, n_b, NUM_COMPLEX);
+ else
+   Y = matalloc(Y, n1, n_c, NUM_COMPLEX);
+
+ for(i = 0, i_ev = 1, i_od = 1; i < n1; i ++)
+ {
+   if(odd[i % l_max_2])
+     partsolve_row(Y, i+1, 1, C_od, i_od ++, 1, n_c);
+   else
+     partsolve_row(Y, i+1, 1, C_ev, i_ev ++, 1, n_c);
+ }
+
+ free(odd);
+ matfree(C_ev);
+ matfree(C_od);
+
+/*************************************************************************
+  If all the atoms are in the same plane, X = (Y_B) is complete.
+*************************************************************************/
+
+ if(n2 == 0)
+ {
+#ifdef CONTROL
+   fprintf(STDCTR,"(ms_partsolve): All atoms are in the same plane.\n");
+#endif
+   return(X);
+ }
+
+/*************************************************************************
+  Maux_a = LL * (Y_B Y_U)
+  S -> LR = LR - LL * Y_U
+  X2 -> Maux_a = S^-1 * (B2 - LL * Y_B)
+  (the right hand sides are set up in the rows of X2 in X)
+*************************************************************************/
+
+ LL = matext(LL, Mbg, n1+1, n, 1, n1);
+ Maux_a = matmul(Maux_a, LL, Y);
+ matfree(LL);
+
+ LR = matext(LR, Mbg, n1+1, n, n1+1, n);
+ X = matalloc(X, n, n_b, NUM_COMPLEX);
+
+ for(i = 0; i < n2; i ++)
+ {
+   ptr_2 = Maux_a->rel + 2*(i*n_c + 1);
+
+   for(ptr_1 = LR->rel + 2*(i*n2 + 1), ptr_end = ptr_1 + 2*n2, k = 2*n_b;
+       ptr_1 < ptr_end; ptr_1 ++, k ++)
+     *ptr_1 -= ptr_2[k];
+
+   partsolve_row(X, n1+i+1, 1, B, n1+i+1, 1, n_b);
+   for(ptr_1 = X->rel + 2*((n1+i)*n_b + 1), ptr_end = ptr_1 + 2*n_b;
+       ptr_1 < ptr_end; ptr_1 ++, ptr_2 ++)
+     *ptr_1 -= *ptr_2;
+ }
+
+ Maux_a = matext(Maux_a, X, n1+1, n, 1, n_b);
+ Maux_a = matsolve(Maux_a, LR, Maux_a);
+ matfree(LR);
+
+/*************************************************************************
+  X1 = Y_B - Y_U * X2  (Maux_b = Y_U * X2)
+*************************************************************************/
+
+ Y_U = matext(Y_U, Y, 1, n1, n_b+1, n_c);
+ Maux_b = matmul(Maux_b, Y_U, Maux_a);
+
+ for(i = 0; i < n1; i ++)
+ {
+   partsolve_row(X, i+1, 1, Y, i+1, 1, n_b);
+   for(ptr_1 = X->rel + 2*(i*n_b + 1), ptr_end = ptr_1 + 2*n_b,
+       ptr_2 = Maux_b->rel + 2*(i*n_b + 1); ptr_1 < ptr_end; ptr_1 ++, ptr_2 ++)
+     *ptr_1 -= *ptr_2;
+ }
+ for(i = 0; i < n2; i ++)
+   partsolve_row(X, n1+i+1, 1, Maux_a, i+1, 1, n_b);
+
+ matfree(Maux_b);
+ matfree(Y_U);
+ matfree(Maux_a);
+ matfree(Y);
+
+ return(X);
+} /* end of function ms_partsolve */
+
+/*======================================================================*/
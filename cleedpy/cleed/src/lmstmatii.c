@@ -34,7 +34,7 @@
 /*======================================================================*/
 /*======================================================================*/
 
-mat ms_tmat_ii ( mat Tii, mat Llm, mat Tl, int l_max /* arguments */ )
+mat ms_tmat_ii ( struct ctx_str *ctx, mat Tii, mat Llm, mat Tl, int l_max /* arguments */ )
 
 /************************************************************************
 
@@ -45,6 +45,7 @@ mat ms_tmat_ii ( mat Tii, mat Llm, mat Tl, int l_max /* arguments */ )
 
  INPUT:
 
+   struct ctx_str *ctx - input: calculation context (C.G. coefficients).
    mat Tii  - output: multiple scattering matrix in (l,m)-space.
    mat Llm  - input: lattice sum:
 
@@ -116,7 +117,7 @@ real *ptr_r, *ptr_i;
 
 mat Gev, God;
 
- if(mk_cg_coef(2*l_max) != 0)
+ if(ctx_cg_coef(ctx, 2*l_max) != 0)
  {
 #ifdef WARNING
    fprintf(STDWAR,
@@ -188,9 +189,9 @@ mat Gev, God;
 
          for(l3 = l3_min; l3 <= l3_max; l3 += 2 )
          {
-           faux_r = sign*cg(l3, m3, l1,m1,l2,-m2);
-           sum_r += Llm->rel[i3] * faux_r;
-           sum_i += Llm->iel[i3] * faux_r;
+           faux_r = sign*cg(ctx->cgc, l3, m3, l1,m1,l2,-m2);
+           sum_r += Llm->rel[2*i3] * faux_r;
+           sum_i += Llm->iel[2*i3] * faux_r;
 
          /*
            l3 is incremented by 2
@@ -208,7 +209,7 @@ mat Gev, God;
           in XM (VHT). Don't ask where it comes from.
        */
          cri_mul(&faux_r, &faux_i,
-                 sum_i, -sum_r, Tl->rel[l1+1], Tl->iel[l1+1]);
+                 sum_i, -sum_r, Tl->rel[2*(l1+1)], Tl->iel[2*(l1+1)]);
          RMATEL(iev1,iev2, Gev) = faux_r;
          IMATEL(iev1,iev2, Gev) = faux_i;
 
@@ -247,10 +248,10 @@ mat Gev, God;
 
          for(l3 = l3_min; l3 <= l3_max; l3 += 2 )
          {
-           faux_r = sign*cg(l3, m3, l1,m1,l2,-m2);
+           faux_r = sign*cg(ctx->cgc, l3, m3, l1,m1,l2,-m2);
 
-           sum_r += Llm->rel[i3] * faux_r;
-           sum_i += Llm->iel[i3] * faux_r;
+           sum_r += Llm->rel[2*i3] * faux_r;
+           sum_i += Llm->iel[2*i3] * faux_r;
 
          /*
            l3 is incremented by 2
@@ -268,7 +269,7 @@ mat Gev, God;
           in XM (VHT). Don't ask where it comes from.
        */
          cri_mul(&faux_r, &faux_i,
-                 sum_i, -sum_r, Tl->rel[l1+1], Tl->iel[l1+1]);
+                 sum_i, -sum_r, Tl->rel[2*(l1+1)], Tl->iel[2*(l1+1)]);
          RMATEL(iod1,iod2, God) = faux_r;
          IMATEL(iod1,iod2, God) = faux_i;
 
@@ -287,11 +288,11 @@ mat Gev, God;
 *************************************************************************/
  iaux = Gev->cols*Gev->rows;
  for( iev1= 1; iev1 <=iaux; iev1 += Gev->rows + 1)
-  Gev->rel[iev1] += 1.;
+  Gev->rel[2*iev1] += 1.;
 
  iaux = God->cols*God->rows;
  for( iod1= 1; iod1 <=iaux; iod1 += God->rows + 1)
-  God->rel[iod1] += 1.;
+  God->rel[2*iod1] += 1.;
 
 #ifdef CONTROL
  fprintf(STDCTR,"\n(ms_tmat_ii): (1 - T*Gev): \n");
@@ -327,7 +328,7 @@ mat Gev, God;
  iaux = (l_max + 1)*(l_max + 1);
  Tii = matalloc(Tii, iaux, iaux, NUM_COMPLEX);
 
- for(l1 = 0, iev2 = 1, iod2 = 1, ptr_r = Tii->rel+1, ptr_i = Tii->iel+1;
+ for(l1 = 0, iev2 = 1, iod2 = 1, ptr_r = Tii->rel+2, ptr_i = Tii->iel+2;
      l1 <= l_max; l1 ++)
  {
    for(m1 = -l1; m1 <= l1; m1 ++)
@@ -335,7 +336,7 @@ mat Gev, God;
      odd1 = ODD(l1+m1);
      for(l2 = 0; l2 <= l_max; l2 ++)
      {
-       for(m2 = -l2; m2 <= l2; m2 ++, ptr_r ++, ptr_i ++)
+       for(m2 = -l2; m2 <= l2; m2 ++, ptr_r += 2, ptr_i += 2)
        {
          if(ODD(l2+m2))
          {
@@ -343,9 +344,9 @@ mat Gev, God;
            {
              cri_powi(ptr_r, ptr_i, l1-l2);
              cri_mul(ptr_r, ptr_i,
-                     *ptr_r, *ptr_i, God->rel[iod2], God->iel[iod2]);
+                     *ptr_r, *ptr_i, God->rel[2*iod2], God->iel[2*iod2]);
              cri_mul(ptr_r, ptr_i,
-                     *ptr_r, *ptr_i, Tl->rel[l2+1], Tl->iel[l2+1]);
+                     *ptr_r, *ptr_i, Tl->rel[2*(l2+1)], Tl->iel[2*(l2+1)]);
              iod2++;
            }
          }
@@ -355,9 +356,9 @@ mat Gev, God;
            {
              cri_powi(ptr_r, ptr_i, l1-l2);
              cri_mul(ptr_r, ptr_i,
-                     *ptr_r, *ptr_i, Gev->rel[iev2], Gev->iel[iev2]);
+                     *ptr_r, *ptr_i, Gev->rel[2*iev2], Gev->iel[2*iev2]);
              cri_mul(ptr_r, ptr_i,
-                     *ptr_r, *ptr_i, Tl->rel[l2+1], Tl->iel[l2+1]);
+                     *ptr_r, *ptr_i, Tl->rel[2*(l2+1)], Tl->iel[2*(l2+1)]);
              iev2++;
            }
          }  /* else */
@@ -26,7 +26,6 @@ GH/01.02.95 - Creation
 /*
 #define CONTROL
 */
-#define CONTROL_X
 #define WARNING
 #define ERROR
 
@@ -34,7 +33,7 @@ GH/01.02.95 - Creation
 
 /*======================================================================*/
 
-mat ms_tmat_ij ( mat Gij, mat Llm, mat Tii, int l_max /* arguments */ )
+mat ms_tmat_ij ( struct ctx_str *ctx, mat Gij, mat Llm, mat Tii, int l_max /* arguments */ )
 
 /************************************************************************
 
@@ -48,6 +47,7 @@ mat ms_tmat_ij ( mat Gij, mat Llm, mat Tii, int l_max /* arguments */ )
 
  INPUT:
 
+   struct ctx_str *ctx - (input) calculation context (C.G. coefficients).
    mat Gij  - (output) multiple scattering matrix in (l,m)-space.
    mat Llm  - (input) lattice sum:
 
@@ -104,7 +104,7 @@ real sign;
 /*************************************************************************
  Check the input matrices Llm and Tii
  Make sure that the C.G. coefficients are available
- (by calling mk_cg_coef)
+ (by calling ctx_cg_coef)
 *************************************************************************/
  if (matcheck(Llm) < 1)
  {
@@ -133,7 +133,7 @@ real sign;
 #endif
  }
 
- if(mk_cg_coef(l_max) != 0)
+ if(ctx_cg_coef(ctx, l_max) != 0)
  {
 #ifdef WARNING
    fprintf(STDWAR,
@@ -146,12 +146,13 @@ real sign;
  iaux = (l_max + 1) * (l_max + 1);
  Gij = matalloc(Gij, iaux, iaux, NUM_COMPLEX);
 
-#ifdef CONTROL
- fprintf(STDCTR,"\n(ms_tmat_ij): Llm:\n");
- for(i3 = 1; i3 <= Llm->rows; i3++)
-  printf("(%8.5f, %8.5f)", Llm->rel[i3], Llm->iel[i3]);
- printf("\n");
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"\n(ms_tmat_ij): Llm:\n");
+   for(i3 = 1; i3 <= Llm->rows; i3++)
+    printf("(%8.5f, %8.5f)", Llm->rel[2*i3], Llm->iel[2*i3]);
+   printf("\n");
+ }
 
 /*************************************************************************
  Loop over (l1,m1),(l2,m2): Set up  -Gij(l1,m1; l2,m2).
@@ -197,20 +198,20 @@ real sign;
 
 
          off_ij = (l1*(l1+1) - m1) * Gij->cols + l2*(l2+1) - m2 + 1;
-         Gij->rel[off_ij] = Gij->iel[off_ij] = 0.;
+         Gij->rel[2*off_ij] = Gij->iel[2*off_ij] = 0.;
 
          i3 = l3_min*(l3_min + 1) - m3 + 1;
 
          for(l3 = l3_min; l3 <= l3_max; l3 += 2 )
          {
 
-           faux_r = sign*cg(l3,+m3, l2,+m2, l1,-m1);
+           faux_r = sign*cg(ctx->cgc, l3,+m3, l2,+m2, l1,-m1);
 /*
            printf("%2d %2d %2d %2d %2d %2d : %.5f\n",
                    l1,m1, l2,m2, l3,m3, faux_r);
 */
-           Gij->rel[off_ij] += Llm->rel[i3] * faux_r;
-           Gij->iel[off_ij] += Llm->iel[i3] * faux_r;
+           Gij->rel[2*off_ij] += Llm->rel[2*i3] * faux_r;
+           Gij->iel[2*off_ij] += Llm->iel[2*i3] * faux_r;
 
          /*
            l3 is incremented by 2
@@ -224,20 +225,22 @@ real sign;
    }  /* m1 */
  }  /* l1 */
 
-#ifdef CONTROL
- fprintf(STDCTR,"\n(ms_tmat_ij): Gij: \n");
- matshow (Gij);
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"\n(ms_tmat_ij): Gij: \n");
+   matshow (Gij);
+ }
 
 /*************************************************************************
  Final matrix multiplication: Gij -> -Tii * Gij
 *************************************************************************/
  Gij = matmul(Gij, Tii, Gij);
 
-#ifdef CONTROL
- fprintf(STDCTR,"\n(ms_tmat_ij): Tii*Gij: \n");
- matshow (Gij);
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"\n(ms_tmat_ij): Tii*Gij: \n");
+   matshow (Gij);
+ }
 
  return(Gij);
 } /* end of function ms_tmat_ij */
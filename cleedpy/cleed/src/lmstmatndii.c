@@ -29,7 +29,6 @@ GH/16.07.02 - fix bug cg/gaunt in summation over l3 (Gii)
 #define CONTROL
 #define CONTROL_X
 */
-#define CONTROL
 #define WARNING
 #define ERROR
 
@@ -42,7 +41,7 @@ GH/16.07.02 - fix bug cg/gaunt in summation over l3 (Gii)
 /*======================================================================*/
 /*======================================================================*/
 
-mat ms_tmat_nd_ii ( mat Tii, mat Llm, mat Tlm_in, int l_max /* arguments */ )
+mat ms_tmat_nd_ii ( struct ctx_str *ctx, mat Tii, mat Llm, mat Tlm_in, int l_max /* arguments */ )
 
 /************************************************************************
 
@@ -53,6 +52,7 @@ mat ms_tmat_nd_ii ( mat Tii, mat Llm, mat Tlm_in, int l_max /* arguments */ )
 
  INPUT:
 
+   struct ctx_str *ctx - input: calculation context (C.G. coefficients).
    mat Tii  - output: multiple scattering matrix in (l,m)-space.
    mat Llm  - input: lattice sum:
 
@@ -80,7 +80,8 @@ mat ms_tmat_nd_ii ( mat Tii, mat Llm, mat Tlm_in, int l_max /* arguments */ )
     C(l3,m3,l1,m1,l2,m2) = C.G. coefficients.
 
  Then compute:
-   Tii =  Tlm * (1 - Gii * Tlm)^-1
+   Tii =  Tlm * (1 - Gii * Tlm)^-1 = (1 - Tlm * Gii)^-1 * Tlm
+ by solving (1 - Tlm * Gii) * Tii = Tlm (no explicit inverse).
 
  Multiply each matrix element with i^(l2-l1).
 
@@ -161,8 +162,8 @@ Check matrix dimensions of Tlm_in and compatibilities with l_max.
          {
            if ( m2 <= Tlm->cols)
            {
-             Tlm->rel[ilm2] = Tlm_in->rel[ilm1];
-             Tlm->iel[ilm2] = Tlm_in->iel[ilm1];
+             Tlm->rel[2*ilm2] = Tlm_in->rel[2*ilm1];
+             Tlm->iel[2*ilm2] = Tlm_in->iel[2*ilm1];
              m2 ++;
              ilm2 ++;
            }
@@ -183,10 +184,11 @@ Check matrix dimensions of Tlm_in and compatibilities with l_max.
 #endif
 
 
-#ifdef CONTROL
- fprintf(STDCTR,"\n(ms_tmat_nd_ii): Tlm: \n");
-/* matshowabs(Tlm); */
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
+    fprintf(STDCTR,"\n(ms_tmat_nd_ii): Tlm: \n");
+   /* matshowabs(Tlm); */
+ }
 
 /*************************************************************************
  Allocate
@@ -195,7 +197,7 @@ Check matrix dimensions of Tlm_in and compatibilities with l_max.
 
 *************************************************************************/
 
- if(mk_cg_coef(2*l_max) != 0)
+ if(ctx_cg_coef(ctx, 2*l_max) != 0)
  {
 #ifdef WARNING
    fprintf(STDWAR,
@@ -254,10 +256,10 @@ Check matrix dimensions of Tlm_in and compatibilities with l_max.
          for(l3 = l3_min; l3 <= l3_max; l3 += 2 )
          {
 /* faux_r = sign*gaunt(l1, m1, l3, m3, l2,m2); */
-           faux_r = sign*cg(l3, m3, l1,m1,l2,-m2);
+           faux_r = sign*cg(ctx->cgc, l3, m3, l1,m1,l2,-m2);
 
-           sum_r += Llm->rel[i3] * faux_r;
-           sum_i += Llm->iel[i3] * faux_r;
+           sum_r += Llm->rel[2*i3] * faux_r;
+           sum_i += Llm->iel[2*i3] * faux_r;
 
          /*
            l3 is incremented by 2
@@ -274,61 +276,54 @@ Check matrix dimensions of Tlm_in and compatibilities with l_max.
          Don't ask why!
        */
 
-         Gii->rel[ilm1] =  sum_i;
-         Gii->iel[ilm1] = -sum_r;
+         Gii->rel[2*ilm1] =  sum_i;
+         Gii->iel[2*ilm1] = -sum_r;
 
        }  /* m2 */
      }  /* l2 */
    }  /* m1 */
  }  /* l1 */
 
-#ifdef CONTROL
- fprintf(STDCTR,"\n(ms_tmat_nd_ii): -Gii: \n");
-/* matshowabs(Gii); */
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
+    fprintf(STDCTR,"\n(ms_tmat_nd_ii): -Gii: \n");
+   /* matshowabs(Gii); */
+ }
 
 /*************************************************************************
- Multiply with Tlm from the r.h.s. : -Gii * Tlm
- Store in Tii, Gii not needed anymore.
+ Multiply with Tlm from the l.h.s. : -Tlm * Gii
+ Store in Gii
 *************************************************************************/
 
- Tii = matmul(Tii, Gii, Tlm);
- matfree(Gii);
-
-#ifdef CONTROL
- fprintf(STDCTR,"\n(ms_tmat_nd_ii): -Gii * Tlm: \n");
-/* matshowabs(Tii); */
-#endif
-
-/*************************************************************************
- Add the identity matrix: (1 - Gii * Tlm )
- Store in Tii
-*************************************************************************/
- iaux = Tii->cols*Tii->rows;
- for( ilm1 = 1; ilm1 <=iaux; ilm1 += Tii->rows + 1)
-  Tii->rel[ilm1] += 1.;
+ Gii = matmul(Gii, Tlm, Gii);
 
-#ifdef CONTROL
- fprintf(STDCTR,"\n(ms_tmat_nd_ii): (1 - Gii * Tlm ): \n");
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
+    fprintf(STDCTR,"\n(ms_tmat_nd_ii): -Tlm * Gii: \n");
+   /* matshowabs(Gii); */
+ }
 
 /*************************************************************************
- Matrix inversion: (1 - Gii * Tlm )^-1
- Store in Tii
+ Add the identity matrix: (1 - Tlm * Gii )
+ Store in Gii
 *************************************************************************/
+ iaux = Gii->cols*Gii->rows;
+ for( ilm1 = 1; ilm1 <=iaux; ilm1 += Gii->rows + 1)
+  Gii->rel[2*ilm1] += 1.;
 
- Tii = matinv(Tii, Tii);
-
-#ifdef CONTROL
- fprintf(STDCTR,"\n(ms_tmat_nd_ii): (1 - Gii * Tlm )^-1: \n");
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"\n(ms_tmat_nd_ii): (1 - Tlm * Gii ): \n");
+ }
 
 /*************************************************************************
-  Multiply with Tl from the l.h.s:
-          Tlm * (1 - Gii * Tlm)^-1
+ Solve (1 - Tlm * Gii) * Tii = Tlm by LU decomposition, which gives
+          (1 - Tlm * Gii)^-1 * Tlm = Tlm * (1 - Gii * Tlm)^-1
+ without the explicit inverse. Gii not needed anymore.
 *************************************************************************/
 
- Tii = matmul(Tii, Tlm, Tii);
+ Tii = matsolve(Tii, Gii, Tlm);
+ matfree(Gii);
 
 /*************************************************************************
   Multiply matrix elements with i^(l2-l1).
@@ -345,16 +340,17 @@ Check matrix dimensions of Tlm_in and compatibilities with l_max.
        for(m2 = -l2; m2 <= l2; m2 ++, ilm1 ++)
        {
          cri_powi(&faux_r, &faux_i, l2-l1);
-         cri_mul(Tii->rel+ilm1, Tii->iel+ilm1, Tii->rel[ilm1], Tii->iel[ilm1],
-                 faux_r, faux_i);
+         cri_mul(Tii->rel+2*ilm1, Tii->iel+2*ilm1,
+                 Tii->rel[2*ilm1], Tii->iel[2*ilm1], faux_r, faux_i);
        }  /* m2 */
      }  /* l2 */
    }  /* m1 */
  }  /* l1 */
 
-#ifdef CONTROL
- fprintf(STDCTR, "\n(ms_tmat_nd_ii): Tii = Tlm * (1 - Gii * Tlm)^-1:\n");
-#endif
+ if(LOG_ON(LOG_MS, LOG_CONTROL))
+ {
+   fprintf(STDCTR, "\n(ms_tmat_nd_ii): Tii = Tlm * (1 - Gii * Tlm)^-1:\n");
+ }
 
  return(Tii);
 } /* end of function ms_tmat_nd_ii */
@@ -30,9 +30,7 @@
 /*======================================================================*/
 /*======================================================================*/
 
-static mat Ylm = NULL;
-
-mat ms_ymat ( mat Ymat, int l_max, struct beam_str *beams, int n_beams)
+mat ms_ymat ( struct ctx_str *ctx, mat Ymat, int l_max, struct beam_str *beams, int n_beams)
 
 /************************************************************************
 
@@ -41,6 +39,8 @@ mat ms_ymat ( mat Ymat, int l_max, struct beam_str *beams, int n_beams)
 
  INPUT:
 
+   struct ctx_str *ctx - (input) calculation context: provides the Ylm
+              coefficients and the scratch storage ctx->Ylm.
    mat Ymat - (output) transformation matrix.
    int l_max - max l quantum number spanning up the (l,m)-space.
    struct beam_str *beams - beams spanning up the k-space.
@@ -100,10 +100,10 @@ real *ptr_r, *ptr_i, *ptr_end;
            (beams+i_beams)->cth_i, (beams+i_beams)->phi);
 #endif
 
-   Ylm = c_ylm(Ylm, (beams+i_beams)->cth_r, (beams+i_beams)->cth_i,
+   ctx->Ylm = c_ylm(ctx->Ylm, ctx->ylmc,
+                    (beams+i_beams)->cth_r, (beams+i_beams)->cth_i,
                     (beams+i_beams)->phi, l_max);
-   memcpy( Ymat->rel+off, Ylm->rel+1, size);
-   memcpy( Ymat->iel+off, Ylm->iel+1, size);
+   memcpy( Ymat->rel+2*off, ctx->Ylm->rel+2, 2*size);
  }
 
  return(Ymat);
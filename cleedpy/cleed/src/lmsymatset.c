@@ -33,9 +33,7 @@ GH/21.04.95 - copied from ms_ymat
 /*======================================================================*/
 /*======================================================================*/
 
-static mat Ylm = NULL;
-
-mat ms_ymat_set ( mat Ymat, int l_max, struct beam_str *beams, int set)
+mat ms_ymat_set ( struct ctx_str *ctx, mat Ymat, int l_max, struct beam_str *beams, int set)
 
 /************************************************************************
 
@@ -44,6 +42,8 @@ mat ms_ymat_set ( mat Ymat, int l_max, struct beam_str *beams, int set)
 
  INPUT:
 
+   struct ctx_str *ctx - (input) calculation context: provides the Ylm
+              coefficients and the scratch storage ctx->Ylm.
    mat Ymat - (output) transformation matrix.
    int l_max - max l quantum number spanning up the (l,m)-space.
    struct beam_str *beams - beams spanning up the k-space.
@@ -115,10 +115,10 @@ real *ptr_r, *ptr_i, *ptr_end;
              (beams+i_beams)->cth_i, (beams+i_beams)->phi);
 #endif
 
-     Ylm = c_ylm(Ylm, (beams+i_beams)->cth_r, (beams+i_beams)->cth_i,
+     ctx->Ylm = c_ylm(ctx->Ylm, ctx->ylmc,
+                      (beams+i_beams)->cth_r, (beams+i_beams)->cth_i,
                       (beams+i_beams)->phi, l_max);
-     memcpy( Ymat->rel+off, Ylm->rel+1, size);
-     memcpy( Ymat->iel+off, Ylm->iel+1, size);
+     memcpy( Ymat->rel+2*off, ctx->Ylm->rel+2, 2*size);
    }
  }
 
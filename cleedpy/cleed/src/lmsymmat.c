@@ -32,7 +32,7 @@ GH/06.04.95 - Creation - copied from ms_ymat.
 /*======================================================================*/
 /*======================================================================*/
 
-mat ms_ymmat ( mat Ymat, int l_max, struct beam_str *beams, int n_beams)
+mat ms_ymmat ( struct ctx_str *ctx, mat Ymat, int l_max, struct beam_str *beams, int n_beams)
 
 /************************************************************************
 
@@ -41,6 +41,8 @@ mat ms_ymmat ( mat Ymat, int l_max, struct beam_str *beams, int n_beams)
 
  INPUT:
 
+   struct ctx_str *ctx - (input) calculation context: provides the Ylm
+              coefficients and the scratch storage ctx->Ylm.
    mat Ymat - (output) transformation matrix.
    int l_max - max l quantum number spanning up the (l,m)-space.
    struct beam_str *beams - beams spanning up the k-space.
@@ -73,7 +75,6 @@ int i_beams;
 
 real faux_r, faux_i;
 real *ptr_r, *ptr_i, *ptr_end;
-mat Ylm;
 
 /*
   Check arguments:
@@ -90,7 +91,6 @@ mat Ylm;
   Calculate the sperical harmonics Ylm(k) and copy into Ymat
 */
 
- Ylm = NULL;
  size = ll_max*sizeof(real);
 
  for (i_beams = 0, off = 1; i_beams < n_beams; i_beams ++, off += ll_max)
@@ -102,10 +102,10 @@ mat Ylm;
            (beams+i_beams)->cth_i, (beams+i_beams)->phi);
 #endif
 
-   Ylm = c_ylm(Ylm, -(beams+i_beams)->cth_r, -(beams+i_beams)->cth_i,
+   ctx->Ylm = c_ylm(ctx->Ylm, ctx->ylmc,
+                    -(beams+i_beams)->cth_r, -(beams+i_beams)->cth_i,
                     (beams+i_beams)->phi, l_max);
-   memcpy( Ymat->rel+off, Ylm->rel+1, size);
-   memcpy( Ymat->iel+off, Ylm->iel+1, size);
+   memcpy( Ymat->rel+2*off, ctx->Ylm->rel+2, 2*size);
  }
 
 /*
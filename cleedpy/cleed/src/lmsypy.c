@@ -100,13 +100,13 @@ real *ptr, *ptr_end;
   - the rows of Yxmat have now the same (l,m) quantum numbers.
     Yxmat->cols = number of k values.
     Yxmat->rows = number of (l,m) pairs.
-  - allocate a buffer of the size of one row.
+  - allocate a buffer of the size of one row (real and imag. parts).
   - find l_max;
 */
 
  Yxmat = mattrans( Yxmat, Ymat);
 
- size = Yxmat->cols * sizeof(real);
+ size = 2 * Yxmat->cols * sizeof(real);
  buffer = (real*)malloc(size);
 
  l_max = (int)(R_sqrt((real) Yxmat->rows ) + 0.1) - 1;
@@ -128,24 +128,15 @@ real *ptr, *ptr_end;
      Exchange row m with row -m
      Change sign, if m is odd.
    */
-     memcpy(buffer,               Yxmat->rel+offl+offm, size);
-     memcpy(Yxmat->rel+offl+offm, Yxmat->rel+offl-offm, size);
-     memcpy(Yxmat->rel+offl-offm, buffer              , size);
-
-     memcpy(buffer,               Yxmat->iel+offl+offm, size);
-     memcpy(Yxmat->iel+offl+offm, Yxmat->iel+offl-offm, size);
-     memcpy(Yxmat->iel+offl-offm, buffer              , size);
+     memcpy(buffer,                   Yxmat->rel+2*(offl+offm), size);
+     memcpy(Yxmat->rel+2*(offl+offm), Yxmat->rel+2*(offl-offm), size);
+     memcpy(Yxmat->rel+2*(offl-offm), buffer                  , size);
 
      if (ODD(m))
      {
-       for( ptr = Yxmat->rel+offl+offm, ptr_end = ptr + Yxmat->cols;
-            ptr < ptr_end; ptr ++) *ptr = -*ptr;
-       for( ptr = Yxmat->rel+offl-offm, ptr_end = ptr + Yxmat->cols;
-            ptr < ptr_end; ptr ++) *ptr = -*ptr;
-
-       for( ptr = Yxmat->iel+offl+offm, ptr_end = ptr + Yxmat->cols;
+       for( ptr = Yxmat->rel+2*(offl+offm), ptr_end = ptr + 2*Yxmat->cols;
             ptr < ptr_end; ptr ++) *ptr = -*ptr;
-       for( ptr = Yxmat->iel+offl-offm, ptr_end = ptr + Yxmat->cols;
+       for( ptr = Yxmat->rel+2*(offl-offm), ptr_end = ptr + 2*Yxmat->cols;
             ptr < ptr_end; ptr ++) *ptr = -*ptr;
      }
    }  /* m */
@@ -217,12 +208,12 @@ real *ptr, *ptr_end;
   - the rows of Yxmat have now the same (l,m) quantum numbers.
     Yxmat->cols = number of k values.
     Yxmat->rows = number of (l,m) pairs.
-  - allocate a buffer of the size of one row.
+  - allocate a buffer of the size of one row (real and imag. parts).
   - find l_max;
 */
  Yxmat = mattrans( Yxmat, Ymat);
 
- size = Yxmat->cols * sizeof(real);
+ size = 2 * Yxmat->cols * sizeof(real);
  buffer = (real*)malloc(size);
 
  l_max = (int)(R_sqrt((real) Yxmat->rows ) + 0.1) - 1;
@@ -244,13 +235,9 @@ real *ptr, *ptr_end;
  /*
    Exchange row m with row -m
  */
-     memcpy(buffer,               Yxmat->rel+offl+offm, size);
-     memcpy(Yxmat->rel+offl+offm, Yxmat->rel+offl-offm, size);
-     memcpy(Yxmat->rel+offl-offm, buffer              , size);
-
-     memcpy(buffer,               Yxmat->iel+offl+offm, size);
-     memcpy(Yxmat->iel+offl+offm, Yxmat->iel+offl-offm, size);
-     memcpy(Yxmat->iel+offl-offm, buffer              , size);
+     memcpy(buffer,                   Yxmat->rel+2*(offl+offm), size);
+     memcpy(Yxmat->rel+2*(offl+offm), Yxmat->rel+2*(offl-offm), size);
+     memcpy(Yxmat->rel+2*(offl-offm), buffer                  , size);
    }  /* m */
 
  /*
@@ -258,12 +245,8 @@ real *ptr, *ptr_end;
  */
    if (ODD(l))
    {
-     for( ptr = Yxmat->rel+offl-(l*Yxmat->cols),
-          ptr_end = ptr + (2*l + 1)*Yxmat->cols;
-          ptr < ptr_end; ptr ++)
-       *ptr = -*ptr;
-     for( ptr = Yxmat->iel+offl-(l*Yxmat->cols),
-          ptr_end = ptr + (2*l + 1)*Yxmat->cols;
+     for( ptr = Yxmat->rel+2*(offl-(l*Yxmat->cols)),
+          ptr_end = ptr + 2*(2*l + 1)*Yxmat->cols;
           ptr < ptr_end; ptr ++)
        *ptr = -*ptr;
    }
@@ -352,12 +335,12 @@ real *ptr, *ptr_end;
    */
    if(ODD(l))
    {
-     ptr_end = Ymmat->rel + Ymmat->cols*Ymmat->rows;
-     for( ptr = Ymmat->rel+offl; ptr <= ptr_end; ptr +=Ymmat->cols)
+     ptr_end = Ymmat->rel + 2*Ymmat->cols*Ymmat->rows;
+     for( ptr = Ymmat->rel+2*offl; ptr <= ptr_end; ptr +=2*Ymmat->cols)
        *ptr = -*ptr;
 
-     ptr_end = Ymmat->iel + Ymmat->cols*Ymmat->rows;
-     for( ptr = Ymmat->iel+offl; ptr <= ptr_end; ptr +=Ymmat->cols)
+     ptr_end = Ymmat->iel + 2*Ymmat->cols*Ymmat->rows;
+     for( ptr = Ymmat->iel+2*offl; ptr <= ptr_end; ptr +=2*Ymmat->cols)
        *ptr = -*ptr;
    }
 
@@ -368,16 +351,16 @@ real *ptr, *ptr_end;
    */
      if(ODD(l+m))
      {
-     ptr_end = Ymmat->rel + Ymmat->cols*Ymmat->rows;
-     for( ptr = Ymmat->rel+offl+m; ptr <= ptr_end; ptr +=Ymmat->cols)
+     ptr_end = Ymmat->rel + 2*Ymmat->cols*Ymmat->rows;
+     for( ptr = Ymmat->rel+2*(offl+m); ptr <= ptr_end; ptr +=2*Ymmat->cols)
        *ptr = -*ptr;
-     for( ptr = Ymmat->rel+offl-m; ptr <= ptr_end; ptr +=Ymmat->cols)
+     for( ptr = Ymmat->rel+2*(offl-m); ptr <= ptr_end; ptr +=2*Ymmat->cols)
        *ptr = -*ptr;
 
-     ptr_end = Ymmat->iel + Ymmat->cols*Ymmat->rows;
-     for( ptr = Ymmat->iel+offl+m; ptr <= ptr_end; ptr +=Ymmat->cols)
+     ptr_end = Ymmat->iel + 2*Ymmat->cols*Ymmat->rows;
+     for( ptr = Ymmat->iel+2*(offl+m); ptr <= ptr_end; ptr +=2*Ymmat->cols)
        *ptr = -*ptr;
-     for( ptr = Ymmat->iel+offl-m; ptr <= ptr_end; ptr +=Ymmat->cols)
+     for( ptr = Ymmat->iel+2*(offl-m); ptr <= ptr_end; ptr +=2*Ymmat->cols)
        *ptr = -*ptr;
      }
    }  /* odd (l+m)'s */
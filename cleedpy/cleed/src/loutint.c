@@ -71,5 +71,6 @@ int out_int(mat Amp, struct beam_str *beams_now, struct beam_str *beams_all, str
             beam_intensities[i_beams_all] = 0.;
     } /* for i_beams_all */
 
+    matfree(Int);
     return(i_beams_now);
 }
@@ -2,7 +2,7 @@
 GH/11.07.03
   file contains function:
 
-  pc_cumtl(mat Tmat, mat tl_0, real ux, real uy, real uz,
+  pc_cumtl(struct ctx_str *ctx, mat Tmat, mat tl_0, real ux, real uy, real uz,
              real energy, int l_max_t, int l_max_0)
 
  Calculate non-diagonal temperature dependent atomic scattering matrix
@@ -34,7 +34,6 @@ GH/11.07.03 - bug fix in output of T_mat for T=0: multiply with (-kappa)
 #define CONTROL
 #define WARNING
 */
-#define CONTROL
 #define WARNING
 #define ERROR
 
@@ -45,13 +44,7 @@ GH/11.07.03 - bug fix in output of T_mat for T=0: multiply with (-kappa)
 /* #define CONV_TEST 0.00000390625 */  /* to be multiplied by (l_max+1)^2 */
 #define CONV_TEST 0.000001        /* to be multiplied by (l_max+1)^2 */
 
-static int n_call = 0;
-static int last_l = -1;
-
-static mat Mx = NULL,   My = NULL,   Mz = NULL;
-static mat MxMx = NULL, MyMy = NULL, MzMz = NULL;
-
-mat pc_cumtl(mat Tmat, mat tl_0, real ux, real uy, real uz,
+mat pc_cumtl(struct ctx_str *ctx, mat Tmat, mat tl_0, real ux, real uy, real uz,
              real energy, int l_max_t, int l_max_0)
 
 /************************************************************************
@@ -61,6 +54,9 @@ mat pc_cumtl(mat Tmat, mat tl_0, real ux, real uy, real uz,
 
  INPUT:
 
+  struct ctx_str *ctx - (input) calculation context. The matrices Mx, etc.
+           are kept in ctx->cumtl and only recalculated if l_max_t changes.
+
   mat Tmat - (input) The function writes the output nondiagonal temperature
            dependent scattering matrix into its first argument.
            If Tmat is NULL, the structure will be created.
@@ -107,6 +103,7 @@ real kappa;
 real faux_r, faux_i;
 real pref, conv_test;
 
+mat Mx, My, Mz, MxMx, MyMy, MzMz;
 mat tl_aux;                    /* backup of original scattering factors */
 mat T_n, T_acc;
 
@@ -127,13 +124,14 @@ mat MzMzTn, MzTnMz, TnMzMz;
  uy2 = uy*uy;
  uz2 = uz*uz;
 
-#ifdef CONTROL
- fprintf(STDCTR,"(pc_cumtl): Enter function: \n");
- fprintf(STDCTR,
-         "\t(ux, uy, uz) = (%.3f, %.3f, %.3f) [au]; energy = %.3f H; lmax_t = %d, lmax_0 = %d\n",
-         ux, uy, uz, energy, l_max_t, l_max_0);
- matshow(tl_0);
-#endif
+ if(LOG_ON(LOG_PC, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(pc_cumtl): Enter function: \n");
+   fprintf(STDCTR,
+           "\t(ux, uy, uz) = (%.3f, %.3f, %.3f) [au]; energy = %.3f H; lmax_t = %d, lmax_0 = %d\n",
+           ux, uy, uz, energy, l_max_t, l_max_0);
+   matshow(tl_0);
+ }
 
 /*************************************************************************
   Backup original scattering factors
@@ -181,14 +179,15 @@ mat MzMzTn, MzTnMz, TnMzMz;
        for(m2 = -l2; m2 <= l2; m2 ++, lm2 ++)
          if((l1 == l2) && (m1 == m2) )
          {
-           RMATEL(lm1, lm2, T_n) = - tl_aux->rel[l1+1] / kappa;
-           IMATEL(lm1, lm2, T_n) = - tl_aux->iel[l1+1] / kappa;
+           RMATEL(lm1, lm2, T_n) = - tl_aux->rel[2*(l1+1)] / kappa;
+           IMATEL(lm1, lm2, T_n) = - tl_aux->iel[2*(l1+1)] / kappa;
          }
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(pc_cumtl): Tmat(T=0): \n");
- matshowabs(T_n);
-#endif
+ if(LOG_ON(LOG_PC, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(pc_cumtl): Tmat(T=0): \n");
+   matshowabs(T_n);
+ }
 
 /*************************************************************************
   If T = 0, i.e. all ux, uy, and uz are zero, we are allready done.
@@ -202,8 +201,8 @@ mat MzMzTn, MzTnMz, TnMzMz;
  fprintf(STDWAR,"(pc_cumtl): All displacements are zero: return Tmat(T=0)\n");
 #endif
 
-   iaux = Tmat->cols * Tmat->rows;
-   for(i_el = 1; i_el <= iaux; i_el ++)
+   iaux = 2 * Tmat->cols * Tmat->rows;
+   for(i_el = 2; i_el <= iaux; i_el += 2)
    {
      Tmat->rel[i_el] *= -kappa;
      Tmat->iel[i_el] *= -kappa;
@@ -219,23 +218,28 @@ mat MzMzTn, MzTnMz, TnMzMz;
    - set T_n etc to their start values.
 *************************************************************************/
 
- if( (n_call == 0) || (last_l != l_max_t) )
+ if( (ctx->cumtl.n_call == 0) || (ctx->cumtl.last_l != l_max_t) )
  {
 
-#ifdef CONTROL
-   fprintf(STDCTR,"(pc_cumtl): calculate Mx, etc. for l_max = %d\n", l_max_t);
-#endif
-   pc_mk_ms( &Mx, &My, &Mz, &MxMx, &MyMy, &MzMz, l_max_t);
+   if(LOG_ON(LOG_PC, LOG_CONTROL))
+   {
+     fprintf(STDCTR,"(pc_cumtl): calculate Mx, etc. for l_max = %d\n", l_max_t);
+   }
+   pc_mk_ms( ctx, &ctx->cumtl.Mx, &ctx->cumtl.My, &ctx->cumtl.Mz,
+             &ctx->cumtl.MxMx, &ctx->cumtl.MyMy, &ctx->cumtl.MzMz, l_max_t);
  }
+ Mx = ctx->cumtl.Mx;     My = ctx->cumtl.My;     Mz = ctx->cumtl.Mz;
+ MxMx = ctx->cumtl.MxMx; MyMy = ctx->cumtl.MyMy; MzMz = ctx->cumtl.MzMz;
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(pc_cumtl): Mx: \n");
- matshow(Mx);
- fprintf(STDCTR,"(pc_cumtl): My: \n");
- matshow(My);
- fprintf(STDCTR,"(pc_cumtl): Mz: \n");
- matshow(Mz);
-#endif
+ if(LOG_ON(LOG_PC, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(pc_cumtl): Mx: \n");
+   matshow(Mx);
+   fprintf(STDCTR,"(pc_cumtl): My: \n");
+   matshow(My);
+   fprintf(STDCTR,"(pc_cumtl): Mz: \n");
+   matshow(Mz);
+ }
 
  MxMxTn = MxTnMx = TnMxMx = NULL;
 
@@ -282,17 +286,18 @@ mat MzMzTn, MzTnMz, TnMzMz;
       MxMxTn = matmul(MxMxTn, MxMx,T_n);
       TnMxMx = matmul(TnMxMx, T_n,MxMx);
 
-#ifdef CONTROL_X
-      if (i_iter < 4)
+      if(LOG_ON(LOG_PC, LOG_CONTROL_X))
       {
-      fprintf(STDCTR, "(pc_cumtl): MxMxTn(%d):\n", i_iter-1);
-      matshow(MxMxTn);
-      fprintf(STDCTR, "(pc_cumtl): MxTnMx(%d):\n", i_iter-1);
-      matshow(MxTnMx);
-      fprintf(STDCTR, "(pc_cumtl): TnMxMx(%d):\n", i_iter-1);
-      matshow(TnMxMx);
+        if (i_iter < 4)
+        {
+        fprintf(STDCTR, "(pc_cumtl): MxMxTn(%d):\n", i_iter-1);
+        matshow(MxMxTn);
+        fprintf(STDCTR, "(pc_cumtl): MxTnMx(%d):\n", i_iter-1);
+        matshow(MxTnMx);
+        fprintf(STDCTR, "(pc_cumtl): TnMxMx(%d):\n", i_iter-1);
+        matshow(TnMxMx);
+        }
       }
-#endif
 
       MyTnMy = matmul(MyTnMy, T_n, My);
       MyTnMy = matmul(MyTnMy, My, MyTnMy);
@@ -306,24 +311,25 @@ mat MzMzTn, MzTnMz, TnMzMz;
       MzMzTn = matmul(MzMzTn, MzMz,T_n);
       TnMzMz = matmul(TnMzMz, T_n,MzMz);
 
-#ifdef CONTROL_X
-      if (i_iter < 4)
+      if(LOG_ON(LOG_PC, LOG_CONTROL_X))
       {
-      fprintf(STDCTR, "(pc_cumtl): MzMzTn(%d):\n", i_iter-1);
-      matshow(MzMzTn);
-      fprintf(STDCTR, "(pc_cumtl): MzTnMz(%d):\n", i_iter-1);
-      matshow(MzTnMz);
-      fprintf(STDCTR, "(pc_cumtl): TnMzMz(%d):\n", i_iter-1);
-      matshow(TnMzMz);
+        if (i_iter < 4)
+        {
+        fprintf(STDCTR, "(pc_cumtl): MzMzTn(%d):\n", i_iter-1);
+        matshow(MzMzTn);
+        fprintf(STDCTR, "(pc_cumtl): MzTnMz(%d):\n", i_iter-1);
+        matshow(MzTnMz);
+        fprintf(STDCTR, "(pc_cumtl): TnMzMz(%d):\n", i_iter-1);
+        matshow(TnMzMz);
+        }
       }
-#endif
 
 /* from here on replace T(n) by T(n+1) */
 
       pref = - kappa * kappa / i_iter;
-      iaux = T_n->cols * T_n->rows;
+      iaux = 2 * T_n->cols * T_n->rows;
 
-      for(i_el = 1; i_el <= iaux; i_el ++)
+      for(i_el = 2; i_el <= iaux; i_el += 2)
       {
 /* Eq. 35 */
         T_n->rel[i_el] =
@@ -348,9 +354,9 @@ mat MzMzTn, MzTnMz, TnMzMz;
    and check convergence of each element.
 */
       relerr_r = relerr_i = 0.;
-      iaux = T_acc->cols * T_acc->rows;
+      iaux = 2 * T_acc->cols * T_acc->rows;
 
-      for(i_el = 1; i_el <= iaux; i_el ++)
+      for(i_el = 2; i_el <= iaux; i_el += 2)
       {
         if( T_acc->rel[i_el] != 0.)
         {
@@ -362,11 +368,12 @@ mat MzMzTn, MzTnMz, TnMzMz;
         }
       } /* for i_el */
 
-#ifdef CONTROL
+   if(LOG_ON(LOG_PC, LOG_CONTROL))
+   {
      fprintf(STDCTR,
      "(pc_cumtl): iteration No %d: rel. errors: (%.3e, %.3e) <> %.3e\n",
      i_iter, relerr_r, relerr_i, conv_test);
-#endif
+   }
 
  } /* for i_iter */
 
@@ -387,8 +394,8 @@ mat MzMzTn, MzTnMz, TnMzMz;
 
 /* Tmat -> Tmat * kappa */
 
- iaux = Tmat->cols * Tmat->rows;
- for(i_el = 1; i_el <= iaux; i_el ++)
+ iaux = 2 * Tmat->cols * Tmat->rows;
+ for(i_el = 2; i_el <= iaux; i_el += 2)
  {
    Tmat->rel[i_el] *= -kappa;
    Tmat->iel[i_el] *= -kappa;
@@ -400,8 +407,8 @@ mat MzMzTn, MzTnMz, TnMzMz;
    - free matrices
 */
 
- n_call ++;
- last_l = l_max_t;
+ ctx->cumtl.n_call ++;
+ ctx->cumtl.last_l = l_max_t;
 
  matfree(tl_aux);
  matfree(T_n);
@@ -411,9 +418,10 @@ mat MzMzTn, MzTnMz, TnMzMz;
  matfree(MyMyTn); matfree(MyTnMy); matfree(TnMyMy);
  matfree(MzMzTn); matfree(MzTnMz); matfree(TnMzMz);
 
-#ifdef CONTROL
- fprintf(STDCTR,"(pc_cumtl): End of function \n");
-#endif
+ if(LOG_ON(LOG_PC, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(pc_cumtl): End of function \n");
+ }
 
  return (Tmat);
 
@@ -2,7 +2,7 @@
 GH/16.09.00
   file contains function:
 
-  pc_mk_ms(mat *p_Mx, mat *p_My, mat *p_Mz,
+  pc_mk_ms(struct ctx_str *ctx, mat *p_Mx, mat *p_My, mat *p_Mz,
            mat *p_MxMx, mat *p_MyMy, mat *p_MzMz, int l_max);
 
  Compute Ms defined in Fritzsche's paper.
@@ -28,7 +28,6 @@ GH/18.09.00 - Creation
 #define CONTROL
 #define WARNING
 */
-#define CONTROL
 #define ERROR
 
 #define EXIT_ON_ERROR
@@ -37,7 +36,8 @@ GH/18.09.00 - Creation
 #define SQRT_4PI3 2.0466534158929771    /* sqrt(4*PI / 3) */
 #define SQRT_2_1  0.7071067811865475    /* 1 / sqrt(2)    */
 
-int pc_mk_ms(mat *p_Mx,   mat *p_My,   mat *p_Mz,
+int pc_mk_ms(struct ctx_str *ctx,
+             mat *p_Mx,   mat *p_My,   mat *p_Mz,
              mat *p_MxMx, mat *p_MyMy, mat *p_MzMz, int l_max)
 
 /************************************************************************
@@ -47,6 +47,8 @@ int pc_mk_ms(mat *p_Mx,   mat *p_My,   mat *p_Mz,
 
  INPUT:
 
+  struct ctx_str *ctx - (input) calculation context (C.G. coefficients).
+
   mat * p_Mx, p_My, p_Mz (input/output)
            The function writes the output matrices into these pointers.
            If tmat is NULL, the mat structure will be created.
@@ -91,24 +93,25 @@ mat Unity;
 
 FILE *log_stream;
 
-#ifdef CONTROL
- fprintf(STDCTR,"(pc_mk_ms): Enter function lmax = %d\n",l_max);
-/*
- sq_4pi3 = R_sqrt(4 * PI / 3.);
- sq_2_1  = 1. / R_sqrt(2.);
-
- fprintf(STDCTR,"(pc_mk_ms):sq_4pi/3 = %f sq_2_1 = %f\n",
-         sq_4pi3 * 10000000000000000., sq_2_1 * 10000000000000000.);
-*/
-#endif
+ if(LOG_ON(LOG_PC, LOG_CONTROL))
+ {
+    fprintf(STDCTR,"(pc_mk_ms): Enter function lmax = %d\n",l_max);
+   /*
+    sq_4pi3 = R_sqrt(4 * PI / 3.);
+    sq_2_1  = 1. / R_sqrt(2.);
+
+    fprintf(STDCTR,"(pc_mk_ms):sq_4pi/3 = %f sq_2_1 = %f\n",
+            sq_4pi3 * 10000000000000000., sq_2_1 * 10000000000000000.);
+   */
+ }
 
 /*************************************************************************
-  call mk_cg_coef to make sure, that all C.G. coefficients are available.
+  call ctx_cg_coef to make sure, that all C.G. coefficients are available.
   preset variables
   l_max_2 = matrix dimension
 *************************************************************************/
 
- mk_cg_coef(2*l_max);
+ ctx_cg_coef(ctx, 2*l_max);
 
  l_max_2 = (l_max+1)*(l_max+1);
 
@@ -138,33 +141,34 @@ FILE *log_stream;
 !!! Note: BLM(l1,m1,l2,m3,l3,m3) = cg(l1,m1,l2,-m2,l3,-m3) !!!
 *************************************************************************/
 
-#ifdef CONTROL
- fprintf(STDCTR,"(pc_mk_ms): Start computing M_xyz matrices\n");
-#endif
+ if(LOG_ON(LOG_PC, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(pc_mk_ms): Start computing M_xyz matrices\n");
+ }
 
- for(i_el = 1, l1 = 0; l1 <= l_max; l1 ++)
+ for(i_el = 2, l1 = 0; l1 <= l_max; l1 ++)
    for(m1 = -l1; m1 <= l1; m1 ++)
    {
      for(l3 = 0; l3 <= l_max; l3 ++)
-       for(m3 = -l3; m3 <= l3; m3 ++, i_el ++)
+       for(m3 = -l3; m3 <= l3; m3 ++, i_el += 2)
        {
          cri_powi(&faux_r, &faux_i, l3 - l1);
 
 /* Eq. 30: m2 = 0, l2 = 1 */
       /* pref = SQRT_4PI3 * M1P(m3) * blm(l1, m1, 1, 0, l3,-m3); */
-         pref = SQRT_4PI3 * M1P(m3) * cg(l1, m1, 1, 0, l3, m3);
+         pref = SQRT_4PI3 * M1P(m3) * cg(ctx->cgc, l1, m1, 1, 0, l3, m3);
          Mz->rel[i_el] = pref * faux_r;
          Mz->iel[i_el] = pref * faux_i;
 
 /* Eq. 31: m2 = +/-1, l2 = 1 for blm/cg */
       /* pref = SQRT_4PI3 * M1P(m3) * blm(l1, m1, 1, 1, l3,-m3); */
-         pref = SQRT_4PI3 * M1P(m3) * cg(l1, m1, 1,-1, l3, m3);
+         pref = SQRT_4PI3 * M1P(m3) * cg(ctx->cgc, l1, m1, 1,-1, l3, m3);
          Mp_r = pref * faux_r;
          Mp_i = pref * faux_i;
 
 /* Eq. 31: m2 = -/+1, l2 = 1 for blm/cg */
       /* pref = SQRT_4PI3 * M1P(m3) * blm(l1, m1, 1,-1, l3,-m3); */
-         pref = SQRT_4PI3 * M1P(m3) * cg(l1, m1, 1, 1, l3, m3);
+         pref = SQRT_4PI3 * M1P(m3) * cg(ctx->cgc, l1, m1, 1, 1, l3, m3);
          Mm_r = pref * faux_r;
          Mm_i = pref * faux_i;
 
@@ -178,14 +182,15 @@ FILE *log_stream;
        } /* m3 */
     } /* m1 */
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(pc_mk_ms): Mz: \n");
- matshow(Mz);
- fprintf(STDCTR,"(pc_mk_ms): Mx: \n");
- matshow(Mx);
- fprintf(STDCTR,"(pc_mk_ms): My: \n");
- matshow(My);
-#endif
+ if(LOG_ON(LOG_PC, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(pc_mk_ms): Mz: \n");
+   matshow(Mz);
+   fprintf(STDCTR,"(pc_mk_ms): Mx: \n");
+   matshow(Mx);
+   fprintf(STDCTR,"(pc_mk_ms): My: \n");
+   matshow(My);
+ }
 
 /*************************************************************************
   Create MxMx, MyMy, MzMz
@@ -195,14 +200,15 @@ FILE *log_stream;
  MyMy = matmul(MyMy, My, My);
  MzMz = matmul(MzMz, Mz, Mz);
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(pc_mk_ms): MzMz: \n");
- matshowabs(MzMz);
- fprintf(STDCTR,"(pc_mk_ms): MxMx: \n");
- matshowabs(MxMx);
- fprintf(STDCTR,"(pc_mk_ms): MyMy: \n");
- matshowabs(MyMy);
-#endif
+ if(LOG_ON(LOG_PC, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(pc_mk_ms): MzMz: \n");
+   matshowabs(MzMz);
+   fprintf(STDCTR,"(pc_mk_ms): MxMx: \n");
+   matshowabs(MxMx);
+   fprintf(STDCTR,"(pc_mk_ms): MyMy: \n");
+   matshowabs(MyMy);
+ }
 
 /*************************************************************************
   Check trace of Sum MxMx + MyMy + MzMz: should be Unity
@@ -211,10 +217,10 @@ FILE *log_stream;
  i_count = 0;
  trace_r = trace_i = 0.;
 
- for(i_el = 1, l1 = 0; l1 <= l_max; l1 ++)
+ for(i_el = 2, l1 = 0; l1 <= l_max; l1 ++)
    for(m1 = -l1; m1 <= l1; m1 ++)
      for(l3 = 0; l3 <= l_max; l3 ++)
-       for(m3 = -l3; m3 <= l3; m3 ++, i_el ++)
+       for(m3 = -l3; m3 <= l3; m3 ++, i_el += 2)
        {
          Unity->rel[i_el] = MxMx->rel[i_el] + MyMy->rel[i_el] + MzMz->rel[i_el];
          Unity->iel[i_el] = MxMx->iel[i_el] + MyMy->iel[i_el] + MzMz->iel[i_el];
@@ -251,27 +257,30 @@ FILE *log_stream;
          } /* if */
        } /* m3 */
 
-#ifdef CONTROL_X
- fprintf(STDCTR,"(pc_mk_ms): MxMx + MyMy + MzMz: \n");
- matshowabs(Unity);
-#endif
+ if(LOG_ON(LOG_PC, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(pc_mk_ms): MxMx + MyMy + MzMz: \n");
+   matshowabs(Unity);
+ }
  if( R_cabs(trace_r, trace_i) != 0.)
  {
    faux_r = R_cabs(trace_r - l_max_2, trace_i) / R_cabs(trace_r, trace_i);
 
-#ifdef CONTROL
-   fprintf(STDCTR,
-   "(pc_mk_ms): rel. error in trace of MxMx + MyMy + MzMz: %.3f\n", faux_r);
-#endif
+   if(LOG_ON(LOG_PC, LOG_CONTROL))
+   {
+     fprintf(STDCTR,
+     "(pc_mk_ms): rel. error in trace of MxMx + MyMy + MzMz: %.3f\n", faux_r);
+   }
  }
 
  *p_Mx = Mx; *p_MxMx = MxMx;
  *p_My = My; *p_MyMy = MyMy;
  *p_Mz = Mz; *p_MzMz = MzMz;
 
-#ifdef CONTROL
- fprintf(STDCTR,"(pc_mk_ms): error counts (l < %d): %d\n", l_max, i_count);
-#endif
+ if(LOG_ON(LOG_PC, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(pc_mk_ms): error counts (l < %d): %d\n", l_max, i_count);
+ }
  if(i_count > 0)
    i_count = - i_count;
  else
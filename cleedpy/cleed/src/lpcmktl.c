@@ -2,7 +2,7 @@
   GH/18.07.95
   file contains function:
 
-  pc_mktl(mat *p_tl, struct phs_str *phs_shifts, int l_max, real energy)
+  pc_mktl(struct ctx_str *ctx, mat *p_tl, struct phs_str *phs_shifts, int l_max, real energy)
 
  Calculate atomic scattering factors for a given energy.
 
@@ -31,7 +31,7 @@ GH/18.07.95 - temperature dependent phase shifts.
 #define EXIT_ON_ERROR
 
 
-mat * pc_mktl(mat *p_tl, struct phs_str *phs_shifts, int l_max, real energy)
+mat * pc_mktl(struct ctx_str *ctx, mat *p_tl, struct phs_str *phs_shifts, int l_max, real energy)
 
 /************************************************************************
 
@@ -40,6 +40,8 @@ mat * pc_mktl(mat *p_tl, struct phs_str *phs_shifts, int l_max, real energy)
 
  INPUT:
 
+  struct ctx_str *ctx - (input) calculation context (handed to pc_temtl).
+
   mat *p_tl - (input) Array of scattering factor matrices. The function
            returns its first argument. If tl is NULL, the structure will
            be created.
@@ -155,14 +157,14 @@ struct phs_str *ptr;
        iaux = 1 + l;
        faux_r = R_cos(delta);
        faux_i = R_sin(delta);
-       cri_mul(p_tl[i_set]->rel+iaux, p_tl[i_set]->iel+iaux,
+       cri_mul(p_tl[i_set]->rel+2*iaux, p_tl[i_set]->iel+2*iaux,
                faux_r, faux_i, faux_i, 0.);
      }
 
    /*
       Include temperature in atomic scattering factors.
    */
-     pc_temtl(p_tl[i_set], p_tl[i_set], ptr->dr[0], energy, l_max, ptr->lmax);
+     pc_temtl(ctx, p_tl[i_set], p_tl[i_set], ptr->dr[0], energy, l_max, ptr->lmax);
 
 #ifdef CONTROL
      fprintf(STDCTR, "(pc_mktl): after pc_temtl, dr[0] = %.3f A^2:\n",
@@ -193,14 +195,14 @@ struct phs_str *ptr;
        iaux = 1 + l;
        faux_r = R_cos(delta);
        faux_i = R_sin(delta);
-       cri_mul(p_tl[i_set]->rel+iaux, p_tl[i_set]->iel+iaux,
+       cri_mul(p_tl[i_set]->rel+2*iaux, p_tl[i_set]->iel+2*iaux,
                faux_r, faux_i, faux_i, 0.);
      }
 
    /*
       Include temperature in atomic scattering factors.
    */
-     pc_temtl(p_tl[i_set], p_tl[i_set], ptr->dr[0], energy, l_max, ptr->lmax);
+     pc_temtl(ctx, p_tl[i_set], p_tl[i_set], ptr->dr[0], energy, l_max, ptr->lmax);
 
 #ifdef CONTROL
      fprintf(STDCTR, "(pc_mktl): after pc_temtl, dr[0] = %.3f A^2:\n",
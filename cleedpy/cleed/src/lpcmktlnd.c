@@ -2,7 +2,7 @@
 GH/16.09.00
   file contains function:
 
-  pc_mktl_nd(mat *p_tl, struct phs_str *phs_shifts, int l_max, real energy)
+  pc_mktl_nd(struct ctx_str *ctx, mat *p_tl, struct phs_str *phs_shifts, int l_max, real energy)
 
  Calculate atomic scattering factors for a given energy.
 
@@ -28,14 +28,13 @@ GH/16.09.00 - calculate non-diagonal t-matrix.
 #define CONTROL
 #define CONTROL_X
 */
-#define CONTROL
 #define WARNING
 #define ERROR
 
 #define EXIT_ON_ERROR
 
 
-mat * pc_mktl_nd(mat *p_tl, struct phs_str *phs_shifts, int l_max, real energy)
+mat * pc_mktl_nd(struct ctx_str *ctx, mat *p_tl, struct phs_str *phs_shifts, int l_max, real energy)
 
 /************************************************************************
 
@@ -47,6 +46,8 @@ mat * pc_mktl_nd(mat *p_tl, struct phs_str *phs_shifts, int l_max, real energy)
 
  INPUT:
 
+  struct ctx_str *ctx - (input) calculation context (handed to pc_temtl and pc_cumtl).
+
   mat *p_tl - (input) Array of scattering factor matrices. The function
            returns its first argument. If tl is NULL, the structure will
            be created.
@@ -94,10 +95,11 @@ struct phs_str *ptr;
  for(n_set = 0; (phs_shifts + n_set)->lmax != I_END_OF_LIST; n_set ++)
  { ; }
 
-#ifdef CONTROL
- fprintf(STDCTR,"(pc_mktl_nd): energy = %.2f H, n_set = %d, l_max = %d\n",
-                energy /*HART*/, n_set, l_max);
-#endif
+ if(LOG_ON(LOG_PC, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(pc_mktl_nd): energy = %.2f H, n_set = %d, l_max = %d\n",
+                  energy /*HART*/, n_set, l_max);
+ }
 
  if(p_tl == NULL)
  {
@@ -136,15 +138,17 @@ struct phs_str *ptr;
 #endif
    } /* neither T_DIAG nor T_NOND */
 
-#ifdef CONTROL_X
-   fprintf(STDCTR,
-           "(pc_mktl_nd):i_set = %d, lmax(set) = %d, neng = %d, t_type = %d\n",
-           i_set, l_set_1 - 1, ptr->neng, ptr->t_type);
-#endif
+   if(LOG_ON(LOG_PC, LOG_CONTROL_X))
+   {
+     fprintf(STDCTR,
+             "(pc_mktl_nd):i_set = %d, lmax(set) = %d, neng = %d, t_type = %d\n",
+             i_set, l_set_1 - 1, ptr->neng, ptr->t_type);
+   }
 
-#ifdef CONTROL
-   fprintf(STDCTR,"(pc_mktl_nd):  d %d: (%s)\n", i_set, ptr->input_file);
-#endif
+   if(LOG_ON(LOG_PC, LOG_CONTROL))
+   {
+     fprintf(STDCTR,"(pc_mktl_nd):  d %d: (%s)\n", i_set, ptr->input_file);
+   }
 
    p_tl[i_set] = matalloc(p_tl[i_set], l_set_1, 1, NUM_COMPLEX);
 
@@ -198,7 +202,7 @@ struct phs_str *ptr;
        iaux = 1 + l;
        faux_r = R_cos(delta);
        faux_i = R_sin(delta);
-       cri_mul(p_tl[i_set]->rel+iaux, p_tl[i_set]->iel+iaux,
+       cri_mul(p_tl[i_set]->rel+2*iaux, p_tl[i_set]->iel+2*iaux,
              faux_r, faux_i, faux_i, 0.);
      }
 
@@ -207,21 +211,23 @@ struct phs_str *ptr;
    */
      if(ptr->t_type == T_DIAG)
      {
-       pc_temtl(p_tl[i_set], p_tl[i_set], ptr->dr[0], energy, l_max, ptr->lmax);
-#ifdef CONTROL_X
-       fprintf(STDCTR, "(pc_mktl_nd): after pc_temtl, dr[0] = %.3f A^2:\n",
-               ptr->dr[0]*BOHR*BOHR);
-       matshowabs(p_tl[i_set]);
-#endif
+       pc_temtl(ctx, p_tl[i_set], p_tl[i_set], ptr->dr[0], energy, l_max, ptr->lmax);
+       if(LOG_ON(LOG_PC, LOG_CONTROL_X))
+       {
+         fprintf(STDCTR, "(pc_mktl_nd): after pc_temtl, dr[0] = %.3f A^2:\n",
+                 ptr->dr[0]*BOHR*BOHR);
+         matshowabs(p_tl[i_set]);
+       }
      } /* T_DIAG */
      else if(ptr->t_type == T_NOND)
      {
-       pc_cumtl(p_tl[i_set], p_tl[i_set],
+       pc_cumtl(ctx, p_tl[i_set], p_tl[i_set],
                 ptr->dr[1], ptr->dr[2], ptr->dr[3], energy, l_max, ptr->lmax);
-#ifdef CONTROL_X
-       fprintf(STDCTR, "(pc_mktl_nd): non-diag. Tlm for set %d:\n", i_set);
-       matshowabs(p_tl[i_set]);
-#endif
+       if(LOG_ON(LOG_PC, LOG_CONTROL_X))
+       {
+         fprintf(STDCTR, "(pc_mktl_nd): non-diag. Tlm for set %d:\n", i_set);
+         matshowabs(p_tl[i_set]);
+       }
      } /* T_NOND */
 
    } /* else if (energy too high) */
@@ -248,7 +254,7 @@ struct phs_str *ptr;
        iaux = 1 + l;
        faux_r = R_cos(delta);
        faux_i = R_sin(delta);
-       cri_mul(p_tl[i_set]->rel+iaux, p_tl[i_set]->iel+iaux,
+       cri_mul(p_tl[i_set]->rel+2*iaux, p_tl[i_set]->iel+2*iaux,
                faux_r, faux_i, faux_i, 0.);
      }
 
@@ -257,22 +263,24 @@ struct phs_str *ptr;
    */
      if(ptr->t_type == T_DIAG)
      {
-       pc_temtl(p_tl[i_set], p_tl[i_set], ptr->dr[0], energy, l_max, ptr->lmax);
-#ifdef CONTROL_X
-       fprintf(STDCTR, "(pc_mktl_nd): after pc_temtl, dr[0] = %.3f A^2:\n",
-             ptr->dr[0]*BOHR*BOHR);
-       matshowabs(p_tl[i_set]);
-#endif
+       pc_temtl(ctx, p_tl[i_set], p_tl[i_set], ptr->dr[0], energy, l_max, ptr->lmax);
+       if(LOG_ON(LOG_PC, LOG_CONTROL_X))
+       {
+         fprintf(STDCTR, "(pc_mktl_nd): after pc_temtl, dr[0] = %.3f A^2:\n",
+               ptr->dr[0]*BOHR*BOHR);
+         matshowabs(p_tl[i_set]);
+       }
      } /* T_DIAG */
      else if(ptr->t_type == T_NOND)
      {
-       pc_cumtl(p_tl[i_set], p_tl[i_set],
+       pc_cumtl(ctx, p_tl[i_set], p_tl[i_set],
                 ptr->dr[1], ptr->dr[2], ptr->dr[3], energy, l_max, ptr->lmax);
 
-#ifdef CONTROL_X
-       fprintf(STDCTR, "(pc_mktl_nd): non-diag. Tlm for set %d:\n", i_set);
-       matshowabs(p_tl[i_set]);
-#endif
+       if(LOG_ON(LOG_PC, LOG_CONTROL_X))
+       {
+         fprintf(STDCTR, "(pc_mktl_nd): non-diag. Tlm for set %d:\n", i_set);
+         matshowabs(p_tl[i_set]);
+       }
      } /* T_NOND */
 
    } /* else (in the right energy range) */
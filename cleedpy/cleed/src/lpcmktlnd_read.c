@@ -184,7 +184,7 @@ struct phs_str *ptr;
          iaux = 1 + l;
          faux_r = R_cos(delta);
          faux_i = R_sin(delta);
-         cri_mul(p_tl[i_set]->rel+iaux, p_tl[i_set]->iel+iaux,
+         cri_mul(p_tl[i_set]->rel+2*iaux, p_tl[i_set]->iel+2*iaux,
                faux_r, faux_i, faux_i, 0.);
        }
 
@@ -222,7 +222,7 @@ struct phs_str *ptr;
          iaux = 1 + l;
          faux_r = R_cos(delta);
          faux_i = R_sin(delta);
-         cri_mul(p_tl[i_set]->rel+iaux, p_tl[i_set]->iel+iaux,
+         cri_mul(p_tl[i_set]->rel+2*iaux, p_tl[i_set]->iel+2*iaux,
                  faux_r, faux_i, faux_i, 0.);
        }
 
@@ -2,7 +2,7 @@
 GH/19.09.00
   file contains function:
 
-  pc_temtl(mat tl_t, mat tl_0,
+  pc_temtl(struct ctx_str *ctx, mat tl_t, mat tl_0,
            real dr2, real energy, int l_max_t, int l_max_0)
 
  Calculate temperature dependent atomic scattering factors.
@@ -31,13 +31,12 @@ GH/19.09.00 - change definition of dr2: mean square displacement.
 #define CONTROL
 #define WARNING
 */
-#define CONTROL
 #define ERROR
 
 #define EXIT_ON_ERROR
 
 
-mat pc_temtl(mat tl_t, mat tl_0,
+mat pc_temtl(struct ctx_str *ctx, mat tl_t, mat tl_0,
              real dr2, real energy, int l_max_t, int l_max_0)
 
 /************************************************************************
@@ -46,6 +45,8 @@ mat pc_temtl(mat tl_t, mat tl_0,
 
  INPUT:
 
+  struct ctx_str *ctx - (input) calculation context (C.G. coefficients).
+
   mat tl_t - (input) The function writes the output temperature dependent
            scattering factors into its first argument. If tl is NULL,
            the structure will be created.
@@ -97,12 +98,13 @@ mat Jl;                        /* Bessel function */
  tl_aux = NULL;
  Jl = NULL;
 
-#ifdef CONTROL
+ if(LOG_ON(LOG_PC, LOG_CONTROL))
+ {
    fprintf(STDCTR,"(pc_temtl): Enter function: \n");
    fprintf(STDCTR,"\tdr2 = %.3f [au^2], energy = %.3f [H], lmax_t = %d, lmax_0 = %d\n",
    dr2, energy, l_max_t, l_max_0);
    matshow(tl_0);
-#endif
+ }
 
 /*
   backup original scattering factors
@@ -125,7 +127,7 @@ mat Jl;                        /* Bessel function */
 #endif
  }
 
- mk_cg_coef(l_max_t+l_max_0);
+ ctx_cg_coef(ctx, l_max_t+l_max_0);
 
 /*******************************************
   Calculate often used values:
@@ -146,7 +148,8 @@ mat Jl;                        /* Bessel function */
  faux_i = 0.;
  for(l1= 1; l1 <= (l_max_t + l_max_0 + 1); l1++)
  {
-   cri_mul(Jl->rel+l1, Jl->iel+l1, faux_r, faux_i, Jl->rel[l1],Jl->iel[l1]);
+   cri_mul(Jl->rel+2*l1, Jl->iel+2*l1, faux_r, faux_i,
+           Jl->rel[2*l1], Jl->iel[2*l1]);
    cri_mul(&faux_r, &faux_i, 0., 1., faux_r, faux_i);
  }
 
@@ -169,32 +172,37 @@ mat Jl;                        /* Bessel function */
      for(l3 = l3_min, fac_l3 = l3_min*2. + 1.;
          l3 <= l3_max; l3 ++, fac_l3 += 2. )
      {
-       faux_r = cg(l3,0, l2,0, l1,0);
+       faux_r = cg(ctx->cgc, l3,0, l2,0, l1,0);
        faux_r *= R_sqrt(fac_l3*fac_l12);
 
-#ifdef CONTROL_X
-       fprintf(STDCTR,"(pc_temtl): pref (%d %d %d) = %f (%f)\n",
-               l1, l2, l3, faux_r, R_sqrt(fac_l3*fac_l12));
-#endif
+       if(LOG_ON(LOG_PC, LOG_CONTROL_X))
+       {
+         fprintf(STDCTR,"(pc_temtl): pref (%d %d %d) = %f (%f)\n",
+                 l1, l2, l3, faux_r, R_sqrt(fac_l3*fac_l12));
+       }
 
        cri_mul(&faux_r, &faux_i,
-               tl_aux->rel[l2+1], tl_aux->iel[l2+1],
-               faux_r * Jl->rel[l3+1], faux_r * Jl->iel[l3+1]);
+               tl_aux->rel[2*(l2+1)], tl_aux->iel[2*(l2+1)],
+               faux_r * Jl->rel[2*(l3+1)], faux_r * Jl->iel[2*(l3+1)]);
 
-       tl_t->rel[l1+1] += faux_r;
-       tl_t->iel[l1+1] += faux_i;
+       tl_t->rel[2*(l1+1)] += faux_r;
+       tl_t->iel[2*(l1+1)] += faux_i;
      }  /* l3 */
    }  /* l2 */
-#ifdef CONTROL
-   kappa = R_sqrt(2* energy);
-   fprintf(STDCTR,
-"(pc_temtl): %d: tl_0=(%7.4f, %7.4f)\ttl_t=(%7.4f, %7.4f)\ttl_t/kappa=(%7.4f, %7.4f)\n",
-                  l1, tl_aux->rel[l1+1], tl_aux->iel[l1+1],
-                      tl_t->rel[l1+1], tl_t->iel[l1+1],
-                      -(tl_t->rel[l1+1])/kappa, -(tl_t->iel[l1+1])/kappa);
-#endif
+   if(LOG_ON(LOG_PC, LOG_CONTROL))
+   {
+        kappa = R_sqrt(2* energy);
+        fprintf(STDCTR,
+     "(pc_temtl): %d: tl_0=(%7.4f, %7.4f)\ttl_t=(%7.4f, %7.4f)\ttl_t/kappa=(%7.4f, %7.4f)\n",
+                       l1, tl_aux->rel[2*(l1+1)], tl_aux->iel[2*(l1+1)],
+                           tl_t->rel[2*(l1+1)], tl_t->iel[2*(l1+1)],
+                           -(tl_t->rel[2*(l1+1)])/kappa, -(tl_t->iel[2*(l1+1)])/kappa);
+   }
  }  /* l1 */
 
+ matfree(Jl);
+ matfree(tl_aux);
+
  return(tl_t);
 
 }  /* end of function pc_temtl */
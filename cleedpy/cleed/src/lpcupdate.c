@@ -2,7 +2,7 @@
   GH/20.09.95
   file contains function:
 
-  pc_update(struct var_str *v_par, struct phs_str *phs_shifts,
+  pc_update(struct ctx_str *ctx, struct var_str *v_par, struct phs_str *phs_shifts,
             real energy)
 
  Update all parameters, that change during the energy loop.
@@ -26,10 +26,6 @@ GH/20.09.95 - optional variable vi (structure var_str has changed).
 
 #include "leed.h"
 
-
-#define CONTROL
-
-#define CONTROL
 #define WARNING
 #define ERROR
 
@@ -38,7 +34,7 @@ GH/20.09.95 - optional variable vi (structure var_str has changed).
 #endif
 
 
-int pc_update(struct var_str *v_par,
+int pc_update(struct ctx_str *ctx, struct var_str *v_par,
                           struct phs_str *phs_shifts, real energy)
 
 /************************************************************************
@@ -47,6 +43,8 @@ int pc_update(struct var_str *v_par,
 
  INPUT:
 
+  struct ctx_str *ctx - calculation context (will be handed to function
+                pc_mktl_nd)
   struct var_str *v_par - all parameters that change during the
                 energy loop (for details see "leed_def.h").
                 The parameter structure must exist and must be preset already.
@@ -113,24 +111,26 @@ real faux_r, faux_i;
  v_par->k_in[2] = faux_r * R_sin(v_par->phi);
 
 
-#ifdef CONTROL
- fprintf(STDCTR,
-  "(pc_update): new energy: Evac = %.2f; (Er, Ei) = (%.2f, %.2f) eV\n",
-  v_par->eng_v*HART, v_par->eng_r*HART, v_par->eng_i*HART);
- fprintf(STDCTR,
-  "             k_in = (%.3f, %.3f) A-1\n",
-  v_par->k_in[1]/BOHR, v_par->k_in[2]/BOHR);
-#endif
-#ifdef CONTROL_X
- fprintf(STDCTR,"(pc_update): k_in = \t(%.2f, %.2f)\n",
-                  v_par->k_in[1], v_par->k_in[2]);
-#endif
+ if(LOG_ON(LOG_PC, LOG_CONTROL))
+ {
+   fprintf(STDCTR,
+    "(pc_update): new energy: Evac = %.2f; (Er, Ei) = (%.2f, %.2f) eV\n",
+    v_par->eng_v*HART, v_par->eng_r*HART, v_par->eng_i*HART);
+   fprintf(STDCTR,
+    "             k_in = (%.3f, %.3f) A-1\n",
+    v_par->k_in[1]/BOHR, v_par->k_in[2]/BOHR);
+ }
+ if(LOG_ON(LOG_PC, LOG_CONTROL_X))
+ {
+   fprintf(STDCTR,"(pc_update): k_in = \t(%.2f, %.2f)\n",
+                    v_par->k_in[1], v_par->k_in[2]);
+ }
 
 /*********************************************************
   Update phase shifts (pc_mktl_nd)
 *********************************************************/
 
- v_par->p_tl = pc_mktl_nd(v_par->p_tl, phs_shifts, v_par->l_max, v_par->eng_r);
+ v_par->p_tl = pc_mktl_nd(ctx, v_par->p_tl, phs_shifts, v_par->l_max, v_par->eng_r);
 
  return(1);
 }  /* end of function pc_update */
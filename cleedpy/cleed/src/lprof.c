@@ -0,0 +1,55 @@
+/*********************************************************************
+  file contains functions:
+
+  prof_time
+     Start time of a stage (wall clock).
+  prof_add
+     Add the time elapsed since the start of a stage to its counters.
+
+*********************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+
+#include "leed.h"
+
+/*======================================================================*/
+/*======================================================================*/
+
+double prof_time(struct prof_str *prof)
+
+/*********************************************************************
+  Return the wall clock time [s] to be passed to prof_add at the end of
+  a stage, or 0 if there are no counters (prof = NULL), so that
+  profiling costs nothing if it is not used.
+*********************************************************************/
+{
+struct timespec now;
+
+ if(prof == NULL) return(0.);
+
+ clock_gettime(CLOCK_MONOTONIC, &now);
+ return( (double)now.tv_sec + 1.e-9 * (double)now.tv_nsec );
+}  /* end of function prof_time */
+
+/*======================================================================*/
+/*======================================================================*/
+
+void prof_add(struct prof_str *prof, int stage, double t_start, long n_calls)
+
+/*********************************************************************
+  Add the wall time elapsed since t_start (prof_time) and n_calls
+  calls to the counters of stage (PROF_*). Nothing is done if
+  prof = NULL.
+
+  The counters of one energy must only be updated by the thread that
+  computes the energy.
+*********************************************************************/
+{
+ if(prof == NULL) return;
+
+ prof->time[stage] += prof_time(prof) - t_start;
+ prof->calls[stage] += n_calls;
+}  /* end of function prof_add */
+
+/*======================================================================*/
@@ -0,0 +1,530 @@
+/*********************************************************************
+  file contains functions:
+
+  rbc_alloc
+     Create a cache for the bulk reflection matrices of an energy list.
+  rbc_free
+     Free the cache and all matrices stored in it.
+  rbc_key
+     Hash of all input the bulk reflection matrix depends on.
+  rbc_beam_key
+     Hash of a beam list.
+  rbc_layer_key
+     Hash of all input the scattering matrices of a layer depend on.
+  rbc_stack_key
+     Hash of a stack of layers on top of the bulk.
+  rbc_set_key
+     Set the bulk key of a cache (invalidates it if the key changed).
+  rbc_get
+     Retrieve a bulk reflection matrix from the cache.
+  rbc_put
+     Store a bulk reflection matrix in the cache.
+  rbc_read
+     Read cache entries from a file.
+  rbc_write
+     Write the cache to a file.
+
+*********************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "leed.h"
+
+#define ERROR
+
+#define RBC_MAGIC "RBULK03"   /* 8 bytes including the terminating 0 */
+
+#define RBC_EMPTY 0           /* entry is not set */
+#define RBC_CLEAN 1           /* entry is set and in the cache file */
+#define RBC_NEW   2           /* entry is set but not yet written */
+
+/*======================================================================*/
+/*======================================================================*/
+
+/*
+  FNV-1a hash, continued from h.
+*/
+static unsigned long long rbc_hash(unsigned long long h, const void *data, size_t n)
+{
+const unsigned char *p = (const unsigned char *) data;
+size_t i;
+
+ for(i = 0; i < n; i ++)
+ {
+   h ^= p[i];
+   h *= 1099511628211ULL;
+ }
+ return(h);
+}
+
+#define RBC_HASH_INIT 14695981039346656037ULL
+#define RBC_HASH_VAL(h, x) ((h) = rbc_hash((h), &(x), sizeof(x)))
+
+/*======================================================================*/
+/*======================================================================*/
+
+struct rbc_str *rbc_alloc(int n_eng)
+
+/************************************************************************
+
+ Create a cache for the bulk reflection matrices of n_eng energies
+ (one entry per energy of the energy loop).
+
+ RETURN VALUES:
+
+   pointer to the new cache.
+
+*************************************************************************/
+{
+struct rbc_str *rbc;
+
+ rbc = (struct rbc_str *) calloc(1, sizeof(struct rbc_str));
+ rbc->n_eng = n_eng;
+ rbc->eng      = (real *) calloc(n_eng, sizeof(real));
+ rbc->beam_key = (unsigned long long *) calloc(n_eng, sizeof(unsigned long long));
+ rbc->state    = (int *) calloc(n_eng, sizeof(int));
+ rbc->R_bulk   = (mat *) calloc(n_eng, sizeof(mat));
+
+ return(rbc);
+}  /* end of function rbc_alloc */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int rbc_free(struct rbc_str *rbc)
+{
+int i;
+
+ if(rbc == NULL) return(0);
+
+ for(i = 0; i < rbc->n_eng; i ++)
+   if(rbc->R_bulk[i] != NULL) matfree(rbc->R_bulk[i]);
+
+ free(rbc->eng);
+ free(rbc->beam_key);
+ free(rbc->state);
+ free(rbc->R_bulk);
+ free(rbc);
+ return(1);
+}  /* end of function rbc_free */
+
+/*======================================================================*/
+/*======================================================================*/
+
+unsigned long long rbc_key(struct cryst_str *bulk, struct phs_str *phs_shifts,
+                           struct var_str *v_par)
+
+/************************************************************************
+
+ Hash of all input the bulk reflection matrix depends on apart from the
+ energy and the beam list:
+
+ - lattice (a, b and m_super) of bulk_par;
+ - all bulk layers and their atoms;
+ - the phase shifts (including <dr^2> and the type of t matrix) of all
+   atom types present in the bulk;
+ - optical potential, angles of incidence, epsilon, l_max, the
+   lattice sum method and the giant matrix solver (and its tolerance)
+   of v_par.
+
+ The vectors vec_to_next are not part of the key: they only connect
+ the bulk to the overlayer.
+
+*************************************************************************/
+{
+unsigned long long h;
+int i_layer, i_atom, type;
+struct layer_str *layer;
+struct atom_str *atom;
+struct phs_str *phs;
+
+ h = RBC_HASH_INIT;
+
+ h = rbc_hash(h, bulk->a + 1, 4 * sizeof(real));
+ h = rbc_hash(h, bulk->b + 1, 4 * sizeof(real));
+ h = rbc_hash(h, bulk->m_super + 1, 4 * sizeof(real));
+
+ RBC_HASH_VAL(h, bulk->nlayers);
+ for(i_layer = 0; i_layer < bulk->nlayers; i_layer ++)
+ {
+   layer = bulk->layers + i_layer;
+   RBC_HASH_VAL(h, layer->periodic);
+   RBC_HASH_VAL(h, layer->natoms);
+   h = rbc_hash(h, layer->a_lat + 1, 4 * sizeof(real));
+   h = rbc_hash(h, layer->vec_from_last + 1, 3 * sizeof(real));
+
+   for(i_atom = 0; i_atom < layer->natoms; i_atom ++)
+   {
+     atom = layer->atoms + i_atom;
+     RBC_HASH_VAL(h, atom->type);
+     RBC_HASH_VAL(h, atom->t_type);
+     h = rbc_hash(h, atom->pos + 1, 3 * sizeof(real));
+
+     type = atom->type;
+     phs = phs_shifts + type;
+     RBC_HASH_VAL(h, phs->lmax);
+     RBC_HASH_VAL(h, phs->neng);
+     RBC_HASH_VAL(h, phs->t_type);
+     h = rbc_hash(h, phs->dr, 4 * sizeof(real));
+     h = rbc_hash(h, phs->energy, phs->neng * sizeof(real));
+     h = rbc_hash(h, phs->pshift, phs->neng * (phs->lmax + 1) * sizeof(real));
+   }
+ }
+
+ RBC_HASH_VAL(h, v_par->vr);
+ RBC_HASH_VAL(h, v_par->vi_pre);
+ RBC_HASH_VAL(h, v_par->vi_exp);
+ RBC_HASH_VAL(h, v_par->theta);
+ RBC_HASH_VAL(h, v_par->phi);
+ RBC_HASH_VAL(h, v_par->epsilon);
+ RBC_HASH_VAL(h, v_par->l_max);
+ RBC_HASH_VAL(h, v_par->lsum);
+ RBC_HASH_VAL(h, v_par->mbg_solver);
+ RBC_HASH_VAL(h, v_par->mbg_tol);
+
+ return(h);
+}  /* end of function rbc_key */
+
+/*======================================================================*/
+/*======================================================================*/
+
+unsigned long long rbc_beam_key(struct beam_str *beams, int n_beams)
+
+/************************************************************************
+
+ Hash of the beam indices and beam sets of a beam list (the rest of the
+ beam parameters follows from the energy and the bulk input).
+
+*************************************************************************/
+{
+unsigned long long h;
+int i;
+
+ h = RBC_HASH_INIT;
+ RBC_HASH_VAL(h, n_beams);
+ for(i = 0; i < n_beams; i ++)
+ {
+   RBC_HASH_VAL(h, beams[i].ind_1);
+   RBC_HASH_VAL(h, beams[i].ind_2);
+   RBC_HASH_VAL(h, beams[i].set);
+ }
+ return(h);
+}  /* end of function rbc_beam_key */
+
+/*======================================================================*/
+/*======================================================================*/
+
+unsigned long long rbc_layer_key(struct layer_str *layer, struct phs_str *phs_shifts,
+                                 struct var_str *v_par)
+
+/************************************************************************
+
+ Hash of all input the scattering matrices of a single layer (as
+ calculated by ms_bravl_nd or ms_compl_nd) depend on apart from the
+ energy and the beam list:
+
+ - lattice vectors and relative unit cell area of the layer;
+ - positions (relative to the layer origin), types and t matrix types
+   of its atoms and the phase shifts of these types;
+ - optical potential, angles of incidence, epsilon, l_max, the
+   lattice sum method and the giant matrix solver (and its tolerance)
+   of v_par.
+
+ The vectors vec_from_last and vec_to_next only enter through the layer
+ doubling and are not part of the key.
+
+*************************************************************************/
+{
+unsigned long long h;
+int i_atom;
+struct atom_str *atom;
+struct phs_str *phs;
+
+ h = RBC_HASH_INIT;
+
+ RBC_HASH_VAL(h, layer->natoms);
+ h = rbc_hash(h, layer->a_lat + 1, 4 * sizeof(real));
+ RBC_HASH_VAL(h, layer->rel_area);
+
+ for(i_atom = 0; i_atom < layer->natoms; i_atom ++)
+ {
+   atom = layer->atoms + i_atom;
+   RBC_HASH_VAL(h, atom->type);
+   RBC_HASH_VAL(h, atom->t_type);
+   h = rbc_hash(h, atom->pos + 1, 3 * sizeof(real));
+
+   phs = phs_shifts + atom->type;
+   RBC_HASH_VAL(h, phs->lmax);
+   RBC_HASH_VAL(h, phs->neng);
+   RBC_HASH_VAL(h, phs->t_type);
+   h = rbc_hash(h, phs->dr, 4 * sizeof(real));
+   h = rbc_hash(h, phs->energy, phs->neng * sizeof(real));
+   h = rbc_hash(h, phs->pshift, phs->neng * (phs->lmax + 1) * sizeof(real));
+ }
+
+ RBC_HASH_VAL(h, v_par->vr);
+ RBC_HASH_VAL(h, v_par->vi_pre);
+ RBC_HASH_VAL(h, v_par->vi_exp);
+ RBC_HASH_VAL(h, v_par->theta);
+ RBC_HASH_VAL(h, v_par->phi);
+ RBC_HASH_VAL(h, v_par->epsilon);
+ RBC_HASH_VAL(h, v_par->l_max);
+ RBC_HASH_VAL(h, v_par->lsum);
+ RBC_HASH_VAL(h, v_par->mbg_solver);
+ RBC_HASH_VAL(h, v_par->mbg_tol);
+
+ return(h);
+}  /* end of function rbc_layer_key */
+
+/*======================================================================*/
+/*======================================================================*/
+
+unsigned long long rbc_stack_key(unsigned long long key, unsigned long long layer_key,
+                                 real *vec)
+
+/************************************************************************
+
+ Hash of a stack of layers that is made up of the stack with key (the
+ key of the bulk for the first layer) and a layer with content
+ layer_key (see rbc_layer_key) on top of it, displaced by vec (1=x,
+ 2=y, 3=z) from the top-most layer of the stack.
+
+*************************************************************************/
+{
+unsigned long long h;
+
+ h = RBC_HASH_INIT;
+ RBC_HASH_VAL(h, key);
+ RBC_HASH_VAL(h, layer_key);
+ h = rbc_hash(h, vec + 1, 3 * sizeof(real));
+
+ return(h);
+}  /* end of function rbc_stack_key */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int rbc_set_key(struct rbc_str *rbc, unsigned long long key)
+
+/************************************************************************
+
+ Set the bulk key of the cache. If it differs from the current key, all
+ entries are discarded.
+
+ RETURN VALUES:
+
+   0 if the key is unchanged, 1 if the cache was cleared.
+
+*************************************************************************/
+{
+int i;
+
+ if(rbc->key == key) return(0);
+
+ for(i = 0; i < rbc->n_eng; i ++) rbc->state[i] = RBC_EMPTY;
+ rbc->key = key;
+ return(1);
+}  /* end of function rbc_set_key */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int rbc_get(struct rbc_str *rbc, int i_eng, real eng,
+            unsigned long long beam_key, mat *p_R_bulk)
+
+/************************************************************************
+
+ Copy the cached bulk reflection matrix for energy i_eng into *p_R_bulk.
+
+ RETURN VALUES:
+
+   1 if the entry exists and belongs to energy eng and the beam list
+     beam_key.
+   0 otherwise (*p_R_bulk is unchanged).
+
+*************************************************************************/
+{
+ if( (rbc->state[i_eng] == RBC_EMPTY) ||
+     (rbc->eng[i_eng] != eng) ||
+     (rbc->beam_key[i_eng] != beam_key) )
+   return(0);
+
+ *p_R_bulk = matcop(*p_R_bulk, rbc->R_bulk[i_eng]);
+ return(1);
+}  /* end of function rbc_get */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int rbc_put(struct rbc_str *rbc, int i_eng, real eng,
+            unsigned long long beam_key, mat R_bulk)
+
+/************************************************************************
+
+ Store a copy of the bulk reflection matrix for energy i_eng.
+
+ Different threads may store entries of different energies at the same
+ time.
+
+*************************************************************************/
+{
+ rbc->R_bulk[i_eng] = matcop(rbc->R_bulk[i_eng], R_bulk);
+ rbc->eng[i_eng] = eng;
+ rbc->beam_key[i_eng] = beam_key;
+ rbc->state[i_eng] = RBC_NEW;
+ return(1);
+}  /* end of function rbc_put */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int rbc_read(struct rbc_str *rbc, real *energies, const char *filename)
+
+/************************************************************************
+
+ Read the entries of a cache file written by rbc_write.
+
+ INPUT:
+
+   real *energies - energy list (rbc->n_eng energies); only entries
+            for these energies are used.
+
+ DESIGN:
+
+   The file is ignored unless it was written for the same bulk key.
+   Files are binary and only meant to be read on the machine that wrote
+   them.
+
+ RETURN VALUES:
+
+   number of entries read.
+   -1 if the file could not be read.
+
+*************************************************************************/
+{
+FILE *inp_stream;
+char magic[8];
+unsigned long long key, beam_key;
+int n_entries, i, i_eng, n_read;
+real eng;
+mat Maux = NULL;
+
+ if( (inp_stream = fopen(filename, "rb")) == NULL) return(-1);
+
+ if( (fread(magic, sizeof(char), 8, inp_stream) != 8) ||
+     (strncmp(magic, RBC_MAGIC, 8) != 0) ||
+     (fread(&key, sizeof(key), 1, inp_stream) != 1) ||
+     (fread(&n_entries, sizeof(n_entries), 1, inp_stream) != 1) )
+ {
+#ifdef ERROR
+   fprintf(STDERR,
+     "*** error (rbc_read): \"%s\" is not a bulk cache file\n", filename);
+#endif
+   fclose(inp_stream);
+   return(-1);
+ }
+
+ n_read = 0;
+ if(key == rbc->key)
+ {
+   for(i = 0; i < n_entries; i ++)
+   {
+     if( (fread(&eng, sizeof(eng), 1, inp_stream) != 1) ||
+         (fread(&beam_key, sizeof(beam_key), 1, inp_stream) != 1) )
+       break;
+     Maux = matread(Maux, inp_stream);
+
+     for(i_eng = 0; i_eng < rbc->n_eng; i_eng ++)
+     {
+       if( (energies[i_eng] == eng) && (rbc->state[i_eng] == RBC_EMPTY) )
+       {
+         rbc->R_bulk[i_eng] = matcop(rbc->R_bulk[i_eng], Maux);
+         rbc->eng[i_eng] = eng;
+         rbc->beam_key[i_eng] = beam_key;
+         rbc->state[i_eng] = RBC_CLEAN;
+         n_read ++;
+         break;
+       }
+     }
+   }
+ }
+
+ if(Maux != NULL) matfree(Maux);
+ fclose(inp_stream);
+ return(n_read);
+}  /* end of function rbc_read */
+
+/*======================================================================*/
+/*======================================================================*/
+
+int rbc_write(struct rbc_str *rbc, const char *filename)
+
+/************************************************************************
+
+ Write all entries of the cache to a file if any of them is new.
+ The file is written under a temporary name first and then renamed, so
+ that an interrupted run does not leave a truncated cache behind.
+
+ RETURN VALUES:
+
+   number of entries written (0 if there was nothing new).
+   -1 if the file could not be written.
+
+*************************************************************************/
+{
+FILE *out_stream;
+char *tmp_name;
+int i, n_new, n_entries;
+
+ for(n_new = n_entries = i = 0; i < rbc->n_eng; i ++)
+ {
+   if(rbc->state[i] != RBC_EMPTY) n_entries ++;
+   if(rbc->state[i] == RBC_NEW) n_new ++;
+ }
+ if(n_new == 0) return(0);
+
+ tmp_name = (char *) malloc(strlen(filename) + 5);
+ sprintf(tmp_name, "%s.tmp", filename);
+
+ if( (out_stream = fopen(tmp_name, "wb")) == NULL)
+ {
+#ifdef ERROR
+   fprintf(STDERR,
+     "*** error (rbc_write): could not open file \"%s\"\n", tmp_name);
+#endif
+   free(tmp_name);
+   return(-1);
+ }
+
+ fwrite(RBC_MAGIC, sizeof(char), 8, out_stream);
+ fwrite(&rbc->key, sizeof(rbc->key), 1, out_stream);
+ fwrite(&n_entries, sizeof(n_entries), 1, out_stream);
+
+ for(i = 0; i < rbc->n_eng; i ++)
+ {
+   if(rbc->state[i] == RBC_EMPTY) continue;
+   fwrite(rbc->eng + i, sizeof(real), 1, out_stream);
+   fwrite(rbc->beam_key + i, sizeof(unsigned long long), 1, out_stream);
+   matwrite(rbc->R_bulk[i], out_stream);
+ }
+
+ if( (fclose(out_stream) != 0) || (rename(tmp_name, filename) != 0) )
+ {
+#ifdef ERROR
+   fprintf(STDERR,
+     "*** error (rbc_write): could not write file \"%s\"\n", filename);
+#endif
+   remove(tmp_name);
+   free(tmp_name);
+   return(-1);
+ }
+ free(tmp_name);
+
+ for(i = 0; i < rbc->n_eng; i ++)
+   if(rbc->state[i] == RBC_NEW) rbc->state[i] = RBC_CLEAN;
+
+ return(n_entries);
+}  /* end of function rbc_write */
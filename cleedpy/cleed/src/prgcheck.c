@@ -32,8 +32,6 @@ GH/02.09.97 - Add hostname
 #define ERROR
 */
 
-#define CONTROL
-
 #ifndef MBYTE
 #define MBYTE 1048576
 #endif
@@ -126,12 +126,12 @@ real ax,bj,bjm,bjp,sum,tox,ans;
 ************************************************************************/
  if( ( z_r == 0.) && ( z_i == 0.) )
  {
-   Jl->rel[1] = 1.;
-   Jl->iel[1] = 0.;
+   Jl->rel[2] = 1.;
+   Jl->iel[2] = 0.;
 
    for(l = 1 ; l <= l_max; l++ )
    {
-     Jl->rel[l+1] = Jl->iel[l+1] = 0.;
+     Jl->rel[2*(l+1)] = Jl->iel[2*(l+1)] = 0.;
    }
    return(Jl);
  }
@@ -182,22 +182,22 @@ real ax,bj,bjm,bjp,sum,tox,ans;
 ************************************************************************/
 
 /* J0(x) */
- cri_mul(Jl->rel+1, Jl->iel+1, z_inv_r, z_inv_i, sin_r, sin_i);
+ cri_mul(Jl->rel+2, Jl->iel+2, z_inv_r, z_inv_i, sin_r, sin_i);
 
 /* J1(x) */
 
 /* (J0(z) - cos(z)) */
- faux_r = Jl->rel[1] - cos_r;
- faux_i = Jl->iel[1] - cos_i;
+ faux_r = Jl->rel[2] - cos_r;
+ faux_i = Jl->iel[2] - cos_i;
 
 /* 1/z * (J0(z) - cos(z)) */
- cri_mul(Jl->rel+2, Jl->iel+2, z_inv_r, z_inv_i, faux_r, faux_i);
+ cri_mul(Jl->rel+4, Jl->iel+4, z_inv_r, z_inv_i, faux_r, faux_i);
 
 #ifdef CONTROL
  fprintf(STDCTR,"(c_bess-m): J(%d) = (%.3e,%.3e)\n",
-                0, Jl->rel[1], Jl->iel[1]);
+                0, Jl->rel[2], Jl->iel[2]);
  fprintf(STDCTR,"(c_bess-m): J(%d) = (%.3e,%.3e)\n",
-                1, Jl->rel[2], Jl->iel[2]);
+                1, Jl->rel[4], Jl->iel[4]);
 #endif
 
 /************************************************************************
@@ -222,14 +222,14 @@ real ax,bj,bjm,bjp,sum,tox,ans;
    faux_r = (2*l - 1) * z_inv_r;
    faux_i = (2*l - 1) * z_inv_i;
 
-   cri_mul(Jl->rel+l+1, Jl->iel+l+1,
-           faux_r, faux_i, Jl->rel[l], Jl->iel[l]);
-   Jl->rel[l+1] -= Jl->rel[l-1];
-   Jl->iel[l+1] -= Jl->iel[l-1];
+   cri_mul(Jl->rel+2*(l+1), Jl->iel+2*(l+1),
+           faux_r, faux_i, Jl->rel[2*l], Jl->iel[2*l]);
+   Jl->rel[2*(l+1)] -= Jl->rel[2*(l-1)];
+   Jl->iel[2*(l+1)] -= Jl->iel[2*(l-1)];
 
 #ifdef CONTROL
    fprintf(STDCTR,"(c_bess-m): (r)J(%d) = (%.3e,%.3e)\n",
-           l, Jl->rel[l+1], Jl->iel[l+1]);
+           l, Jl->rel[2*(l+1)], Jl->iel[2*(l+1)]);
 #endif
  }   /* for l */
 
@@ -266,15 +266,16 @@ real ax,bj,bjm,bjp,sum,tox,ans;
    }
 
 /* calculate normalizing factor J0 / F0 */
-   cri_div(&pref_r, &pref_i, Jl->rel[1], Jl->iel[1], F_r[1], F_i[1]);
+   cri_div(&pref_r, &pref_i, Jl->rel[2], Jl->iel[2], F_r[1], F_i[1]);
 
    l_int = MAX(2, l_int+1);
    for(l = l_int; l <= l_max; l++)
    {
-     cri_mul(Jl->rel+l+1, Jl->iel+l+1, pref_r, pref_i, F_r[l+1], F_i[l+1]);
+     cri_mul(Jl->rel+2*(l+1), Jl->iel+2*(l+1),
+             pref_r, pref_i, F_r[l+1], F_i[l+1]);
 #ifdef CONTROL
      fprintf(STDCTR,"(c_bess-m): (m)J(%d) = (%.3e,%.3e)\n",
-             l, Jl->rel[l+1], Jl->iel[l+1]);
+             l, Jl->rel[2*(l+1)], Jl->iel[2*(l+1)]);
 #endif
    }
 #ifdef CONTROL
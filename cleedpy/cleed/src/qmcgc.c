@@ -3,7 +3,10 @@
   file contains functions:
 
   mk_cg_coef      (09.08.94)
-      Calculate Clebsh Gordan coefficients
+      Return a table of Clebsh Gordan coefficients
+
+  free_cg_coef
+      Release a table returned by mk_cg_coef
 
   show_cg_coef()  (08.08.94)
       Show all Clebsh Gordan coefficients in the list cg_coef.
@@ -43,7 +46,6 @@ GH/22.09.00 - add gaunt and blm
 #define CONTROL_MK
 */
 
-#define CONTROL
 #define WARNING
 #define ERROR
 
@@ -54,18 +56,102 @@ GH/22.09.00 - add gaunt and blm
 /* if a C.G-C exceeds this level, a warning message will be printed */
 #endif
 
-#define UNUSED     -1
+/*
+  Largest table calculated so far. It is shared by all callers of
+  mk_cg_coef and only accessed inside the critical section qm_cg_coef.
+*/
+static struct cgc_str *cgc_shared = NULL;
 
-static double *cg_coef  = NULL;      /* Clebsh Gordan coefficients */
+static struct cgc_str * mk_cg_tab(int l_max);
 
-static int l_max_coef = UNUSED;      /* l_max for the C.G.C */
-static int st_fac1    = UNUSED;
-static int st_fac2    = UNUSED;
+/*======================================================================*/
+/*======================================================================*/
+
+struct cgc_str * mk_cg_coef(int l_max)
+
+/************************************************************************
+
+ DESCRIPTION:
+
+ Return a table of Clebsh Gordan coefficients
+   C( l1, m1, l2, m2, l3, m3)
+ for (at least) 0 <= l1 <= 2*l_max, 0 <= l2,l3 <= l_max.
+
+ INPUT:
+
+   int l_max - max angular momentum for output.
+
+ DESIGN:
+
+ The table is shared: if a table for an equal or larger l_max has been
+ calculated before, a reference to it is returned. Otherwise a new table
+ is calculated (mk_cg_tab) and replaces the previous one for later calls.
+ Tables already handed out remain valid until they are released with
+ free_cg_coef, i.e. a table never changes while it is used.
+
+ RETURN VALUE:
+
+   Pointer to the table (must be released with free_cg_coef).
+   NULL if an error occured (and if EXIT_ON_ERROR is not defined).
+
+*************************************************************************/
+{
+struct cgc_str *cgc;
+
+#pragma omp critical (qm_cg_coef)
+ {
+   if( (cgc_shared == NULL) || (cgc_shared->l_max < l_max) )
+   {
+     cgc = mk_cg_tab(l_max);
+     if(cgc != NULL)
+     {
+       if( (cgc_shared != NULL) && (-- cgc_shared->n_ref == 0) )
+       {
+         free(cgc_shared->coef);
+         free(cgc_shared);
+       }
+       cgc_shared = cgc;
+     }
+   }
+
+   cgc = cgc_shared;
+   if(cgc != NULL) cgc->n_ref ++;
+ }
+
+ return(cgc);
+}  /* end of function mk_cg_coef */
+
+/*======================================================================*/
+/*======================================================================*/
+
+void free_cg_coef(struct cgc_str *cgc)
+
+/************************************************************************
+
+ DESCRIPTION:
+
+ Release a reference to a table of C.G. coefficients returned by
+ mk_cg_coef. The table is freed when it is neither used nor the current
+ shared table.
+
+*************************************************************************/
+{
+ if(cgc == NULL) return;
+
+#pragma omp critical (qm_cg_coef)
+ {
+   if(-- cgc->n_ref == 0)
+   {
+     free(cgc->coef);
+     free(cgc);
+   }
+ }
+}  /* end of function free_cg_coef */
 
 /*======================================================================*/
 /*======================================================================*/
 
-int mk_cg_coef(int l_max)
+static struct cgc_str * mk_cg_tab(int l_max)
 
 /************************************************************************
 
@@ -105,7 +191,7 @@ int mk_cg_coef(int l_max)
      0 <=   l1  <= 2*l_max,  0 <= m1 <= l1;
      0 <= l2,l3 <= l_max,  -l2 <= m2 <= l2;
 
-   Memory requirements for the static array cg_coef:
+   Memory requirements for the array cg_coef:
 
    (2*l_max+1)*(2*l_max+2)/2 * (l_max+1)^2 * (l_max/2+1) * sizeof(double)
 
@@ -118,10 +204,8 @@ int mk_cg_coef(int l_max)
 
  Return values:
 
-   -1  if an error occured (and if EXIT_ON_ERROR is not defined).
-    0  if C.G. had been calculated before (l_max_coef >= l_max)
-    1  if C.G. were calculated in this call of mk_cg_coef (l_max_coef == l_max)
-   >1  number of warnings accounted.
+   New table (n_ref = 1), NULL if an error occured (and if EXIT_ON_ERROR
+   is not defined).
 
 *************************************************************************/
 {
@@ -143,30 +227,24 @@ double fac_m, sum_m;     /* factors in the calculation of the C.G.C.'s */
 double fac_l, fac_ls;
 double sign;
 
-/*****************************************
- Check if the C.G.C had been
- calculated already:
-*****************************************/
-
-/*
-  If yes, return 0.
-*/
- if( (l_max <= l_max_coef) && (cg_coef != NULL) )
-  return(0);
+double *cg_coef;         /* Clebsh Gordan coefficients */
+int st_fac1, st_fac2;
+struct cgc_str *cgc;
 
 /*
-  If not, allocate memory for cg_coef
+  Allocate memory for cg_coef
 */
  iaux = (2*l_max + 1)*(2*l_max + 2)/2 * (l_max + 1)*(l_max + 1) * (l_max/2 + 1);
 
-#ifdef CONTROL
-       fprintf(STDCTR,"(mk_cg_coef): cg_coef[%d] (%.3f Mb) for l_max = %2d\n",
-                      iaux, (real)iaux*sizeof(double) / MBYTE, l_max );
-#endif
+ if(LOG_ON(LOG_QM, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(mk_cg_coef): cg_coef[%d] (%.3f Mb) for l_max = %2d\n",
+                  iaux, (real)iaux*sizeof(double) / MBYTE, l_max );
+ }
 
- if (cg_coef != NULL) free(cg_coef);
  cg_coef = (double *) calloc (iaux, sizeof(double));
- if (cg_coef == NULL)
+ cgc = (struct cgc_str *) malloc (sizeof(struct cgc_str));
+ if ( (cg_coef == NULL) || (cgc == NULL) )
  {
 #ifdef ERROR
    fprintf(STDERR,"(mk_cg_coef): allocation error: cg_coef[%d] = %d bytes\n",
@@ -176,16 +254,23 @@ double sign;
    exit(1);
 #endif
 #ifndef EXIT_ON_ERROR
-   return(-1);
+   free(cg_coef);
+   free(cgc);
+   return(NULL);
 #endif
  }
 
 /*
-  Static variables used to retrieve the C.G.C's
+  Storage information used to retrieve the C.G.C's
 */
  st_fac1 = (l_max + 1)*(l_max + 1) * (l_max/2 + 1);
  st_fac2 = (l_max/2 + 1);
- l_max_coef = l_max;
+
+ cgc->l_max   = l_max;
+ cgc->st_fac1 = st_fac1;
+ cgc->st_fac2 = st_fac2;
+ cgc->coef    = cg_coef;
+ cgc->n_ref   = 1;
 
 
 /*
@@ -362,9 +447,10 @@ double sign;
    } /* l2 */
  } /* l1 */
 
-#ifdef CONTROL
- fprintf(STDCTR,"(mk_cg_coef): number of operations = %d\n", i_op);
-#endif
+ if(LOG_ON(LOG_QM, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(mk_cg_coef): number of operations = %d\n", i_op);
+ }
 #ifdef WARNING
  if (i_warn)
    fprintf(STDWAR,"* (mk_cg_coef): number of warnings   = %d\n", i_warn);
@@ -372,24 +458,26 @@ double sign;
 
  free(fac);
 
- return(1+i_warn);
-}  /* end of function mk_cg_coef */
+ return(cgc);
+}  /* end of function mk_cg_tab */
 
 /*======================================================================*/
 /*======================================================================*/
 
-void show_cg_coef()
+void show_cg_coef(const struct cgc_str *cgc)
 
 /************************************************************************
 
  DESCRIPTION:
 
- Show all Clebsh Gordan coefficients in the list cg_coef.
+ Show all Clebsh Gordan coefficients in the table cgc.
    C( l1, m1, l2, m2, l3, m3)
  for l1 <= 2*l_max_coef, l2,l3 <= l_max_coef.
 
  INPUT:
 
+ const struct cgc_str *cgc - table of C.G. coefficients (mk_cg_coef).
+
  DESIGN:
 
 *************************************************************************/
@@ -401,6 +489,11 @@ int l23_max;
 
 int i_st;
 
+int l_max_coef = cgc->l_max;
+int st_fac1 = cgc->st_fac1;
+int st_fac2 = cgc->st_fac2;
+const double *cg_coef = cgc->coef;
+
 
  for(l1 = 0; l1 <= 2* l_max_coef; l1 ++)
  {
@@ -441,7 +534,8 @@ int i_st;
 /*======================================================================*/
 /*======================================================================*/
 
-double cg (int l1, int m1, int l2, int m2, int l3, int m3)
+double cg (const struct cgc_str *cgc,
+           int l1, int m1, int l2, int m2, int l3, int m3)
 
 /************************************************************************
 
@@ -453,6 +547,7 @@ double cg (int l1, int m1, int l2, int m2, int l3, int m3)
 
  INPUT:
 
+ const struct cgc_str *cgc - table of C.G. coefficients (mk_cg_coef).
  int l1, l2, l3, m1, m2, m3 -  angular momentum quantum numbers
 
  DESIGN:
@@ -491,10 +586,10 @@ int i_st;
          l1,m1,l2,m2,l3,m3 );
 #endif
 
- i_st = (l1 * (l1 + 1)/2 + m1) * st_fac1 +
-        (l2 * (l2 + 1)   + m2) * st_fac2 + l3/2;
+ i_st = (l1 * (l1 + 1)/2 + m1) * cgc->st_fac1 +
+        (l2 * (l2 + 1)   + m2) * cgc->st_fac2 + l3/2;
 
- return(cg_coef[i_st]);
+ return(cgc->coef[i_st]);
 
 
 }  /* end of function cg */
@@ -502,7 +597,7 @@ int i_st;
 /*======================================================================*/
 /*======================================================================*/
 
-double * cg_info (int l1, int m1, int l2, int m2,
+double * cg_info (const struct cgc_str *cgc, int l1, int m1, int l2, int m2,
                   int* l_max, int* inc1, int* inc2)
 
 /************************************************************************
@@ -528,19 +623,20 @@ double * cg_info (int l1, int m1, int l2, int m2,
 
 *************************************************************************/
 {
-  *l_max = l_max_coef;
-  *inc1  = st_fac1;
-  *inc2  = st_fac2;
+  *l_max = cgc->l_max;
+  *inc1  = cgc->st_fac1;
+  *inc2  = cgc->st_fac2;
 
-  return (cg_coef + (l1 * (l1 + 1)/2 + m1) * st_fac1 +
-                    (l2 * (l2 + 1)   + m2) * st_fac2   );
+  return (cgc->coef + (l1 * (l1 + 1)/2 + m1) * cgc->st_fac1 +
+                      (l2 * (l2 + 1)   + m2) * cgc->st_fac2   );
 
 }  /* end of function cg_info */
 
 /*======================================================================*/
 /*======================================================================*/
 
-double blm (int l1, int m1, int l2, int m2, int l3, int m3)
+double blm (const struct cgc_str *cgc,
+            int l1, int m1, int l2, int m2, int l3, int m3)
 
 /************************************************************************
 
@@ -567,7 +663,7 @@ double blm (int l1, int m1, int l2, int m2, int l3, int m3)
 {
 double faux;
 
-faux = cg(l2,-m2,l1,m1,l3,m3);
+faux = cg(cgc, l2,-m2,l1,m1,l3,m3);
 return(faux);
 
 }  /* end of function blm */
@@ -575,7 +671,8 @@ return(faux);
 /*======================================================================*/
 /*======================================================================*/
 
-double gaunt (int l1, int m1, int l2, int m2, int l3, int m3)
+double gaunt (const struct cgc_str *cgc,
+              int l1, int m1, int l2, int m2, int l3, int m3)
 
 /************************************************************************
 
@@ -599,7 +696,7 @@ double gaunt (int l1, int m1, int l2, int m2, int l3, int m3)
 {
 double faux;
 
-faux = cg(l2,m2,l1,-m1,l3,m3);
+faux = cg(cgc, l2,m2,l1,-m1,l3,m3);
 return(faux);
 
 }  /* end of function gaunt */
@@ -0,0 +1,192 @@
+/*********************************************************************
+  file contains functions:
+
+  c_erfc
+
+       Calculate the complementary error function erfc(z) for a complex
+       argument z.
+
+*********************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+
+#include "mat.h"
+#include "qm.h"
+
+#define ERFC_FAC  1.12837916709551257388   /* 2/sqrt(PI) */
+
+/*======================================================================*/
+/*======================================================================*/
+
+static void c_wofz ( real *w_r, real *w_i, real x, real y )
+
+/************************************************************************
+
+ Faddeeva function w(z) = exp(-z^2) * erfc(-iz) for z = x + iy in the
+ upper half plane (y >= 0).
+
+ design:
+
+ Algorithm of G.P.M. Poppe and C.M.J. Wijers (ACM TOMS 16 (1990) 38):
+ power series near the origin, otherwise Laplace continued fraction
+ (with Taylor series about z + ih for moderate |z|). The relative
+ accuracy is about 14 significant digits.
+
+*************************************************************************/
+{
+int i, n, nu, kapn;
+int a, b;
+
+real xabs, yabs, xs, ys, qrho;
+real xquad, yquad;
+real xsum, ysum, xaux;
+real u1, v1, u2, v2, daux;
+real h, h2, qlambda;
+real rx, ry, sx, sy, tx, ty, c;
+real u, v;
+
+ xabs = R_fabs(x);
+ yabs = y;
+ xs = xabs / 6.3;
+ ys = yabs / 4.4;
+ qrho = xs*xs + ys*ys;
+
+ xquad = xabs*xabs - yabs*yabs;
+ yquad = 2.*xabs*yabs;
+
+ a = (qrho < 0.085264);
+
+ if (a)
+ {
+/*
+  Power series (Abramowitz & Stegun 7.1.5) for small |z|
+*/
+   qrho = (1. - 0.85*ys) * R_sqrt(qrho);
+   n = (int) R_nint(6. + 72.*qrho);
+   i = 2*n + 1;
+   xsum = 1. / i;
+   ysum = 0.;
+   for ( ; n >= 1; n --)
+   {
+     i -= 2;
+     xaux = (xsum*xquad - ysum*yquad) / n;
+     ysum = (xsum*yquad + ysum*xquad) / n;
+     xsum = xaux + 1. / i;
+   }
+   u1 = -ERFC_FAC*(xsum*yabs + ysum*xabs) + 1.;
+   v1 =  ERFC_FAC*(xsum*xabs - ysum*yabs);
+   daux = R_exp(-xquad);
+   u2 =  daux * R_cos(yquad);
+   v2 = -daux * R_sin(yquad);
+
+   u = u1*u2 - v1*v2;
+   v = u1*v2 + v1*u2;
+ }
+ else
+ {
+/*
+  Continued fraction (and Taylor series for moderate |z|)
+*/
+   if (qrho > 1.)
+   {
+     h = 0.;
+     kapn = 0;
+     qrho = R_sqrt(qrho);
+     nu = (int) (3. + (1442. / (26.*qrho + 77.)));
+   }
+   else
+   {
+     qrho = (1. - ys) * R_sqrt(1. - qrho);
+     h = 1.88 * qrho;
+     kapn = (int) R_nint(7. + 34.*qrho);
+     nu   = (int) R_nint(16. + 26.*qrho);
+   }
+   h2 = 2.*h;
+
+   b = (h > 0.);
+   for (qlambda = 1., i = 0; b && (i < kapn); i ++) qlambda *= h2;
+
+   rx = ry = sx = sy = 0.;
+   for (n = nu; n >= 0; n --)
+   {
+     tx = yabs + h + (n+1)*rx;
+     ty = xabs - (n+1)*ry;
+     c = 0.5 / (tx*tx + ty*ty);
+     rx = c*tx;
+     ry = c*ty;
+     if (b && (n <= kapn))
+     {
+       tx = qlambda + sx;
+       sx = rx*tx - ry*sy;
+       sy = ry*tx + rx*sy;
+       qlambda /= h2;
+     }
+   }
+
+   if (b)
+   {
+     u = ERFC_FAC*sx;
+     v = ERFC_FAC*sy;
+   }
+   else
+   {
+     u = ERFC_FAC*rx;
+     v = ERFC_FAC*ry;
+   }
+
+   if (yabs == 0.) u = R_exp(-xabs*xabs);
+ }
+
+ if (x < 0.) v = -v;
+
+ *w_r = u;
+ *w_i = v;
+} /* end of function c_wofz */
+
+/*======================================================================*/
+/*======================================================================*/
+
+void c_erfc ( real *res_r, real *res_i, real z_r, real z_i )
+
+/************************************************************************
+
+ Calculate the complementary error function erfc(z) for a complex
+ argument z = z_r + i*z_i.
+
+ design:
+
+ For Re(z) >= 0, erfc(z) = exp(-z^2) * w(iz), where iz lies in the upper
+ half plane in which the Faddeeva function w is evaluated (c_wofz).
+ For Re(z) < 0, erfc(z) = 2 - erfc(-z).
+
+ Note that |erfc(z)| grows like exp(Im(z)^2) for large imaginary parts;
+ the result overflows if Im(z)^2 - Re(z)^2 exceeds about 700.
+
+*************************************************************************/
+{
+int neg;
+real w_r, w_i;
+real faux_r, faux_i;
+
+ neg = (z_r < 0.);
+ if (neg)
+ {
+   z_r = -z_r;
+   z_i = -z_i;
+ }
+
+/* w(iz), iz = -z_i + i*z_r */
+ c_wofz(&w_r, &w_i, -z_i, z_r);
+
+/* exp(-z^2) */
+ cri_exp(&faux_r, &faux_i, z_i*z_i - z_r*z_r, -2.*z_r*z_i);
+
+ cri_mul(res_r, res_i, faux_r, faux_i, w_r, w_i);
+
+ if (neg)
+ {
+   *res_r = 2. - *res_r;
+   *res_i =    - *res_i;
+ }
+} /* end of function c_erfc */
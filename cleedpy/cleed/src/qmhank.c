@@ -12,6 +12,11 @@
        Calculate all Hankel functions H(1)l up to l = l_max for a given
        complex argument.
 
+  c_hank1_vec
+
+       Calculate all Hankel functions H(1)l up to l = l_max for a vector
+       of complex arguments.
+
   (Tested for PI/2, PI, i and -i.)
 
 *********************************************************************/
@@ -30,12 +35,13 @@
 /*
 #define CONTROL
 */
-#define CONTROL
 #define WARNING
 #define ERROR
 
 #define EXIT_ON_ERROR
 
+#define HANK_CHUNK 64        /* arguments per chunk in c_hank1_vec */
+
 /*======================================================================*/
 /*======================================================================*/
 
@@ -115,8 +121,8 @@ real *ptr_r, *ptr_i;
  Hl = matalloc( Hl, (l_max+1), 1, NUM_COMPLEX );
 
 /* Add the offset of 1 to r/ptr_i */
- ptr_r = Hl->rel+1;
- ptr_i = Hl->iel+1;
+ ptr_r = Hl->rel+2;
+ ptr_i = Hl->iel+2;
 
 /*
   Some often used values
@@ -134,7 +140,7 @@ real *ptr_r, *ptr_i;
  ptr_i[0] = -z_inv * cos(x);
 
  /* H1(x) */
- cri_mul(ptr_r+1, ptr_i+1, ptr_r[0], ptr_i[0], z_inv, -1.);
+ cri_mul(ptr_r+2, ptr_i+2, ptr_r[0], ptr_i[0], z_inv, -1.);
 
 
 /*
@@ -145,9 +151,9 @@ real *ptr_r, *ptr_i;
  for(l = 2; l <= l_max; l++ )
  {
    faux = (2*l - 1) * z_inv;
-   cri_mul(ptr_r+l, ptr_i+l, faux, 0., ptr_r[l-1], ptr_i[l-1]);
-   ptr_r[l] -= ptr_r[l-2];
-   ptr_i[l] -= ptr_i[l-2];
+   cri_mul(ptr_r+2*l, ptr_i+2*l, faux, 0., ptr_r[2*l-2], ptr_i[2*l-2]);
+   ptr_r[2*l] -= ptr_r[2*l-4];
+   ptr_i[2*l] -= ptr_i[2*l-4];
  }   /* l */
 
  return(Hl);
@@ -233,8 +239,8 @@ real *ptr_r, *ptr_i;
  Hl = matalloc( Hl, (l_max+1), 1, NUM_COMPLEX );
 
 /* Add the offset of 1 to r/ptr_i */
- ptr_r = Hl->rel+1;
- ptr_i = Hl->iel+1;
+ ptr_r = Hl->rel+2;
+ ptr_i = Hl->iel+2;
 
 /*
   Some often used values
@@ -254,7 +260,7 @@ real *ptr_r, *ptr_i;
  cri_mul(ptr_r  , ptr_i  , z_inv_i , -z_inv_r , faux_r, faux_i);
 
  /* H1(x) */
- cri_mul(ptr_r+1, ptr_i+1, ptr_r[0], ptr_i[0], z_inv_r, z_inv_i - 1.);
+ cri_mul(ptr_r+2, ptr_i+2, ptr_r[0], ptr_i[0], z_inv_r, z_inv_i - 1.);
 
 
 /*
@@ -267,9 +273,9 @@ real *ptr_r, *ptr_i;
    faux_r = (2*l - 1) * z_inv_r;
    faux_i = (2*l - 1) * z_inv_i;
 
-   cri_mul(ptr_r+l, ptr_i+l, faux_r, faux_i, ptr_r[l-1], ptr_i[l-1]);
-   ptr_r[l] -= ptr_r[l-2];
-   ptr_i[l] -= ptr_i[l-2];
+   cri_mul(ptr_r+2*l, ptr_i+2*l, faux_r, faux_i, ptr_r[2*l-2], ptr_i[2*l-2]);
+   ptr_r[2*l] -= ptr_r[2*l-4];
+   ptr_i[2*l] -= ptr_i[2*l-4];
  }   /* l */
 
  return(Hl);
@@ -278,3 +284,112 @@ real *ptr_r, *ptr_i;
 
 /*======================================================================*/
 /*======================================================================*/
+
+int c_hank1_vec ( real *h_r, real *h_i, const real *z_r, const real *z_i,
+                  int n, int l_max )
+
+/************************************************************************
+
+ Calculate all orders of the Hankel function of the first kind H(1)l up to
+ l = l_max for n complex arguments z[j] at once.
+
+ input:
+
+ real *h_r, *h_i - output: real and imaginary parts of the Hankel
+             functions: H(1)l(z[j]) = h_r[l*n + j] + i*h_i[l*n + j]
+             (j = 0, ..., n-1). Both arrays must have room for
+             (MAX(l_max,1) + 1)*n elements.
+ real *z_r, *z_i - real and imaginary parts of the n arguments.
+ int n     - number of arguments.
+ int l_max - max angular momentum for output.
+
+ design:
+
+ Same formulas as c_hank1, but the arrays are stored by l (structure of
+ arrays) and the recurrence runs over all arguments for each l, so that
+ the inner loops have no dependencies and can be vectorised. The
+ arguments are processed in chunks of HANK_CHUNK.
+
+ output(return value):
+
+ number of arguments (n), -1 if failed.
+
+*************************************************************************/
+{
+int l, j, j0, n_chunk;
+
+real faux_r, faux_i;
+real exp_r, exp_i;
+real z_inv_r[HANK_CHUNK], z_inv_i[HANK_CHUNK];
+real *h0_r, *h0_i, *h1_r, *h1_i, *h2_r, *h2_i;
+
+
+ if (l_max < 1) l_max = 1;   /* we need at least that much storage */
+
+ for(j0 = 0; j0 < n; j0 += HANK_CHUNK)
+ {
+   n_chunk = MIN(HANK_CHUNK, n - j0);
+
+/*
+  1/z, H0(z) = - i/z * exp(iz) and H1(z) = H0(z) * (1/z - i).
+*/
+   for(j = 0; j < n_chunk; j ++)
+   {
+     faux_r = z_r[j0+j]*z_r[j0+j] + z_i[j0+j]*z_i[j0+j];
+     if(faux_r == 0.)
+     {
+#ifdef ERROR
+       fprintf(STDERR,
+               " *** error (c_hank1_vec): invalid argument z = (0., 0.)\n");
+#endif
+#ifdef EXIT_ON_ERROR
+       exit(1);
+#else
+       return(-1);
+#endif
+     }
+     z_inv_r[j] =  z_r[j0+j] / faux_r;
+     z_inv_i[j] = -z_i[j0+j] / faux_r;
+   }
+
+   h0_r = h_r + j0; h0_i = h_i + j0;
+   h1_r = h0_r + n; h1_i = h0_i + n;
+   for(j = 0; j < n_chunk; j ++)
+   {
+     faux_r = exp(-z_i[j0+j]);
+     exp_r = faux_r * cos(z_r[j0+j]);
+     exp_i = faux_r * sin(z_r[j0+j]);
+
+     h0_r[j] = z_inv_i[j]*exp_r + z_inv_r[j]*exp_i;
+     h0_i[j] = z_inv_i[j]*exp_i - z_inv_r[j]*exp_r;
+
+     h1_r[j] = h0_r[j]*z_inv_r[j] - h0_i[j]*(z_inv_i[j] - 1.);
+     h1_i[j] = h0_r[j]*(z_inv_i[j] - 1.) + h0_i[j]*z_inv_r[j];
+   }
+
+/*
+ loop over l:
+
+  Hl (z) = (2*l-1)/z Hl-1(z) - Hl-2(z)
+*/
+   for(l = 2; l <= l_max; l++ )
+   {
+     h2_r = h1_r + n; h2_i = h1_i + n;
+     for(j = 0; j < n_chunk; j ++)
+     {
+       faux_r = (2*l - 1) * z_inv_r[j];
+       faux_i = (2*l - 1) * z_inv_i[j];
+       h2_r[j] = faux_r*h1_r[j] - faux_i*h1_i[j] - h0_r[j];
+       h2_i[j] = faux_r*h1_i[j] + faux_i*h1_r[j] - h0_i[j];
+     }
+     h0_r = h1_r; h0_i = h1_i;
+     h1_r = h2_r; h1_i = h2_i;
+   }   /* l */
+ }   /* j0 */
+
+ return(n);
+
+} /* end of function c_hank1_vec */
+
+/*======================================================================*/
+/*======================================================================*/
@@ -17,6 +17,10 @@
        Produce the coefficients needed to calculate spherical harmonics
        in function ylm.
 
+  free_ylm_coef
+
+       Release the coefficients returned by mk_ylm_coef.
+
 GH/15.08.94 - Creation
 GH/03.04.95 - Calculate Yl-m explicitly in c_ylm.
 GH/05.08.95 - mk_ylm_coef is a global function (not static anymore), i.e.
@@ -44,23 +48,20 @@ GH/10.08.95 - WARNING output at the end of mk_ylm_coef.
 
 
 #define MEM_BLOCK 256           /* memory block for coef */
-#define UNUSED    -1
-
-static real *coef  = NULL;      /* coefficients in the power series of Ylm */
 
-static real *r_pre = NULL;      /* prefactors used to calculate Ylm r/c_ylm */
-static real *i_pre = NULL;
-static real *r_prec = NULL;     /* prefactors used to calculate Yl-m c_ylm */
-static real *i_prec = NULL;
+/*
+  Largest set of coefficients calculated so far. It is shared by all
+  callers of mk_ylm_coef and only accessed inside the critical section
+  qm_ylm_coef.
+*/
+static struct ylmc_str *ylmc_shared = NULL;
 
-static int l_max_coef = UNUSED;
-static int l_max_r = UNUSED;
-static int l_max_c = UNUSED;
+static struct ylmc_str * mk_ylm_tab(int l_max);
 
 /*======================================================================*/
 /*======================================================================*/
 
-mat r_ylm( mat Ylm, real x, real phi, int l_max )
+mat r_ylm( mat Ylm, const struct ylmc_str *ylmc, real x, real phi, int l_max )
 
 /************************************************************************
 
@@ -70,6 +71,9 @@ mat r_ylm( mat Ylm, real x, real phi, int l_max )
  input:
 
  mat Ylm   - output: spherical harmonics in natural order (see below).
+ const struct ylmc_str *ylmc
+           - coefficients of the power series (mk_ylm_coef); they must
+             be available up to l_max.
  real x    - first argument: cos(theta)
  real phi  - 2nd argument: phi
  int l_max - max angular momentum for output.
@@ -78,14 +82,14 @@ mat r_ylm( mat Ylm, real x, real phi, int l_max )
 
  The shperical harmonics Ylm are calculated as a power series times
  prefactors. The coefficients of the power series have to be generated
- once and stored in the array coef (function mk_ylm_coef). It is checked
- within the function r_ylm, if this has been done already.
+ once (function mk_ylm_coef) and are handed over in ylmc.
 
  Variables used within the function:
 
-  r/i_pre - (dimension: l_max+1) powers of
+  r/i_pre - powers of
             sin(x) * exp(i*phi) = sqrt (1- x*x)*(cos(phi) + i sin(phi) )
             which is the m-dependent prefactor of the spherical harmonics.
+            The power m is accumulated in the loop over m.
 
   r_pre_l, r_pre_m
             these variables are either x or 1. The relation holds:
@@ -106,6 +110,8 @@ mat r_ylm( mat Ylm, real x, real phi, int l_max )
  I.e. index(l,m) = l*(l+1) + m + 1. Note that, like usually for matrices,
  the first array element Ylm[0] is not occupied.
 
+ NULL, if the coefficients are not available up to l_max.
+
 *************************************************************************/
 {
 int iaux, off;
@@ -115,60 +121,47 @@ int lamb;                      /* power of x */
 int index;                     /* used to run through coef */
 
 real r_pre_l, r_pre_m;       /* prefactors */
-real i_pre_l, i_pre_m;
+real r_pre, i_pre;           /* (sin(x) * exp(i*phi))^m */
+real r_pre_1, i_pre_1;       /*  sin(x) * exp(i*phi) */
 
 real faux;
 real x_2, sum;
 
+const real *coef;
 
 /*
-  Allocate memory for Ylm
-*/
- iaux = (l_max+1)*(l_max+1);                /* Total number of (l,m) pairs */
- Ylm = matalloc( Ylm, 1, iaux, NUM_COMPLEX );
-
-/*
-  Calculate coefficients and allocate memory for prefactors r/i_pre
-  if not done yet or if l_max has changed since last time.
+  Check if the coefficients are available
 */
- if ( l_max > l_max_coef )
+ if ( l_max > ylmc->l_max )
  {
-#ifdef WARNING
-   if(l_max_coef != UNUSED)
-   {
-     fprintf(STDWAR,"*** warning (r_ylm): recalculating coefficients: ");
-     fprintf(STDWAR,"old l_max: %d, new: %d\n", l_max_coef, l_max);
-   }
+#ifdef ERROR
+   fprintf(STDERR,"*** error (r_ylm): coefficients available up to l_max ");
+   fprintf(STDERR,"= %d, requested: %d\n", ylmc->l_max, l_max);
 #endif
-   mk_ylm_coef(l_max);
+   return(NULL);
  }
+ coef = ylmc->coef;
 
- if ( l_max > l_max_r )
- {
-   if (r_pre == NULL) r_pre = (real *) calloc( (l_max+1) , sizeof(real) );
-   else       r_pre = (real *) realloc( r_pre, (l_max+1) * sizeof(real) );
-
-   if (i_pre == NULL) i_pre = (real *) calloc( (l_max+1) , sizeof(real) );
-   else       i_pre = (real *) realloc( i_pre, (l_max+1) * sizeof(real) );
- }
+/*
+  Allocate memory for Ylm
+*/
+ iaux = (l_max+1)*(l_max+1);                /* Total number of (l,m) pairs */
+ Ylm = matalloc( Ylm, 1, iaux, NUM_COMPLEX );
 
 /*
   Some often used values
 */
  x_2 = x*x;
 
- r_pre[0] = 1.;
- i_pre[0] = 0.;
-
  faux = sqrt(1 - x_2);
- r_pre[1] = faux * cos(phi);
- i_pre[1] = faux * sin(phi);
+ r_pre_1 = faux * cos(phi);
+ i_pre_1 = faux * sin(phi);
 
 /*
   Y_00:
 */
- Ylm->rel[1] = coef[0];
- Ylm->iel[1] = 0.;
+ Ylm->rel[2] = coef[0];
+ Ylm->iel[2] = 0.;
 
 /*
  loop over l
@@ -179,14 +172,10 @@ real x_2, sum;
  {
  /*
    Determine prefactors,
-   write next value into r/i_pre;
    determine offset in Ylm -> off
  */
    r_pre_l = 1. + x - r_pre_l;
 
-   r_pre[l] = (r_pre[l-1]*r_pre[1]) - (i_pre[l-1]*i_pre[1]);
-   i_pre[l] = (i_pre[l-1]*r_pre[1]) + (r_pre[l-1]*i_pre[1]);
-
    off = l*(l+1) + 1;
 
  /*
@@ -194,6 +183,8 @@ real x_2, sum;
     it is 1.
  */
    r_pre_m = r_pre_l;
+   r_pre = 1.;
+   i_pre = 0.;
    for(m = 0; m <= l; m++ )
    {
      sum = 0.;
@@ -203,23 +194,27 @@ real x_2, sum;
        sum = sum * x_2 + coef[index];
      }
 
-     Ylm->rel[off + m] = r_pre[m] * r_pre_m * sum;
-     Ylm->iel[off + m] = i_pre[m] * r_pre_m * sum;
+     Ylm->rel[2*(off + m)] = r_pre * r_pre_m * sum;
+     Ylm->iel[2*(off + m)] = i_pre * r_pre_m * sum;
 
      /* -m: (-1)^m */
      if(ODD(m))
      {
-       Ylm->rel[off - m] = - Ylm->rel[off + m];
-       Ylm->iel[off - m] =   Ylm->iel[off + m];
+       Ylm->rel[2*(off - m)] = - Ylm->rel[2*(off + m)];
+       Ylm->iel[2*(off - m)] =   Ylm->iel[2*(off + m)];
      }
      else
      {
-       Ylm->rel[off - m] =   Ylm->rel[off + m];
-       Ylm->iel[off - m] = - Ylm->iel[off + m];
+       Ylm->rel[2*(off - m)] =   Ylm->rel[2*(off + m)];
+       Ylm->iel[2*(off - m)] = - Ylm->iel[2*(off + m)];
      }
 
      r_pre_m = 1. + x - r_pre_m;
 
+     faux  = r_pre;
+     r_pre = (faux *r_pre_1) - (i_pre*i_pre_1);
+     i_pre = (i_pre*r_pre_1) + (faux *i_pre_1);
+
    } /* m */
  }   /* l */
 
@@ -230,7 +225,8 @@ real x_2, sum;
 /*======================================================================*/
 /*======================================================================*/
 
-mat c_ylm( mat Ylm, real z_r, real z_i, real phi, int l_max )
+mat c_ylm( mat Ylm, const struct ylmc_str *ylmc,
+           real z_r, real z_i, real phi, int l_max )
 
 /************************************************************************
 
@@ -240,6 +236,9 @@ mat c_ylm( mat Ylm, real z_r, real z_i, real phi, int l_max )
  input:
 
  mat Ylm    - output: spherical harmonics in natural order (see below).
+ const struct ylmc_str *ylmc
+            - coefficients of the power series (mk_ylm_coef); they must
+              be available up to l_max.
  real z_r/i - real and imaginary part of 1st argument: complex cos(theta)
  real phi   - 2nd argument: phi (real)
  int l_max  - max angular momentum for output.
@@ -248,8 +247,7 @@ mat c_ylm( mat Ylm, real z_r, real z_i, real phi, int l_max )
 
  The spherical harmonics Ylm are calculated as a power series times
  prefactors. The coefficients of the power series have to be generated
- once and stored in the array coef (function mk_ylm_coef). It is checked
- within the function r_ylm, if this has been done already.
+ once (function mk_ylm_coef) and are handed over in ylmc.
 
  The definition of the Ylm and Yl-m is according to formula (10,VHT):
 
@@ -271,9 +269,10 @@ mat c_ylm( mat Ylm, real z_r, real z_i, real phi, int l_max )
 
  Variables used within the function:
 
-  r/i_pre - (dimension: l_max+1) powers of
+  r/i_pre - powers of
             sin(x) * exp(i*phi) = sqrt (1- x*x)*(cos(phi) + i sin(phi) )
             which is the m-dependent prefactor of the spherical harmonics.
+            The power m is accumulated in the loop over m.
 
   r_pre_l, r_pre_m
             these variables are either x or 1. The relation holds:
@@ -294,6 +293,8 @@ mat c_ylm( mat Ylm, real z_r, real z_i, real phi, int l_max )
  I.e. index(l,m) = l*(l+1) + m + 1. Note that, like usually for matrices,
  the first array element Ylm[0] is not occupied.
 
+ NULL, if the coefficients are not available up to l_max.
+
 *************************************************************************/
 {
 int iaux, off;
@@ -304,74 +305,55 @@ int index;                     /* used to run through coef */
 
 real r_pre_l, i_pre_l;       /* prefactors */
 real r_pre_m, i_pre_m;
+real r_pre, i_pre;           /* (sin(x) * exp( i*phi))^m */
+real r_prec, i_prec;         /* (-sin(x) * exp(-i*phi))^m */
+real r_pre_1, i_pre_1;
+real r_prec_1, i_prec_1;
 
 real faux_i, faux_r;
 real z2_i, z2_r;
 real sum_r, sum_i;
 
+const real *coef;
 
 /*
-  Allocate memory for Ylm
-*/
- iaux = (l_max+1)*(l_max+1);            /* Total number of (l,m) pairs + 1 */
- Ylm = matalloc( Ylm, 1, iaux, NUM_COMPLEX );
-
-/*
-  Calculate coefficients and allocate memory for prefactors r/i_pre
-  if not done yet or if l_max has changed since last time.
+  Check if the coefficients are available
 */
- if ( l_max > l_max_coef )
+ if ( l_max > ylmc->l_max )
  {
-#ifdef WARNING
-   if(l_max_coef != UNUSED)
-   {
-     fprintf(STDWAR,"*** warning (c_ylm): recalculating coefficients: ");
-     fprintf(STDWAR,"old l_max: %d, new: %d\n", l_max_coef, l_max);
-   }
+#ifdef ERROR
+   fprintf(STDERR,"*** error (c_ylm): coefficients available up to l_max ");
+   fprintf(STDERR,"= %d, requested: %d\n", ylmc->l_max, l_max);
 #endif
-   mk_ylm_coef(l_max);
+   return(NULL);
  }
+ coef = ylmc->coef;
 
- if ( l_max > l_max_r)
- {
-   if (r_pre == NULL) r_pre = (real *) calloc( (l_max+1) , sizeof(real) );
-   else       r_pre = (real *) realloc( r_pre, (l_max+1) * sizeof(real) );
-
-   if (i_pre == NULL) i_pre = (real *) calloc( (l_max+1) , sizeof(real) );
-   else       i_pre = (real *) realloc( i_pre, (l_max+1) * sizeof(real) );
- }
-
- if ( l_max > l_max_c)
- {
-   if (r_prec == NULL) r_prec = (real *) calloc( (l_max+1) , sizeof(real) );
-   else       r_prec = (real *) realloc( r_prec, (l_max+1) * sizeof(real) );
-
-   if (i_prec == NULL) i_prec = (real *) calloc( (l_max+1) , sizeof(real) );
-   else       i_prec = (real *) realloc( i_prec, (l_max+1) * sizeof(real) );
- }
+/*
+  Allocate memory for Ylm
+*/
+ iaux = (l_max+1)*(l_max+1);            /* Total number of (l,m) pairs + 1 */
+ Ylm = matalloc( Ylm, 1, iaux, NUM_COMPLEX );
 
 /*
   Some often used values
 */
  cri_mul(&z2_r, &z2_i, z_r, z_i, z_r, z_i);              /* z*z */
 
- r_pre[0] = 1.; i_pre[0] = 0.;
- r_prec[0] = 1.; i_prec[0] = 0.;
-
  cri_sqrt(&faux_r, &faux_i, (1. - z2_r), - z2_i);        /* sqrt(1 - z*z) */
 
  sum_r = cos(phi); sum_i = sin(phi);                     /* exp(i*phi) */
- cri_mul(r_pre+1, i_pre+1, faux_r, faux_i, sum_r, sum_i );
+ cri_mul(&r_pre_1, &i_pre_1, faux_r, faux_i, sum_r, sum_i );
 
  sum_r = cos(-phi); sum_i = sin(-phi);                   /* exp(-i*phi) */
- cri_mul(r_prec+1, i_prec+1, -faux_r, -faux_i, sum_r, sum_i );
+ cri_mul(&r_prec_1, &i_prec_1, -faux_r, -faux_i, sum_r, sum_i );
 
 /*
   Y_00:
 */
 
- Ylm->rel[1] = coef[0];
- Ylm->iel[1] = 0.;
+ Ylm->rel[2] = coef[0];
+ Ylm->iel[2] = 0.;
 
 /*
  loop over l
@@ -381,20 +363,18 @@ real sum_r, sum_i;
  for(l = 1; l <= l_max; l++ )
  {
  /*
-   Write next value into r/i_pre(c);
    Determine prefactors (for odd (l+m), the lowest power of x is x,
    for even (l+m), it is 1).
    Determine offset in Ylm -> off
  */
-   cri_mul(r_pre+l, i_pre+l, r_pre[l-1], i_pre[l-1], r_pre[1], i_pre[1]);
-   cri_mul(r_prec+l, i_prec+l, r_prec[l-1], i_prec[l-1], r_prec[1], i_prec[1]);
-
    r_pre_l = 1. + z_r - r_pre_l;
    i_pre_l =      z_i - i_pre_l;
    r_pre_m = r_pre_l; i_pre_m = i_pre_l;
 
    off = l*(l+1) + 1;
 
+   r_pre  = 1.; i_pre  = 0.;
+   r_prec = 1.; i_prec = 0.;
    for(m = 0; m <= l; m++ )
    {
    /*
@@ -424,16 +404,19 @@ real sum_r, sum_i;
      cri_mul(&faux_r, &faux_i, sum_r, sum_i, r_pre_m, i_pre_m);
 
      /* +m: */
-     cri_mul(Ylm->rel+off+m, Ylm->iel+off+m,
-             faux_r, faux_i, r_pre[m], i_pre[m]);
+     cri_mul(Ylm->rel+2*(off+m), Ylm->iel+2*(off+m),
+             faux_r, faux_i, r_pre, i_pre);
 
      /* -m: */
-     cri_mul(Ylm->rel+off-m, Ylm->iel+off-m,
-             faux_r, faux_i, r_prec[m], i_prec[m]);
+     cri_mul(Ylm->rel+2*(off-m), Ylm->iel+2*(off-m),
+             faux_r, faux_i, r_prec, i_prec);
 
      r_pre_m = 1. + z_r - r_pre_m;
      i_pre_m =      z_i - i_pre_m;
 
+     cri_mul(&r_pre, &i_pre, r_pre, i_pre, r_pre_1, i_pre_1);
+     cri_mul(&r_prec, &i_prec, r_prec, i_prec, r_prec_1, i_prec_1);
+
    } /* m */
  }   /* l */
 
@@ -444,18 +427,85 @@ real sum_r, sum_i;
 /*======================================================================*/
 /*======================================================================*/
 
-int mk_ylm_coef(int l_max)
+struct ylmc_str * mk_ylm_coef(int l_max)
+
+/************************************************************************
+
+ Return the coefficients needed to calculate spherical harmonics in
+ functions r_ylm and c_ylm up to (at least) l_max.
+
+ The coefficients are shared: if they have been calculated for an equal
+ or larger l_max before, a reference to these is returned. Otherwise they
+ are recalculated (mk_ylm_tab) and replace the previous ones for later
+ calls. Coefficients already handed out remain valid until they are
+ released with free_ylm_coef.
+
+ return value: coefficients (to be released with free_ylm_coef)
+
+*************************************************************************/
+{
+struct ylmc_str *ylmc;
+
+#pragma omp critical (qm_ylm_coef)
+ {
+   if( (ylmc_shared == NULL) || (ylmc_shared->l_max < l_max) )
+   {
+     ylmc = mk_ylm_tab(l_max);
+     if( (ylmc_shared != NULL) && (-- ylmc_shared->n_ref == 0) )
+     {
+       free(ylmc_shared->coef);
+       free(ylmc_shared);
+     }
+     ylmc_shared = ylmc;
+   }
+
+   ylmc = ylmc_shared;
+   ylmc->n_ref ++;
+ }
+
+ return(ylmc);
+
+} /* end of function mk_ylm_coef */
+
+/*======================================================================*/
+/*======================================================================*/
+
+void free_ylm_coef(struct ylmc_str *ylmc)
+
+/************************************************************************
+
+ Release coefficients returned by mk_ylm_coef. They are freed when they
+ are neither used nor the current shared set.
+
+*************************************************************************/
+{
+ if(ylmc == NULL) return;
+
+#pragma omp critical (qm_ylm_coef)
+ {
+   if(-- ylmc->n_ref == 0)
+   {
+     free(ylmc->coef);
+     free(ylmc);
+   }
+ }
+} /* end of function free_ylm_coef */
+
+/*======================================================================*/
+/*======================================================================*/
+
+static struct ylmc_str * mk_ylm_tab(int l_max)
 
 /************************************************************************
 
  Produce the coefficients needed to calculate spherical harmonics in
  functions r_ylm and c_ylm.
 
- return value: l_max_coef
+ return value: new set of coefficients (n_ref = 1)
 
 *************************************************************************/
 {
-int i, j;
+int i;
 int iaux;
 int index;                   /* index */
 int i_mem;                   /* number of memory blocks allocated */
@@ -467,6 +517,9 @@ double *fac;
 real pre_0, pre_ll, pre_lm;  /* prefactors */
 real sgn;                    /* sign of the coefficients */
 
+real *coef;
+struct ylmc_str *ylmc;
+
 /*
   Produce a list of factorials
 */
@@ -482,10 +535,7 @@ real sgn;                    /* sign of the coefficients */
 */
 
  i_mem = 1;
- if (coef == NULL)
-   coef = (real *) calloc(i_mem * MEM_BLOCK , sizeof(real) );
- else
-   coef = (real *) realloc( coef, i_mem * MEM_BLOCK * sizeof(real) );
+ coef = (real *) calloc(i_mem * MEM_BLOCK , sizeof(real) );
 
 /*
  loop over l
@@ -541,16 +591,21 @@ real sgn;                    /* sign of the coefficients */
 #endif
 
  free(fac);
- l_max_coef = l_max;
 
-#ifdef WARNING
-/* Write memory size to warning output */
-       fprintf(STDCTR,"(mk_ylm_coef): coef[%d] (%d bytes) for l_max = %d\n",
-               index, i_mem * MEM_BLOCK * sizeof(real), l_max_coef);
-#endif
+ ylmc = (struct ylmc_str *) malloc(sizeof(struct ylmc_str));
+ ylmc->l_max = l_max;
+ ylmc->coef  = coef;
+ ylmc->n_ref = 1;
 
- return( l_max_coef );
+/* Write memory size to control output */
+ if(LOG_ON(LOG_QM, LOG_CONTROL))
+ {
+   fprintf(STDCTR,"(mk_ylm_coef): coef[%d] (%d bytes) for l_max = %d\n",
+           index, i_mem * MEM_BLOCK * sizeof(real), l_max);
+ }
 
-} /* end of function mk_ylm_coef */
+ return( ylmc );
+
+} /* end of function mk_ylm_tab */
 /*======================================================================*/
 /*======================================================================*/
@@ -0,0 +1,66 @@
+from pathlib import Path
+
+import typer
+
+from ..benchmark import (
+    SWEEPS,
+    benchmark_cases,
+    compare_reports,
+    load_report,
+    run_benchmark,
+)
+
+EXAMPLES_PATH = Path(__file__).resolve().parents[2] / "examples"
+
+
+def benchmark(
+    output_file: str = typer.Option(  # noqa: B008
+        "benchmark.json", "--output", "-o", help="Output file (JSON)"
+    ),
+    phase_path: str = typer.Option(  # noqa: B008
+        str(EXAMPLES_PATH / "data" / "PHASE"), "--phase", "-p", help="Phase path"
+    ),
+    examples_path: str = typer.Option(  # noqa: B008
+        str(EXAMPLES_PATH), "--examples", help="Directory with the examples"
+    ),
+    sweeps: list[str] = typer.Option(  # noqa: B008
+        None,
+        "--sweep",
+        "-s",
+        help=f"Sweep to run (repeatable): examples, {', '.join(SWEEPS)}. "
+        + "Default: all",
+    ),
+    n_threads: int = typer.Option(  # noqa: B008
+        1,
+        "--threads",
+        "-t",
+        help="Number of threads for the energy loop (0: all available cores)",
+    ),
+    repeat: int = typer.Option(  # noqa: B008
+        1, "--repeat", "-r", help="Runs per case (the fastest is reported)"
+    ),
+    baseline: str = typer.Option(  # noqa: B008
+        None, "--baseline", "-b", help="Earlier report to compare with"
+    ),
+):
+    """Benchmark the LEED engine and write wall time, time per stage and
+    peak memory of every case to a JSON file."""
+    cases = benchmark_cases(sweeps, examples_path)
+    report = run_benchmark(cases, phase_path, n_threads, repeat, output_file)
+
+    if baseline is not None:
+        print(f"\nRatio to {baseline} (< 1: faster/smaller)")
+        for case in compare_reports(report, load_report(baseline)):
+            print(
+                f"{case['name']:28s} time {case['wall_time']:6.3f} "
+                f"memory {case['peak_memory']:6.3f}"
+            )
+
+
+def cli():
+    """Benchmark CLI."""
+    typer.run(benchmark)
+
+
+if __name__ == "__main__":
+    cli()
@@ -1,6 +1,7 @@
 import datetime
 from pathlib import Path
 
+import numpy as np
 import typer
 
 from ..config import OLD_FORMAT_TEMPLATE, load_parameters
@@ -38,30 +39,24 @@ CLEED_OUT_HEADER = f"""# ####################################### #
 
 def print_cleed_results(result, output_file):
     """Function that prints the results of cleed."""
+    arrays = result.arrays()
+    energies = arrays.energies * HART
     with open(output_file, "w") as f:
         f.write(CLEED_OUT_HEADER)
-        energy_step = (result.energies[result.n_energies - 1] - result.energies[0]) / (
-            result.n_energies - 1
-        )
+        energy_step = (energies[-1] - energies[0]) / (result.n_energies - 1)
         f.write(
-            f"#en {result.n_energies} {result.energies[0]*HART:.6f} {result.energies[result.n_energies-1]*HART:.6f} {energy_step*HART:.6f}\n"
+            f"#en {result.n_energies} {energies[0]:.6f} {energies[-1]:.6f} {energy_step:.6f}\n"
         )
         f.write(f"#bn {result.n_beams}\n")
         for i in range(result.n_beams):
             f.write(
-                f"#bi {i} {result.beam_index1[i]:.6f} {result.beam_index2[i]:.6f} {result.beam_set[i]}\n"
-            )
-        for i in range(result.n_energies):
-            f.write(
-                " ".join(
-                    [f"{result.energies[i]*HART:.2f}"]
-                    + [
-                        f"{result.iv_curves[i*result.n_beams+j]:.6e}"
-                        for j in range(result.n_beams)
-                    ]
-                )
+                f"#bi {i} {arrays.beam_index1[i]:.6f} {arrays.beam_index2[i]:.6f} {arrays.beam_set[i]}\n"
             )
-            f.write("\n")
+        np.savetxt(
+            f,
+            np.column_stack([energies, arrays.iv_curves]),
+            fmt=["%.2f"] + ["%.6e"] * result.n_beams,
+        )
 
 
 def leed(
@@ -77,6 +72,12 @@ def leed(
     output_file: str = typer.Option(  # noqa: B008
         "leed.out", "--output", "-o", help="Output file"
     ),  # noqa: B008
+    n_threads: int = typer.Option(  # noqa: B008
+        1,
+        "--threads",
+        "-t",
+        help="Number of threads for the energy loop (0: all available cores)",
+    ),
 ):
     """Leed CLI."""
 
@@ -89,7 +90,9 @@ def leed(
         with open(parameters_file, "w") as f:
             f.write(old_format)
 
-    result = call_cleed(str(parameters_file), str(parameters_file), phase_path)
+    result = call_cleed(
+        str(parameters_file), str(parameters_file), phase_path, n_threads=n_threads
+    )
 
     print_cleed_results(result, output_file)
 
@@ -80,6 +80,19 @@ def run_search(
         "-A",
         help="Which overlayer (!) atoms to optimize, e.g. '1-20,24-30'. The indexing starts from 1.",
     ),
+    n_threads: int = typer.Option(  # noqa: B008
+        1,
+        "--threads",
+        "-t",
+        help="Number of threads for the energy loop (0: all available cores)",
+    ),
+    bulk_cache: Path = typer.Option(  # noqa: B008
+        None,
+        "--bulk-cache",
+        file_okay=True,
+        dir_okay=False,
+        help="File to keep the bulk reflection matrices in between runs.",
+    ),
 ) -> None:
     """Command line interface for the search tool."""
 
@@ -98,6 +111,8 @@ def run_search(
         phase_path=str(phase_path),
         experimental_iv_file=str(experimental_iv),
         optimization_history_file=str(optimization_history),
+        n_threads=n_threads,
+        bulk_cache_file=None if bulk_cache is None else str(bulk_cache),
     )
 
     # Prepare what to optimize.
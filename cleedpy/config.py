@@ -9,6 +9,12 @@ import yaml
 from numpy import typing as np_typing
 from pydantic import BaseModel, model_validator
 
+# Methods for the lattice sums (LSUM_REAL, LSUM_EWALD, LSUM_AUTO in leed_def.h).
+LATTICE_SUM = {"real": 0, "ewald": 1, "auto": 2}
+# Solvers of the giant matrix equations (MBG_LU, MBG_GMRES, MBG_INV in
+# leed_def.h).
+GIANT_MATRIX_SOLVER = {"lu": 0, "gmres": 1, "inverse": 2}
+
 OLD_FORMAT_TEMPLATE = jinja2.Template(
     """
 c: {{ system_name }}
@@ -38,8 +44,14 @@ it: {{ "%4.1f"|format(polar_incidence_angle) }}
 ip: {{ "%4.1f"|format(azimuthal_incidence_angle) }}
 ep: {{ "%9.1e"|format(epsilon) }}
 lm: {{ maximum_angular_momentum }}
+ls: {{ LATTICE_SUM[lattice_sum] }}
+gs: {{ GIANT_MATRIX_SOLVER[giant_matrix_solver] }}
+gt: {{ "%9.1e"|format(giant_matrix_tolerance) }}
 """
 )
+OLD_FORMAT_TEMPLATE.globals.update(
+    LATTICE_SUM=LATTICE_SUM, GIANT_MATRIX_SOLVER=GIANT_MATRIX_SOLVER
+)
 
 
 class UnitCellParameters(BaseModel):
@@ -169,6 +181,15 @@ class InputParameters(BaseModel):
     epsilon: float = 1e-2
     maximum_angular_momentum: int = 8
     sample_temperature: float = 300.0
+    # Lattice sums of the periodic planes: "real" (real space), "ewald"
+    # (cost independent of the imaginary optical potential) or "auto"
+    # (Ewald summation for weak damping).
+    lattice_sum: Literal["real", "ewald", "auto"] = "real"
+    # Solution of the giant matrix equations of composite layers: "lu"
+    # (LU decomposition), "gmres" (iterative, to giant_matrix_tolerance)
+    # or "inverse" (explicit inversion).
+    giant_matrix_solver: Literal["lu", "gmres", "inverse"] = "lu"
+    giant_matrix_tolerance: float = 1e-8
 
     def get_ase_structure(self) -> "ase.Atoms":
         """Get the ASE structure from the input parameters"""
@@ -1,16 +1,25 @@
 import math
 import pathlib as pl
 import platform
-from ctypes import CDLL, POINTER, Structure, c_char_p, c_double, c_int, cdll
-from dataclasses import dataclass
-
-from ..config import (
-    AtomParametersStructured,
-    AtomParametersVariants,
-    Position,
-    PositionOptimizationParameters,
-    SearchParameters,
+import weakref
+from ctypes import (
+    CDLL,
+    POINTER,
+    Structure,
+    addressof,
+    c_char_p,
+    c_double,
+    c_int,
+    c_long,
+    c_void_p,
+    cdll,
+    pointer,
 )
+from typing import NamedTuple
+
+import numpy as np
+
+from ..config import GIANT_MATRIX_SOLVER, LATTICE_SUM, InputParameters
 from ..physics import constants
 from .matrix import MatPtr
 
@@ -104,9 +113,63 @@ class EnergyLoopVariables(Structure):
         ("epsilon", c_double),
         ("l_max", c_int),
         ("p_t1", POINTER(MatPtr)),
+        ("lsum", c_int),
+        ("mbg_solver", c_int),
+        ("mbg_tol", c_double),
     ]
 
 
+# Stages of the calculation of one energy (PROF_* in leed_def.h).
+PROFILE_STAGES = (
+    "update",
+    "beams",
+    "lattice_sums",
+    "tmatrix",
+    "giant_matrix",
+    "layer_doubling",
+    "bulk_doubling",
+    "output",
+)
+
+
+class StageProfile(Structure):
+    """Parses C structure to python class (struct prof_str in leed_def.h):
+    wall time [s] and number of calls per stage (PROFILE_STAGES), bytes
+    of matrix elements allocated and GMRES iterations for one energy.
+    """
+
+    _fields_ = [
+        ("time", c_double * len(PROFILE_STAGES)),
+        ("calls", c_long * len(PROFILE_STAGES)),
+        ("bytes", c_double),
+        ("bytes_new", c_double),
+        ("mbg_iterations", c_long),
+    ]
+
+
+class CleedArrays(NamedTuple):
+    """NumPy views of the arrays of a CleedResult (see CleedResult.arrays)."""
+
+    energies: np.ndarray  # (n_energies,) [Hartree]
+    iv_curves: np.ndarray  # (n_energies, n_beams)
+    beam_index1: np.ndarray  # (n_beams,)
+    beam_index2: np.ndarray  # (n_beams,)
+    beam_set: np.ndarray  # (n_beams,)
+
+
+def _array_view(address_of, shape, ctype, owner):
+    """Read-only NumPy array of the C array `address_of` points to, without
+    copying. The array keeps `owner` alive."""
+    n = math.prod(shape)
+    if n == 0 or not address_of:
+        return np.empty(shape, dtype=ctype)
+    buffer = (ctype * n).from_address(addressof(address_of.contents))
+    buffer._owner = owner
+    array = np.frombuffer(buffer, dtype=ctype).reshape(shape)
+    array.flags.writeable = False
+    return array
+
+
 class CleedResult(Structure):
     """Parses C structure to python class:
     struct leed_results {
@@ -117,6 +180,7 @@ class CleedResult(Structure):
         int n_energies;
         real * energies;
         real * iv_curves;
+        struct prof_str * profile;
     };
     """
 
@@ -128,89 +192,202 @@ class CleedResult(Structure):
         ("n_energies", c_int),
         ("energies", POINTER(c_double)),
         ("iv_curves", POINTER(c_double)),
+        ("profile", POINTER(StageProfile)),
     ]
 
-
-@dataclass
-class CleedInputs:
-    bulk: Crystal
-    overlayers: Crystal
-    energies: list[float]
-    phase_shifts: PhaseShifts
-    params: EnergyLoopVariables
-
-
-def generate_energies(inp: list[float]) -> list[c_double]:
-    return [c_double(i) for i in inp]
+    def arrays(self) -> CleedArrays:
+        """The result arrays as read-only NumPy views (no copies).
+
+        The intensities are laid out energies x beams. The views keep this
+        result, and the session it belongs to, alive; like the arrays of a
+        session result, they are overwritten by the next evaluation of the
+        session and must not be used after it has been closed. Use
+        `np.array(...)` to keep a copy.
+        """
+        n_beams, n_energies = self.n_beams, self.n_energies
+        return CleedArrays(
+            energies=_array_view(self.energies, (n_energies,), c_double, self),
+            iv_curves=_array_view(
+                self.iv_curves, (n_energies, n_beams), c_double, self
+            ),
+            beam_index1=_array_view(self.beam_index1, (n_beams,), c_double, self),
+            beam_index2=_array_view(self.beam_index2, (n_beams,), c_double, self),
+            beam_set=_array_view(self.beam_set, (n_beams,), c_int, self),
+        )
+
+    def free(self):
+        """Free the arrays of a result of `call_cleed` now rather than when
+        the result is garbage collected. Views from `arrays` must not be
+        used afterwards. The arrays of a `LeedSession` result belong to the
+        session; for them this does nothing.
+        """
+        finalizer = getattr(self, "_finalizer", None)
+        info = finalizer.detach() if finalizer is not None else None
+        if info is not None:
+            _, result_free, _, _ = info
+            result_free(self)
+
+
+class EnergyRange(Structure):
+    _fields_ = [
+        ("ini", c_double),
+        ("fin", c_double),
+        ("stp", c_double),
+    ]
 
 
-def convert_energy_loop_variables(inp: SearchParameters) -> EnergyLoopVariables:
+# Types of atomic scattering matrices (T_DIAG, T_NOND in leed_def.h).
+T_DIAG = 0
+T_NOND = 1
+# Max. number of GMRES iterations per giant matrix (MBG_MAX_ITER in leed_def.h).
+GMRES_MAX_ITERATIONS = 1000
+# Levels and categories of the control output (LOG_* in gh_stddef.h).
+LOG_LEVEL = {"none": 0, "control": 1, "control_x": 2}
+LOG_CATEGORY = {
+    "input": 0x01,
+    "beams": 0x02,
+    "tmatrix": 0x04,
+    "scattering": 0x08,
+    "layer_doubling": 0x10,
+    "basic": 0x20,
+    "matrix": 0x40,
+}
+I_END_OF_LIST = -9999
+
+
+def convert_energy_loop_variables(inp: InputParameters) -> EnergyLoopVariables:
     """
     This corresponds to the following c function: inp_rdpar
+    Only the values read by inp_rdpar are set, the others are preset in C.
     """
     return EnergyLoopVariables(
-        eng_r=c_double(inp.energy_range.initial / constants.HART),
-        eng_i=c_double(inp.energy_range.final / constants.HART),
-        eng_v=c_double(inp.energy_range.step / constants.HART),
-        vr=c_double(inp.optical_potential[0]),
-        vi_prev=c_double(inp.optical_potential[1]),
-        vi_exp=c_double(inp.optical_potential[1]),
-        theta=c_double(math.radians(inp.polar_incidence_angle)),
-        phi=c_double(math.radians(inp.azimuthal_incidence_angle)),
-        k_in=(c_double * 4)(0, 0, 0, 0),
-        epsilon=c_double(inp.epsilon),
-        l_max=c_int(inp.maximum_angular_momentum),
-        p_t1=POINTER(MatPtr),
+        vi_exp=0.0,
+        theta=math.radians(inp.polar_incidence_angle),
+        phi=math.radians(inp.azimuthal_incidence_angle),
+        epsilon=inp.epsilon,
+        l_max=inp.maximum_angular_momentum,
+        lsum=LATTICE_SUM[inp.lattice_sum],
+        mbg_solver=GIANT_MATRIX_SOLVER[inp.giant_matrix_solver],
+        mbg_tol=inp.giant_matrix_tolerance,
     )
 
 
-def generate_single_atom_structure(inp: AtomParametersVariants) -> Atom:
-    """
-    Generate a single atom for cleed from the inp atom parameters
-    """
-    match inp:
-        case AtomParametersStructured(
-            phase_file, Position(x, y, z), vibrational_displacement
-        ):
-            a = Atom()
-            a.layer = 0
-            a.type = 0
-            a.t_type = 0
-            a.pos = (x, y, z, 0)
-            a.dwf
-
-        case AtomParametersStructured(
-            phase_file, PositionOptimizationParameters(), vibrational_displacement
-        ):
-            raise ValueError(
-                "Cleed needs a position for each atom, not an optimization range"
-            )
-        case _:
-            raise ValueError("Not implemented")
+def convert_energy_range(inp: InputParameters) -> EnergyRange:
+    return EnergyRange(
+        ini=inp.energy_range.initial / constants.HART,
+        fin=inp.energy_range.final / constants.HART,
+        stp=inp.energy_range.step / constants.HART,
+    )
 
 
-def generate_atom_structure(inp: list[AtomParametersVariants]) -> list[Atom]:
+def convert_vibrational_displacement(inp, temperature, lib=None):
+    """Return (t_type, dr) as computed by inp_rdbul/inp_rdovl.
+
+    dr[0] is <dr^2>, dr[1..3] are the root mean square displacements along
+    x, y and z, all in Bohr.
     """
-    Generate a list of atoms for cleed from the inp list of atom parameters
-    It also sorts the atoms by the z-coordinate
+    version = inp[0]
+    values = [float(v) for v in inp[1:]]
+    sqrt3 = math.sqrt(3.0)
+    t_type = T_DIAG
+
+    if version == "dr1":
+        r = values[0] / constants.BOHR_TO_ANGSTROM
+        dr = [r * r] + [r / sqrt3] * 3
+    elif version in ("dr3", "nd3"):
+        d = [v / constants.BOHR_TO_ANGSTROM for v in values[:3]]
+        dr = [sum(x * x for x in d), *d]
+        if version == "nd3":
+            t_type = T_NOND
+    elif version == "dmt":
+        lib = lib or get_cleed_lib()
+        lib.inp_debtemp.argtypes = [c_double, c_double, c_double]
+        lib.inp_debtemp.restype = c_double
+        r2 = lib.inp_debtemp(values[0], values[1], temperature)
+        dr = [r2] + [math.sqrt(r2) / sqrt3] * 3
+    else:
+        raise ValueError(f"Unknown vibrational displacement type {version}")
+
+    return t_type, dr
+
+
+class CleedInputs:
+    """The input of a LEED calculation as C structures.
+
+    The structures (and all arrays they point to) are kept alive by this
+    object, so it must not be released before C is done with them.
+    Positions are converted to Bohr, energies to Hartree, angles to radians.
     """
-    return [Atom() for i in inp]
-
-
-def generate_crystal_structure(inp: AtomParametersVariants) -> Crystal:
-    match inp:
-        case AtomParametersStructured(
-            phase_file, Position(x, y, z), vibrational_displacement
-        ):
-            pass
-        case AtomParametersStructured(
-            phase_file, PositionOptimizationParameters(), vibrational_displacement
-        ):
-            raise ValueError(
-                "Cleed needs a position for each atom, not an optimization range"
+
+    def __init__(self, inp: InputParameters, phase_path, lib=None):
+        self._keep = []
+        self._phase_types = {}
+        self._phase_list = []
+
+        def key(atom):
+            t_type, dr = convert_vibrational_displacement(
+                atom.vibrational_displacement, inp.sample_temperature, lib
+            )
+            path = str(pl.Path(phase_path) / f"{atom.phase_file}.phs")
+            k = (path, t_type, tuple(dr))
+            if k not in self._phase_types:
+                self._phase_types[k] = len(self._phase_list)
+                self._phase_list.append(k)
+            return self._phase_types[k]
+
+        bulk_atoms = [(atom, key(atom)) for atom in inp.bulk_layers]
+        over_atoms = [(atom, key(atom)) for atom in inp.overlayers]
+
+        for v in (inp.unit_cell.a1, inp.unit_cell.a2):
+            if v[2] != 0.0:
+                raise ValueError("a1 and a2 must be parallel to the surface")
+
+        vr, vi = inp.optical_potential
+        self.bulk = Crystal()
+        self.bulk.vr = -abs(vr) / constants.HART
+        self.bulk.vi = abs(vi) / constants.HART
+        self.bulk.temp = inp.sample_temperature
+        a1 = [x / constants.BOHR_TO_ANGSTROM for x in inp.unit_cell.a1]
+        a2 = [x / constants.BOHR_TO_ANGSTROM for x in inp.unit_cell.a2]
+        self.bulk.a = (0.0, a1[0], a2[0], a1[1], a2[1])
+        m1, m2 = inp.superstructure_matrix.m1, inp.superstructure_matrix.m2
+        self.bulk.m_super = (0.0, m1[0], m1[1], m2[0], m2[1])
+        self._set_atoms(self.bulk, bulk_atoms)
+
+        self.a3 = (c_double * 4)(
+            0.0, *[x / constants.BOHR_TO_ANGSTROM for x in inp.unit_cell.a3]
+        )
+
+        self.overlayers = Crystal()
+        self.overlayers.vr = self.bulk.vr
+        self._set_atoms(self.overlayers, over_atoms)
+
+        self.phase_shifts = (PhaseShifts * (len(self._phase_list) + 1))()
+        for i, (path, t_type, dr) in enumerate(self._phase_list):
+            self.phase_shifts[i].input_file = path.encode()
+            self.phase_shifts[i].t_type = t_type
+            self.phase_shifts[i].dr = dr
+        self.phase_shifts[len(self._phase_list)].lmax = I_END_OF_LIST
+
+        self.params = convert_energy_loop_variables(inp)
+        self.energies = convert_energy_range(inp)
+
+    def _set_atoms(self, crystal, atoms):
+        c_atoms = (Atom * max(len(atoms), 1))()
+        for i, (atom, type_index) in enumerate(atoms):
+            position = atom.position
+            c_atoms[i].type = type_index
+            c_atoms[i].pos = (
+                0.0,
+                position.x / constants.BOHR_TO_ANGSTROM,
+                position.y / constants.BOHR_TO_ANGSTROM,
+                position.z / constants.BOHR_TO_ANGSTROM,
             )
-        case _:
-            raise ValueError("Not implemented")
+        layer = Layer(natoms=len(atoms), atoms=c_atoms)
+        self._keep += [c_atoms, layer]
+        crystal.nlayers = 1
+        crystal.layers = pointer(layer)
+        crystal.natoms = len(atoms)
 
 
 def get_cleed_lib() -> CDLL:
@@ -262,16 +439,197 @@ def get_cleed_lib() -> CDLL:
     )
 
 
-def call_cleed(parameters_file, bulk_file, phase_path):
+def set_log_level(level="none", categories=None):
+    """Select the control output of the cleed library.
+
+    `level` is one of LOG_LEVEL ("none", the default of the library, writes
+    nothing); `categories` restricts the output to some of LOG_CATEGORY
+    (None: all). The selection applies to all later calculations.
+    """
+    mask = 0
+    for category in categories or LOG_CATEGORY:
+        mask |= LOG_CATEGORY[category]
+
     lib = get_cleed_lib()
+    lib.matlog_set.argtypes = [c_int, c_int]
+    lib.matlog_set.restype = None
+    lib.matlog_set(LOG_LEVEL[level], mask)
+
+
+def result_profile(result):
+    """Per-stage counters of a CleedResult as numpy arrays.
+
+    "time" [s] and "calls" have one row per energy and one column per stage
+    (PROFILE_STAGES); "bytes" is the size of the matrix elements requested
+    per energy, "bytes_new" the part of it that was not taken from the
+    memory pool, "mbg_iterations" the number of GMRES iterations spent on
+    the giant matrices (0 unless the GMRES solver is used). The arrays are
+    copies.
+    """
+    profile = [result.profile[i] for i in range(result.n_energies)]
+    n_stages = len(PROFILE_STAGES)
+    return {
+        "stages": PROFILE_STAGES,
+        "time": np.array([list(p.time) for p in profile]).reshape(-1, n_stages),
+        "calls": np.array([list(p.calls) for p in profile]).reshape(-1, n_stages),
+        "bytes": np.array([p.bytes for p in profile]),
+        "bytes_new": np.array([p.bytes_new for p in profile]),
+        "mbg_iterations": np.array([p.mbg_iterations for p in profile]),
+    }
+
 
-    lib.leed.argtypes = [c_char_p, c_char_p, c_char_p]
-    lib.leed.restype = CleedResult
+def call_cleed(parameters_file, bulk_file, phase_path, n_threads=1):
+    """Run the LEED calculation.
 
-    result = lib.leed(parameters_file.encode(), bulk_file.encode(), phase_path.encode())
+    The energy loop runs on `n_threads` threads; 0 (or a negative value) lets
+    the OpenMP runtime choose, e.g. from OMP_NUM_THREADS.
+
+    The arrays of the result are freed when the result is garbage collected
+    (or by `CleedResult.free`).
+    """
+    lib = get_cleed_lib()
+
+    lib.leed_threads.argtypes = [c_char_p, c_char_p, c_char_p, c_int]
+    lib.leed_threads.restype = CleedResult
+    lib.leed_result_free.argtypes = [POINTER(CleedResult)]
+    lib.leed_result_free.restype = None
+
+    result = lib.leed_threads(
+        parameters_file.encode(), bulk_file.encode(), phase_path.encode(), n_threads
+    )
+    # the finalizer must not refer to the result itself: free a copy
+    result._finalizer = weakref.finalize(
+        result, lib.leed_result_free, CleedResult.from_buffer_copy(result)
+    )
 
     return result
 
 
+class LeedSession:
+    """A LEED calculation that is set up once and evaluated many times.
+
+    The input (files, or the parameters for `from_config`) is read, and the
+    beam lists and coefficient tables are built, only when the session is
+    created. Afterwards only the positions
+    of the overlayer atoms can be changed with `set_positions` before the
+    IV curves are recomputed with `evaluate`.
+    """
+
+    def __init__(self, parameters_file, bulk_file, phase_path, n_threads=1):
+        self._bind(get_cleed_lib())
+
+        self.lib.leed_session_create.argtypes = [c_char_p, c_char_p, c_char_p, c_int]
+        self.lib.leed_session_create.restype = c_void_p
+
+        self.handle = self.lib.leed_session_create(
+            parameters_file.encode(), bulk_file.encode(), phase_path.encode(), n_threads
+        )
+        self.n_atoms = self.lib.leed_session_n_atoms(self.handle)
+
+    @classmethod
+    def from_config(cls, config: InputParameters, phase_path, n_threads=1):
+        """Create a session directly from the input parameters.
+
+        The structures are handed to C in memory; no input file is written.
+        `phase_path` is the directory with the phase shift files.
+        """
+        session = cls.__new__(cls)
+        session._bind(get_cleed_lib())
+
+        session.lib.leed_session_create_str.argtypes = [
+            POINTER(Crystal),
+            POINTER(c_double),
+            POINTER(Crystal),
+            POINTER(PhaseShifts),
+            POINTER(EnergyLoopVariables),
+            POINTER(EnergyRange),
+            c_int,
+        ]
+        session.lib.leed_session_create_str.restype = c_void_p
+
+        inputs = CleedInputs(config, phase_path, session.lib)
+        session.handle = session.lib.leed_session_create_str(
+            inputs.bulk,
+            inputs.a3,
+            inputs.overlayers,
+            inputs.phase_shifts,
+            inputs.params,
+            inputs.energies,
+            n_threads,
+        )
+        session.n_atoms = session.lib.leed_session_n_atoms(session.handle)
+        return session
+
+    def _bind(self, lib):
+        self.lib = lib
+        self.lib.leed_session_n_atoms.argtypes = [c_void_p]
+        self.lib.leed_session_n_atoms.restype = c_int
+        self.lib.leed_session_set_positions.argtypes = [
+            c_void_p,
+            POINTER(c_double),
+            c_int,
+        ]
+        self.lib.leed_session_set_positions.restype = c_int
+        self.lib.leed_session_evaluate.argtypes = [c_void_p]
+        self.lib.leed_session_evaluate.restype = CleedResult
+        self.lib.leed_session_free.argtypes = [c_void_p]
+        self.lib.leed_session_free.restype = None
+        self.lib.leed_session_set_bulk_cache.argtypes = [c_void_p, c_char_p]
+        self.lib.leed_session_set_bulk_cache.restype = c_int
+
+    def set_positions(self, positions):
+        """Set the overlayer atom positions.
+
+        `positions` is a sequence of (x, y, z) in Angstroms, one per overlayer
+        atom and in the same order as in the parameter file.
+        """
+        flat = [float(c) for position in positions for c in position]
+        if len(flat) != 3 * self.n_atoms:
+            raise ValueError(
+                f"Expected positions for {self.n_atoms} atoms, got {len(flat) // 3}"
+            )
+        if self.lib.leed_session_set_positions(
+            self.handle, (c_double * len(flat))(*flat), self.n_atoms
+        ) != 1:
+            raise RuntimeError("leed_session_set_positions failed")
+
+    def set_bulk_cache(self, filename):
+        """Keep the bulk reflection matrices in `filename`.
+
+        The bulk reflection matrices are always reused between evaluations
+        of a session. With a cache file they are also reused by later
+        sessions with the same bulk, energies and angles. The file is
+        updated whenever new matrices have been computed. `None` stops
+        writing the file. Returns the number of matrices read from the file.
+        """
+        name = None if filename is None else str(filename).encode()
+        return self.lib.leed_session_set_bulk_cache(self.handle, name)
+
+    def evaluate(self):
+        """Compute the IV curves for the current positions.
+
+        The arrays of the returned result are owned by the session and are
+        overwritten by the next call to `evaluate`.
+        """
+        result = self.lib.leed_session_evaluate(self.handle)
+        # keep the session (and its arrays) alive as long as the result
+        result._owner = self
+        return result
+
+    def close(self):
+        if getattr(self, "handle", None) is not None:
+            self.lib.leed_session_free(self.handle)
+            self.handle = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __del__(self):
+        self.close()
+
+
 if __name__ == "__main__":
     call_cleed()
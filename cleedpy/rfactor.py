@@ -1,17 +1,174 @@
+from dataclasses import dataclass
+
 import numpy as np
 from scipy.interpolate import CubicSpline
+from scipy.signal import fftconvolve
 
 from . import config
 
 GEO_PREFACTOR = (
     5.0  # To scale the geometrical rfactor to be comparable with the iv rfactor.
 )
+# Imaginary part of the inner potential [eV]: width of the Lorentzian smoothing
+# and of the Y-function.
+VI = 4.0
+# Relative tolerance of the steps of an equidistant energy grid.
+STEP_TOLERANCE = 1e-9
+# Range of the inner potential shift [eV], spacing of the shifts of its first
+# scan [eV] and number of refinements (each divides the spacing by 5).
+SHIFT_BOUNDS = (-10.0, 10.0)
+SHIFT_STEP = 1.0
+SHIFT_REFINEMENTS = 3
+
+
+@dataclass
+class BeamCurves:
+    """IV curves of several beams, one column per beam.
+
+    `energies` and `intensities` are (n_points, n_beams) arrays. The points of
+    every beam are sorted by energy; columns of beams with fewer points are
+    padded with NaN at the end. `beams` holds the two indices of every beam.
+    """
+
+    beams: np.ndarray
+    energies: np.ndarray
+    intensities: np.ndarray
+
+    @classmethod
+    def from_iv(cls, iv):
+        """Group the rows (index1, index2, ..., energy, intensity) of an IV
+        array by beam."""
+        iv = np.asarray(iv, dtype=float)
+        beams, inverse = np.unique(iv[:, :2], axis=0, return_inverse=True)
+        inverse = inverse.reshape(-1)
+        order = np.lexsort((iv[:, -2], inverse))
+        counts = np.bincount(inverse, minlength=len(beams))
+
+        column = inverse[order]
+        row = np.arange(len(order)) - (np.cumsum(counts) - counts)[column]
+        energies = np.full((counts.max(initial=0), len(beams)), np.nan)
+        intensities = np.full_like(energies, np.nan)
+        energies[row, column] = iv[order, -2]
+        intensities[row, column] = iv[order, -1]
+        return cls(beams, energies, intensities)
+
+    @property
+    def valid(self):
+        return ~np.isnan(self.energies)
+
+    def take(self, columns):
+        """The curves of the beams in `columns`."""
+        return BeamCurves(
+            self.beams[columns], self.energies[:, columns], self.intensities[:, columns]
+        )
+
+    def smoothed(self, vi=VI):
+        """The curves after Lorentzian smoothing (see smooth_curves)."""
+        intensities = smooth_curves(self.energies, self.intensities, vi)
+        return BeamCurves(self.beams, self.energies, intensities)
 
 
-def lorentzian_smoothing(curve, vi=4.0):
+class CurveSpline:
+    """Cubic splines through the columns of BeamCurves.
+
+    If all beams have the same energies, one spline is built for all of them
+    and evaluated without a loop over the beams.
+    """
+
+    def __init__(self, curves: BeamCurves):
+        energies, intensities = curves.energies, curves.intensities
+        valid = curves.valid
+        n_points = valid.sum(axis=0)
+        self.lower = np.nanmin(energies, axis=0)
+        self.upper = np.nanmax(energies, axis=0)
+
+        self._spline = None
+        self._splines = None
+        if valid.all() and len(energies) >= 2 and np.all(energies == energies[:, :1]):
+            self._spline = CubicSpline(energies[:, 0], intensities, axis=0)
+        else:
+            self._splines = [
+                CubicSpline(energies[:n, i], intensities[:n, i]) if n >= 2 else None
+                for i, n in enumerate(n_points)
+            ]
+
+    def __call__(self, x):
+        """Column i of the (n, n_beams, ...) array `x` evaluated with the
+        spline of beam i. NaN in `x` gives NaN."""
+        if self._spline is None:
+            values = np.full(x.shape, np.nan)
+            for i, spline in enumerate(self._splines):
+                if spline is not None:
+                    values[:, i] = spline(x[:, i])
+            return values
+
+        knots = self._spline.x
+        interval = np.searchsorted(knots, x, side="right") - 1
+        np.clip(interval, 0, len(knots) - 2, out=interval)
+        t = x - knots[interval]
+
+        # coefficients of the interval and beam of every point
+        n_beams = x.shape[1]
+        index = interval * n_beams + np.arange(n_beams).reshape(
+            -1, *(1,) * (x.ndim - 2)
+        )
+        c = self._spline.c.reshape(4, -1)
+        values = np.take(c[0], index)
+        for k in range(1, 4):
+            values *= t
+            values += np.take(c[k], index)
+        return values
+
+
+def _common_step(energies):
+    """Energy step if every column of `energies` is equidistant with the
+    same step, None otherwise."""
+    steps = np.diff(energies, axis=0)
+    steps = steps[~np.isnan(steps)]
+    if steps.size == 0:
+        return 1.0
+    step = steps[0]
+    if step > 0 and np.all(np.abs(steps - step) <= STEP_TOLERANCE * step):
+        return step
+    return None
+
+
+def smooth_curves(energies, intensities, vi=VI):
+    """Lorentzian smoothing of the columns of (n_points, n_beams) arrays (NaN
+    marks missing points, see BeamCurves).
+
+    Every smoothed intensity is the average of the intensities of its column
+    weighted with vi^2 / ((E' - E)^2 + vi^2). If all columns are equidistant
+    with the same step, the weighted sums are convolutions with one kernel and
+    are computed by FFT for all beams at once; otherwise the weights of all
+    pairs of points are computed.
+    """
+    valid = ~np.isnan(energies)
+    values = np.where(valid, intensities, 0.0)
+    weights = valid.astype(float)
+
+    n = len(energies)
+    step = _common_step(energies)
+    if step is not None:
+        distance = np.arange(1 - n, n) * step
+        kernel = (vi**2 / (distance**2 + vi**2))[:, None]
+        window = slice(n - 1, 2 * n - 1)
+        numerator = fftconvolve(values, kernel, axes=0)[window]
+        denominator = fftconvolve(weights, kernel, axes=0)[window]
+    else:
+        e = np.where(valid, energies, 0.0)
+        kernel = vi**2 / ((e[:, None] - e[None, :]) ** 2 + vi**2)
+        numerator = np.einsum("ijb,jb->ib", kernel, values)
+        denominator = np.einsum("ijb,jb->ib", kernel, weights)
+
+    with np.errstate(divide="ignore", invalid="ignore"):
+        return np.where(valid, numerator / denominator, np.nan)
+
+
+def lorentzian_smoothing(curve, vi=VI):
     """
     Draws a Lorentzian curve in the same grid as the given curve.
-    Performs the convolution of the two curves.
+    Performs the convolution of the two curves (see smooth_curves).
     The given curve is represented by an array of (e,i) points, where e = energy and i = intensity.
 
     Inputs:
@@ -22,21 +179,11 @@ def lorentzian_smoothing(curve, vi=4.0):
         The result of the convolution: a new array of [e,i] arrays
     """
 
+    curve = np.asarray(curve, dtype=float)
     energies = curve[:, 0]
-    intensities = curve[:, 1]
-    result = []
+    result = smooth_curves(energies[:, None], curve[:, 1:2], vi)[:, 0]
 
-    for j in range(energies.size):
-        c = 0
-        l_value = 0
-        for i in range(energies.size):
-            c += vi**2 / ((energies[i] - energies[j]) ** 2 + vi**2)
-            l_value += (
-                intensities[i] * vi**2 / ((energies[i] - energies[j]) ** 2 + vi**2)
-            )
-        result.append(l_value / c)
-
-    return np.array(list(zip(energies, result)))
+    return np.column_stack([energies, result])
 
 
 def r2_factor(experimental_curve, theoretical_curve):
@@ -130,8 +277,7 @@ def y_function(intensities, energy_step):
             L = (I[i] - I[i-1]) / (energy_step * 0.5 * (I[i] + I[i-1]))
     """
 
-    # [TODO] constants should be defined elsewhere
-    vi = 4
+    vi = VI
 
     y_values = (intensities[1:] - intensities[:-1]) / (
         energy_step * 0.5 * (intensities[1:] + intensities[:-1])
@@ -153,21 +299,6 @@ def energy_step(energies):
     return energies[1:] - energies[:-1]
 
 
-def split_in_pairs(exp_iv, theo_iv):
-    """This function takes a complete datasets with a experimental and theoretical iv curves splits them them in pairs corresponding to the same index."""
-
-    beam_indices = np.unique(np.vstack([exp_iv, theo_iv])[:, [0, 1]], axis=0)
-
-    for indx1, indx2 in beam_indices:
-        exp_curve = exp_iv[(exp_iv[:, 0] == indx1) & (exp_iv[:, 1] == indx2)][
-            :, [-2, -1]
-        ]
-        theo_curve = theo_iv[(theo_iv[:, 0] == indx1) & (theo_iv[:, 1] == indx2)][
-            :, [-2, -1]
-        ]
-        yield exp_curve, theo_curve
-
-
 def find_common_x_axis(reference_grid, other_grid):
     min_x = max(np.min(reference_grid), np.min(other_grid))
     max_x = min(np.max(reference_grid), np.max(other_grid))
@@ -178,55 +309,204 @@ def find_common_x_axis(reference_grid, other_grid):
     return reference_grid
 
 
-def compute_rfactor(experimental_iv, theoretical_iv, shift=0.0, rfactor_type="r2"):
+def matching_beams(experimental: BeamCurves, theoretical: BeamCurves):
+    """Columns of the experimental and of the theoretical curves of the beams
+    present in both."""
+    columns = {tuple(beam): i for i, beam in enumerate(theoretical.beams)}
+    pairs = [
+        (i, columns[tuple(beam)])
+        for i, beam in enumerate(experimental.beams)
+        if tuple(beam) in columns
+    ]
+    i_exp, i_theo = np.array(pairs, dtype=int).reshape(-1, 2).T
+    return i_exp, i_theo
 
-    r_tot = 0.0
-    rfactor = {
-        "r2": r2_factor,
-        "pendry": rp_factor,
-    }
 
-    delta_e = []  # To store the energy range of each curve.
+def _r2_beams(energies, ie, it):
+    """R2-factor (see r2_factor) of every column; NaN energies are skipped."""
+    valid = ~np.isnan(energies)
+    ie = np.where(valid, ie, 0.0)
+    it = np.where(valid, it, 0.0)
 
-    # Looping over the pairs of experimental and theoretical curves corresponding to the same index.
-    for exp_curve, theo_curve in split_in_pairs(experimental_iv, theoretical_iv):
-        if len(exp_curve) < 1 or len(theo_curve) < 1:
-            continue
+    c = np.sqrt(np.sum(it**2, axis=0) / np.sum(ie**2, axis=0))
+    it_avg = np.sum(it, axis=0) / np.sum(valid, axis=0)
+    numerator = np.sum(np.where(valid, (it - c * ie) ** 2, 0.0), axis=0)
+    denominator = np.sum(np.where(valid, (it - it_avg) ** 2, 0.0), axis=0)
+    return np.sqrt(numerator / denominator)
 
-        # Perform Lorentzian smoothing.
-        exp_curve = lorentzian_smoothing(exp_curve)
-        theo_curve = lorentzian_smoothing(theo_curve)
 
-        # Shifting the theoretical curve.
-        theo_curve[:, 0] += shift
+def _rp_beams(energies, ye, it):
+    """Pendry R-factor (see rp_factor) of every column; NaN energies are
+    skipped. `ye` is the experimental Y-function between consecutive
+    energies."""
+    step = energy_step(energies)
+    pairs = ~np.isnan(step)
+    ye = np.where(pairs, ye, 0.0)
+    yt = np.where(pairs, y_function(it, step), 0.0)
+    step = np.where(pairs, step, 0.0)
 
-        # Finding common x axis.
-        common_x = find_common_x_axis(exp_curve[:, 0], theo_curve[:, 0])
+    numerator = np.sum((yt - ye) ** 2 * step, axis=0)
+    denominator = np.sum(ye**2 * step, axis=0) + np.sum(yt**2 * step, axis=0)
+    return numerator / denominator
 
-        # If no common points - skip the curve.
-        if len(common_x) == 0:
-            continue
 
-        exp_spline = CubicSpline(x=exp_curve[:, 0], y=exp_curve[:, 1])(common_x)
-        theo_spline = CubicSpline(x=theo_curve[:, 0], y=theo_curve[:, 1])(common_x)
+def beam_rfactors(experimental, theoretical_spline, shift=0.0, rfactor_type="r2"):
+    """R-factor of every beam and the energy range it is computed on.
 
-        # Uncomment for testing.
-        # import matplotlib.pyplot as plt  # noqa: E800
-        # plt.plot(theo_curve[:,0], theo_curve[:,1], 'o', label='Data Points')  # noqa: E800
-        # plt.plot(common_x, theo_spline, label='Cubic Spline')  # noqa: E800
-        # #plt.plot(exp_curve_before_smooth[:,0], exp_curve_before_smooth[:,1], label='Before smooth')  # noqa: E800
-        # plt.legend()  # noqa: E800
-        # plt.show()  # noqa: E800
+    `experimental` is an ExperimentalDataset and `theoretical_spline` the
+    CurveSpline of the smoothed theoretical curves of the same beams; the
+    theoretical energies are shifted by `shift`. A beam is compared on the
+    experimental energies within the range of both curves; beams with less
+    than two of them get the energy range 0.
 
-        r = rfactor[rfactor_type](
-            np.column_stack([common_x, exp_spline]),
-            np.column_stack([common_x, theo_spline]),
+    For an array of shifts, all of them are evaluated at once and the results
+    have an additional last axis, one entry per shift.
+    """
+    shift = np.asarray(shift, dtype=float)
+    extra = (1,) * shift.ndim
+    n_beams = len(experimental.curves.beams)
+
+    energies = experimental.curves.energies.reshape(-1, n_beams, *extra)
+    lower = theoretical_spline.lower.reshape(n_beams, *extra)
+    upper = theoretical_spline.upper.reshape(n_beams, *extra)
+    common = (
+        ~np.isnan(energies) & (energies >= lower + shift) & (energies <= upper + shift)
+    )
+    x = np.where(common, energies, np.nan)
+    it = theoretical_spline(x - shift)
+
+    with np.errstate(divide="ignore", invalid="ignore"):
+        if rfactor_type == "pendry":
+            r = _rp_beams(x, experimental.y.reshape(-1, n_beams, *extra), it)
+        elif rfactor_type == "r2":
+            ie = experimental.curves.intensities.reshape(-1, n_beams, *extra)
+            r = _r2_beams(x, ie, it)
+        else:
+            raise ValueError(f"Unknown R-factor type {rfactor_type}")
+
+    delta_e = np.max(np.where(common, energies, -np.inf), axis=0) - np.min(
+        np.where(common, energies, np.inf), axis=0
+    )
+    delta_e = np.where(np.sum(common, axis=0) >= 2, delta_e, 0.0)
+    return r, delta_e
+
+
+def total_rfactor(experimental, theoretical_spline, shift=0.0, rfactor_type="r2"):
+    """Average of the beam R-factors (see beam_rfactors) weighted with their
+    energy ranges.
+
+    For an array of shifts, the array of the R-factors (NaN where the curves
+    do not overlap).
+    """
+    r, delta_e = beam_rfactors(experimental, theoretical_spline, shift, rfactor_type)
+    used = delta_e > 0
+    total_e = np.sum(np.where(used, delta_e, 0.0), axis=0)
+    with np.errstate(divide="ignore", invalid="ignore"):
+        total = np.sum(np.where(used, r * delta_e, 0.0), axis=0) / total_e
+
+    if np.ndim(shift) > 0:
+        return np.where(total_e > 0, total, np.nan)
+    if total_e == 0:
+        raise ValueError("The experimental and theoretical curves have no overlap")
+    return float(total)
+
+
+def scan_shift(
+    experimental,
+    theoretical_spline,
+    bounds=SHIFT_BOUNDS,
+    rfactor_type="pendry",
+    step=SHIFT_STEP,
+    n_refinements=SHIFT_REFINEMENTS,
+):
+    """Shift of the theoretical energies within `bounds` with the lowest
+    R-factor, and that R-factor.
+
+    The R-factor is evaluated for shifts `step` apart, all at once (see
+    total_rfactor). Then, `n_refinements` times, the interval between the
+    neighbours of the best shift is scanned again with 11 shifts. The curves
+    are smoothed and splined only once, by the caller
+    (ExperimentalDataset.prepare).
+    """
+    lower, upper = bounds
+    best_shift, best_r = None, np.inf
+    shifts = np.linspace(lower, upper, max(round((upper - lower) / step), 1) + 1)
+    for _ in range(n_refinements + 1):
+        r = total_rfactor(experimental, theoretical_spline, shifts, rfactor_type)
+        if np.all(np.isnan(r)):
+            break
+        i = np.nanargmin(r)
+        if r[i] < best_r:
+            best_shift, best_r = shifts[i], r[i]
+        spacing = shifts[1] - shifts[0]
+        shifts = np.linspace(
+            max(best_shift - spacing, lower), min(best_shift + spacing, upper), 11
+        )
+
+    if best_shift is None:
+        raise ValueError("The experimental and theoretical curves have no overlap")
+    return float(best_shift), float(best_r)
+
+
+@dataclass
+class ExperimentalDataset:
+    """Experimental IV curves prepared for repeated R-factor evaluations.
+
+    The curves are grouped by beam and smoothed once; `y` holds the
+    Y-function of the smoothed curves between consecutive energies. The
+    theoretical curves are interpolated at the experimental energies, so no
+    experimental splines are needed.
+    """
+
+    curves: BeamCurves
+    y: np.ndarray
+    vi: float = VI
+
+    @classmethod
+    def from_iv(cls, experimental_iv, vi=VI):
+        """Dataset of the rows (index1, index2, ..., energy, intensity) of an
+        IV array."""
+        curves = BeamCurves.from_iv(experimental_iv).smoothed(vi)
+        y = y_function(curves.intensities, energy_step(curves.energies))
+        return cls(curves, y, vi)
+
+    def take(self, columns):
+        """The dataset of the beams in `columns`."""
+        return ExperimentalDataset(
+            self.curves.take(columns), self.y[:, columns], self.vi
         )
 
-        delta_e.append(common_x[-1] - common_x[0])
-        r_tot += r * (common_x[-1] - common_x[0])
+    def prepare(self, theoretical):
+        """Match the theoretical curves (BeamCurves or IV array) with the
+        experimental ones.
+
+        Returns the dataset of the beams present in both and the CurveSpline
+        of the smoothed theoretical curves of the same beams, as needed by
+        beam_rfactors and total_rfactor.
+        """
+        if not isinstance(theoretical, BeamCurves):
+            theoretical = BeamCurves.from_iv(theoretical)
+        i_exp, i_theo = matching_beams(self.curves, theoretical)
+        spline = CurveSpline(theoretical.take(i_theo).smoothed(self.vi))
+        return self.take(i_exp), spline
 
-    return r_tot / sum(delta_e)
+    def rfactor(self, theoretical, shift=0.0, rfactor_type="r2"):
+        """R-factor of the theoretical curves (see compute_rfactor)."""
+        return total_rfactor(*self.prepare(theoretical), shift, rfactor_type)
+
+
+def compute_rfactor(experimental_iv, theoretical_iv, shift=0.0, rfactor_type="r2"):
+    """R-factor of the beams present in both IV arrays (rows: index1, index2,
+    ..., energy, intensity).
+
+    Both sets of curves are smoothed, the theoretical energies shifted by
+    `shift` and the theoretical curves interpolated at the experimental
+    energies; all beams are processed at once (see total_rfactor). For
+    repeated evaluations with the same experimental curves, build an
+    ExperimentalDataset once instead.
+    """
+    experimental = ExperimentalDataset.from_iv(experimental_iv)
+    return experimental.rfactor(theoretical_iv, shift, rfactor_type)
 
 
 def compute_geometrical_rfactor(config: config.InputParameters):
@@ -2,26 +2,37 @@ import numpy as np
 from scipy import optimize
 
 from . import config, physics, rfactor
-from .interface.cleed import call_cleed
+from .interface.cleed import LeedSession
 
 
 def cleed_result_to_iv(result) -> np.ndarray:
-    """Convert CLEED result to IV array."""
-    iv = []
-    n_beams = result.n_beams
-    n_energies = result.n_energies
-    for i in range(n_energies):
-        for j in range(n_beams):
-            iv.append(
-                [
-                    result.beam_index1[j],
-                    result.beam_index2[j],
-                    0,
-                    result.energies[i] * physics.constants.HART,
-                    result.iv_curves[i * n_beams + j],
-                ]
-            )
-    return np.array(iv)
+    """Convert CLEED result to IV array.
+
+    One row (index1, index2, 0, energy [eV], intensity) per energy and
+    beam, energies varying slowest.
+    """
+    arrays = result.arrays()
+    n_energies, n_beams = arrays.iv_curves.shape
+    iv = np.empty((n_energies * n_beams, 5))
+    iv[:, 0] = np.tile(arrays.beam_index1, n_energies)
+    iv[:, 1] = np.tile(arrays.beam_index2, n_energies)
+    iv[:, 2] = 0
+    iv[:, 3] = np.repeat(arrays.energies * physics.constants.HART, n_beams)
+    iv[:, 4] = arrays.iv_curves.ravel()
+    return iv
+
+
+def cleed_result_to_curves(result) -> rfactor.BeamCurves:
+    """Convert CLEED result to IV curves, one column per beam (energies in
+    eV). The intensities are copied."""
+    arrays = result.arrays()
+    n_energies, n_beams = arrays.iv_curves.shape
+    energies = arrays.energies * physics.constants.HART
+    return rfactor.BeamCurves(
+        beams=np.column_stack([arrays.beam_index1, arrays.beam_index2]),
+        energies=np.repeat(energies[:, None], n_beams, axis=1),
+        intensities=np.array(arrays.iv_curves),
+    )
 
 
 class CleedSearchCoordinator:
@@ -31,12 +42,19 @@ class CleedSearchCoordinator:
         phase_path: str,
         experimental_iv_file: str,
         optimization_history_file: str = "optimization_history.log",
+        n_threads: int = 1,
+        bulk_cache_file: str | None = None,
     ) -> None:
         self.config = config
         self.phase_path = phase_path
+        self.n_threads = n_threads
+        self.bulk_cache_file = bulk_cache_file
         self.iteration = 0
         self.current_rfactor = 0.0
         self.experimental_iv = np.loadtxt(experimental_iv_file)
+        # Grouped and smoothed once for all R-factor evaluations.
+        self.experimental = rfactor.ExperimentalDataset.from_iv(self.experimental_iv)
+        self.theoretical = None
         self.optimization_history_file = optimization_history_file
         self.x = []
         self.correspondence = []
@@ -44,6 +62,7 @@ class CleedSearchCoordinator:
         self.optimal_shift = 0.0
         self.largest_rfactor = 1.0
         self.result = None
+        self.session = None
 
     def start_optimization(self, method: str = "Nelder-Mead") -> None:
         """Start the optimization process."""
@@ -99,6 +118,27 @@ class CleedSearchCoordinator:
                     obj = getattr(obj, p)
             setattr(obj, path[-1], value)
 
+    def get_session(self) -> LeedSession:
+        """Return the LEED session with the current overlayer positions.
+
+        The session is created from the configuration on the first call;
+        afterwards only the atom positions of the session are updated.
+        """
+        if self.session is None:
+            self.session = LeedSession.from_config(
+                self.config, self.phase_path, n_threads=self.n_threads
+            )
+            if self.bulk_cache_file is not None:
+                self.session.set_bulk_cache(self.bulk_cache_file)
+        else:
+            self.session.set_positions(
+                [
+                    (atom.position.x, atom.position.y, atom.position.z)
+                    for atom in self.config.overlayers
+                ]
+            )
+        return self.session
+
     def function_to_minimize(self, x: np.typing.ArrayLike) -> float:
         self.iteration += 1
 
@@ -112,44 +152,22 @@ class CleedSearchCoordinator:
         if geometrical_r > 1.0:
             return geometrical_r + self.largest_rfactor
 
-        # Write the current parameters to a temporary file.
-        old_format = config.OLD_FORMAT_TEMPLATE.render(**self.config.model_dump())
-        with open("current_parameters.inp", "w") as fobj:
-            fobj.write(old_format)
-
         # Call CLEED with the current parameters.
-        result = call_cleed(
-            "current_parameters.inp", "current_parameters.inp", self.phase_path
-        )
+        result = self.get_session().evaluate()
 
-        self.theoretical_iv = cleed_result_to_iv(result)
+        # Smooth and spline the theoretical curves once for all shifts.
+        self.theoretical = self.experimental.prepare(cleed_result_to_curves(result))
 
         # Optimize the shift if requested.
         if self.optimize_shift:
-            shift_opt_result = optimize.minimize_scalar(
-                self.function_to_minimize_shift,
-                bounds=(-10.0, 10.0),
-                method="bounded",
+            self.optimal_shift, _ = rfactor.scan_shift(
+                *self.theoretical, rfactor_type="pendry"
             )
-            self.optimal_shift = shift_opt_result.x
 
-        iv_r = rfactor.compute_rfactor(
-            theoretical_iv=self.theoretical_iv,
-            experimental_iv=self.experimental_iv,
-            shift=self.optimal_shift,
-            rfactor_type="pendry",
+        iv_r = rfactor.total_rfactor(
+            *self.theoretical, shift=self.optimal_shift, rfactor_type="pendry"
         )
 
         self.current_rfactor = iv_r + geometrical_r
 
         return self.current_rfactor
-
-    def function_to_minimize_shift(self, shift: float) -> float:
-        """Function to minimize the shift between theoretical and experimental IV curves."""
-        r = rfactor.compute_rfactor(
-            theoretical_iv=self.theoretical_iv,
-            experimental_iv=self.experimental_iv,
-            shift=shift,
-            rfactor_type="pendry",
-        )
-        return r
@@ -0,0 +1,53 @@
+from pathlib import Path
+
+from cleedpy import benchmark
+from cleedpy.config import InputParameters
+from cleedpy.interface.cleed import PROFILE_STAGES
+
+PHASE_PATH = Path(__file__).resolve().parent / "../examples/data/PHASE"
+
+
+def test_benchmark_cases():
+    cases = benchmark.benchmark_cases(None, "examples")
+    assert len(cases) == len(benchmark.EXAMPLES) + sum(
+        len(values) for values in benchmark.SWEEPS.values()
+    )
+
+    for case in cases:
+        if case.config is not None:
+            InputParameters.model_validate(case.config)
+
+    config = benchmark.synthetic_config(superstructure=3)
+    assert config["superstructure_matrix"]["m1"] == [3, 0.0]
+    assert len(config["overlayers"]) == 1 + 2 * 9
+
+    config = benchmark.synthetic_config(composite_atoms=20)
+    z = sorted(atom["position"][2] for atom in config["overlayers"])
+    assert len(z) == 20
+    # Consecutive planes are closer than the layer separation (1 A).
+    assert all(b - a < 1.0 for a, b in zip(z, z[1:]))
+
+
+def test_run_benchmark(tmp_path):
+    case = benchmark.BenchmarkCase(
+        name="small",
+        sweep="l_max",
+        value=6,
+        config=benchmark.synthetic_config(l_max=6, energy_final=90.0),
+    )
+    output_file = tmp_path / "benchmark.json"
+    report = benchmark.run_benchmark(
+        [case], PHASE_PATH, output_file=output_file, log=None
+    )
+
+    assert benchmark.load_report(output_file) == report
+    (entry,) = report["cases"]
+    assert entry["name"] == "small"
+    assert entry["wall_time"] > 0.0
+    assert entry["peak_memory"] > 0
+    assert entry["matrix_bytes"] > 0
+    assert list(entry["stage_time"]) == list(PROFILE_STAGES)
+    assert entry["stage_calls"]["update"] == entry["n_energies"]
+
+    (ratio,) = benchmark.compare_reports(report, report)
+    assert ratio["wall_time"] == 1.0
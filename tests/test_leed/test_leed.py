@@ -1,10 +1,26 @@
+import ctypes
+import gc
+import os
 from pathlib import Path
 
 import numpy as np
 import pytest
 
-from cleedpy.interface.cleed import call_cleed
+from cleedpy.cli.leed import print_cleed_results
+from cleedpy.config import OLD_FORMAT_TEMPLATE, load_parameters
+from cleedpy.interface.cleed import (
+    GIANT_MATRIX_SOLVER,
+    GMRES_MAX_ITERATIONS,
+    LATTICE_SUM,
+    PROFILE_STAGES,
+    LeedSession,
+    call_cleed,
+    result_profile,
+    set_log_level,
+)
 from cleedpy.physics.constants import HART
+from cleedpy.rfactor import ExperimentalDataset, compute_rfactor
+from cleedpy.search import cleed_result_to_curves, cleed_result_to_iv
 
 
 @pytest.mark.parametrize(
@@ -14,13 +30,16 @@ from cleedpy.physics.constants import HART
         "../../examples/ni111_2x2O_leed/",
     ],
 )
-def test_leed(folder):
+@pytest.mark.parametrize("n_threads", [1, 2])
+def test_leed(folder, n_threads):
     # Script directory with pathlib
 
     script_dir = Path(__file__).resolve().parent
     parameter_file = script_dir / folder / "leed.inp"
     phase_shift = script_dir / "../../examples/data/PHASE"
-    result = call_cleed(str(parameter_file), str(parameter_file), str(phase_shift))
+    result = call_cleed(
+        str(parameter_file), str(parameter_file), str(phase_shift), n_threads=n_threads
+    )
 
     # Read beams.txt file using numpy. The file contains 3 colums: 1st beam index (float), 2nd beam index (float), and beam set (int)
     beams = np.loadtxt(script_dir / folder / "beams.txt", dtype=float)
@@ -57,3 +76,327 @@ def test_leed(folder):
             iv_curves[i],
             [result.iv_curves[i * result.n_beams + j] for j in range(result.n_beams)],
         )
+
+
+def iv_array(result):
+    return np.array(
+        [result.iv_curves[i] for i in range(result.n_energies * result.n_beams)]
+    )
+
+
+def test_leed_session(tmp_path):
+    script_dir = Path(__file__).resolve().parent
+    parameter_file = script_dir / "../../examples/ni111_cu_leed/leed.inp"
+    phase_shift = str(script_dir / "../../examples/data/PHASE")
+
+    # Same geometry as the parameter file, but with the Cu atom moved down.
+    moved_file = tmp_path / "leed.inp"
+    moved_file.write_text(parameter_file.read_text().replace("6.0900", "5.8000"))
+
+    with LeedSession(str(parameter_file), str(parameter_file), phase_shift) as session:
+        assert session.n_atoms == 3
+        reference = call_cleed(str(parameter_file), str(parameter_file), phase_shift)
+        assert np.allclose(iv_array(session.evaluate()), iv_array(reference))
+
+        session.set_positions(
+            [(0.0, 0.0, 5.8), (1.245, -0.7188, 4.06), (1.245, 0.7188, 2.03)]
+        )
+        reference = call_cleed(str(moved_file), str(moved_file), phase_shift)
+        assert np.allclose(iv_array(session.evaluate()), iv_array(reference))
+
+        with pytest.raises(ValueError):
+            session.set_positions([(0.0, 0.0, 5.8)])
+
+
+def overlayer_positions(text):
+    return [
+        tuple(float(c) for c in line.split()[2:5])
+        for line in text.splitlines()
+        if line.startswith("po:")
+    ]
+
+
+def test_leed_session_lower_layer(tmp_path):
+    script_dir = Path(__file__).resolve().parent
+    parameter_file = script_dir / "../../examples/ni111_2x2O_leed/leed.inp"
+    phase_shift = str(script_dir / "../../examples/data/PHASE")
+
+    # Three overlayer layers; one atom of the lowest (Ni) layer is moved down.
+    original_file = tmp_path / "leed.inp"
+    original_file.write_text(
+        parameter_file.read_text().replace("ef: 300.1", "ef: 110.")
+    )
+    lines = original_file.read_text().splitlines()
+    lines[25] = lines[25].replace("2.0000", "1.9000")
+    moved_file = tmp_path / "leed_moved.inp"
+    moved_file.write_text("\n".join(lines) + "\n")
+
+    with LeedSession(str(original_file), str(original_file), phase_shift) as session:
+        for step, path in enumerate([original_file, moved_file, original_file]):
+            session.set_positions(overlayer_positions(path.read_text()))
+            result = session.evaluate()
+            reference = call_cleed(str(path), str(path), phase_shift)
+            assert np.allclose(iv_array(result), iv_array(reference))
+
+            profile = result_profile(result)
+            calls = dict(zip(PROFILE_STAGES, profile["calls"].sum(axis=0)))
+            if step > 0:
+                # The bulk is kept, but no partial stack above it is valid.
+                assert calls["bulk_doubling"] == 0
+                assert calls["layer_doubling"] == 3 * result.n_energies
+            if step == 2:
+                # The original lowest layer is found again in the layer cache.
+                assert calls["giant_matrix"] == 0
+                assert calls["tmatrix"] == 0
+
+
+def test_leed_session_from_config(tmp_path):
+    script_dir = Path(__file__).resolve().parent
+    config = load_parameters(script_dir / "../../examples/ni111_cu_search/input.yml")
+    phase_shift = str(script_dir / "../../examples/data/PHASE")
+
+    parameter_file = tmp_path / "leed.inp"
+    parameter_file.write_text(OLD_FORMAT_TEMPLATE.render(**config.model_dump()))
+    reference = call_cleed(str(parameter_file), str(parameter_file), phase_shift)
+
+    with LeedSession.from_config(config, phase_shift) as session:
+        assert session.n_atoms == len(config.overlayers)
+        result = session.evaluate()
+        assert result.n_beams == reference.n_beams
+        assert result.n_energies == reference.n_energies
+        assert np.allclose(iv_array(result), iv_array(reference))
+
+
+def test_leed_session_bulk_cache(tmp_path):
+    script_dir = Path(__file__).resolve().parent
+    parameter_file = str(script_dir / "../../examples/ni111_cu_leed/leed.inp")
+    phase_shift = str(script_dir / "../../examples/data/PHASE")
+    cache_file = tmp_path / "bulk.cache"
+    reference = iv_array(call_cleed(parameter_file, parameter_file, phase_shift))
+
+    with LeedSession(parameter_file, parameter_file, phase_shift) as session:
+        assert session.set_bulk_cache(cache_file) == 0
+        assert np.allclose(iv_array(session.evaluate()), reference)
+        # Second evaluation uses the bulk matrices kept in memory.
+        assert np.allclose(iv_array(session.evaluate()), reference)
+    assert cache_file.exists()
+
+    with LeedSession(parameter_file, parameter_file, phase_shift) as session:
+        n_energies = session.evaluate().n_energies
+    with LeedSession(parameter_file, parameter_file, phase_shift) as session:
+        assert session.set_bulk_cache(cache_file) == n_energies
+        assert np.allclose(iv_array(session.evaluate()), reference)
+
+
+def test_leed_session_bulk_cache_method(tmp_path):
+    script_dir = Path(__file__).resolve().parent
+    parameter_file = script_dir / "../../examples/ni111_cu_leed/leed.inp"
+    phase_shift = str(script_dir / "../../examples/data/PHASE")
+    text = parameter_file.read_text().replace("ef: 498.1", "ef: 150.")
+
+    # A cache written with one lattice sum method or giant matrix solver is
+    # not used with another one.
+    methods = {
+        "ewald": f"ls: {LATTICE_SUM['ewald']}\n",
+        "real": f"ls: {LATTICE_SUM['real']}\n",
+        "gmres": f"gs: {GIANT_MATRIX_SOLVER['gmres']}\ngt: 1.e-4\n",
+    }
+    files = {}
+    for method, lines in methods.items():
+        files[method] = tmp_path / f"leed_{method}.inp"
+        files[method].write_text(text + lines)
+    for written, used in (("ewald", "real"), ("real", "ewald"), ("real", "gmres")):
+        cache_file = tmp_path / f"bulk_{written}_{used}.cache"
+        with LeedSession(str(files[written]), str(files[written]), phase_shift) as s:
+            s.set_bulk_cache(cache_file)
+            n_energies = s.evaluate().n_energies
+        with LeedSession(str(files[written]), str(files[written]), phase_shift) as s:
+            assert s.set_bulk_cache(cache_file) == n_energies
+
+        reference = call_cleed(str(files[used]), str(files[used]), phase_shift)
+        with LeedSession(str(files[used]), str(files[used]), phase_shift) as s:
+            assert s.set_bulk_cache(cache_file) == 0
+            assert np.array_equal(iv_array(s.evaluate()), iv_array(reference))
+
+
+def test_leed_lattice_sum_ewald(tmp_path):
+    script_dir = Path(__file__).resolve().parent
+    parameter_file = script_dir / "../../examples/ni111_cu_leed/leed.inp"
+    phase_shift = str(script_dir / "../../examples/data/PHASE")
+
+    # With a converged real space summation, both methods agree.
+    text = parameter_file.read_text().replace("ep: 1.e-2", "ep: 1.e-7")
+    results = []
+    for method in ("real", "ewald"):
+        method_file = tmp_path / f"leed_{method}.inp"
+        method_file.write_text(text + f"ls: {LATTICE_SUM[method]}\n")
+        results.append(
+            iv_array(call_cleed(str(method_file), str(method_file), phase_shift))
+        )
+    assert np.allclose(results[0], results[1], rtol=1e-5)
+
+
+def test_leed_giant_matrix_gmres(tmp_path):
+    script_dir = Path(__file__).resolve().parent
+    parameter_file = script_dir / "../../examples/ni111_2x2O_leed/leed.inp"
+    phase_shift = str(script_dir / "../../examples/data/PHASE")
+
+    # Buckle the Ni plane below the O atom, so that the composite layer
+    # consists of several atomic planes.
+    lines = parameter_file.read_text().splitlines()
+    lines[18] = lines[18].replace("4.1000", "3.9000")
+    lines[19] = lines[19].replace("4.1000", "4.3000")
+    text = "\n".join(lines).replace("ef: 300.1", "ef: 110.") + "\n"
+    results = []
+    iterations = {}
+    for solver in ("lu", "gmres", "inverse"):
+        solver_file = tmp_path / f"leed_{solver}.inp"
+        solver_file.write_text(
+            text + f"gs: {GIANT_MATRIX_SOLVER[solver]}\ngt: 1.e-10\n"
+        )
+        result = call_cleed(str(solver_file), str(solver_file), phase_shift)
+        results.append(iv_array(result))
+        profile = result_profile(result)
+        n_giant = profile["calls"][:, PROFILE_STAGES.index("giant_matrix")]
+        iterations[solver] = (profile["mbg_iterations"], n_giant)
+    assert np.allclose(results[0], results[1], rtol=1e-7)
+    assert np.allclose(results[0], results[2], rtol=1e-7)
+
+    # The GMRES iterations are reported per energy; the direct solvers
+    # have none.
+    gmres_iterations, n_giant = iterations["gmres"]
+    assert np.all(n_giant > 0)
+    assert np.all(gmres_iterations > 0)
+    assert np.all(gmres_iterations < GMRES_MAX_ITERATIONS * n_giant)
+    assert np.all(iterations["lu"][0] == 0)
+    assert np.all(iterations["inverse"][0] == 0)
+
+
+def test_leed_log_level(capfd):
+    script_dir = Path(__file__).resolve().parent
+    parameter_file = str(script_dir / "../../examples/ni111_cu_leed/leed.inp")
+    phase_shift = str(script_dir / "../../examples/data/PHASE")
+    libc = ctypes.CDLL(None)
+
+    def control_output(level, categories=None):
+        set_log_level(level, categories)
+        try:
+            call_cleed(parameter_file, parameter_file, phase_shift)
+        finally:
+            set_log_level("none")
+        libc.fflush(None)
+        return capfd.readouterr().out
+
+    assert control_output("none") == ""
+    output = control_output("control", ["layer_doubling"])
+    assert "(ld_2n)" in output
+    assert "(ms_bravl)" not in output
+
+
+def test_leed_profile():
+    script_dir = Path(__file__).resolve().parent
+    parameter_file = str(script_dir / "../../examples/ni111_2x2O_leed/leed.inp")
+    phase_shift = str(script_dir / "../../examples/data/PHASE")
+    result = call_cleed(parameter_file, parameter_file, phase_shift)
+    profile = result_profile(result)
+
+    n_stages = len(PROFILE_STAGES)
+    assert profile["time"].shape == (result.n_energies, n_stages)
+    assert profile["calls"].shape == (result.n_energies, n_stages)
+    assert np.all(profile["time"] >= 0.0)
+
+    calls = dict(zip(PROFILE_STAGES, profile["calls"].T))
+    for stage in ("update", "beams", "output"):
+        assert np.all(calls[stage] == 1)
+    for stage in ("lattice_sums", "tmatrix", "giant_matrix", "bulk_doubling"):
+        assert np.all(calls[stage] > 0)
+
+    assert np.all(profile["bytes"] > 0)
+
+
+def test_leed_result_arrays(tmp_path):
+    script_dir = Path(__file__).resolve().parent
+    parameter_file = str(script_dir / "../../examples/ni111_cu_leed/leed.inp")
+    phase_shift = str(script_dir / "../../examples/data/PHASE")
+
+    with LeedSession(parameter_file, parameter_file, phase_shift) as session:
+        result = session.evaluate()
+        arrays = result.arrays()
+
+        assert arrays.iv_curves.shape == (result.n_energies, result.n_beams)
+        assert arrays.iv_curves.flags.c_contiguous
+        assert not arrays.iv_curves.flags.writeable
+        assert np.array_equal(arrays.iv_curves.ravel(), iv_array(result))
+        assert np.array_equal(
+            arrays.energies, [result.energies[i] for i in range(result.n_energies)]
+        )
+        assert np.array_equal(
+            arrays.beam_set, [result.beam_set[i] for i in range(result.n_beams)]
+        )
+        # Views of the session buffers, not copies.
+        assert (
+            arrays.iv_curves.__array_interface__["data"][0]
+            == ctypes.cast(result.iv_curves, ctypes.c_void_p).value
+        )
+
+        iv = cleed_result_to_iv(result)
+        assert iv.shape == (result.n_energies * result.n_beams, 5)
+        assert np.array_equal(iv[:, 4], iv_array(result))
+        assert np.array_equal(iv[: result.n_beams, 0], arrays.beam_index1)
+        assert np.allclose(iv[:: result.n_beams, 3], arrays.energies * HART)
+
+        curves = cleed_result_to_curves(result)
+        assert np.array_equal(curves.intensities, arrays.iv_curves)
+        dataset = ExperimentalDataset.from_iv(iv)
+        assert np.isclose(dataset.rfactor(curves, 2.0), compute_rfactor(iv, iv, 2.0))
+
+        output_file = tmp_path / "leed.out"
+        print_cleed_results(result, output_file)
+        assert np.allclose(
+            np.loadtxt(output_file)[:, 1:], arrays.iv_curves, rtol=1e-6, atol=0.0
+        )
+
+
+def resident_memory():
+    """Resident set size of this process [bytes]."""
+    with open("/proc/self/statm") as f:
+        return int(f.read().split()[1]) * os.sysconf("SC_PAGE_SIZE")
+
+
+@pytest.mark.skipif(
+    not Path("/proc/self/statm").exists(), reason="needs /proc/self/statm"
+)
+def test_leed_memory(tmp_path):
+    script_dir = Path(__file__).resolve().parent
+    parameter_file = script_dir / "../../examples/ni111_cu_leed/leed.inp"
+    phase_shift = str(script_dir / "../../examples/data/PHASE")
+    short_file = tmp_path / "leed.inp"
+    short_file.write_text(parameter_file.read_text().replace("ef: 498.1", "ef: 150."))
+    short_file = str(short_file)
+
+    result = call_cleed(short_file, short_file, phase_shift)
+    reference = np.array(result.arrays().iv_curves)
+    result.free()
+    assert result.n_energies == 0 and not result.iv_curves
+    result.free()
+
+    def repeat(evaluate, n=30):
+        evaluate()
+        memory = resident_memory()
+        n_files = len(os.listdir("/proc/self/fd"))
+        for _ in range(n):
+            evaluate()
+        gc.collect()
+        return resident_memory() - memory, len(os.listdir("/proc/self/fd")) - n_files
+
+    def run():
+        result = call_cleed(short_file, short_file, phase_shift)
+        assert np.array_equal(result.arrays().iv_curves, reference)
+
+    growth, new_files = repeat(run)
+    assert growth < 4 * 2**20
+    assert new_files == 0
+
+    with LeedSession(short_file, short_file, phase_shift) as session:
+        growth, _ = repeat(session.evaluate)
+    assert growth < 4 * 2**20
@@ -3,6 +3,7 @@ import math
 import matplotlib.pyplot as plt
 import numpy as np
 import pytest
+from scipy.interpolate import CubicSpline
 
 from cleedpy import rfactor as rf
 
@@ -202,3 +203,153 @@ def test_find_common_x_axis():
     expected = np.array([3, 4, 5])
     result = rf.find_common_x_axis(reference_grid=x1, other_grid=x2)
     assert np.array_equal(result, expected), f"Expected {expected}, but got {result}"
+
+
+def direct_smoothing(energies, intensities, vi=4.0):
+    """Lorentzian smoothing evaluated point by point."""
+    weights = vi**2 / ((energies[None, :] - energies[:, None]) ** 2 + vi**2)
+    return weights @ intensities / weights.sum(axis=1)
+
+
+def synthetic_iv(beams, shift=0.0):
+    """IV rows (index1, index2, set, energy, intensity) of the beams given
+    as (index1, index2, first energy, last energy, step)."""
+    rows = []
+    for index1, index2, e_first, e_last, step in beams:
+        e = np.arange(e_first, e_last + step / 2, step)
+        i = np.sin((e + shift) * np.pi / (20 + index1)) ** 2 + 0.1 + index2
+        indices = np.full((e.size, 2), (index1, index2))
+        rows.append(np.column_stack([indices, np.zeros(e.size), e, i]))
+    return np.vstack(rows)
+
+
+@pytest.mark.parametrize("step", [1.0, None])
+def test_smooth_curves(step):
+    """All columns at once, padded columns and equidistant (FFT) or other
+    energies agree with the direct evaluation."""
+    rng = np.random.default_rng(1)
+    lengths = (40, 25, 33)
+    energies = np.full((max(lengths), len(lengths)), np.nan)
+    intensities = np.full_like(energies, np.nan)
+    for i, n in enumerate(lengths):
+        if step is None:
+            energies[:n, i] = np.sort(rng.uniform(50.0, 150.0, n))
+        else:
+            energies[:n, i] = 60.0 + 3 * i + step * np.arange(n)
+        intensities[:n, i] = rng.uniform(0.1, 1.0, n)
+
+    smoothed = rf.smooth_curves(energies, intensities)
+    for i, n in enumerate(lengths):
+        assert np.allclose(
+            smoothed[:n, i],
+            direct_smoothing(energies[:n, i], intensities[:n, i]),
+            rtol=1e-12,
+            atol=0.0,
+        )
+        assert np.all(np.isnan(smoothed[n:, i]))
+
+
+def test_beam_curves():
+    iv = synthetic_iv([(1, 0, 80.0, 120.0, 2.0), (0, 1, 60.0, 100.0, 2.0)])
+    curves = rf.BeamCurves.from_iv(iv[::-1])
+    assert curves.beams.tolist() == [[0, 1], [1, 0]]
+    assert curves.energies.shape == (21, 2)
+    assert np.array_equal(curves.energies[:, 0], np.arange(60.0, 101.0, 2.0))
+    assert np.array_equal(curves.intensities[:, 1], iv[:21, -1])
+
+
+@pytest.mark.parametrize("rfactor_type", ["r2", "pendry"])
+@pytest.mark.parametrize("shift", [-3.3, 0.0, 4.0])
+def test_compute_rfactor(rfactor_type, shift):
+    """The R-factor of all beams at once equals the average of the R-factors
+    of the single beams weighted with their common energy range."""
+    experimental = synthetic_iv(
+        [(1, 0, 70.0, 200.0, 1.0), (0, 1, 95.0, 180.0, 1.0), (2, 0, 150.0, 250.0, 1.0)]
+    )
+    theoretical = synthetic_iv(
+        [(0, 1, 60.0, 250.0, 4.0), (1, 0, 60.0, 250.0, 4.0), (1, 1, 60.0, 250.0, 4.0)],
+        shift=1.5,
+    )
+    single = {"r2": rf.r2_factor, "pendry": rf.rp_factor}[rfactor_type]
+
+    r_tot, delta_tot = 0.0, 0.0
+    for beam in [(1, 0), (0, 1)]:
+        exp_curve = rf.lorentzian_smoothing(
+            experimental[np.all(experimental[:, :2] == beam, axis=1)][:, -2:]
+        )
+        theo_curve = rf.lorentzian_smoothing(
+            theoretical[np.all(theoretical[:, :2] == beam, axis=1)][:, -2:]
+        )
+        theo_curve[:, 0] += shift
+        common_x = rf.find_common_x_axis(exp_curve[:, 0], theo_curve[:, 0])
+        r = single(
+            np.column_stack([common_x, CubicSpline(*exp_curve.T)(common_x)]),
+            np.column_stack([common_x, CubicSpline(*theo_curve.T)(common_x)]),
+        )
+        r_tot += r * (common_x[-1] - common_x[0])
+        delta_tot += common_x[-1] - common_x[0]
+
+    assert math.isclose(
+        rf.compute_rfactor(experimental, theoretical, shift, rfactor_type),
+        r_tot / delta_tot,
+        rel_tol=1e-10,
+    )
+
+
+def test_experimental_dataset():
+    """A dataset built once gives the R-factors of compute_rfactor for any
+    theoretical curves, given as IV array or BeamCurves."""
+    experimental = synthetic_iv([(1, 0, 70.0, 200.0, 1.0), (0, 1, 95.0, 180.0, 1.0)])
+    dataset = rf.ExperimentalDataset.from_iv(experimental)
+
+    curves = rf.BeamCurves.from_iv(experimental)
+    smoothed = rf.smooth_curves(curves.energies, curves.intensities)
+    assert np.allclose(dataset.curves.intensities, smoothed, equal_nan=True)
+    assert np.allclose(
+        dataset.y,
+        rf.y_function(smoothed, rf.energy_step(curves.energies)),
+        equal_nan=True,
+    )
+
+    for phase in (0.0, 2.0):
+        theoretical = synthetic_iv(
+            [(0, 1, 60.0, 250.0, 4.0), (1, 0, 60.0, 250.0, 4.0)], shift=phase
+        )
+        for rfactor_type in ("r2", "pendry"):
+            expected = rf.compute_rfactor(experimental, theoretical, 1.0, rfactor_type)
+            assert dataset.rfactor(theoretical, 1.0, rfactor_type) == expected
+            assert math.isclose(
+                dataset.rfactor(rf.BeamCurves.from_iv(theoretical), 1.0, rfactor_type),
+                expected,
+                rel_tol=1e-12,
+            )
+
+
+def test_scan_shift():
+    """The shift scan evaluates many shifts at once and finds the shift of
+    synthetic curves, at least as well as a fine brute-force scan."""
+    experimental = synthetic_iv([(1, 0, 70.0, 200.0, 1.0), (0, 1, 95.0, 180.0, 1.0)])
+    theoretical = synthetic_iv(
+        [(0, 1, 60.0, 250.0, 4.0), (1, 0, 60.0, 250.0, 4.0)], shift=2.5
+    )
+    dataset, spline = rf.ExperimentalDataset.from_iv(experimental).prepare(theoretical)
+
+    shifts = np.linspace(-10.0, 10.0, 2001)
+    r = rf.total_rfactor(dataset, spline, shifts, "pendry")
+    for s, r_s in zip(shifts[::200], r[::200]):
+        assert math.isclose(
+            rf.total_rfactor(dataset, spline, s, "pendry"), r_s, rel_tol=1e-12
+        )
+
+    shift, r_min = rf.scan_shift(dataset, spline, rfactor_type="pendry")
+    # The smoothing at the ends of the curves moves the optimum slightly.
+    assert abs(shift - 2.5) < 0.1
+    assert abs(shift - shifts[np.argmin(r)]) < 0.01
+    assert r_min <= np.min(r) + 1e-6
+    assert r_min == pytest.approx(rf.total_rfactor(dataset, spline, shift, "pendry"))
+
+    # Curves shifted beyond their overlap are ignored.
+    r = rf.total_rfactor(dataset, spline, np.array([0.0, 1000.0]), "pendry")
+    assert np.isfinite(r[0]) and np.isnan(r[1])
+    with pytest.raises(ValueError):
+        rf.scan_shift(dataset, spline, bounds=(900.0, 1000.0))